@@ -0,0 +1,361 @@
+// bracketLedger.cpp
+//
+// Bracket order (profit target, stop loss and trailing stop) ledger.  See bracketLedger.h
+//
+//	NOTE: Signals are interpreted as in plLedger so that the net position tracked here is the net position the
+//		P&L ledger holds when the merged exits reach it.  The line items are not the ledger's: a reduction here
+//		closes line items in true FIFO order, while plLedger keeps the baseline signed test under which the oldest
+//		long line item absorbs the whole of a reduction.  On a reduction spanning several long line items the
+//		items left here, and so their targets and stops, differ from the ledger's.  The cash of the round trip
+//		is the same.  checkBracketOrder checks both
+//
+
+#include "bracketLedger.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "myMath.h"
+
+using namespace std;
+
+// Prototypes
+static bracketEntry createBracketEntry(const profitContext &ctx, const bracketState &br, int ID, int qty);
+static bool isAdditive(int openPosition, double sig);
+static bool knownAdvSig(double advSig);
+static int applySignal(const profitContext &ctx, bracketState &br, const int ID, double &badSig);
+static double stopLevel(const bracketState &br, const bracketEntry &entry);
+static void checkBracket(const profitContext &ctx, bracketState &br, const int ID);
+static void foldExitLedger(vector<profitEntry> &exitLedger);
+
+// Reset the state of a bracket
+void initBracket(bracketState &br, double profitTgt, double stopTgt, double trailTgt)
+{
+	br.profitTgt = profitTgt;
+	br.stopTgt = stopTgt;
+	br.trailTgt = trailTgt;
+	br.openLedger.clear();
+	br.exitLedger.clear();
+	br.openPosition = 0;
+}
+
+// Find the exits of every bracket
+int findExits(const profitContext &ctx, vector<bracketState> &brackets, double &badSig)
+{
+	const size_t numBrackets = brackets.size();
+	int sigIndex;
+
+	// As in plLedger nothing before the first trade is interpreted
+	for (sigIndex = 0; sigIndex < ctx.rows; sigIndex++)
+	{
+		if (abs(seriesAt(ctx.sig, sigIndex)) >= 1)
+			break;
+	}
+
+	// A signal on the last bar has no following bar to execute on
+	for (int curBar = sigIndex; curBar < ctx.rows - 1; curBar++)
+	{
+		for (size_t br = 0; br < numBrackets; br++)
+		{
+			if (applySignal(ctx, brackets[br], curBar, badSig) != 0)
+				return 1;
+
+			if (brackets[br].openPosition != 0)
+				checkBracket(ctx, brackets[br], curBar);
+		}
+	}
+
+	for (size_t br = 0; br < numBrackets; br++)
+	{
+		foldExitLedger(brackets[br].exitLedger);
+	}
+
+	return 0;
+}
+
+// Pure C++ entry point of the bracket sweep
+int bracketOrderStats(const double *barsPtr, const double *sigPtr, int rows, double minTick, const double *profitTicks,
+					  const double *stopTicks, const double *trailTicks, int numBrackets, double bigPoint, double cost,
+					  vector<plStats> &tgtStats, double &badSig)
+{
+	const profitContext ctx = createProfitContext(barsPtr, sigPtr, rows, minTick, 0);
+
+	vector<bracketState> brackets(numBrackets);
+	vector<const vector<profitEntry>*> ledgers(numBrackets);
+	for (int br = 0; br < numBrackets; br++)
+	{
+		initBracket(brackets[br], minTick * profitTicks[br], minTick * stopTicks[br], minTick * trailTicks[br]);
+		ledgers[br] = &brackets[br].exitLedger;
+	}
+
+	if (findExits(ctx, brackets, badSig) != 0)
+		return 1;
+
+	tgtStats.assign(numBrackets, plStats());
+	return statsLedgers(ctx, ledgers, bigPoint, cost, tgtStats, vector<double*>(numBrackets, (double*)NULL), badSig);
+}
+
+/////////////
+//
+// FUNCTIONS & METHODS
+//
+/////////////
+
+// Open a line item on the signal of bar 'ID'.  It is executed at the Open of the following bar
+static bracketEntry createBracketEntry(const profitContext &ctx, const bracketState &br, int ID, int qty)
+{
+	const double price = seriesAt(ctx.bars, ID + 1 + ctx.shiftOpen);
+	const double side = (qty > 0) ? 1 : -1;
+
+	// A disabled leg is placed at infinity so that it is never reached
+	bracketEntry entry;
+	entry.open.sigIndex = ID;
+	entry.open.qtyOpen = qty;
+	entry.open.openPrice = price;
+	entry.open.profitPrice = price + side * ((br.profitTgt > 0) ? br.profitTgt : HUGE_VAL);
+	entry.stopPrice = price - side * ((br.stopTgt > 0) ? br.stopTgt : HUGE_VAL);
+	entry.minMax = price;
+
+	return entry;
+}
+
+// Same test as plLedger.  A signal is additive when it adds to (or opens) the net position
+static bool isAdditive(int openPosition, double sig)
+{
+	return (openPosition <= 0 && sig <= -1) || (openPosition >= 0 && sig >= 1);
+}
+
+static bool knownAdvSig(double advSig)
+{
+	// For now we only need to check for |0.5|
+	double frac = abs(advSig - int(advSig));
+
+	if (frac == 0.5)		// Close any opposing open position
+	{
+		return true;
+	}
+	return false;
+}
+
+// Apply the signal of bar 'ID' to the open ledger
+static int applySignal(const profitContext &ctx, bracketState &br, const int ID, double &badSig)
+{
+	const double sig = seriesAt(ctx.sig, ID);
+
+	if (sig == 0)
+		return 0;
+
+	// REVERSE or FLATTEN
+	if (fraction(sig))
+	{
+		if (!knownAdvSig(sig))
+		{
+			badSig = sig;
+			return 1;
+		}
+
+		// Reverse instructions are ignored when they are additive
+		if (!isAdditive(br.openPosition, sig))
+		{
+			br.openLedger.clear();
+			br.openPosition = 0;
+		}
+	}
+
+	int qty = int(sig);
+
+	// REDUCE.  Opposing line items are closed FIFO
+	while (qty != 0 && br.openPosition != 0 && !isAdditive(br.openPosition, qty))
+	{
+		bracketEntry &front = br.openLedger.front();
+
+		if (abs(front.open.qtyOpen) > abs(qty))
+		{
+			front.open.qtyOpen = front.open.qtyOpen + qty;
+			br.openPosition = br.openPosition + qty;
+			qty = 0;
+		}
+		else
+		{
+			qty = qty + front.open.qtyOpen;
+			br.openPosition = br.openPosition - front.open.qtyOpen;
+			br.openLedger.pop_front();
+		}
+	}
+
+	// ADD.  Any remainder opens a new line item
+	if (qty != 0)
+	{
+		br.openLedger.push_back(createBracketEntry(ctx, br, ID, qty));
+		br.openPosition = br.openPosition + qty;
+	}
+
+	return 0;
+}
+
+// Effective stop of a line item.  The tighter of the hard stop and the trailing stop
+static double stopLevel(const bracketState &br, const bracketEntry &entry)
+{
+	if (br.trailTgt <= 0)
+		return entry.stopPrice;
+
+	if (entry.open.qtyOpen > 0)
+		return max(entry.stopPrice, entry.minMax - br.trailTgt);
+
+	return min(entry.stopPrice, entry.minMax + br.trailTgt);
+}
+
+// Check every open line item against the bar following signal 'ID'
+static void checkBracket(const profitContext &ctx, bracketState &br, const int ID)
+{
+	const double openPrice = seriesAt(ctx.bars, ID + 1 + ctx.shiftOpen);
+	const double highPrice = seriesAt(ctx.bars, ID + 1 + ctx.shiftHigh);
+	const double lowPrice = seriesAt(ctx.bars, ID + 1 + ctx.shiftLow);
+
+	// erase returns the following entry so the iterator is only advanced when nothing was taken
+	list<bracketEntry>::iterator iter = br.openLedger.begin();
+	while (iter != br.openLedger.end())
+	{
+		const bool isLong = (iter->open.qtyOpen > 0);
+		const bool entryBar = (iter->open.sigIndex == ID);
+		const double targetPrice = iter->open.profitPrice;
+		bool exit = false;
+		double exitPrice = 0;
+
+		// Gap through a level at the Open.  A line item entered on this bar was filled at the Open
+		if (!entryBar)
+		{
+			const double stopPrice = stopLevel(br, *iter);
+
+			if (isLong ? (openPrice <= stopPrice) : (openPrice >= stopPrice))
+			{
+				exit = true;
+				exitPrice = openPrice;
+			}
+			else if (isLong ? (openPrice >= targetPrice) : (openPrice <= targetPrice))
+			{
+				exit = true;
+				exitPrice = openPrice;
+			}
+			else
+			{
+				// The Open is known before the rest of the bar so it may tighten the trailing stop
+				iter->minMax = isLong ? max(iter->minMax, openPrice) : min(iter->minMax, openPrice);
+			}
+		}
+
+		// Range of the bar.  The stop is taken to have been reached first
+		if (!exit)
+		{
+			const double stopPrice = stopLevel(br, *iter);
+			const bool stopHit = isLong ? (entryBar ? lowPrice < stopPrice : lowPrice <= stopPrice)
+				: (entryBar ? highPrice > stopPrice : highPrice >= stopPrice);
+			const bool targetHit = isLong ? (entryBar ? highPrice > targetPrice : highPrice >= targetPrice)
+				: (entryBar ? lowPrice < targetPrice : lowPrice <= targetPrice);
+
+			if (stopHit)
+			{
+				exit = true;
+				exitPrice = stopPrice;
+			}
+			else if (targetHit)
+			{
+				exit = true;
+				exitPrice = targetPrice;
+			}
+		}
+
+		if (exit)
+		{
+			// The exit closes the line item so its quantity is reversed
+			profitEntry exitEntry;
+			exitEntry.barIndex = ID;
+			exitEntry.qtyProfit = -iter->open.qtyOpen;
+			exitEntry.profitPrice = exitPrice;
+			br.exitLedger.push_back(exitEntry);
+
+			br.openPosition = br.openPosition - iter->open.qtyOpen;
+			iter = br.openLedger.erase(iter);
+		}
+		else
+		{
+			// New High | Low for the trailing stop of the following bars
+			iter->minMax = isLong ? max(iter->minMax, highPrice) : min(iter->minMax, lowPrice);
+			iter++;
+		}
+	}
+}
+
+// Fold neighbouring exits of the same bar at the same price in to a single virtual bar
+static void foldExitLedger(vector<profitEntry> &exitLedger)
+{
+	// Each exit is folded in to the following exit and the survivors moved down in a single pass
+	size_t keep = 0;
+	for (size_t ii = 0; ii < exitLedger.size(); ii++)
+	{
+		if ((ii + 1 < exitLedger.size()) &&
+			(exitLedger[ii].barIndex == exitLedger[ii + 1].barIndex) &&
+			(exitLedger[ii].profitPrice == exitLedger[ii + 1].profitPrice))
+		{
+			exitLedger[ii + 1].qtyProfit = exitLedger[ii + 1].qtyProfit + exitLedger[ii].qtyProfit;
+		}
+		else
+		{
+			exitLedger[keep++] = exitLedger[ii];
+		}
+	}
+	exitLedger.resize(keep);
+}
+
+//
+//  -------------------------------------------------------------------------
+//                                  _    _ 
+//         ___  _ __   ___ _ __    / \  | | __ _  ___   ___  _ __ __ _ 
+//        / _ \| '_ \ / _ \ '_ \  / _ \ | |/ _` |/ _ \ / _ \| '__/ _` |
+//       | (_) | |_) |  __/ | | |/ ___ \| | (_| | (_) | (_) | | | (_| |
+//        \___/| .__/ \___|_| |_/_/   \_\_|\__, |\___(_)___/|_|  \__, |
+//             |_|                         |___/                 |___/
+//  -------------------------------------------------------------------------
+//        This code is distributed in the hope that it will be useful,
+//
+//                      	 WITHOUT ANY WARRANTY
+//
+//                  WITHOUT CLAIM AS TO MERCHANTABILITY
+//
+//                  OR FITNESS FOR A PARTICULAR PURPOSE
+//
+//                           expressed or implied.
+//
+//   Use of this code, pseudocode, algorithmic or trading logic contained
+//   herein, whether sound or faulty for any purpose is the sole
+//   responsibility of the USER. Any such use of these algorithms, coding
+//   logic or concepts in whole or in part carry no covenant of correctness
+//   or recommended usage from the AUTHOR or any of the possible
+//   contributors listed or unlisted, known or unknown.
+//
+//   Any reference of this code or to this code including any variants from
+//   this code, or any other credits due this AUTHOR from this code shall be
+//   clearly and unambiguously cited and evident during any use, whether in
+//   whole or in part.
+//
+//   The public sharing of this code does not relinquish, reduce, restrict or
+//   encumber any rights the AUTHOR has in respect to claims of intellectual
+//   property.
+//
+//   IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY
+//   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+//   OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+//   ANY WAY OUT OF THE USE OF THIS SOFTWARE, CODE, OR CODE FRAGMENT(S), EVEN
+//   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//   -------------------------------------------------------------------------
+//
+//                             ALL RIGHTS RESERVED
+//
+//   -------------------------------------------------------------------------
+//
+//   Author:	Mark Tompkins
+//   Copyright:	(c)2013
+//
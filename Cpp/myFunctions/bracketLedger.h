@@ -0,0 +1,113 @@
+#ifndef BRACKETLEDGER_H
+#define BRACKETLEDGER_H
+
+#include <list>
+#include <vector>
+#include "plLedger.h"
+#include "profitTarget.h"
+
+// Bracket order (profit target, stop loss and trailing stop) ledger used by bracketOrder
+//
+// Every open position line item carries its own bracket which is checked against each bar in one pass:
+//	- A gap through the stop or the target at the Open exits at the Open
+//	- Otherwise a bar reaching the stop exits at the stop and a bar reaching the target exits at the target.
+//	  A bar reaching both is taken to have reached the stop first
+//	- On the bar of entry a level must be exceeded rather than touched, as in numTicksProfit's same bar check
+//	- The trailing stop follows the most favourable price (minMax) of the bars before the one being checked,
+//	  and the Open of that bar, so it never uses a High | Low that may have come after the stop was reached
+// Exits are profitEntry rows and are merged in to the bars and signal exactly as numTicksProfit's profits are
+// (see expandRows and statsLedgers in profitTarget.h).  A distance of zero disables that leg of the bracket.
+// Line items are reduced in true FIFO order, so only the net position is shared with plLedger (see bracketLedger.cpp).
+//
+// Every routine holds no state of its own, so any number of calls may run concurrently provided they do not
+// share a bracketState.
+
+// Open position line item with its bracket
+typedef struct bracketEntry
+{
+	openEntry open;				// Entry.  open.profitPrice is the profit target
+	double stopPrice;			// Hard stop
+	double minMax;				// Most favourable price since entry (trailing stop reference)
+} bracketEntry;
+
+// Bracket state of one set of exit distances
+typedef struct bracketState
+{
+	double profitTgt;			// Profit target distance (minTick * profitTicks).  0 = none
+	double stopTgt;				// Stop loss distance (minTick * stopTicks).  0 = none
+	double trailTgt;			// Trailing stop distance (minTick * trailTicks).  0 = none
+	std::list<bracketEntry> openLedger;	// Open positions
+	std::vector<profitEntry> exitLedger;	// Exits taken (target, stop or trailing stop) in bar order
+	int openPosition;			// Net open position
+} bracketState;
+
+// Reset the state of a bracket
+void initBracket(bracketState &br, double profitTgt, double stopTgt, double trailTgt);
+
+// Find the exits of every bracket.  Every bracket is advanced on a bar before the next bar is read.
+// On success each bracket's exitLedger is in bar order with same bar, same price exits folded together.
+// Returns 0 on success or 1 if a signal could not be interpreted, in which case 'badSig' holds the offending value
+int findExits(const profitContext &ctx, std::vector<bracketState> &brackets, double &badSig);
+
+// Pure C++ entry point equivalent to bracketOrder('pl',bars,sig,minTick,profitTicks,stopTicks,trailTicks,bigPoint,cost,'stats').
+// Each of the tick arrays holds 'numBrackets' values and 'tgtStats' receives one summary per bracket.
+// Returns 0 on success or 1 if a signal could not be interpreted, in which case 'badSig' holds the offending value
+int bracketOrderStats(const double *barsPtr, const double *sigPtr, int rows, double minTick, const double *profitTicks,
+					  const double *stopTicks, const double *trailTicks, int numBrackets, double bigPoint, double cost,
+					  std::vector<plStats> &tgtStats, double &badSig);
+
+#endif // BRACKETLEDGER_H
+
+//
+//  -------------------------------------------------------------------------
+//                                  _    _ 
+//         ___  _ __   ___ _ __    / \  | | __ _  ___   ___  _ __ __ _ 
+//        / _ \| '_ \ / _ \ '_ \  / _ \ | |/ _` |/ _ \ / _ \| '__/ _` |
+//       | (_) | |_) |  __/ | | |/ ___ \| | (_| | (_) | (_) | | | (_| |
+//        \___/| .__/ \___|_| |_/_/   \_\_|\__, |\___(_)___/|_|  \__, |
+//             |_|                         |___/                 |___/
+//  -------------------------------------------------------------------------
+//        This code is distributed in the hope that it will be useful,
+//
+//                      	 WITHOUT ANY WARRANTY
+//
+//                  WITHOUT CLAIM AS TO MERCHANTABILITY
+//
+//                  OR FITNESS FOR A PARTICULAR PURPOSE
+//
+//                           expressed or implied.
+//
+//   Use of this code, pseudocode, algorithmic or trading logic contained
+//   herein, whether sound or faulty for any purpose is the sole
+//   responsibility of the USER. Any such use of these algorithms, coding
+//   logic or concepts in whole or in part carry no covenant of correctness
+//   or recommended usage from the AUTHOR or any of the possible
+//   contributors listed or unlisted, known or unknown.
+//
+//   Any reference of this code or to this code including any variants from
+//   this code, or any other credits due this AUTHOR from this code shall be
+//   clearly and unambiguously cited and evident during any use, whether in
+//   whole or in part.
+//
+//   The public sharing of this code does not relinquish, reduce, restrict or
+//   encumber any rights the AUTHOR has in respect to claims of intellectual
+//   property.
+//
+//   IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY
+//   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+//   OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+//   ANY WAY OUT OF THE USE OF THIS SOFTWARE, CODE, OR CODE FRAGMENT(S), EVEN
+//   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//   -------------------------------------------------------------------------
+//
+//                             ALL RIGHTS RESERVED
+//
+//   -------------------------------------------------------------------------
+//
+//   Author:	Mark Tompkins
+//   Copyright:	(c)2013
+//
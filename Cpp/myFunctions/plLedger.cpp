@@ -0,0 +1,584 @@
+// plLedger.cpp
+//
+// Bar by bar profit & loss ledger.  See plLedger.h
+//
+//	NOTE: This ledger accepts both advanced (fractional) and standard SIGNAL inputs as documented in calcProfitLoss.cpp
+//
+
+#include "plLedger.h"
+#include <cmath>
+#include <limits>
+#include "myMath.h"
+
+using namespace std;
+
+// Prototypes
+static bool knownAdvSig(double advSig);
+
+// Reset a ledger to its initial flat state
+void plInit(plState &st, double bigPoint, double cost)
+{
+	st.bigPoint = bigPoint;
+	st.cost = cost;
+
+	st.openLedger = createOpenBook();
+	st.openPosition = 0;
+	st.anyTrades = false;
+	st.pendingSig = 0;
+	st.bars = 0;
+
+	st.runSum = 0;
+	st.prevRunSum = 0;
+	st.prevPrevNetLiq = 0;
+
+	st.cur.cash = 0;
+	st.cur.openEQ = 0;
+	st.cur.netLiq = 0;
+	st.cur.returns = 0;
+	st.cur.closed = false;
+	st.prev = st.cur;
+}
+
+int plStep(plState &st, double openPrice, double closePrice, double sig, double &badSig)
+{
+	// The pending signal is executed on this bar. It is checked before anything is changed
+	// so that a failure leaves the state at the last good bar
+	const double pendSig = st.pendingSig;
+	const bool execute = (st.bars > 0 && st.anyTrades);
+
+	if (plCheckPending(st, badSig) != 0)
+		return 1;
+
+	const int ii = st.bars - 1;				// Index of the signal being executed
+	double cashBar = 0;
+	double openEQBar = 0;
+	bool closedBar = false;					// A position is reduced or closed on this bar
+
+	// Put first trade on ledger
+	// We only need the integer portion of the first trade
+	if (st.bars > 0 && !st.anyTrades)
+	{
+		if (abs(pendSig) >= 1)				// See if we have a signal that generates a position
+		{
+			bookPush(st.openLedger, createLineEntry(ii, int(pendSig), openPrice));
+			st.openPosition = int(pendSig);
+			st.anyTrades = true;
+		}
+	}
+	else if (execute)
+	{
+		if (pendSig != 0)
+		{
+			// Is this an advanced signal?
+			// Unknown advanced signals have been rejected above
+			if (fraction(pendSig))
+			{
+				// Check for additive or reductive
+				if ((st.openPosition <= 0 && pendSig <= -1) || (st.openPosition >= 0 && pendSig >= 1))
+				// Additive
+				{
+					// We ignore reverse advance instructions when they are additive
+				}
+				// Reductive
+				else
+				{
+					// Reverse instruction
+					// Liquidate any open position
+					while (!st.openLedger.lines.empty())
+					{
+						// Aggregate cash for the executing observation
+						closedBar = true;
+						cashBar = cashBar + ((openPrice - st.openLedger.lines.front().price) * st.openLedger.lines.front().quantity * st.bigPoint) - 
+							(abs(st.openLedger.lines.front().quantity) * st.cost);
+						bookPopFront(st.openLedger);
+					}
+
+					st.openPosition = 0;
+				}
+			}
+
+			// Any integer and if so Additive or reductive ?
+			if ((st.openPosition <= 0 && pendSig <= -1) || (st.openPosition >= 0 && pendSig >= 1))
+				// Additive
+			{
+				// Trade is additive. Add or create existing position --> openLedger
+				bookPush(st.openLedger, createLineEntry(ii, int(pendSig), openPrice));
+				st.openPosition = st.openPosition + int(pendSig);
+			}
+			// Reductive
+			else
+			{
+				// Signal is effectively a reverse or liquidate
+				if (int(abs(pendSig)) >= abs(st.openPosition))
+				{
+					// New trade is larger than or equal to existing position. Calculate cash on all ledger lines
+					while (!st.openLedger.lines.empty())
+					{
+						// Aggregate cash for the executing observation
+						closedBar = true;
+						cashBar = cashBar + ((openPrice - st.openLedger.lines.front().price) * st.openLedger.lines.front().quantity * st.bigPoint) - 
+							(abs(st.openLedger.lines.front().quantity) * st.cost);
+						bookPopFront(st.openLedger);
+					}
+
+					// update open position tracker
+					st.openPosition = int(pendSig) + st.openPosition;
+
+					// if there is a 'remainder', this is the new net open position
+					// put it on the openLedger
+					if (st.openPosition != 0)
+					{
+						bookPush(st.openLedger, createLineEntry(ii, st.openPosition, openPrice));
+					}
+				}
+				// partial liquidation
+				else
+				{
+					// New trade is smaller than the current open position.
+					// How many do we need to reduce by?
+					int needQty = int(pendSig);
+
+					// Prepare to iterate until we are satisfied
+					while (needQty != 0)
+					{
+						// Is the current line item quantity larger than what we need?
+						if (abs(st.openLedger.lines.front().quantity) > needQty)
+						{
+							// If so we will P&L the quantity we need and reduce the open position size
+							closedBar = true;
+							cashBar = cashBar + ((openPrice - st.openLedger.lines.front().price) * -needQty * st.bigPoint) - 
+								(abs(needQty) * st.cost);
+							// Reduce the position size.  We are aggregating so we add (e.g. 5 Purchases + 4 Sales = 1 Long)
+							bookAdjustFront(st.openLedger, needQty);
+							// We are satisfied and don't need any more contracts
+							needQty = 0;
+						}
+						// Current line item quantity is equal to or smaller than what we need.  Process P&L and remove.
+						else
+						{
+							// P&L entire quantity
+							closedBar = true;
+							cashBar = cashBar + ((openPrice - st.openLedger.lines.front().price) * -st.openLedger.lines.front().quantity * st.bigPoint) - 
+								(abs(st.openLedger.lines.front().quantity) * st.cost);
+							// Reduce needed quantity by what we've been provided
+							needQty = needQty + st.openLedger.lines.front().quantity;
+							// Remove the line item (FIFO)
+							bookPopFront(st.openLedger);
+						}
+					}
+					// Rebuild the aggregates from the remaining line items so the rounding of the removed
+					// quantities does not carry in to the marks of the open position
+					bookResum(st.openLedger);
+
+					// update open position tracker
+					st.openPosition = int(st.openPosition + pendSig);
+				}
+			}
+		}
+
+		// Calculate current openEQ if there are any positions
+		// !!!!!!!!!!!!!!!!!!!!!!
+		// !! IMPORTANT
+		// !!!!!!!!!!!!!!!!!!!!!!
+		// Because we are using virtual bars for calculations, we have introduced a known issue
+		// that a profit may occur within an observation High or Low.  To offset this we will
+		// clean the prior bar's openEQ below. This will cause some invalid depictions
+		// of open equity between observations but would be effectively be a margining issue
+		if (st.openPosition != 0)
+		{
+			// Mark all line items at once from the ledger aggregates
+			openEQBar = bookOpenEQ(st.openLedger, closePrice, st.bigPoint);
+		}
+	}
+
+	// The bar before is now final
+	st.prevPrevNetLiq = st.prev.netLiq;
+	st.prev = st.cur;
+	st.prevRunSum = st.runSum;
+
+	// This is a 'dirty' cleaning of trades that were closed on the next observation.
+	// Because we are creating a vBar for profit objectives, if the openEquity is greater than the next
+	// observation's cash, we'll reduce openEquity to equal cash.  This should normalize some spikes.
+	// The first observation is never cleaned
+	if (st.bars >= 2)
+	{
+		if (st.prev.openEQ != cashBar && openEQBar == 0 && cashBar > 0)
+		{
+			st.prev.openEQ = cashBar;
+		}
+		st.prev.netLiq = st.prevRunSum + st.prev.openEQ;
+		st.prev.returns = st.prev.netLiq - st.prevPrevNetLiq;
+	}
+
+	// Calculate a cumulative sum of closed trades and open equity per observation
+	st.runSum = st.runSum + cashBar;
+	st.cur.cash = cashBar;
+	st.cur.openEQ = openEQBar;
+	st.cur.closed = closedBar;
+	st.cur.netLiq = st.runSum + openEQBar;
+
+	// Calculate a return from day to day based on the change in value observation to observation
+	st.cur.returns = (st.bars > 0) ? st.cur.netLiq - st.prev.netLiq : 0;
+
+	st.pendingSig = sig;
+	st.bars++;
+
+	return 0;
+}
+
+// Check the pending signal as plStep will when it is executed on the next bar
+int plCheckPending(const plState &st, double &badSig)
+{
+	// Signals before the first trade only contribute their integer portion
+	if (st.bars > 0 && st.anyTrades && fraction(st.pendingSig) && !knownAdvSig(st.pendingSig))
+	{
+		// Unknown advanced signal.  Report back to the caller.
+		badSig = st.pendingSig;
+		return 1;
+	}
+
+	return 0;
+}
+
+// P&L a single signal column from bar 0
+int plColumn(const double *openPtr, const double *closePtr, const double *sigPtr, int rows, double bigPoint, double cost,
+			 double *cashIdx, double *openEQIdx, double *netLiqIdx, double *returnsIdx, double &badSig)
+{
+	return plColumn(createSeries(openPtr), createSeries(closePtr), createSeries(sigPtr), rows, bigPoint, cost,
+		cashIdx, openEQIdx, netLiqIdx, returnsIdx, badSig);
+}
+
+int plColumn(const plSeries &open, const plSeries &close, const plSeries &sig, int rows, double bigPoint, double cost,
+			 double *cashIdx, double *openEQIdx, double *netLiqIdx, double *returnsIdx, double &badSig)
+{
+	plState st;
+	plInit(st, bigPoint, cost);
+
+	for (int ii = 0; ii < rows; ii++)
+	{
+		if (plStep(st, seriesAt(open, ii), seriesAt(close, ii), seriesAt(sig, ii), badSig) != 0)
+			return 1;
+
+		// The prior bar is final once this bar has been processed
+		if (ii > 0)
+		{
+			cashIdx[ii-1] = st.prev.cash;
+			openEQIdx[ii-1] = st.prev.openEQ;
+			netLiqIdx[ii-1] = st.prev.netLiq;
+			returnsIdx[ii-1] = st.prev.returns;
+		}
+	}
+
+	// Last observation
+	if (rows > 0)
+	{
+		cashIdx[rows-1] = st.cur.cash;
+		openEQIdx[rows-1] = st.cur.openEQ;
+		netLiqIdx[rows-1] = st.cur.netLiq;
+		returnsIdx[rows-1] = st.cur.returns;
+	}
+
+	return 0;
+}
+
+// Accumulate the performance statistics of a single signal column from bar 0
+int plColumnStats(const double *openPtr, const double *closePtr, const double *sigPtr, int rows, double bigPoint, double cost,
+				  plStats &stats, double &badSig)
+{
+	return plColumnStats(createSeries(openPtr), createSeries(closePtr), createSeries(sigPtr), rows, bigPoint, cost, stats, badSig);
+}
+
+int plColumnStats(const plSeries &open, const plSeries &close, const plSeries &sig, int rows, double bigPoint, double cost,
+				  plStats &stats, double &badSig)
+{
+	// A split at the last observation places every bar in the first segment
+	plStats unused;
+	return plColumnSplitStats(open, close, sig, rows, bigPoint, cost, rows, stats, unused, badSig);
+}
+
+// Accumulate the performance statistics of a single signal column split in to test and validation segments
+int plColumnSplitStats(const double *openPtr, const double *closePtr, const double *sigPtr, int rows, double bigPoint, double cost,
+					   int splitIdx, plStats &testStats, plStats &valStats, double &badSig)
+{
+	return plColumnSplitStats(createSeries(openPtr), createSeries(closePtr), createSeries(sigPtr), rows, bigPoint, cost,
+		splitIdx, testStats, valStats, badSig);
+}
+
+int plColumnSplitStats(const plSeries &open, const plSeries &close, const plSeries &sig, int rows, double bigPoint, double cost,
+					   int splitIdx, plStats &testStats, plStats &valStats, double &badSig)
+{
+	plState st;
+	plInit(st, bigPoint, cost);
+	plStatsInit(testStats);
+	plStatsInit(valStats);
+
+	for (int ii = 0; ii < rows; ii++)
+	{
+		if (plStep(st, seriesAt(open, ii), seriesAt(close, ii), seriesAt(sig, ii), badSig) != 0)
+			return 1;
+
+		// The prior bar is final once this bar has been processed
+		if (ii > 0)
+			plStatsAdd((ii - 1 < splitIdx) ? testStats : valStats, st.prev);
+	}
+
+	// Last observation
+	if (rows > 0)
+		plStatsAdd((rows - 1 < splitIdx) ? testStats : valStats, st.cur);
+
+	return 0;
+}
+
+/////////////
+//
+// FUNCTIONS & METHODS
+//
+/////////////
+
+// Constructor for a double series read unchanged
+plSeries createSeries(const double *ptr)
+{
+	return createSeries(ptr, PL_DOUBLE, 1.0);
+}
+
+// Constructor for a series of any supported element type
+plSeries createSeries(const void *ptr, int type, double scale)
+{
+	plSeries series;
+	series.ptr = ptr;
+	series.type = type;
+	series.scale = scale;
+
+	return series;
+}
+
+// The same series starting 'count' elements later
+plSeries seriesOffset(const plSeries &series, size_t count)
+{
+	size_t elemSize;
+	switch (series.type)
+	{
+	case PL_INT8:	elemSize = sizeof(int8_t);	break;
+	case PL_INT16:	elemSize = sizeof(int16_t);	break;
+	case PL_INT32:	elemSize = sizeof(int32_t);	break;
+	default:	elemSize = sizeof(double);	break;
+	}
+
+	return createSeries((const char*)series.ptr + count * elemSize, series.type, series.scale);
+}
+
+// Constructor for ledger line item creation
+tradeEntry createLineEntry(int ID, int qty, double price)
+{
+	tradeEntry lineEntry;
+	lineEntry.index = ID;
+	lineEntry.quantity = qty;
+	lineEntry.price = price;
+
+	return lineEntry;
+}
+
+// Constructor for an empty open position ledger
+openBook createOpenBook()
+{
+	openBook book;
+	book.netQty = 0;
+	book.netCost = 0;
+
+	return book;
+}
+
+// Add a line item to the back of the ledger
+void bookPush(openBook &book, const tradeEntry &entry)
+{
+	book.lines.push_back(entry);
+	book.netQty = book.netQty + entry.quantity;
+	book.netCost = book.netCost + (entry.quantity * entry.price);
+}
+
+// Remove the oldest line item (FIFO)
+void bookPopFront(openBook &book)
+{
+	book.netQty = book.netQty - book.lines.front().quantity;
+	book.netCost = book.netCost - (book.lines.front().quantity * book.lines.front().price);
+	book.lines.pop_front();
+
+	// Start clean once flat so rounding does not carry into the next position
+	if (book.lines.empty())
+	{
+		book.netQty = 0;
+		book.netCost = 0;
+	}
+}
+
+// Change the quantity of the oldest line item by 'qty' (e.g. 5 Purchases + 4 Sales = 1 Long)
+void bookAdjustFront(openBook &book, int qty)
+{
+	book.lines.front().quantity = book.lines.front().quantity + qty;
+	book.netQty = book.netQty + qty;
+	book.netCost = book.netCost + (qty * book.lines.front().price);
+}
+
+// Recompute the aggregates from the line items
+void bookResum(openBook &book)
+{
+	book.netQty = 0;
+	book.netCost = 0;
+	for (size_t jj = 0; jj < book.lines.size(); jj++)
+	{
+		book.netQty = book.netQty + book.lines[jj].quantity;
+		book.netCost = book.netCost + (book.lines[jj].quantity * book.lines[jj].price);
+	}
+}
+
+// Open equity of all line items marked at 'markPrice'
+// Equivalent to summing (markPrice - price) * quantity * bigPoint over every line item
+double bookOpenEQ(const openBook &book, double markPrice, double bigPoint)
+{
+	return ((markPrice * book.netQty) - book.netCost) * bigPoint;
+}
+
+// Constructor for empty performance statistics
+void plStatsInit(plStats &stats)
+{
+	stats.obsv = 0;
+	stats.meanRet = 0;
+	stats.m2Ret = 0;
+	stats.peakNetLiq = 0;
+	stats.maxDD = 0;
+	stats.grossProfit = 0;
+	stats.grossLoss = 0;
+	stats.numTrades = 0;
+	stats.numWins = 0;
+}
+
+// Add the final values of the next bar
+void plStatsAdd(plStats &stats, const plBar &bar)
+{
+	// Welford's running mean and variance of returns
+	stats.obsv++;
+	double delta = bar.returns - stats.meanRet;
+	stats.meanRet = stats.meanRet + delta / stats.obsv;
+	stats.m2Ret = stats.m2Ret + delta * (bar.returns - stats.meanRet);
+
+	// Drawdown from the running peak of netLiq
+	if (stats.obsv == 1 || bar.netLiq > stats.peakNetLiq)
+	{
+		stats.peakNetLiq = bar.netLiq;
+	}
+	if (stats.peakNetLiq - bar.netLiq > stats.maxDD)
+	{
+		stats.maxDD = stats.peakNetLiq - bar.netLiq;
+	}
+
+	// Closed trades
+	if (bar.closed)
+	{
+		stats.numTrades++;
+		if (bar.cash > 0)
+		{
+			stats.numWins++;
+			stats.grossProfit = stats.grossProfit + bar.cash;
+		}
+		else
+		{
+			stats.grossLoss = stats.grossLoss + bar.cash;
+		}
+	}
+}
+
+// Sharpe ratio with a zero risk free rate as Matlab sharpe(returns,0)
+// Uses the N-1 normalized standard deviation
+double plSharpe(const plStats &stats)
+{
+	if (stats.obsv < 2)
+		return numeric_limits<double>::quiet_NaN();
+
+	return stats.meanRet / sqrt(stats.m2Ret / (stats.obsv - 1));
+}
+
+double plProfitFactor(const plStats &stats)
+{
+	return stats.grossProfit / abs(stats.grossLoss);
+}
+
+double plWinRate(const plStats &stats)
+{
+	return double(stats.numWins) / stats.numTrades;
+}
+
+// The test segment is weighted twice as heavily as the validation segment
+double plMETS(double sharpeTest, double sharpeVal)
+{
+	return ((sharpeTest * 2) + sharpeVal) / 3;
+}
+
+static bool knownAdvSig(double advSig)
+{
+	// We can check for known advanced signals to help in debugging
+	// by registering them here.  This can be a searchable array when
+	// more than one advanced signal exists.
+	// For now we only need to check for |0.5|
+
+	double frac = abs(advSig - int(advSig));
+
+	if (frac == 0.5)		// Close any opposing open position
+	{
+		return true;
+	}
+	return false;
+}
+
+//
+//  -------------------------------------------------------------------------
+//                                  _    _ 
+//         ___  _ __   ___ _ __    / \  | | __ _  ___   ___  _ __ __ _ 
+//        / _ \| '_ \ / _ \ '_ \  / _ \ | |/ _` |/ _ \ / _ \| '__/ _` |
+//       | (_) | |_) |  __/ | | |/ ___ \| | (_| | (_) | (_) | | | (_| |
+//        \___/| .__/ \___|_| |_/_/   \_\_|\__, |\___(_)___/|_|  \__, |
+//             |_|                         |___/                 |___/
+//  -------------------------------------------------------------------------
+//        This code is distributed in the hope that it will be useful,
+//
+//                      	 WITHOUT ANY WARRANTY
+//
+//                  WITHOUT CLAIM AS TO MERCHANTABILITY
+//
+//                  OR FITNESS FOR A PARTICULAR PURPOSE
+//
+//                           expressed or implied.
+//
+//   Use of this code, pseudocode, algorithmic or trading logic contained
+//   herein, whether sound or faulty for any purpose is the sole
+//   responsibility of the USER. Any such use of these algorithms, coding
+//   logic or concepts in whole or in part carry no covenant of correctness
+//   or recommended usage from the AUTHOR or any of the possible
+//   contributors listed or unlisted, known or unknown.
+//
+//   Any reference of this code or to this code including any variants from
+//   this code, or any other credits due this AUTHOR from this code shall be
+//   clearly and unambiguously cited and evident during any use, whether in
+//   whole or in part.
+//
+//   The public sharing of this code does not relinquish, reduce, restrict or
+//   encumber any rights the AUTHOR has in respect to claims of intellectual
+//   property.
+//
+//   IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY
+//   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+//   OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+//   ANY WAY OUT OF THE USE OF THIS SOFTWARE, CODE, OR CODE FRAGMENT(S), EVEN
+//   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//   -------------------------------------------------------------------------
+//
+//                             ALL RIGHTS RESERVED
+//
+//   -------------------------------------------------------------------------
+//
+//   Author:	Mark Tompkins
+//   Copyright:	(c)2013
+//
@@ -0,0 +1,221 @@
+#ifndef PLLEDGER_H
+#define PLLEDGER_H
+
+#include <deque>
+#include <stddef.h>
+#include <stdint.h>
+
+// Profit & loss ledger shared by the MEX P&L routines (e.g. calcProfitLoss)
+//
+// The ledger is advanced one bar at a time. A signal given on a bar is executed at the
+// Open of the following bar and open equity is marked at the Close. Because a bar's open
+// equity may be 'cleaned' once the next bar is known (see plStep), the values of a bar are
+// only final after the following bar has been processed.
+
+// Ledger line item
+typedef struct tradeEntry
+{
+	int index;
+	int quantity;
+	double price;
+} tradeEntry;
+
+// Open position ledger
+// The FIFO line items are kept to P&L liquidations while the running aggregates
+// allow the open equity to be marked each bar without walking the line items
+typedef struct openBook
+{
+	std::deque<tradeEntry> lines;	// FIFO line items
+	int netQty;			// Sum of the line item quantities
+	double netCost;			// Sum of the line item quantity * price (quantity weighted entry price * netQty)
+} openBook;
+
+// Values produced for a single bar
+typedef struct plBar
+{
+	double cash;			// Cash debits and credits
+	double openEQ;			// Open equity if there is an open position
+	double netLiq;			// Aggregated cash plus the current openEQ
+	double returns;			// Change in netLiq from the prior bar
+	bool closed;			// A position was reduced or closed on this bar
+} plBar;
+
+// Running state of a ledger between bars
+typedef struct plState
+{
+	double bigPoint;		// Full tick dollar value of the contract
+	double cost;			// Per contract commission
+
+	openBook openLedger;		// Open line items
+	int openPosition;		// Net open position
+	bool anyTrades;			// The first trade has been placed
+	double pendingSig;		// Signal of the last processed bar.  Executed on the next bar's Open
+	int bars;			// Number of bars processed
+
+	double runSum;			// Cumulative cash through the last processed bar
+	double prevRunSum;		// Cumulative cash through the bar before
+	double prevPrevNetLiq;		// Final netLiq two bars back
+
+	plBar cur;			// Last processed bar (provisional)
+	plBar prev;			// Bar before the last processed bar (final)
+} plState;
+
+// Running performance statistics of a ledger
+// Accumulated from final bar values so no per bar arrays are needed
+typedef struct plStats
+{
+	int obsv;			// Number of observations
+	double meanRet;			// Running mean of returns
+	double m2Ret;			// Running sum of squared deviations from the mean of returns (Welford)
+	double peakNetLiq;		// Highest netLiq so far
+	double maxDD;			// Largest decline of netLiq from a prior peak
+	double grossProfit;		// Sum of cash on winning closing bars
+	double grossLoss;		// Sum of cash on losing closing bars (negative)
+	int numTrades;			// Number of bars with a closing transaction
+	int numWins;			// Number of closing bars with a positive cash result
+} plStats;
+
+// Element types of a price or signal series
+enum plType { PL_DOUBLE, PL_INT8, PL_INT16, PL_INT32 };
+
+// Read only column of prices or signals of any supported element type.
+// Compact types let int32 tick prices and int8 | int16 signals be P&L'd without widening the inputs.
+// Each element is read as double(element) * scale, so a double series with a scale of 1 is unchanged.
+typedef struct plSeries
+{
+	const void *ptr;		// First element
+	int type;			// plType of the elements
+	double scale;			// Multiplier applied to each element (e.g. tick size, or 0.5 for doubled signals)
+} plSeries;
+
+// Constructors for a series
+plSeries createSeries(const double *ptr);
+plSeries createSeries(const void *ptr, int type, double scale);
+
+// The same series starting 'count' elements later
+plSeries seriesOffset(const plSeries &series, size_t count);
+
+// Element 'ii' of a series as a double
+inline double seriesAt(const plSeries &series, int ii)
+{
+	switch (series.type)
+	{
+	case PL_INT8:	return ((const int8_t*)series.ptr)[ii] * series.scale;
+	case PL_INT16:	return ((const int16_t*)series.ptr)[ii] * series.scale;
+	case PL_INT32:	return ((const int32_t*)series.ptr)[ii] * series.scale;
+	default:	return ((const double*)series.ptr)[ii] * series.scale;
+	}
+}
+
+// Constructor for ledger line item creation
+tradeEntry createLineEntry(int ID, int qty, double price);
+
+// Open position ledger maintenance
+openBook createOpenBook();
+void bookPush(openBook &book, const tradeEntry &entry);
+void bookPopFront(openBook &book);
+void bookAdjustFront(openBook &book, int qty);
+void bookResum(openBook &book);
+double bookOpenEQ(const openBook &book, double markPrice, double bigPoint);
+
+// Reset a ledger to its initial flat state
+void plInit(plState &st, double bigPoint, double cost);
+
+// Process the next bar given its Open, Close and signal.
+// On success 'st.cur' holds the provisional values of this bar and 'st.prev' the final values of the bar before.
+// Returns 0 on success or 1 if the pending signal could not be interpreted, in which case
+// 'badSig' holds the offending value and the state is left unchanged.
+int plStep(plState &st, double openPrice, double closePrice, double sig, double &badSig);
+
+// Check the signal of the last processed bar, which plStep executes on the next bar.
+// Returns 0 if the signal can be executed or 1 if it could not be interpreted, in which case 'badSig' holds the
+// offending value.  Lets a caller reject a bad signal as soon as it is given rather than on the next bar.
+int plCheckPending(const plState &st, double &badSig);
+
+// P&L a single signal column from bar 0.
+// Output arrays must hold 'rows' elements.
+// Returns 0 on success or 1 if a signal could not be interpreted, in which case 'badSig' holds the offending value
+int plColumn(const double *openPtr, const double *closePtr, const double *sigPtr, int rows, double bigPoint, double cost,
+			 double *cashIdx, double *openEQIdx, double *netLiqIdx, double *returnsIdx, double &badSig);
+int plColumn(const plSeries &open, const plSeries &close, const plSeries &sig, int rows, double bigPoint, double cost,
+			 double *cashIdx, double *openEQIdx, double *netLiqIdx, double *returnsIdx, double &badSig);
+
+// Performance statistics
+void plStatsInit(plStats &stats);
+void plStatsAdd(plStats &stats, const plBar &bar);
+double plSharpe(const plStats &stats);			// mean(returns) / std(returns) as Matlab sharpe(returns,0)
+double plProfitFactor(const plStats &stats);		// grossProfit / |grossLoss|
+double plWinRate(const plStats &stats);			// numWins / numTrades
+
+// Accumulate the performance statistics of a single signal column from bar 0 without producing per bar arrays.
+// Returns 0 on success or 1 if a signal could not be interpreted, in which case 'badSig' holds the offending value
+int plColumnStats(const double *openPtr, const double *closePtr, const double *sigPtr, int rows, double bigPoint, double cost,
+				  plStats &stats, double &badSig);
+int plColumnStats(const plSeries &open, const plSeries &close, const plSeries &sig, int rows, double bigPoint, double cost,
+				  plStats &stats, double &badSig);
+
+// As plColumnStats but the bars before 'splitIdx' are accumulated in 'testStats' and the remaining bars in 'valStats'.
+// The ledger runs continuously across the split so any position open at the split carries into the validation segment.
+int plColumnSplitStats(const double *openPtr, const double *closePtr, const double *sigPtr, int rows, double bigPoint, double cost,
+					   int splitIdx, plStats &testStats, plStats &valStats, double &badSig);
+int plColumnSplitStats(const plSeries &open, const plSeries &close, const plSeries &sig, int rows, double bigPoint, double cost,
+					   int splitIdx, plStats &testStats, plStats &valStats, double &badSig);
+
+// Weighted METS score of the test and validation Sharpe ratios
+double plMETS(double sharpeTest, double sharpeVal);
+
+#endif // PLLEDGER_H
+
+//
+//  -------------------------------------------------------------------------
+//                                  _    _ 
+//         ___  _ __   ___ _ __    / \  | | __ _  ___   ___  _ __ __ _ 
+//        / _ \| '_ \ / _ \ '_ \  / _ \ | |/ _` |/ _ \ / _ \| '__/ _` |
+//       | (_) | |_) |  __/ | | |/ ___ \| | (_| | (_) | (_) | | | (_| |
+//        \___/| .__/ \___|_| |_/_/   \_\_|\__, |\___(_)___/|_|  \__, |
+//             |_|                         |___/                 |___/
+//  -------------------------------------------------------------------------
+//        This code is distributed in the hope that it will be useful,
+//
+//                      	 WITHOUT ANY WARRANTY
+//
+//                  WITHOUT CLAIM AS TO MERCHANTABILITY
+//
+//                  OR FITNESS FOR A PARTICULAR PURPOSE
+//
+//                           expressed or implied.
+//
+//   Use of this code, pseudocode, algorithmic or trading logic contained
+//   herein, whether sound or faulty for any purpose is the sole
+//   responsibility of the USER. Any such use of these algorithms, coding
+//   logic or concepts in whole or in part carry no covenant of correctness
+//   or recommended usage from the AUTHOR or any of the possible
+//   contributors listed or unlisted, known or unknown.
+//
+//   Any reference of this code or to this code including any variants from
+//   this code, or any other credits due this AUTHOR from this code shall be
+//   clearly and unambiguously cited and evident during any use, whether in
+//   whole or in part.
+//
+//   The public sharing of this code does not relinquish, reduce, restrict or
+//   encumber any rights the AUTHOR has in respect to claims of intellectual
+//   property.
+//
+//   IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY
+//   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+//   OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+//   ANY WAY OUT OF THE USE OF THIS SOFTWARE, CODE, OR CODE FRAGMENT(S), EVEN
+//   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//   -------------------------------------------------------------------------
+//
+//                             ALL RIGHTS RESERVED
+//
+//   -------------------------------------------------------------------------
+//
+//   Author:	Mark Tompkins
+//   Copyright:	(c)2013
+//
@@ -0,0 +1,920 @@
+// profitTarget.cpp
+//
+// Profit target (number of ticks) ledger.  See profitTarget.h
+//
+//	NOTE: We will assume the following standard:	+/- 1 lot is additive	+/- 2 lots is a reverse
+//
+
+#include "profitTarget.h"
+#include <cmath>
+#include <cstdlib>
+#include "myMath.h"
+
+using namespace std;
+
+// Cursor over one column of the expanded (original plus virtual profit) rows
+typedef struct expandCursor
+{
+	const profitEntry *pft;				// Next virtual profit row
+	const profitEntry *pftEnd;
+	int row;					// Original row last passed
+	int lag;					// Number of rows after a profit's barIndex that its virtual row follows
+} expandCursor;
+
+// Expanded row walk of one profit target while P&L'ing it
+typedef struct targetWalk
+{
+	expandCursor sigCursor;
+	expandCursor barCursor;
+	size_t numRows;					// Number of expanded rows
+	size_t nextRow;					// Next expanded row to P&L
+	plState st;
+} targetWalk;
+
+// Prototypes
+static openEntry createOpenLedgerEntry(int ID, int qty, double price, double profitTgt);
+static profitEntry createProfitLedgerEntry(int ID, int qty, double price);
+
+static bool isTrade(double isSig);
+static bool knownAdvSig(double advSig);
+static int sumQty(const targetState &tgt);
+static double getAvgPftPrice(const targetState &tgt);
+static bool openEmpty(const targetState &tgt);
+static void openClear(targetState &tgt);
+static void openPushBack(targetState &tgt, const openEntry &entry);
+static void openPopFront(targetState &tgt);
+static void openPopBack(targetState &tgt);
+static void shrinkProfitLedger(vector<profitEntry> &profitLedger);
+static void moveProfitLedger(vector<profitEntry> &profitLedger, const int ID, int qty, double price);
+static void checkOpen(const profitContext &ctx, targetState &tgt, const int ID);
+static void newAvgChk(targetState &tgt);
+static void newMinMax(const profitContext &ctx, targetState &tgt, const int ID);
+static void checkMinMax(const profitContext &ctx, targetState &tgt, const int ID);
+static void chkOpenMethod(const profitContext &ctx, targetState &tgt, const int curBar);
+static void sameBarProfitCheck(const profitContext &ctx, targetState &tgt, const int ID, int qty);
+static void firstSignal(const profitContext &ctx, targetState &tgt, const int sigIndex);
+static int nextBar(const profitContext &ctx, targetState &tgt, const int curBar, double &badSig);
+static expandCursor createExpandCursor(const vector<profitEntry> &profitLedger, int lag);
+static const profitEntry *expandNext(expandCursor &cursor);
+static int expandPeekRow(const expandCursor &cursor);
+
+// Constructor for a context over 'rows' bars of double prices and signals
+profitContext createProfitContext(const double *barsPtr, const double *sigPtr, int rows, double minTick, double openAvg)
+{
+	return createProfitContext(createSeries(barsPtr), createSeries(sigPtr), rows, minTick, openAvg);
+}
+
+// Constructor for a context over 'rows' bars of any supported element types
+profitContext createProfitContext(const plSeries &bars, const plSeries &sig, int rows, double minTick, double openAvg)
+{
+	profitContext ctx;
+	ctx.bars = bars;
+	ctx.sig = sig;
+	ctx.rows = rows;
+	ctx.minTick = minTick;
+	ctx.openAvg = openAvg;
+
+	// The price matrix is passed as a continuous 1 dimensional array concatenating all columns
+	ctx.shiftOpen = 0;
+	ctx.shiftHigh = rows;
+	ctx.shiftLow = 2 * rows;
+	ctx.shiftClose = 3 * rows;
+
+	return ctx;
+}
+
+// Find the profits of every target
+int findProfits(const profitContext &ctx, vector<targetState> &targets, double &badSig)
+{
+	const size_t numTargets = targets.size();
+	int	sigIndex;					// Iterator that will store the index of the referenced signal
+	bool anyTrades = false;					// Trade logical
+
+	// Check that we have at least one signal (at least one trade)
+	for (sigIndex=0; sigIndex < ctx.rows; sigIndex++)	// Remember C++ starts counting at '0'
+	{
+		if (isTrade(seriesAt(ctx.sig, sigIndex)))		// See if we have a signal
+		{
+			anyTrades = true;
+			break;					// Exit the for loop
+		}
+	}	
+
+	// If there are no trades or the minTick is zero indicating no profit taking the profit ledgers stay empty.
+	// Otherwise start the check for profit targets reached per open position
+	if (anyTrades && ctx.minTick != 0)
+	{
+		// FIRST SIGNAL PROCESSING
+		for (size_t tgt = 0; tgt < numTargets; tgt++)
+		{
+			firstSignal(ctx, targets[tgt], sigIndex);
+		}
+
+		// ITERATE REMAINING BARS
+		// sigIndex = first signal index
+		for (int curBar=sigIndex + 1; curBar < ctx.rows-1; curBar++)
+		{
+			for (size_t tgt = 0; tgt < numTargets; tgt++)
+			{
+				if (nextBar(ctx, targets[tgt], curBar, badSig) != 0)
+					return 1;
+			}
+		}
+	}
+
+	for (size_t tgt = 0; tgt < numTargets; tgt++)
+	{
+		shrinkProfitLedger(targets[tgt].profitLedger);
+	}
+
+	return 0;
+}
+
+// Pure C++ entry point of the profit target sweep
+int numTicksProfitStats(const double *barsPtr, const double *sigPtr, int rows, double minTick, const double *numTicks, int numTargets,
+						double openAvg, double bigPoint, double cost, vector<plStats> &tgtStats, double &badSig)
+{
+	const profitContext ctx = createProfitContext(barsPtr, sigPtr, rows, minTick, openAvg);
+
+	vector<targetState> targets(numTargets);
+	for (int tgt = 0; tgt < numTargets; tgt++)
+	{
+		initTarget(targets[tgt], minTick * numTicks[tgt]);
+	}
+
+	if (findProfits(ctx, targets, badSig) != 0)
+		return 1;
+
+	tgtStats.assign(numTargets, plStats());
+	return statsTargets(ctx, targets, bigPoint, cost, tgtStats, vector<double*>(numTargets, (double*)NULL), badSig);
+}
+
+// Accumulate the P&L summary of every target's expanded rows
+int statsTargets(const profitContext &ctx, const vector<targetState> &targets, double bigPoint, double cost,
+				 vector<plStats> &tgtStats, const vector<double*> &tgtSigPtrs, double &badSig)
+{
+	vector<const vector<profitEntry>*> ledgers(targets.size());
+	for (size_t tgt = 0; tgt < targets.size(); tgt++)
+	{
+		ledgers[tgt] = &targets[tgt].profitLedger;
+	}
+
+	return statsLedgers(ctx, ledgers, bigPoint, cost, tgtStats, tgtSigPtrs, badSig);
+}
+
+// Accumulate the P&L summary of every ledger's expanded rows.
+// All ledgers are walked together one original row at a time so the inputs are read once however many ledgers
+// are given.  Each ledger's expanded signal is written when its pointer is not NULL.
+// Returns 0 on success or 1 if the ledger could not interpret a signal, in which case 'badSig' holds the offending value
+int statsLedgers(const profitContext &ctx, const vector<const vector<profitEntry>*> &ledgers, double bigPoint, double cost,
+				 vector<plStats> &tgtStats, const vector<double*> &tgtSigPtrs, double &badSig)
+{
+	const size_t numTargets = ledgers.size();
+	vector<targetWalk> walks(numTargets);
+
+	for (size_t tgt = 0; tgt < numTargets; tgt++)
+	{
+		walks[tgt].sigCursor = createExpandCursor(*ledgers[tgt], 0);
+		walks[tgt].barCursor = createExpandCursor(*ledgers[tgt], 1);
+		walks[tgt].numRows = ctx.rows + ledgers[tgt]->size();
+		walks[tgt].nextRow = 0;
+		plInit(walks[tgt].st, bigPoint, cost);
+		plStatsInit(tgtStats[tgt]);
+	}
+
+	for (int row = 0; row < ctx.rows; row++)
+	{
+		for (size_t tgt = 0; tgt < numTargets; tgt++)
+		{
+			targetWalk &walk = walks[tgt];
+
+			// Every expanded row whose signal and bar are both at or before this original row
+			while (walk.nextRow < walk.numRows && expandPeekRow(walk.sigCursor) <= row && expandPeekRow(walk.barCursor) <= row)
+			{
+				const profitEntry *sigPft = expandNext(walk.sigCursor);
+				const profitEntry *barPft = expandNext(walk.barCursor);
+
+				const double sigValue = (sigPft != NULL) ? sigPft->qtyProfit : seriesAt(ctx.sig, walk.sigCursor.row);
+				const double openPrice = (barPft != NULL) ? barPft->profitPrice : seriesAt(ctx.bars, walk.barCursor.row + ctx.shiftOpen);
+				const double closePrice = (barPft != NULL) ? barPft->profitPrice : seriesAt(ctx.bars, walk.barCursor.row + ctx.shiftClose);
+
+				if (tgtSigPtrs[tgt] != NULL)
+					tgtSigPtrs[tgt][walk.nextRow] = sigValue;
+
+				if (plStep(walk.st, openPrice, closePrice, sigValue, badSig) != 0)
+					return 1;
+
+				// The prior row is final once this row has been processed
+				if (walk.nextRow > 0)
+					plStatsAdd(tgtStats[tgt], walk.st.prev);
+
+				walk.nextRow++;
+			}
+		}
+	}
+
+	// Last row
+	for (size_t tgt = 0; tgt < numTargets; tgt++)
+	{
+		if (walks[tgt].nextRow > 0)
+			plStatsAdd(tgtStats[tgt], walks[tgt].st.cur);
+	}
+
+	return 0;
+}
+
+// Walk the original rows and the virtual profit rows in expanded order.
+// The expanded bars and signals are written when their pointers are given and P&L'd when 'cashPtr' is given,
+// so the expanded series never has to be built to be P&L'd.
+// Returns 0 on success or 1 if the ledger could not interpret a signal, in which case 'badSig' holds the offending value
+int expandRows(const profitContext &ctx, const vector<profitEntry> &profitLedger, size_t numNewRows, double *barsOutPtr, double *sigOutPtr,
+			   double bigPoint, double cost, double *cashPtr, double *openEQPtr, double *netLiqPtr, double *returnsPtr, double &badSig)
+{
+	expandCursor sigCursor = createExpandCursor(profitLedger, 0);
+	expandCursor barCursor = createExpandCursor(profitLedger, 1);
+
+	plState st;
+	plInit(st, bigPoint, cost);
+
+	for (size_t ii = 0; ii < numNewRows; ii++)
+	{
+		const profitEntry *sigPft = expandNext(sigCursor);
+		const profitEntry *barPft = expandNext(barCursor);
+
+		const double sigValue = (sigPft != NULL) ? sigPft->qtyProfit : seriesAt(ctx.sig, sigCursor.row);
+		const double openPrice = (barPft != NULL) ? barPft->profitPrice : seriesAt(ctx.bars, barCursor.row + ctx.shiftOpen);
+		const double closePrice = (barPft != NULL) ? barPft->profitPrice : seriesAt(ctx.bars, barCursor.row + ctx.shiftClose);
+
+		if (sigOutPtr != NULL)
+			sigOutPtr[ii] = sigValue;
+
+		// Virtual bars are flat at the profit price
+		if (barsOutPtr != NULL)
+		{
+			barsOutPtr[ii] = openPrice;
+			barsOutPtr[ii + numNewRows] = (barPft != NULL) ? barPft->profitPrice : seriesAt(ctx.bars, barCursor.row + ctx.shiftHigh);
+			barsOutPtr[ii + 2 * numNewRows] = (barPft != NULL) ? barPft->profitPrice : seriesAt(ctx.bars, barCursor.row + ctx.shiftLow);
+			barsOutPtr[ii + 3 * numNewRows] = closePrice;
+		}
+
+		if (cashPtr != NULL)
+		{
+			if (plStep(st, openPrice, closePrice, sigValue, badSig) != 0)
+				return 1;
+
+			// The prior row is final once this row has been processed
+			if (ii > 0)
+			{
+				cashPtr[ii-1] = st.prev.cash;
+				openEQPtr[ii-1] = st.prev.openEQ;
+				netLiqPtr[ii-1] = st.prev.netLiq;
+				returnsPtr[ii-1] = st.prev.returns;
+			}
+		}
+	}
+
+	// Last row
+	if (cashPtr != NULL && numNewRows > 0)
+	{
+		cashPtr[numNewRows-1] = st.cur.cash;
+		openEQPtr[numNewRows-1] = st.cur.openEQ;
+		netLiqPtr[numNewRows-1] = st.cur.netLiq;
+		returnsPtr[numNewRows-1] = st.cur.returns;
+	}
+
+	return 0;
+}
+
+// Reset the profit taking state of a target
+void initTarget(targetState &tgt, double profitTgt)
+{
+	tgt.profitTgt = profitTgt;
+	openClear(tgt);
+	tgt.profitLedger.clear();
+	tgt.openPosition = 0;
+	tgt.minMax = 0;
+}
+
+/////////////
+//
+// FUNCTIONS & METHODS
+//
+/////////////
+
+// Cursor over the expanded rows of one column
+// A profit found on the signal of bar 'b' follows signal 'b' (lag 0) and, as the signal lags price by one bar,
+// its virtual bar follows price bar 'b+1' (lag 1)
+static expandCursor createExpandCursor(const vector<profitEntry> &profitLedger, int lag)
+{
+	expandCursor cursor;
+	cursor.pft = profitLedger.empty() ? NULL : &profitLedger[0];
+	cursor.pftEnd = profitLedger.empty() ? NULL : &profitLedger[0] + profitLedger.size();
+	cursor.row = -1;
+	cursor.lag = lag;
+
+	return cursor;
+}
+
+// Advance to the next expanded row.  Returns the virtual profit row or NULL when the next row is the original 'cursor.row'
+static const profitEntry *expandNext(expandCursor &cursor)
+{
+	// Virtual rows owed after the original row last passed.  The profit ledger is in bar order
+	if (cursor.row >= 0 && cursor.pft != cursor.pftEnd && cursor.pft->barIndex + cursor.lag <= cursor.row)
+	{
+		const profitEntry *pftEntry = cursor.pft;
+		cursor.pft++;
+		return pftEntry;
+	}
+
+	cursor.row++;
+	return NULL;
+}
+
+// Original row the next expanded row belongs to without advancing
+static int expandPeekRow(const expandCursor &cursor)
+{
+	if (cursor.row >= 0 && cursor.pft != cursor.pftEnd && cursor.pft->barIndex + cursor.lag <= cursor.row)
+		return cursor.row;
+
+	return cursor.row + 1;
+}
+
+// Open the first detected trade of a target
+static void firstSignal(const profitContext &ctx, targetState &tgt, const int sigIndex)
+{
+	// Put first detected trade on openLedger
+	openPushBack(tgt, createOpenLedgerEntry(sigIndex, int(seriesAt(ctx.sig, sigIndex)), seriesAt(ctx.bars, sigIndex + 1 + ctx.shiftOpen), tgt.profitTgt));
+
+	// Short signal.  Assign minMax to LOW
+	if (seriesAt(ctx.sig, sigIndex) < 0)		
+	{
+		tgt.minMax = seriesAt(ctx.bars, sigIndex + 1 + ctx.shiftLow);
+	}
+	// Long signal. Assign minMax to HIGH
+	else if (seriesAt(ctx.sig, sigIndex) > 0)	
+	{
+		tgt.minMax = seriesAt(ctx.bars, sigIndex + 1 + ctx.shiftHigh);
+	}
+
+	// Check for profit on same observation
+	// 'minMax' has been updated so we can safely call 'sameBarProfitCheck'
+	sameBarProfitCheck(ctx, tgt, sigIndex, int(seriesAt(ctx.sig, sigIndex)));
+}
+
+// Advance a target by one bar
+static int nextBar(const profitContext &ctx, targetState &tgt, const int curBar, double &badSig)
+{
+	// ORDER OF SIGNIFICANCE from a signal with an existing position
+	// REVERSE
+	if (fraction(seriesAt(ctx.sig, curBar)))
+	{
+		// Is fraction the same sign (additive in nature) ?
+		// Additive
+		// NOTE: The misplaced parenthesis is preserved on purpose.  The test is always false so every fraction takes
+		//       the liquidate branch.  That branch also clears the openPosition sameBarProfitCheck leaves behind on an
+		//       empty ledger, so correcting only this test changes the profits of plain +/-1 and +/-0.5 signals.
+		if (sign(seriesAt(ctx.sig, curBar) == sign(tgt.openPosition)))
+		{
+			// Nothing to do with the current logic
+			// The only fraction currently in use is |0.5| to liquidate entire opposing openPosition
+		}
+		// Reductive (liquidate)
+		else
+		{
+			// Adding logic here for prevention of 'other' fractions or surprising inputs
+			if (knownAdvSig(seriesAt(ctx.sig, curBar)))
+			{
+				// Liquidate any open position
+				openClear(tgt);
+				tgt.openPosition = 0;
+			}
+			// Unknown advanced instruction
+			else
+			{
+				badSig = seriesAt(ctx.sig, curBar);
+				return 1;
+			}
+		}
+	}
+
+	// REDUCE or ADD
+	// Do we have a signal with an integer portion ?
+	if (abs(int(seriesAt(ctx.sig, curBar))) >= 1)
+	{
+		// Signal is reductive
+		if ((int(seriesAt(ctx.sig, curBar)) > 0 && tgt.openPosition < 0) || (int(seriesAt(ctx.sig, curBar)) < 0 && tgt.openPosition > 0))					
+		{
+			// Signal is effectively a reverse or liquidate
+			if (int(seriesAt(ctx.sig, curBar)) >= tgt.openPosition)
+			{
+				tgt.openPosition = int(seriesAt(ctx.sig, curBar)) + tgt.openPosition;
+				openClear(tgt);
+				if (tgt.openPosition != 0)
+				{
+					openPushBack(tgt, createOpenLedgerEntry(curBar, tgt.openPosition, seriesAt(ctx.bars, curBar + 1 + ctx.shiftOpen), tgt.profitTgt));
+				}
+			}
+			else
+			{
+				// How many do we need to reduce by?
+				int needQty = int(seriesAt(ctx.sig, curBar));
+				// Prepare to iterate until we are satisfied
+				while (needQty !=0)
+				{
+					// Is the current line item quantity larger than what we need?
+					openEntry &front = tgt.openLedger[tgt.openHead];
+					if (abs(front.qtyOpen) > needQty)
+					{
+						// Reduce the position size.  We are aggregating so we add (e.g. 5 Purchases + 4 Sales = 1 Long)
+						front.qtyOpen = front.qtyOpen + needQty;
+						// We are satisfied and don't need any more contracts
+						needQty = 0;
+					}
+					// Current line item quantity is equal to or smaller than what we need.  Process P&L and remove.
+					else
+					{
+						// Reduce needed quantity by what we've been provided
+						needQty = needQty + front.qtyOpen;
+						// Remove the line item (FIFO)
+						openPopFront(tgt);
+					}
+				}
+				tgt.openPosition = tgt.openPosition + int(seriesAt(ctx.sig, curBar));
+			}
+		}
+		// Signal is additive
+		else
+		{
+			// Before adding, check if the open qualifies to liquidate any existing position
+			if (tgt.openPosition != 0)
+			{
+				chkOpenMethod(ctx, tgt, curBar);
+			}
+			
+			// Process addition
+			// Put trade on openLedger
+			openPushBack(tgt, createOpenLedgerEntry(curBar, int(seriesAt(ctx.sig, curBar)), seriesAt(ctx.bars, curBar + 1 + ctx.shiftOpen), tgt.profitTgt));
+			sameBarProfitCheck(ctx, tgt, curBar, int(seriesAt(ctx.sig, curBar)));
+		}
+	}
+	// NONE
+	else
+	{
+		// We can just check against the open and leave the range check for all entries on the openLedger below
+		// Only check if necessary
+		if (tgt.openPosition !=0)
+		{
+			chkOpenMethod(ctx, tgt, curBar);
+		}
+		
+	}
+
+	// Check for extremes that result in a profit for any openPosition
+	if (tgt.openPosition != 0)
+	{
+		checkMinMax(ctx, tgt, curBar);
+	}
+
+	return 0;
+}
+
+// Constructor for ledger line item creation
+static openEntry createOpenLedgerEntry(int ID, int qty, double price, double profitTgt)
+{
+	openEntry OpenLedgerEntry;
+	OpenLedgerEntry.sigIndex = ID;
+	OpenLedgerEntry.qtyOpen = qty;
+	OpenLedgerEntry.openPrice = price;
+	if (qty < 0)
+	{
+		OpenLedgerEntry.profitPrice = price - profitTgt;
+	}
+	else
+	{
+		OpenLedgerEntry.profitPrice = price + profitTgt;
+	}
+
+	return OpenLedgerEntry;
+}
+
+static profitEntry createProfitLedgerEntry(int ID, int qty, double price)
+{
+	profitEntry ProfitLedgerEntry;
+	ProfitLedgerEntry.barIndex = ID;
+	ProfitLedgerEntry.qtyProfit = qty;												// Quantity already transformed at calling function
+	ProfitLedgerEntry.profitPrice = price;
+
+	return ProfitLedgerEntry;
+}
+
+static void moveProfitLedger(vector<profitEntry> &profitLedger, const int ID, int qty, double price)
+{
+	// We take the price of the next observation for the generated signal
+	// We reverse the quantity to reflect closing of the positions
+	profitLedger.push_back(createProfitLedgerEntry(ID, qty * -1, price));	
+}
+
+static void sameBarProfitCheck(const profitContext &ctx, targetState &tgt, const int ID, int qty)
+{
+	if (ctx.openAvg == 0)
+	{
+		// Is there a profit on the bar of the trade? 
+		// Short signal - check LOW
+		if ((qty < 0) && (seriesAt(ctx.bars, ID + 1 + ctx.shiftLow) < seriesAt(ctx.bars, ID + 1 + ctx.shiftOpen) - tgt.profitTgt))
+		{
+			// We have a profit on the same observation.  Move the entry in the profit ledger
+			moveProfitLedger(tgt.profitLedger, ID, qty, seriesAt(ctx.bars, ID + 1 + ctx.shiftOpen) - tgt.profitTgt);
+			tgt.openPosition = tgt.openPosition - qty;
+			openPopBack(tgt);
+		}
+		// Long signal - check HIGH
+		else if ((qty > 0) && (seriesAt(ctx.bars, ID + 1 + ctx.shiftHigh) > seriesAt(ctx.bars, ID + 1 + ctx.shiftOpen) + tgt.profitTgt))	
+		{
+			// We have a profit on the same observation.  Put entry in the profit ledger
+			moveProfitLedger(tgt.profitLedger, ID, qty, seriesAt(ctx.bars, ID + 1 + ctx.shiftOpen) + tgt.profitTgt);
+			tgt.openPosition = tgt.openPosition - qty;
+			openPopBack(tgt);
+		} 
+		else
+		{
+			tgt.openPosition = tgt.openPosition + qty;
+		}
+	}
+	else
+	{
+
+		// Check same bar using new average
+		// Requires minMax already updated !!
+		newAvgChk(tgt);
+
+	}
+}
+
+// A new High | Low has occurred and we have determined that we have an openPosition
+// Check if profit targets have been reached
+static void newMinMax(const profitContext &ctx, targetState &tgt, const int ID)
+{
+	if (!openEmpty(tgt))
+	{
+		if (ctx.openAvg == 0)
+		{
+			// The entries not taken are moved down over the taken ones in a single pass.  'remaining' is the
+			// quantity of the entries kept so far plus those not yet visited, i.e. of the ledger as it stands
+			size_t keep = tgt.openHead;
+			int remaining = sumQty(tgt);
+			for (size_t ii = tgt.openHead; ii < tgt.openLedger.size(); ii++)
+			{
+				const openEntry entry = tgt.openLedger[ii];
+
+				// Short. Check minMax <= profitPrice
+				// Long. Check minMax >= profitPrice
+				if ((tgt.openPosition < 0 && tgt.minMax <= entry.profitPrice) ||
+					(tgt.openPosition > 0 && tgt.minMax >= entry.profitPrice))
+				{
+					moveProfitLedger(tgt.profitLedger, ID, entry.qtyOpen, entry.profitPrice);
+					remaining = remaining - entry.qtyOpen;
+				}
+				else
+				{
+					tgt.openLedger[keep++] = entry;
+				}
+
+				// Update openPosition.  It is 0 once the last entry has been taken
+				tgt.openPosition = remaining;
+			}
+			tgt.openLedger.resize(keep);
+			if (openEmpty(tgt))
+			{
+				openClear(tgt);
+			}
+		}
+		// Using the average price approach 
+		else
+		{
+			newAvgChk(tgt);
+		}
+	}
+}
+
+static void newAvgChk(targetState &tgt)
+{
+	double profitPrice = getAvgPftPrice(tgt);
+
+	if (tgt.openPosition < 0)					// Short. Check minMax <= profitPrice
+	{
+		if (tgt.minMax <= profitPrice)
+		{
+			for (size_t ii = tgt.openHead; ii < tgt.openLedger.size(); ii++)
+			{
+				moveProfitLedger(tgt.profitLedger, tgt.openLedger[ii].sigIndex, tgt.openLedger[ii].qtyOpen, profitPrice);
+			}
+			openClear(tgt);
+			tgt.openPosition = 0;
+		}
+	}
+	else if (tgt.openPosition > 0)				// Long. Check minMax >= profitPrice
+	{
+		if (tgt.minMax >= profitPrice)
+		{
+			for (size_t ii = tgt.openHead; ii < tgt.openLedger.size(); ii++)
+			{
+				moveProfitLedger(tgt.profitLedger, tgt.openLedger[ii].sigIndex, tgt.openLedger[ii].qtyOpen, profitPrice);
+			}
+			openClear(tgt);
+			tgt.openPosition = 0;
+		}
+	}
+}
+
+static double getAvgPftPrice(const targetState &tgt)
+{
+	int netQty = 0;
+	double sumWghts = 0;
+	double wghtAvg = 0;
+	double profitPrice = 0;
+
+
+	for (size_t ii = tgt.openHead; ii < tgt.openLedger.size(); ii++)
+	{
+		netQty = netQty + tgt.openLedger[ii].qtyOpen;
+		sumWghts = sumWghts + (abs(tgt.openLedger[ii].qtyOpen) * tgt.openLedger[ii].openPrice);
+	}
+
+	wghtAvg = sumWghts / abs(netQty);
+
+	// Short objective
+	if (netQty < 0)
+	{
+		profitPrice = wghtAvg - tgt.profitTgt;
+	}
+	// Long objective
+	else
+	{
+		profitPrice = wghtAvg + tgt.profitTgt;
+	}
+
+	return profitPrice;
+}
+
+static void checkOpen(const profitContext &ctx, targetState &tgt, const int ID)
+{
+	if (ctx.openAvg == 0)
+	{
+		// The entries not taken are moved down over the taken ones in a single pass.  'remaining' is the
+		// quantity of the entries kept so far plus those not yet visited, i.e. of the ledger as it stands
+		const double openPrice = seriesAt(ctx.bars, ID + 1 + ctx.shiftOpen);
+		size_t keep = tgt.openHead;
+		int remaining = sumQty(tgt);
+		for (size_t ii = tgt.openHead; ii < tgt.openLedger.size(); ii++)
+		{
+			const openEntry entry = tgt.openLedger[ii];
+
+			// Short. Check Open <= profitPrice
+			// Long. Check Open >= profitPrice
+			if ((tgt.openPosition < 0) ? (openPrice <= entry.profitPrice) : (openPrice >= entry.profitPrice))
+			{
+				// Open satisfies profit threshold
+				moveProfitLedger(tgt.profitLedger, ID, entry.qtyOpen, openPrice);
+				remaining = remaining - entry.qtyOpen;
+				// Update openPosition.  It is 0 once the last entry has been taken
+				tgt.openPosition = remaining;
+			}
+			else
+			{
+				tgt.openLedger[keep++] = entry;
+			}
+		}
+		tgt.openLedger.resize(keep);
+		if (openEmpty(tgt))
+		{
+			openClear(tgt);
+		}
+	}
+	else
+	{
+		double profitPrice = getAvgPftPrice(tgt);
+
+		if (tgt.openPosition < 0)
+		{
+			if (seriesAt(ctx.bars, ID + 1 + ctx.shiftOpen) <= profitPrice)
+			{
+				// Open satisfies profit threshold
+				for (size_t ii = tgt.openHead; ii < tgt.openLedger.size(); ii++)
+				{
+					moveProfitLedger(tgt.profitLedger, tgt.openLedger[ii].sigIndex, tgt.openLedger[ii].qtyOpen, seriesAt(ctx.bars, ID + 1 + ctx.shiftOpen));
+				}
+				openClear(tgt);
+				tgt.openPosition = 0;
+			}
+		}
+		else
+		{
+			if (seriesAt(ctx.bars, ID + 1 + ctx.shiftOpen) >= profitPrice)
+			{
+				// Open satisfies profit threshold
+				for (size_t ii = tgt.openHead; ii < tgt.openLedger.size(); ii++)
+				{
+					moveProfitLedger(tgt.profitLedger, tgt.openLedger[ii].sigIndex, tgt.openLedger[ii].qtyOpen, seriesAt(ctx.bars, ID + 1 + ctx.shiftOpen));
+				}
+				openClear(tgt);
+			}
+			tgt.openPosition = 0;
+		}
+	}
+};
+
+static void checkMinMax(const profitContext &ctx, targetState &tgt, const int ID)
+{
+	if (tgt.openPosition < 0)						// Short.  Check minMax to LOW
+	{
+		if (seriesAt(ctx.bars, ID + 1 + ctx.shiftLow) < tgt.minMax)		//New minMax
+		{
+			tgt.minMax = seriesAt(ctx.bars, ID + 1 + ctx.shiftLow);
+			newMinMax(ctx, tgt, ID);
+		}
+	}
+	else if (tgt.openPosition > 0)					// Long.  Check minMax to HIGH
+	{
+		if (seriesAt(ctx.bars, ID + 1 + ctx.shiftHigh) > tgt.minMax)		//New minMax
+		{
+			tgt.minMax = seriesAt(ctx.bars, ID + 1 + ctx.shiftHigh);
+			newMinMax(ctx, tgt, ID);
+		}			
+	}
+}
+
+static void shrinkProfitLedger(vector<profitEntry> &profitLedger)
+{
+	// Each entry is folded in to the following entry and the survivors moved down in a single pass so runs collapse
+	size_t keep = 0;
+	for (size_t ii = 0; ii < profitLedger.size(); ii++)
+	{
+		if ((ii + 1 < profitLedger.size()) &&
+			(profitLedger[ii].barIndex == profitLedger[ii + 1].barIndex) &&
+			(sign(profitLedger[ii].qtyProfit) == sign(profitLedger[ii + 1].qtyProfit)))
+		{
+			profitLedger[ii + 1].qtyProfit = profitLedger[ii + 1].qtyProfit + profitLedger[ii].qtyProfit;
+		}
+		else
+		{
+			profitLedger[keep++] = profitLedger[ii];
+		}
+	}
+	profitLedger.resize(keep);
+}
+
+static bool isTrade(double isSig)
+{
+	if (abs(isSig)>=1)
+	{
+		return true;
+	}
+	return false;
+}
+
+static bool knownAdvSig(double advSig)
+{
+	// We can check for known advanced signals to help in debugging
+	// by registering them here.  This can be a searchable array when
+	// more than one advanced signal exists.
+	// For now we only need to check for |0.5|
+
+	double frac = abs(advSig - int(advSig));
+
+	if (frac == 0.5)		// Close any opposing open position
+	{
+		return true;
+	}
+	return false;
+}
+
+// Net quantity of the open positions of a target
+static int sumQty(const targetState &tgt)
+{
+	int sumOfQty = 0;  // the sum is accumulated here
+	for (size_t ii = tgt.openHead; ii < tgt.openLedger.size(); ii++)
+	{
+		sumOfQty += tgt.openLedger[ii].qtyOpen;
+	}
+
+	return sumOfQty;
+}
+
+// The open ledger holds no open positions
+static bool openEmpty(const targetState &tgt)
+{
+	return tgt.openHead == tgt.openLedger.size();
+}
+
+// Take every open position.  The capacity is kept for the next position
+static void openClear(targetState &tgt)
+{
+	tgt.openLedger.clear();
+	tgt.openHead = 0;
+}
+
+// Open a position.  The space of the positions taken from the front is reused before the vector grows
+static void openPushBack(targetState &tgt, const openEntry &entry)
+{
+	if (tgt.openHead > 0 && tgt.openLedger.size() == tgt.openLedger.capacity())
+	{
+		tgt.openLedger.erase(tgt.openLedger.begin(), tgt.openLedger.begin() + tgt.openHead);
+		tgt.openHead = 0;
+	}
+	tgt.openLedger.push_back(entry);
+}
+
+// Take the oldest open position (FIFO)
+static void openPopFront(targetState &tgt)
+{
+	tgt.openHead++;
+	if (openEmpty(tgt))
+	{
+		openClear(tgt);
+	}
+}
+
+// Take the newest open position
+static void openPopBack(targetState &tgt)
+{
+	tgt.openLedger.pop_back();
+	if (openEmpty(tgt))
+	{
+		openClear(tgt);
+	}
+}
+
+static void chkOpenMethod(const profitContext &ctx, targetState &tgt, const int curBar)
+{
+	if (tgt.openPosition < 0)
+	{
+		// We can add a check to reduce calls to the function unless necessary
+		if(seriesAt(ctx.bars, curBar + 1 + ctx.shiftOpen) < tgt.minMax)
+		{
+			checkOpen(ctx, tgt, curBar);
+			tgt.minMax = seriesAt(ctx.bars, curBar + 1 + ctx.shiftOpen);
+		}
+	}
+	else if (tgt.openPosition > 0)
+	{
+		if(seriesAt(ctx.bars, curBar + 1 + ctx.shiftOpen) > tgt.minMax)
+		{
+			checkOpen(ctx, tgt, curBar);
+			tgt.minMax = seriesAt(ctx.bars, curBar + 1 + ctx.shiftOpen);
+		}
+	}	
+}
+
+//
+//  -------------------------------------------------------------------------
+//                                  _    _ 
+//         ___  _ __   ___ _ __    / \  | | __ _  ___   ___  _ __ __ _ 
+//        / _ \| '_ \ / _ \ '_ \  / _ \ | |/ _` |/ _ \ / _ \| '__/ _` |
+//       | (_) | |_) |  __/ | | |/ ___ \| | (_| | (_) | (_) | | | (_| |
+//        \___/| .__/ \___|_| |_/_/   \_\_|\__, |\___(_)___/|_|  \__, |
+//             |_|                         |___/                 |___/
+//  -------------------------------------------------------------------------
+//        This code is distributed in the hope that it will be useful,
+//
+//                      	 WITHOUT ANY WARRANTY
+//
+//                  WITHOUT CLAIM AS TO MERCHANTABILITY
+//
+//                  OR FITNESS FOR A PARTICULAR PURPOSE
+//
+//                           expressed or implied.
+//
+//   Use of this code, pseudocode, algorithmic or trading logic contained
+//   herein, whether sound or faulty for any purpose is the sole
+//   responsibility of the USER. Any such use of these algorithms, coding
+//   logic or concepts in whole or in part carry no covenant of correctness
+//   or recommended usage from the AUTHOR or any of the possible
+//   contributors listed or unlisted, known or unknown.
+//
+//   Any reference of this code or to this code including any variants from
+//   this code, or any other credits due this AUTHOR from this code shall be
+//   clearly and unambiguously cited and evident during any use, whether in
+//   whole or in part.
+//
+//   The public sharing of this code does not relinquish, reduce, restrict or
+//   encumber any rights the AUTHOR has in respect to claims of intellectual
+//   property.
+//
+//   IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY
+//   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+//   OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+//   ANY WAY OUT OF THE USE OF THIS SOFTWARE, CODE, OR CODE FRAGMENT(S), EVEN
+//   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//   -------------------------------------------------------------------------
+//
+//                             ALL RIGHTS RESERVED
+//
+//   -------------------------------------------------------------------------
+//
+//   Author:	Mark Tompkins
+//   Copyright:	(c)2013
+//
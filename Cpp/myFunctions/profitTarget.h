@@ -0,0 +1,151 @@
+#ifndef PROFITTARGET_H
+#define PROFITTARGET_H
+
+#include <stddef.h>
+#include <vector>
+#include "plLedger.h"
+
+// Profit target (number of ticks) ledger used by numTicksProfit
+//
+// A profit is taken when a position's entry price is bettered by 'numTicks' ticks.  Each profit becomes a virtual bar
+// at the profit price and a closing signal inserted after the bar it was reached on.
+//
+// Every routine works from a read only profitContext and per target targetState objects and holds no state of its own,
+// so any number of calls may run concurrently provided they do not share a targetState.
+
+// Open position line item
+typedef struct openEntry
+{
+	int sigIndex;				// Array index of signal that created open position
+	int qtyOpen;				// Quantity of created open position
+	double openPrice;			// Entry price of open position
+	double profitPrice;			// Price where position will be closed with a profit
+} openEntry;
+
+// Profit ledger line item
+typedef struct profitEntry
+{
+	int barIndex;				// Array index of observation that create the profit taking
+	int qtyProfit;				// Quantity bought or sold at the profit taking price
+	double profitPrice;			// Profit price
+} profitEntry;
+
+// Read only inputs shared by every target of a call
+typedef struct profitContext
+{
+	plSeries bars;				// Open | High | Low | Close column major price matrix
+	plSeries sig;				// Signal column
+	int rows;				// Number of bars
+	double minTick;				// What a single tick increment is for a given contract
+	double openAvg;				// Manage profit taking per contract or on the averaged net position (0 = atomic | 1 = average)
+	int shiftOpen;				// Column offsets in to barsPtr
+	int shiftHigh;
+	int shiftLow;
+	int shiftClose;
+} profitContext;
+
+// Profit taking state of one profit target
+// The ledgers are contiguous so a sweep of many targets walks flat arrays rather than list nodes.  The open
+// positions are the entries of openLedger from openHead on: taking the oldest only advances the head, and
+// the space of taken entries is reused before the vector grows.  The profit ledger is only appended to.
+typedef struct targetState
+{
+	double profitTgt;			// Calculated profit target (minTick * numTicks)
+	std::vector<openEntry> openLedger;	// Open positions from openHead on, oldest first
+	size_t openHead;			// Index of the oldest open position
+	std::vector<profitEntry> profitLedger;	// Profits taken
+	int openPosition;			// Net open position
+	double minMax;				// Current minimum | maximum to optimize (minimize) checks
+} targetState;
+
+// Constructors for a context over 'rows' bars.  Compact series (int32 tick prices, int8 | int16 signals) are read
+// in place through seriesAt rather than widened to double
+profitContext createProfitContext(const double *barsPtr, const double *sigPtr, int rows, double minTick, double openAvg);
+profitContext createProfitContext(const plSeries &bars, const plSeries &sig, int rows, double minTick, double openAvg);
+
+// Reset the profit taking state of a target
+void initTarget(targetState &tgt, double profitTgt);
+
+// Find the profits of every target.  Every target is advanced on a bar before the next bar is read.
+// On success each target's profitLedger is in bar order with same bar entries folded together.
+// Returns 0 on success or 1 if a signal could not be interpreted, in which case 'badSig' holds the offending value
+int findProfits(const profitContext &ctx, std::vector<targetState> &targets, double &badSig);
+
+// Walk the original rows and the virtual profit rows of one profit ledger in expanded order.
+// The expanded bars (numNewRows x 4) and signals are written when their pointers are not NULL and
+// P&L'd in to the cash, openEQ, netLiq and returns arrays when 'cashPtr' is not NULL.
+// Returns 0 on success or 1 if the P&L ledger could not interpret a signal, in which case 'badSig' holds the offending value
+int expandRows(const profitContext &ctx, const std::vector<profitEntry> &profitLedger, size_t numNewRows, double *barsOutPtr, double *sigOutPtr,
+			   double bigPoint, double cost, double *cashPtr, double *openEQPtr, double *netLiqPtr, double *returnsPtr, double &badSig);
+
+// Accumulate the P&L summary of every target's expanded rows in one pass over the inputs.
+// Each target's expanded signal is written when its entry of 'tgtSigPtrs' is not NULL.
+// Returns 0 on success or 1 if the P&L ledger could not interpret a signal, in which case 'badSig' holds the offending value
+int statsTargets(const profitContext &ctx, const std::vector<targetState> &targets, double bigPoint, double cost,
+				 std::vector<plStats> &tgtStats, const std::vector<double*> &tgtSigPtrs, double &badSig);
+
+// As statsTargets for any set of profit ledgers (e.g. the exit ledgers of bracketOrder)
+int statsLedgers(const profitContext &ctx, const std::vector<const std::vector<profitEntry>*> &ledgers, double bigPoint, double cost,
+				 std::vector<plStats> &tgtStats, const std::vector<double*> &tgtSigPtrs, double &badSig);
+
+// Pure C++ entry point equivalent to numTicksProfit('pl',bars,sig,minTick,numTicks,openAvg,bigPoint,cost,'stats').
+// 'numTicks' holds 'numTargets' targets and 'tgtStats' receives one summary per target.
+// Returns 0 on success or 1 if a signal could not be interpreted, in which case 'badSig' holds the offending value
+int numTicksProfitStats(const double *barsPtr, const double *sigPtr, int rows, double minTick, const double *numTicks, int numTargets,
+						double openAvg, double bigPoint, double cost, std::vector<plStats> &tgtStats, double &badSig);
+
+#endif // PROFITTARGET_H
+
+//
+//  -------------------------------------------------------------------------
+//                                  _    _ 
+//         ___  _ __   ___ _ __    / \  | | __ _  ___   ___  _ __ __ _ 
+//        / _ \| '_ \ / _ \ '_ \  / _ \ | |/ _` |/ _ \ / _ \| '__/ _` |
+//       | (_) | |_) |  __/ | | |/ ___ \| | (_| | (_) | (_) | | | (_| |
+//        \___/| .__/ \___|_| |_/_/   \_\_|\__, |\___(_)___/|_|  \__, |
+//             |_|                         |___/                 |___/
+//  -------------------------------------------------------------------------
+//        This code is distributed in the hope that it will be useful,
+//
+//                      	 WITHOUT ANY WARRANTY
+//
+//                  WITHOUT CLAIM AS TO MERCHANTABILITY
+//
+//                  OR FITNESS FOR A PARTICULAR PURPOSE
+//
+//                           expressed or implied.
+//
+//   Use of this code, pseudocode, algorithmic or trading logic contained
+//   herein, whether sound or faulty for any purpose is the sole
+//   responsibility of the USER. Any such use of these algorithms, coding
+//   logic or concepts in whole or in part carry no covenant of correctness
+//   or recommended usage from the AUTHOR or any of the possible
+//   contributors listed or unlisted, known or unknown.
+//
+//   Any reference of this code or to this code including any variants from
+//   this code, or any other credits due this AUTHOR from this code shall be
+//   clearly and unambiguously cited and evident during any use, whether in
+//   whole or in part.
+//
+//   The public sharing of this code does not relinquish, reduce, restrict or
+//   encumber any rights the AUTHOR has in respect to claims of intellectual
+//   property.
+//
+//   IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY
+//   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+//   OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+//   ANY WAY OUT OF THE USE OF THIS SOFTWARE, CODE, OR CODE FRAGMENT(S), EVEN
+//   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//   -------------------------------------------------------------------------
+//
+//                             ALL RIGHTS RESERVED
+//
+//   -------------------------------------------------------------------------
+//
+//   Author:	Mark Tompkins
+//   Copyright:	(c)2013
+//
@@ -0,0 +1,439 @@
+// rsiCalc.cpp
+//
+// Relative strength index.  See rsiCalc.h
+//
+
+#include "rsiCalc.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+// Running simple moving average that detrends prices as they are taken
+typedef struct rsiTrend
+{
+	const double *priceIn;
+	int length;					// Moving average length
+	int row;					// Last row taken
+	double sum;					// Sum of the prices of the window ending at 'row'
+} rsiTrend;
+
+// Prototypes
+static inline double advance(double prevPrice, double price);
+static inline double decline(double prevPrice, double price);
+static inline double rsiValue(double avgGain, double avgLoss);
+static inline double detrendNext(rsiTrend &trend);
+static void rsiPass(const double *priceIn, int rows, const int *lookbacks, const int *detrends, int numPeriods,
+	double *rsiOut, size_t periodStride);
+static void rsiBlock(const double *priceIn, int rows, const int *lookbacks, int detrend, int numBlock,
+	double *blockOut, size_t periodStride);
+
+// RSI of a single price column
+void rsiColumn(const double *priceIn, int rows, int lookback, double *rsiOut)
+{
+	rsiPeriods(priceIn, rows, &lookback, 1, rsiOut);
+}
+
+// RSI of a single price column for several lookbacks
+void rsiPeriods(const double *priceIn, int rows, const int *lookbacks, int numPeriods, double *rsiOut)
+{
+	rsiPass(priceIn, rows, lookbacks, NULL, numPeriods, rsiOut, rows);
+}
+
+// RSI of every column of a price panel for several lookbacks
+void rsiPanel(const double *pricesIn, int rows, int cols, const int *lookbacks, const int *detrends, int numPeriods,
+	double *rsiOut)
+{
+	// Create a NaN value
+	double m_Nan = std::numeric_limits<double>::quiet_NaN(); 
+
+	const size_t periodStride = (size_t)rows * cols;
+
+	// Columns are independent so they are shared between threads.  Each reads and writes its own contiguous column
+#pragma omp parallel for schedule(dynamic)
+	for (int col = 0; col < cols; col++)
+	{
+		const double *priceIn = pricesIn + (size_t)col * rows;
+		double *colOut = rsiOut + (size_t)col * rows;
+
+		// Leading NaNs are history from before the instrument listed
+		int start = 0;
+		while (start < rows && priceIn[start] != priceIn[start])
+		{
+			start++;
+		}
+
+		for (int pp = 0; pp < numPeriods; pp++)
+		{
+			for (int ii = 0; ii < start; ii++)
+			{
+				colOut[pp * periodStride + ii] = m_Nan;
+			}
+		}
+
+		rsiPass(priceIn + start, rows - start, lookbacks, detrends, numPeriods, colOut + start, periodStride);
+	}
+}
+
+// Flat, empty streaming state
+void rsiInit(rsiState &st, int lookback, int detrend)
+{
+	st.lookback = lookback;
+	st.detrend = detrend;
+	st.bars = 0;
+
+	st.prevPrice = 0;
+	st.avgGain = 0;
+	st.avgLoss = 0;
+	st.value = std::numeric_limits<double>::quiet_NaN();
+	st.trendSum = 0;
+
+	st.seed.assign(lookback + 1, 0);
+	st.window.assign(detrend, 0);
+}
+
+// Take the next price.  The same steps as rsiBlock for a single lookback
+double rsiPush(rsiState &st, double price)
+{
+	// Leading NaNs are history from before the instrument listed
+	if (st.bars == 0 && price != price)
+	{
+		return st.value;
+	}
+
+	// Detrend with the running sum of the last 'detrend' prices
+	if (st.detrend > 0)
+	{
+		double &oldest = st.window[st.bars % st.detrend];
+
+		st.trendSum = st.trendSum + price;
+		if (st.bars >= st.detrend)
+		{
+			st.trendSum = st.trendSum - oldest;
+		}
+		oldest = price;
+
+		price = price - st.trendSum / st.detrend;
+	}
+
+	if (st.bars < st.lookback)
+	{
+		st.seed[st.bars] = price;
+	}
+	else if (st.bars == st.lookback)
+	{
+		// The first average is the sum of the last 'lookback' advances & declines, latest first
+		st.seed[st.bars] = price;
+
+		double sumAdv = 0;
+		double sumDec = 0;
+
+		for (int jj = 0; jj != st.lookback; jj++)
+		{
+			const int ii = st.lookback - jj;
+			sumAdv = sumAdv + advance(st.seed[ii-1], st.seed[ii]);
+			sumDec = sumDec + decline(st.seed[ii-1], st.seed[ii]);
+		}
+
+		st.avgGain = sumAdv / st.lookback;
+		st.avgLoss = sumDec / st.lookback;
+		st.value = rsiValue(st.avgGain, st.avgLoss);
+	}
+	else
+	{
+		const double obsvLess1 = st.lookback - 1;
+		const double obsv = st.lookback;
+
+		st.avgGain = ((st.avgGain * obsvLess1) + advance(st.prevPrice, price)) / obsv;
+		st.avgLoss = ((st.avgLoss * obsvLess1) + decline(st.prevPrice, price)) / obsv;
+		st.value = rsiValue(st.avgGain, st.avgLoss);
+	}
+
+	st.prevPrice = price;
+	st.bars++;
+
+	return st.value;
+}
+
+// Flatten a streaming state:
+// version | lookback | detrend | bars | prevPrice | avgGain | avgLoss | value | trendSum | seed | window
+void rsiSave(const rsiState &st, std::vector<double> &saved)
+{
+	saved.clear();
+	saved.push_back(RSI_STATE_VERSION);
+	saved.push_back(st.lookback);
+	saved.push_back(st.detrend);
+	saved.push_back(st.bars);
+	saved.push_back(st.prevPrice);
+	saved.push_back(st.avgGain);
+	saved.push_back(st.avgLoss);
+	saved.push_back(st.value);
+	saved.push_back(st.trendSum);
+	saved.insert(saved.end(), st.seed.begin(), st.seed.end());
+	saved.insert(saved.end(), st.window.begin(), st.window.end());
+}
+
+// Rebuild a streaming state from rsiSave
+int rsiRestore(rsiState &st, const double *saved, size_t numSaved)
+{
+	if (numSaved < 9 || saved[0] != RSI_STATE_VERSION)
+	{
+		return 1;
+	}
+
+	const int lookback = int(saved[1]);
+	const int detrend = int(saved[2]);
+
+	if (lookback < 1 || detrend < 0 || saved[3] < 0 || numSaved != 9 + size_t(lookback + 1) + size_t(detrend))
+	{
+		return 1;
+	}
+
+	rsiInit(st, lookback, detrend);
+	st.bars = int(saved[3]);
+	st.prevPrice = saved[4];
+	st.avgGain = saved[5];
+	st.avgLoss = saved[6];
+	st.value = saved[7];
+	st.trendSum = saved[8];
+	st.seed.assign(saved + 9, saved + 9 + lookback + 1);
+	st.window.assign(saved + 9 + lookback + 1, saved + numSaved);
+
+	return 0;
+}
+
+/////////////
+//
+// FUNCTIONS & METHODS
+//
+/////////////
+
+// RSI of a single price column for several lookbacks.  Column 'p' of the output starts at rsiOut + p * periodStride.
+// Consecutive lookbacks sharing a detrend length are smoothed together, up to RSI_BLOCK at a time
+static void rsiPass(const double *priceIn, int rows, const int *lookbacks, const int *detrends, int numPeriods,
+	double *rsiOut, size_t periodStride)
+{
+	int first = 0;
+	while (first < numPeriods)
+	{
+		const int detrend = (detrends == NULL) ? 0 : detrends[first];
+		int numBlock = 1;
+		while (numBlock < RSI_BLOCK && first + numBlock < numPeriods &&
+			(detrends == NULL || detrends[first + numBlock] == detrend))
+		{
+			numBlock++;
+		}
+
+		rsiBlock(priceIn, rows, lookbacks + first, detrend, numBlock, rsiOut + first * periodStride, periodStride);
+		first += numBlock;
+	}
+}
+
+// RSI of up to RSI_BLOCK lookbacks in one pass over the prices.  A 'detrend' above 0 takes the advances and declines
+// of price less its simple moving average of that length.  Lookbacks at or beyond 'rows' give a column of NaNs
+static void rsiBlock(const double *priceIn, int rows, const int *lookbacks, int detrend, int numBlock,
+	double *blockOut, size_t periodStride)
+{
+	// Create a NaN value
+	double m_Nan = std::numeric_limits<double>::quiet_NaN(); 
+
+	// Wilder smoothed averages of each lookback.  Note: these are not averages in the formal sense
+	double avgGain[RSI_BLOCK];
+	double avgLoss[RSI_BLOCK];
+	double obsvLess1[RSI_BLOCK];
+	double obsv[RSI_BLOCK];
+	int minLookback = rows;
+	int maxLookback = 0;
+
+	for (int pp = 0; pp < numBlock; pp++)
+	{
+		minLookback = min(minLookback, lookbacks[pp]);
+		maxLookback = max(maxLookback, lookbacks[pp]);
+	}
+
+	// Prices of the seeding rows.  Undetrended these are the prices themselves.  Detrended, only the rows up to the
+	// longest lookback are held and later rows are detrended as the pass takes them
+	const double *seedPrices = priceIn;
+	int lastSeed = rows - 1;
+	vector<double> seedDetrended;
+	rsiTrend trend = {priceIn, detrend, -1, 0};
+
+	if (detrend > 0)
+	{
+		lastSeed = min(maxLookback, rows - 1);
+		seedDetrended.resize(lastSeed + 1);
+		for (int ii = 0; ii <= lastSeed; ii++)
+		{
+			seedDetrended[ii] = detrendNext(trend);
+		}
+		seedPrices = seedDetrended.data();
+	}
+
+	for (int pp = 0; pp < numBlock; pp++)
+	{
+		const int lookback = lookbacks[pp];
+		double *RSI = blockOut + pp * periodStride;
+
+		for (int ii = 0; ii < lookback && ii < rows; ii++)
+		{
+			RSI[ii] = m_Nan;
+		}
+
+		// The first average is the sum of the last 'lookback' advances & declines.
+		// Summed latest first as the recurrence is sensitive to rounding
+		if (lookback < rows)
+		{
+			double sumAdv = 0;
+			double sumDec = 0;
+
+			for (int jj = 0; jj != lookback; jj++)
+			{
+				const int ii = lookback - jj;
+				sumAdv = sumAdv + advance(seedPrices[ii-1], seedPrices[ii]);
+				sumDec = sumDec + decline(seedPrices[ii-1], seedPrices[ii]);
+			}
+
+			avgGain[pp] = sumAdv / lookback;
+			avgLoss[pp] = sumDec / lookback;
+			RSI[lookback] = rsiValue(avgGain[pp], avgLoss[pp]);
+		}
+
+		obsvLess1[pp] = lookback - 1;
+		obsv[pp] = lookback;
+	}
+
+	if (minLookback + 1 >= rows)
+	{
+		return;
+	}
+
+	// Lookbacks still seeding.  Only those past their first average are advanced
+	double prevPrice = seedPrices[minLookback];
+	int ii = minLookback + 1;
+	for (; ii <= maxLookback && ii < rows; ii++)
+	{
+		const double price = seedPrices[ii];
+		const double adv = advance(prevPrice, price);
+		const double dec = decline(prevPrice, price);
+		prevPrice = price;
+
+		for (int pp = 0; pp < numBlock; pp++)
+		{
+			if (ii > lookbacks[pp])
+			{
+				avgGain[pp] = ((avgGain[pp] * obsvLess1[pp]) + adv) / obsv[pp];
+				avgLoss[pp] = ((avgLoss[pp] * obsvLess1[pp]) + dec) / obsv[pp];
+				blockOut[pp * periodStride + ii] = rsiValue(avgGain[pp], avgLoss[pp]);
+			}
+		}
+	}
+
+	// Every lookback advances on every bar
+	for (; ii < rows; ii++)
+	{
+		const double price = (ii <= lastSeed) ? seedPrices[ii] : detrendNext(trend);
+		const double adv = advance(prevPrice, price);
+		const double dec = decline(prevPrice, price);
+		prevPrice = price;
+
+		for (int pp = 0; pp < numBlock; pp++)
+		{
+			avgGain[pp] = ((avgGain[pp] * obsvLess1[pp]) + adv) / obsv[pp];
+			avgLoss[pp] = ((avgLoss[pp] * obsvLess1[pp]) + dec) / obsv[pp];
+			blockOut[pp * periodStride + ii] = rsiValue(avgGain[pp], avgLoss[pp]);
+		}
+	}
+}
+
+// Advance of a price over the price prior
+static inline double advance(double prevPrice, double price)
+{
+	return (price - prevPrice > 0) ? abs(price - prevPrice) : 0;
+}
+
+// Decline of a price from the price prior
+static inline double decline(double prevPrice, double price)
+{
+	return (price - prevPrice > 0) ? 0 : abs(price - prevPrice);
+}
+
+// Price of the next row less its simple moving average.  Rows before a full window average the available prices over
+// the whole length, as Matlab's filter(ones(length,1)/length,1,price) and movAvg
+static inline double detrendNext(rsiTrend &trend)
+{
+	trend.row++;
+	trend.sum = trend.sum + trend.priceIn[trend.row];
+	if (trend.row >= trend.length)
+	{
+		trend.sum = trend.sum - trend.priceIn[trend.row - trend.length];
+	}
+
+	return trend.priceIn[trend.row] - trend.sum / trend.length;
+}
+
+// RSI of a pair of smoothed averages
+static inline double rsiValue(double avgGain, double avgLoss)
+{
+	if (avgLoss == 0)
+	{
+		return 100;
+	}
+
+	return 100 - (100 / (1 + avgGain / avgLoss));
+}
+
+//
+//  -------------------------------------------------------------------------
+//                                  _    _ 
+//         ___  _ __   ___ _ __    / \  | | __ _  ___   ___  _ __ __ _ 
+//        / _ \| '_ \ / _ \ '_ \  / _ \ | |/ _` |/ _ \ / _ \| '__/ _` |
+//       | (_) | |_) |  __/ | | |/ ___ \| | (_| | (_) | (_) | | | (_| |
+//        \___/| .__/ \___|_| |_/_/   \_\_|\__, |\___(_)___/|_|  \__, |
+//             |_|                         |___/                 |___/
+//  -------------------------------------------------------------------------
+//        This code is distributed in the hope that it will be useful,
+//
+//                      	 WITHOUT ANY WARRANTY
+//
+//                  WITHOUT CLAIM AS TO MERCHANTABILITY
+//
+//                  OR FITNESS FOR A PARTICULAR PURPOSE
+//
+//                           expressed or implied.
+//
+//   Use of this code, pseudocode, algorithmic or trading logic contained
+//   herein, whether sound or faulty for any purpose is the sole
+//   responsibility of the USER. Any such use of these algorithms, coding
+//   logic or concepts in whole or in part carry no covenant of correctness
+//   or recommended usage from the AUTHOR or any of the possible
+//   contributors listed or unlisted, known or unknown.
+//
+//   Any reference of this code or to this code including any variants from
+//   this code, or any other credits due this AUTHOR from this code shall be
+//   clearly and unambiguously cited and evident during any use, whether in
+//   whole or in part.
+//
+//   The public sharing of this code does not relinquish, reduce, restrict or
+//   encumber any rights the AUTHOR has in respect to claims of intellectual
+//   property.
+//
+//   IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY
+//   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+//   OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+//   ANY WAY OUT OF THE USE OF THIS SOFTWARE, CODE, OR CODE FRAGMENT(S), EVEN
+//   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//   -------------------------------------------------------------------------
+//
+//                             ALL RIGHTS RESERVED
+//
+//   -------------------------------------------------------------------------
+//
+//   Author:	Mark Tompkins
+//   Copyright:	(c)2013
+//
@@ -0,0 +1,121 @@
+#ifndef RSICALC_H
+#define RSICALC_H
+
+#include <stddef.h>
+#include <vector>
+
+// Relative strength index (RSI) used by relStrIdx
+//
+// RSI = 100 - 100 / (1 + RS) where RS is the ratio of the Wilder smoothed average gain and average loss.
+// The routines hold no state of their own so any number of calls may run concurrently.
+
+// Number of lookbacks smoothed together in one pass over the prices
+#define RSI_BLOCK 16
+
+// RSI of a single price column over a 'lookback' period.  'rsiOut' receives 'rows' values, the first 'lookback' of which are NaN.
+// The caller checks 1 <= lookback <= rows
+void rsiColumn(const double *priceIn, int rows, int lookback, double *rsiOut);
+
+// RSI of a single price column for each of 'numPeriods' lookbacks.  'rsiOut' is rows x numPeriods (column major).
+// Advances and declines are taken once per bar and up to RSI_BLOCK lookbacks are smoothed in the same pass
+// without any temporary arrays.  Each column is identical to rsiColumn of its lookback.
+// The caller checks 1 <= lookbacks[p] <= rows
+void rsiPeriods(const double *priceIn, int rows, const int *lookbacks, int numPeriods, double *rsiOut);
+
+// RSI of every column of a rows x cols price panel for each of 'numPeriods' lookbacks.  'rsiOut' is rows x cols x numPeriods
+// (column major) so a single lookback gives a rows x cols matrix laid out as the panel.  Leading NaNs of a column are
+// history from before the instrument listed: they stay NaN and the column's RSI starts from its first price, as
+// rsiPeriods of the listed rows.  A column with no more than 'lookback' listed rows is all NaN.
+// 'detrends' (NULL for none) gives each lookback a simple moving average length subtracted from price before the
+// advances and declines are taken, as rsiSTA and rsiSIG do with movAvg.  0 leaves that lookback undetrended.
+// The average is kept as a running sum within the pass so no detrended copy of the prices is made.
+// Columns are spread over threads when built with OpenMP.  The caller checks 1 <= lookbacks[p] and 0 <= detrends[p]
+void rsiPanel(const double *pricesIn, int rows, int cols, const int *lookbacks, const int *detrends, int numPeriods,
+	double *rsiOut);
+// Running state of a streaming RSI of one price series.  Prices are pushed one bar at a time and each update is O(1)
+// from the previous smoothed averages, so the values are bit-identical to rsiPanel of the same prices, lookback and
+// detrend (leading NaNs are skipped the same way).  Memory is fixed at lookback + detrend prices
+typedef struct rsiState
+{
+	int lookback;
+	int detrend;			// Simple moving average length subtracted from price.  0 = none
+	int bars;			// Prices taken.  Leading NaNs are not counted
+
+	double prevPrice;		// Last (detrended) price
+	double avgGain;			// Wilder smoothed averages once seeded
+	double avgLoss;
+	double value;			// RSI of the last price.  NaN until 'lookback' advances have been taken
+	double trendSum;		// Sum of the detrend window
+
+	std::vector<double> seed;	// (Detrended) prices of the first lookback + 1 bars.  Summed latest first as rsiPanel
+	std::vector<double> window;	// Last 'detrend' prices as a ring indexed by bars % detrend
+} rsiState;
+
+// Flat, empty state.  The caller checks 1 <= lookback and 0 <= detrend
+void rsiInit(rsiState &st, int lookback, int detrend);
+
+// Take the next price and return the RSI of its bar (st.value)
+double rsiPush(rsiState &st, double price);
+
+// Flatten a state to doubles so it can be stored and restored (e.g. across sessions).  The first value is RSI_STATE_VERSION
+#define RSI_STATE_VERSION 1
+void rsiSave(const rsiState &st, std::vector<double> &saved);
+
+// Rebuild a state from rsiSave.  Returns 0, or 1 when 'saved' is not a state of this version
+int rsiRestore(rsiState &st, const double *saved, size_t numSaved);
+
+#endif // RSICALC_H
+
+//
+//  -------------------------------------------------------------------------
+//                                  _    _ 
+//         ___  _ __   ___ _ __    / \  | | __ _  ___   ___  _ __ __ _ 
+//        / _ \| '_ \ / _ \ '_ \  / _ \ | |/ _` |/ _ \ / _ \| '__/ _` |
+//       | (_) | |_) |  __/ | | |/ ___ \| | (_| | (_) | (_) | | | (_| |
+//        \___/| .__/ \___|_| |_/_/   \_\_|\__, |\___(_)___/|_|  \__, |
+//             |_|                         |___/                 |___/
+//  -------------------------------------------------------------------------
+//        This code is distributed in the hope that it will be useful,
+//
+//                      	 WITHOUT ANY WARRANTY
+//
+//                  WITHOUT CLAIM AS TO MERCHANTABILITY
+//
+//                  OR FITNESS FOR A PARTICULAR PURPOSE
+//
+//                           expressed or implied.
+//
+//   Use of this code, pseudocode, algorithmic or trading logic contained
+//   herein, whether sound or faulty for any purpose is the sole
+//   responsibility of the USER. Any such use of these algorithms, coding
+//   logic or concepts in whole or in part carry no covenant of correctness
+//   or recommended usage from the AUTHOR or any of the possible
+//   contributors listed or unlisted, known or unknown.
+//
+//   Any reference of this code or to this code including any variants from
+//   this code, or any other credits due this AUTHOR from this code shall be
+//   clearly and unambiguously cited and evident during any use, whether in
+//   whole or in part.
+//
+//   The public sharing of this code does not relinquish, reduce, restrict or
+//   encumber any rights the AUTHOR has in respect to claims of intellectual
+//   property.
+//
+//   IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY
+//   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+//   OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+//   ANY WAY OUT OF THE USE OF THIS SOFTWARE, CODE, OR CODE FRAGMENT(S), EVEN
+//   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//   -------------------------------------------------------------------------
+//
+//                             ALL RIGHTS RESERVED
+//
+//   -------------------------------------------------------------------------
+//
+//   Author:	Mark Tompkins
+//   Copyright:	(c)2013
+//
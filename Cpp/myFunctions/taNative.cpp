@@ -0,0 +1,760 @@
+// taNative.cpp
+//
+// Native implementations of hot TA-Lib functions.  See taNative.h
+//
+// The scalar routines are written to follow TA-Lib's own loops operation for operation.  The AVX2 routines carry a running
+// window sum through each block of four bars with an in register prefix sum; recurrences that depend on the
+// previous bar in a non linear way (ATR, window extremes) keep their scalar loop and vectorize the rest.
+// TA-Lib's unstable periods and compatibility setting are assumed at their defaults (0 and TA_COMPATIBILITY_DEFAULT).
+
+#include "taNative.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define TA_NATIVE_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TA_AVX2_FN
+#else
+#define TA_AVX2_FN __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace std;
+
+#define TA_NATIVE_MAX_PERIOD 100000	// TA-Lib's upper bound for every period
+#define TA_NATIVE_MIN_VAR 0.00000001	// Variances below this are 0 (TA-Lib's TA_IS_ZERO_OR_NEG)
+
+// Prototypes
+static bool detectAvx2();
+static inline bool useAvx2(int path);
+static inline double trueRange(const double *inHigh, const double *inLow, const double *inClose, int row);
+static void smaScalar(const double *inReal, int rows, int period, double *out);
+static void emaScalar(const double *inReal, int rows, int period, double *out);
+static void wmaScalar(const double *inReal, int rows, int period, double *out);
+static void stdDevScalar(const double *inReal, int rows, int period, double numDev, double *out);
+static void bandsScalar(const double *middle, int numOut, double upMult, double dnMult, double *upper, double *lower);
+static void trueRangeScalar(const double *inHigh, const double *inLow, const double *inClose, int firstRow, int rows,
+	double *out);
+static void willrScalar(const double *inClose, const double *lowest, int numOut, int period, double *out);
+template <bool isMax> static void windowExtreme(const double *inReal, int rows, int period, double *out);
+
+#ifdef TA_NATIVE_X86
+TA_AVX2_FN static void smaAvx2(const double *inReal, int rows, int period, double *out);
+TA_AVX2_FN static void emaAvx2(const double *inReal, int rows, int period, double *out);
+TA_AVX2_FN static void wmaAvx2(const double *inReal, int rows, int period, double *out);
+TA_AVX2_FN static void stdDevAvx2(const double *inReal, int rows, int period, double numDev, double *out);
+TA_AVX2_FN static void bandsAvx2(const double *middle, int numOut, double upMult, double dnMult, double *upper,
+	double *lower);
+TA_AVX2_FN static void trueRangeAvx2(const double *inHigh, const double *inLow, const double *inClose, int firstRow,
+	int rows, double *out);
+TA_AVX2_FN static void willrAvx2(const double *inClose, const double *lowest, int numOut, int period, double *out);
+#else
+// No AVX2 on this architecture.  useAvx2() is always false
+#define smaAvx2 smaScalar
+#define emaAvx2 emaScalar
+#define wmaAvx2 wmaScalar
+#define stdDevAvx2 stdDevScalar
+#define bandsAvx2 bandsScalar
+#define trueRangeAvx2 trueRangeScalar
+#define willrAvx2 willrScalar
+#endif
+
+bool taNativeHasAvx2()
+{
+	static const bool hasAvx2 = detectAvx2();
+	return hasAvx2;
+}
+
+int taNativeSma(const double *inReal, int rows, int period, int path, double *out)
+{
+	if (period < 2 || period > TA_NATIVE_MAX_PERIOD)
+		return 1;
+
+	if (rows >= period)
+	{
+		if (useAvx2(path))
+			smaAvx2(inReal, rows, period, out);
+		else
+			smaScalar(inReal, rows, period, out);
+	}
+
+	return 0;
+}
+
+int taNativeEma(const double *inReal, int rows, int period, int path, double *out)
+{
+	if (period < 2 || period > TA_NATIVE_MAX_PERIOD)
+		return 1;
+
+	if (rows >= period)
+	{
+		if (useAvx2(path))
+			emaAvx2(inReal, rows, period, out);
+		else
+			emaScalar(inReal, rows, period, out);
+	}
+
+	return 0;
+}
+
+int taNativeWma(const double *inReal, int rows, int period, int path, double *out)
+{
+	if (period < 2 || period > TA_NATIVE_MAX_PERIOD)
+		return 1;
+
+	if (rows >= period)
+	{
+		if (useAvx2(path))
+			wmaAvx2(inReal, rows, period, out);
+		else
+			wmaScalar(inReal, rows, period, out);
+	}
+
+	return 0;
+}
+
+int taNativeStdDev(const double *inReal, int rows, int period, double numDev, int path, double *out)
+{
+	if (period < 2 || period > TA_NATIVE_MAX_PERIOD)
+		return 1;
+
+	if (rows >= period)
+	{
+		if (useAvx2(path))
+			stdDevAvx2(inReal, rows, period, numDev, out);
+		else
+			stdDevScalar(inReal, rows, period, numDev, out);
+	}
+
+	return 0;
+}
+
+int taNativeBbands(const double *inReal, int rows, int period, double upMult, double dnMult, int typeMA, int path,
+	double *upper, double *middle, double *lower)
+{
+	if (period < 2 || period > TA_NATIVE_MAX_PERIOD || typeMA < 0 || typeMA > 2)
+		return 1;
+
+	if (rows < period)
+		return 0;
+
+	// Middle band, then the standard deviation (about the SMA whatever the type, as TA-Lib) held in the lower band
+	switch (typeMA)
+	{
+		case 0:
+			taNativeSma(inReal, rows, period, path, middle);
+			break;
+		case 1:
+			taNativeEma(inReal, rows, period, path, middle);
+			break;
+		case 2:
+			taNativeWma(inReal, rows, period, path, middle);
+			break;
+	}
+	taNativeStdDev(inReal, rows, period, 1.0, path, lower);
+
+	if (useAvx2(path))
+		bandsAvx2(middle, rows - period + 1, upMult, dnMult, upper, lower);
+	else
+		bandsScalar(middle, rows - period + 1, upMult, dnMult, upper, lower);
+
+	return 0;
+}
+
+int taNativeAtr(const double *inHigh, const double *inLow, const double *inClose, int rows, int period, int path,
+	double *out)
+{
+	if (period < 1 || period > TA_NATIVE_MAX_PERIOD)
+		return 1;
+
+	// A period of 1 is the true range (lookback 1)
+	if (period == 1)
+	{
+		if (useAvx2(path))
+			trueRangeAvx2(inHigh, inLow, inClose, 1, rows, out);
+		else
+			trueRangeScalar(inHigh, inLow, inClose, 1, rows, out);
+		return 0;
+	}
+
+	if (rows <= period)
+		return 0;
+
+	// Seed with the SMA of the true ranges of rows 1 .. period
+	double periodTotal = 0;
+	for (int ii = 1; ii <= period; ii++)
+		periodTotal += trueRange(inHigh, inLow, inClose, ii);
+
+	double prevATR = periodTotal / period;
+	out[0] = prevATR;
+
+	// True ranges of the remaining rows in place, then Wilder's smoothing over them
+	if (useAvx2(path))
+		trueRangeAvx2(inHigh, inLow, inClose, period + 1, rows, out + 1);
+	else
+		trueRangeScalar(inHigh, inLow, inClose, period + 1, rows, out + 1);
+
+	for (int jj = 1; jj < rows - period; jj++)
+	{
+		prevATR *= period - 1;
+		prevATR += out[jj];
+		prevATR /= period;
+		out[jj] = prevATR;
+	}
+
+	return 0;
+}
+
+int taNativeWillr(const double *inHigh, const double *inLow, const double *inClose, int rows, int period, int path,
+	double *out)
+{
+	if (period < 2 || period > TA_NATIVE_MAX_PERIOD)
+		return 1;
+
+	if (rows < period)
+		return 0;
+
+	int numOut = rows - period + 1;
+	vector<double> lowest(numOut);
+
+	windowExtreme<true>(inHigh, rows, period, out);
+	windowExtreme<false>(inLow, rows, period, &lowest[0]);
+
+	if (useAvx2(path))
+		willrAvx2(inClose, &lowest[0], numOut, period, out);
+	else
+		willrScalar(inClose, &lowest[0], numOut, period, out);
+
+	return 0;
+}
+
+int taNativeMax(const double *inReal, int rows, int period, int path, double *out)
+{
+	if (period < 2 || period > TA_NATIVE_MAX_PERIOD)
+		return 1;
+
+	if (rows >= period)
+		windowExtreme<true>(inReal, rows, period, out);
+
+	return 0;
+}
+
+int taNativeMin(const double *inReal, int rows, int period, int path, double *out)
+{
+	if (period < 2 || period > TA_NATIVE_MAX_PERIOD)
+		return 1;
+
+	if (rows >= period)
+		windowExtreme<false>(inReal, rows, period, out);
+
+	return 0;
+}
+
+// AVX2 support of the processor and of the operating system (saved ymm registers)
+static bool detectAvx2()
+{
+#if defined(TA_NATIVE_X86) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+
+	__cpuid(info, 1);
+	bool osAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+
+	__cpuidex(info, 7, 0);
+	return osAvx && (info[1] & (1 << 5));
+#elif defined(TA_NATIVE_X86)
+	return __builtin_cpu_supports("avx2") != 0;
+#else
+	return false;
+#endif
+}
+
+static inline bool useAvx2(int path)
+{
+	return path == TA_NATIVE_AVX2 && taNativeHasAvx2();
+}
+
+// True range of 'row' (1 <= row) as TA_TRANGE
+static inline double trueRange(const double *inHigh, const double *inLow, const double *inClose, int row)
+{
+	double greatest = inHigh[row] - inLow[row];
+
+	double val2 = fabs(inClose[row - 1] - inHigh[row]);
+	if (val2 > greatest)
+		greatest = val2;
+
+	double val3 = fabs(inClose[row - 1] - inLow[row]);
+	if (val3 > greatest)
+		greatest = val3;
+
+	return greatest;
+}
+
+// Scalar paths.  'out' always receives the value of row 'lookback' first
+
+static void smaScalar(const double *inReal, int rows, int period, double *out)
+{
+	double periodTotal = 0;
+	int ii = 0;
+
+	while (ii < period - 1)
+		periodTotal += inReal[ii++];
+
+	for (int trailing = 0; ii < rows; ii++, trailing++)
+	{
+		periodTotal += inReal[ii];
+		double total = periodTotal;
+		periodTotal -= inReal[trailing];
+		out[trailing] = total / period;
+	}
+}
+
+static void emaScalar(const double *inReal, int rows, int period, double *out)
+{
+	double k = 2.0 / (double)(period + 1);
+	double total = 0;
+
+	for (int ii = 0; ii < period; ii++)
+		total += inReal[ii];
+
+	double prevMA = total / period;
+	out[0] = prevMA;
+
+	for (int ii = period; ii < rows; ii++)
+	{
+		prevMA = ((inReal[ii] - prevMA) * k) + prevMA;
+		out[ii - period + 1] = prevMA;
+	}
+}
+
+static void wmaScalar(const double *inReal, int rows, int period, double *out)
+{
+	double divider = (double)period * (period + 1) / 2;
+	double periodSub = 0;
+	double periodSum = 0;
+	int ii = 0;
+
+	for (; ii < period - 1; ii++)
+	{
+		periodSub += inReal[ii];
+		periodSum += inReal[ii] * (ii + 1);
+	}
+
+	double trailingValue = 0;
+	for (int trailing = 0; ii < rows; ii++, trailing++)
+	{
+		double value = inReal[ii];
+		periodSub += value;
+		periodSub -= trailingValue;
+		periodSum += value * period;
+		trailingValue = inReal[trailing];
+		out[trailing] = periodSum / divider;
+		periodSum -= periodSub;
+	}
+}
+
+static void stdDevScalar(const double *inReal, int rows, int period, double numDev, double *out)
+{
+	double periodTotal1 = 0;
+	double periodTotal2 = 0;
+	int ii = 0;
+
+	for (; ii < period - 1; ii++)
+	{
+		periodTotal1 += inReal[ii];
+		periodTotal2 += inReal[ii] * inReal[ii];
+	}
+
+	for (int trailing = 0; ii < rows; ii++, trailing++)
+	{
+		periodTotal1 += inReal[ii];
+		periodTotal2 += inReal[ii] * inReal[ii];
+		double meanValue1 = periodTotal1 / period;
+		double meanValue2 = periodTotal2 / period;
+		periodTotal1 -= inReal[trailing];
+		periodTotal2 -= inReal[trailing] * inReal[trailing];
+
+		double variance = meanValue2 - meanValue1 * meanValue1;
+		out[trailing] = (variance < TA_NATIVE_MIN_VAR) ? 0.0 : sqrt(variance) * numDev;
+	}
+}
+
+// Bands from the middle band and the standard deviation held in 'lower'
+static void bandsScalar(const double *middle, int numOut, double upMult, double dnMult, double *upper, double *lower)
+{
+	for (int jj = 0; jj < numOut; jj++)
+	{
+		double stdDev = lower[jj];
+		upper[jj] = middle[jj] + stdDev * upMult;
+		lower[jj] = middle[jj] - stdDev * dnMult;
+	}
+}
+
+// True ranges of rows firstRow .. rows - 1
+static void trueRangeScalar(const double *inHigh, const double *inLow, const double *inClose, int firstRow, int rows,
+	double *out)
+{
+	for (int row = firstRow; row < rows; row++)
+		out[row - firstRow] = trueRange(inHigh, inLow, inClose, row);
+}
+
+// %R from the highest highs (in 'out') and lowest lows of every window
+static void willrScalar(const double *inClose, const double *lowest, int numOut, int period, double *out)
+{
+	for (int jj = 0; jj < numOut; jj++)
+	{
+		double diff = (out[jj] - lowest[jj]) / (-100.0);
+		out[jj] = (diff != 0.0) ? (out[jj] - inClose[jj + period - 1]) / diff : 0.0;
+	}
+}
+
+template <bool isMax> static inline double extreme(double a, double b)
+{
+	return isMax ? ((a > b) ? a : b) : ((a < b) ? a : b);
+}
+
+// Highest (isMax) or lowest value of every window of 'period' rows (van Herk / Gil-Werman).  The rows are cut in to
+// blocks of 'period'.  A window spans the end of one block and the start of the next, so its extreme is that of the
+// block suffix from its first row and the block prefix to its last row.  'out' receives rows - period + 1 values.
+// The prefix and suffix runs are serial so both paths share this loop
+template <bool isMax> static void windowExtreme(const double *inReal, int rows, int period, double *out)
+{
+	int numOut = rows - period + 1;
+	vector<double> suffix(numOut);
+
+	for (int blockStart = 0; blockStart < numOut; blockStart += period)
+	{
+		int blockEnd = min(blockStart + period, rows) - 1;
+		double run = inReal[blockEnd];
+
+		for (int row = blockEnd; row >= blockStart; row--)
+		{
+			run = extreme<isMax>(inReal[row], run);
+			if (row < numOut)
+				suffix[row] = run;
+		}
+	}
+
+	// Block prefixes
+	double prefix = 0;
+	int blockRow = 0;
+
+	for (int row = 0; row < rows; row++)
+	{
+		prefix = (blockRow == 0) ? inReal[row] : extreme<isMax>(prefix, inReal[row]);
+		blockRow = (blockRow == period - 1) ? 0 : blockRow + 1;
+
+		if (row >= period - 1)
+			out[row - period + 1] = extreme<isMax>(suffix[row - period + 1], prefix);
+	}
+}
+
+#ifdef TA_NATIVE_X86
+
+// AVX2 paths.  Prefix sums of four lanes: lane j receives v[0] + ... + v[j]
+TA_AVX2_FN static inline __m256d scan4(__m256d v)
+{
+	const __m256d zero = _mm256_setzero_pd();
+
+	v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(2, 1, 0, 3)), zero, 0x1));
+	v = _mm256_add_pd(v, _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(1, 0, 3, 2)), zero, 0x3));
+
+	return v;
+}
+
+// Last lane in every lane
+TA_AVX2_FN static inline __m256d lastLane(__m256d v)
+{
+	return _mm256_permute4x64_pd(v, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+// Running window sum: total + the prefix sums of inReal[row + j] - inReal[row + j - period]
+TA_AVX2_FN static inline __m256d windowSums(const double *inReal, int row, int period, __m256d total)
+{
+	__m256d change = _mm256_sub_pd(_mm256_loadu_pd(inReal + row), _mm256_loadu_pd(inReal + row - period));
+	return _mm256_add_pd(total, scan4(change));
+}
+
+TA_AVX2_FN static void smaAvx2(const double *inReal, int rows, int period, double *out)
+{
+	double periodTotal = 0;
+	for (int ii = 0; ii < period; ii++)
+		periodTotal += inReal[ii];
+	out[0] = periodTotal / period;
+
+	const __m256d divisor = _mm256_set1_pd(period);
+	__m256d total = _mm256_set1_pd(periodTotal);
+	int row = period;
+
+	for (; row + 4 <= rows; row += 4)
+	{
+		__m256d sums = windowSums(inReal, row, period, total);
+		_mm256_storeu_pd(out + row - period + 1, _mm256_div_pd(sums, divisor));
+		total = lastLane(sums);
+	}
+
+	periodTotal = _mm256_cvtsd_f64(total);
+	for (; row < rows; row++)
+	{
+		periodTotal += inReal[row] - inReal[row - period];
+		out[row - period + 1] = periodTotal / period;
+	}
+}
+
+// ema = (1 - k) x ema[-1] + k x price.  Four bars are one affine prefix scan with the powers of (1 - k)
+TA_AVX2_FN static void emaAvx2(const double *inReal, int rows, int period, double *out)
+{
+	double k = 2.0 / (double)(period + 1);
+	double decay = 1 - k;
+	double total = 0;
+
+	for (int ii = 0; ii < period; ii++)
+		total += inReal[ii];
+
+	double prevMA = total / period;
+	out[0] = prevMA;
+
+	const __m256d zero = _mm256_setzero_pd();
+	const __m256d weight = _mm256_set1_pd(k);
+	const __m256d decay1 = _mm256_set1_pd(decay);
+	const __m256d decay2 = _mm256_set1_pd(decay * decay);
+	const __m256d decays = _mm256_setr_pd(decay, decay * decay, decay * decay * decay, decay * decay * decay * decay);
+	__m256d last = _mm256_set1_pd(prevMA);
+	int row = period;
+
+	for (; row + 4 <= rows; row += 4)
+	{
+		__m256d v = _mm256_mul_pd(weight, _mm256_loadu_pd(inReal + row));
+		v = _mm256_add_pd(v, _mm256_mul_pd(decay1, _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(2, 1, 0, 3)), zero, 0x1)));
+		v = _mm256_add_pd(v, _mm256_mul_pd(decay2, _mm256_blend_pd(_mm256_permute4x64_pd(v, _MM_SHUFFLE(1, 0, 3, 2)), zero, 0x3)));
+
+		__m256d ema = _mm256_add_pd(v, _mm256_mul_pd(decays, last));
+		_mm256_storeu_pd(out + row - period + 1, ema);
+		last = lastLane(ema);
+	}
+
+	prevMA = _mm256_cvtsd_f64(last);
+	for (; row < rows; row++)
+	{
+		prevMA = ((inReal[row] - prevMA) * k) + prevMA;
+		out[row - period + 1] = prevMA;
+	}
+}
+
+// weighted[t] = weighted[t - 1] - windowSum[t - 1] + period x price[t]
+TA_AVX2_FN static void wmaAvx2(const double *inReal, int rows, int period, double *out)
+{
+	double divider = (double)period * (period + 1) / 2;
+	double periodSum = 0;
+	double periodTotal = 0;
+
+	for (int ii = 0; ii < period; ii++)
+	{
+		periodSum += inReal[ii] * (ii + 1);
+		periodTotal += inReal[ii];
+	}
+	out[0] = periodSum / divider;
+
+	const __m256d divisor = _mm256_set1_pd(divider);
+	const __m256d weight = _mm256_set1_pd(period);
+	__m256d total = _mm256_set1_pd(periodTotal);
+	__m256d weighted = _mm256_set1_pd(periodSum);
+	int row = period;
+
+	for (; row + 4 <= rows; row += 4)
+	{
+		__m256d sums = windowSums(inReal, row, period, total);
+		__m256d prevSums = _mm256_blend_pd(_mm256_permute4x64_pd(sums, _MM_SHUFFLE(2, 1, 0, 3)), total, 0x1);
+		__m256d change = _mm256_sub_pd(_mm256_mul_pd(weight, _mm256_loadu_pd(inReal + row)), prevSums);
+
+		weighted = _mm256_add_pd(weighted, scan4(change));
+		_mm256_storeu_pd(out + row - period + 1, _mm256_div_pd(weighted, divisor));
+
+		total = lastLane(sums);
+		weighted = lastLane(weighted);
+	}
+
+	periodTotal = _mm256_cvtsd_f64(total);
+	periodSum = _mm256_cvtsd_f64(weighted);
+	for (; row < rows; row++)
+	{
+		periodSum += inReal[row] * period - periodTotal;
+		periodTotal += inReal[row] - inReal[row - period];
+		out[row - period + 1] = periodSum / divider;
+	}
+}
+
+TA_AVX2_FN static void stdDevAvx2(const double *inReal, int rows, int period, double numDev, double *out)
+{
+	double periodTotal1 = 0;
+	double periodTotal2 = 0;
+
+	for (int ii = 0; ii < period; ii++)
+	{
+		periodTotal1 += inReal[ii];
+		periodTotal2 += inReal[ii] * inReal[ii];
+	}
+
+	const __m256d zero = _mm256_setzero_pd();
+	const __m256d divisor = _mm256_set1_pd(period);
+	const __m256d minVar = _mm256_set1_pd(TA_NATIVE_MIN_VAR);
+	const __m256d devs = _mm256_set1_pd(numDev);
+	__m256d total1 = _mm256_set1_pd(periodTotal1);
+	__m256d total2 = _mm256_set1_pd(periodTotal2);
+	int row = period;
+
+	double meanValue1 = periodTotal1 / period;
+	double variance = periodTotal2 / period - meanValue1 * meanValue1;
+	out[0] = (variance < TA_NATIVE_MIN_VAR) ? 0.0 : sqrt(variance) * numDev;
+
+	for (; row + 4 <= rows; row += 4)
+	{
+		__m256d price = _mm256_loadu_pd(inReal + row);
+		__m256d trailing = _mm256_loadu_pd(inReal + row - period);
+
+		total1 = _mm256_add_pd(total1, scan4(_mm256_sub_pd(price, trailing)));
+		total2 = _mm256_add_pd(total2, scan4(_mm256_sub_pd(_mm256_mul_pd(price, price), _mm256_mul_pd(trailing, trailing))));
+
+		__m256d mean1 = _mm256_div_pd(total1, divisor);
+		__m256d var = _mm256_sub_pd(_mm256_div_pd(total2, divisor), _mm256_mul_pd(mean1, mean1));
+		__m256d dev = _mm256_mul_pd(_mm256_sqrt_pd(var), devs);
+
+		_mm256_storeu_pd(out + row - period + 1, _mm256_blendv_pd(dev, zero, _mm256_cmp_pd(var, minVar, _CMP_LT_OQ)));
+
+		total1 = lastLane(total1);
+		total2 = lastLane(total2);
+	}
+
+	periodTotal1 = _mm256_cvtsd_f64(total1);
+	periodTotal2 = _mm256_cvtsd_f64(total2);
+	for (; row < rows; row++)
+	{
+		periodTotal1 += inReal[row] - inReal[row - period];
+		periodTotal2 += inReal[row] * inReal[row] - inReal[row - period] * inReal[row - period];
+
+		meanValue1 = periodTotal1 / period;
+		variance = periodTotal2 / period - meanValue1 * meanValue1;
+		out[row - period + 1] = (variance < TA_NATIVE_MIN_VAR) ? 0.0 : sqrt(variance) * numDev;
+	}
+}
+
+TA_AVX2_FN static void bandsAvx2(const double *middle, int numOut, double upMult, double dnMult, double *upper,
+	double *lower)
+{
+	const __m256d up = _mm256_set1_pd(upMult);
+	const __m256d dn = _mm256_set1_pd(dnMult);
+	int jj = 0;
+
+	for (; jj + 4 <= numOut; jj += 4)
+	{
+		__m256d mid = _mm256_loadu_pd(middle + jj);
+		__m256d stdDev = _mm256_loadu_pd(lower + jj);
+
+		_mm256_storeu_pd(upper + jj, _mm256_add_pd(mid, _mm256_mul_pd(stdDev, up)));
+		_mm256_storeu_pd(lower + jj, _mm256_sub_pd(mid, _mm256_mul_pd(stdDev, dn)));
+	}
+
+	bandsScalar(middle + jj, numOut - jj, upMult, dnMult, upper + jj, lower + jj);
+}
+
+// As trueRange.  max_pd(a, b) is (a > b) ? a : b so the comparisons are those of TA-Lib
+TA_AVX2_FN static void trueRangeAvx2(const double *inHigh, const double *inLow, const double *inClose, int firstRow,
+	int rows, double *out)
+{
+	const __m256d signBit = _mm256_set1_pd(-0.0);
+	int row = firstRow;
+
+	for (; row + 4 <= rows; row += 4)
+	{
+		__m256d high = _mm256_loadu_pd(inHigh + row);
+		__m256d low = _mm256_loadu_pd(inLow + row);
+		__m256d prevClose = _mm256_loadu_pd(inClose + row - 1);
+
+		__m256d greatest = _mm256_sub_pd(high, low);
+		greatest = _mm256_max_pd(_mm256_andnot_pd(signBit, _mm256_sub_pd(prevClose, high)), greatest);
+		greatest = _mm256_max_pd(_mm256_andnot_pd(signBit, _mm256_sub_pd(prevClose, low)), greatest);
+
+		_mm256_storeu_pd(out + row - firstRow, greatest);
+	}
+
+	trueRangeScalar(inHigh, inLow, inClose, row, rows, out + row - firstRow);
+}
+
+TA_AVX2_FN static void willrAvx2(const double *inClose, const double *lowest, int numOut, int period, double *out)
+{
+	const __m256d zero = _mm256_setzero_pd();
+	const __m256d scale = _mm256_set1_pd(-100.0);
+	int jj = 0;
+
+	for (; jj + 4 <= numOut; jj += 4)
+	{
+		__m256d highest = _mm256_loadu_pd(out + jj);
+		__m256d diff = _mm256_div_pd(_mm256_sub_pd(highest, _mm256_loadu_pd(lowest + jj)), scale);
+		__m256d value = _mm256_div_pd(_mm256_sub_pd(highest, _mm256_loadu_pd(inClose + jj + period - 1)), diff);
+
+		_mm256_storeu_pd(out + jj, _mm256_blendv_pd(value, zero, _mm256_cmp_pd(diff, zero, _CMP_EQ_OQ)));
+	}
+
+	willrScalar(inClose + jj, lowest + jj, numOut - jj, period, out + jj);
+}
+
+#endif // TA_NATIVE_X86
+//
+//  -------------------------------------------------------------------------
+//                                  _    _ 
+//         ___  _ __   ___ _ __    / \  | | __ _  ___   ___  _ __ __ _ 
+//        / _ \| '_ \ / _ \ '_ \  / _ \ | |/ _` |/ _ \ / _ \| '__/ _` |
+//       | (_) | |_) |  __/ | | |/ ___ \| | (_| | (_) | (_) | | | (_| |
+//        \___/| .__/ \___|_| |_/_/   \_\_|\__, |\___(_)___/|_|  \__, |
+//             |_|                         |___/                 |___/
+//  -------------------------------------------------------------------------
+//        This code is distributed in the hope that it will be useful,
+//
+//                      	 WITHOUT ANY WARRANTY
+//
+//                  WITHOUT CLAIM AS TO MERCHANTABILITY
+//
+//                  OR FITNESS FOR A PARTICULAR PURPOSE
+//
+//                           expressed or implied.
+//
+//   Use of this code, pseudocode, algorithmic or trading logic contained
+//   herein, whether sound or faulty for any purpose is the sole
+//   responsibility of the USER. Any such use of these algorithms, coding
+//   logic or concepts in whole or in part carry no covenant of correctness
+//   or recommended usage from the AUTHOR or any of the possible
+//   contributors listed or unlisted, known or unknown.
+//
+//   Any reference of this code or to this code including any variants from
+//   this code, or any other credits due this AUTHOR from this code shall be
+//   clearly and unambiguously cited and evident during any use, whether in
+//   whole or in part.
+//
+//   The public sharing of this code does not relinquish, reduce, restrict or
+//   encumber any rights the AUTHOR has in respect to claims of intellectual
+//   property.
+//
+//   IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY
+//   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+//   OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+//   ANY WAY OUT OF THE USE OF THIS SOFTWARE, CODE, OR CODE FRAGMENT(S), EVEN
+//   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//   -------------------------------------------------------------------------
+//
+//                             ALL RIGHTS RESERVED
+//
+//   -------------------------------------------------------------------------
+//
+//   Author:	Mark Tompkins
+//   Copyright:	(c)2013
+//
@@ -0,0 +1,113 @@
+#ifndef TANATIVE_H
+#define TANATIVE_H
+
+// Native implementations of the TA-Lib functions that dominate taInvoke sweeps, used by taInvoke('backend',...)
+//
+// Each routine takes the same inputs and optional inputs as its TA-Lib function and writes the values TA-Lib
+// writes: 'out' receives rows - lookback values, the first being the value of row 'lookback' (TA-Lib's
+// TA_xxx_Lookback), and nothing when rows <= lookback.  Every routine returns 0, or 1 when an optional input is
+// outside TA-Lib's range, and holds no state so any number of calls may run concurrently.
+//
+// Two paths are given.  TA_NATIVE_SCALAR is portable C++ written to follow TA-Lib's loops operation for operation.
+// TA_NATIVE_AVX2 processes four bars per instruction and is taken only when taNativeHasAvx2() (otherwise the
+// scalar path runs).  The serial parts (the window extremes of MAX, MIN and WILLR, ATR's smoothing) are shared so
+// MAX, MIN, WILLR and ATR are bit-identical between the paths.  SMA, EMA, WMA, STDDEV and BBANDS sum their windows
+// in a different order and the rounding accumulates with the length of the series:
+//
+//	|avx2 - scalar| <= TA_NATIVE_TOLERANCE x rows x S
+//
+// where S is the largest |input| of the series.  STDDEV and the bands of BBANDS are compared as variances,
+// (value / numDev)^2 and ((band - middle) / multiplier)^2, against S^2 since a square root amplifies the error of a
+// variance near 0.  A variance within the tolerance of TA-Lib's 1e-8 floor may be 0 on one path only.
+// bench/checkTaNative holds both paths to this bound and to each function's definition.  Agreement with TA-Lib
+// itself is only measured by bench/benchTaInvoke, which is built when TA-Lib is found.
+// Window extremes (MAX, MIN, WILLR) are found in three comparisons a bar whatever the lookback (van Herk /
+// Gil-Werman) where TA-Lib rescans the window each time its extreme leaves it.
+
+#define TA_NATIVE_TOLERANCE 1e-12
+
+enum taNativePath { TA_NATIVE_SCALAR, TA_NATIVE_AVX2 };
+
+// True when the processor and operating system support AVX2.  Tested once
+bool taNativeHasAvx2();
+
+// Simple, exponential (TA-Lib's default SMA seed) and linearly weighted moving averages.  2 <= period
+int taNativeSma(const double *inReal, int rows, int period, int path, double *out);
+int taNativeEma(const double *inReal, int rows, int period, int path, double *out);
+int taNativeWma(const double *inReal, int rows, int period, int path, double *out);
+
+// Population standard deviation x numDev.  Variances below 1e-8 give 0 as TA-Lib.  2 <= period
+int taNativeStdDev(const double *inReal, int rows, int period, double numDev, int path, double *out);
+
+// Bollinger Bands: middle band of typeMA 0 (SMA), 1 (EMA) or 2 (WMA) +/- multiples of STDDEV(period, 1).
+// Other types return 1 and are left to TA-Lib.  2 <= period
+int taNativeBbands(const double *inReal, int rows, int period, double upMult, double dnMult, int typeMA, int path,
+	double *upper, double *middle, double *lower);
+
+// Average true range, Wilder smoothed from an SMA seed.  period 1 is the true range.  1 <= period
+int taNativeAtr(const double *inHigh, const double *inLow, const double *inClose, int rows, int period, int path,
+	double *out);
+
+// Williams' %R.  2 <= period
+int taNativeWillr(const double *inHigh, const double *inLow, const double *inClose, int rows, int period, int path,
+	double *out);
+
+// Highest and lowest value over a period.  2 <= period
+int taNativeMax(const double *inReal, int rows, int period, int path, double *out);
+int taNativeMin(const double *inReal, int rows, int period, int path, double *out);
+
+#endif // TANATIVE_H
+
+//
+//  -------------------------------------------------------------------------
+//                                  _    _ 
+//         ___  _ __   ___ _ __    / \  | | __ _  ___   ___  _ __ __ _ 
+//        / _ \| '_ \ / _ \ '_ \  / _ \ | |/ _` |/ _ \ / _ \| '__/ _` |
+//       | (_) | |_) |  __/ | | |/ ___ \| | (_| | (_) | (_) | | | (_| |
+//        \___/| .__/ \___|_| |_/_/   \_\_|\__, |\___(_)___/|_|  \__, |
+//             |_|                         |___/                 |___/
+//  -------------------------------------------------------------------------
+//        This code is distributed in the hope that it will be useful,
+//
+//                      	 WITHOUT ANY WARRANTY
+//
+//                  WITHOUT CLAIM AS TO MERCHANTABILITY
+//
+//                  OR FITNESS FOR A PARTICULAR PURPOSE
+//
+//                           expressed or implied.
+//
+//   Use of this code, pseudocode, algorithmic or trading logic contained
+//   herein, whether sound or faulty for any purpose is the sole
+//   responsibility of the USER. Any such use of these algorithms, coding
+//   logic or concepts in whole or in part carry no covenant of correctness
+//   or recommended usage from the AUTHOR or any of the possible
+//   contributors listed or unlisted, known or unknown.
+//
+//   Any reference of this code or to this code including any variants from
+//   this code, or any other credits due this AUTHOR from this code shall be
+//   clearly and unambiguously cited and evident during any use, whether in
+//   whole or in part.
+//
+//   The public sharing of this code does not relinquish, reduce, restrict or
+//   encumber any rights the AUTHOR has in respect to claims of intellectual
+//   property.
+//
+//   IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY
+//   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+//   OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+//   ANY WAY OUT OF THE USE OF THIS SOFTWARE, CODE, OR CODE FRAGMENT(S), EVEN
+//   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//   -------------------------------------------------------------------------
+//
+//                             ALL RIGHTS RESERVED
+//
+//   -------------------------------------------------------------------------
+//
+//   Author:	Mark Tompkins
+//   Copyright:	(c)2013
+//
@@ -0,0 +1,613 @@
+// taStream.cpp
+//
+// Streaming (bar by bar) TA-Lib functions.  See taStream.h
+//
+// Each push is the body of TA-Lib's loop for one bar.  The seeding loops TA-Lib runs before its output loop are
+// taken a bar at a time from the same running sums, so the arithmetic and its order are unchanged.
+
+#include "taStream.h"
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+#define TA_STREAM_MAX_PERIOD 100000	// TA-Lib's upper bound for every period
+#define TA_STREAM_MIN_VAR 0.00000001	// Variances below this are 0 (TA-Lib's TA_IS_ZERO_OR_NEG)
+#define TA_STREAM_EPSILON 0.00000001	// TA-Lib's TA_IS_ZERO
+
+static const double s_nan = numeric_limits<double>::quiet_NaN();
+
+static bool validPeriod(double period, int minPeriod)
+{
+	return period >= minPeriod && period <= TA_STREAM_MAX_PERIOD;
+}
+
+static bool isZero(double value)
+{
+	return -TA_STREAM_EPSILON < value && value < TA_STREAM_EPSILON;
+}
+
+// True range of a bar as TA_TRANGE
+static double trueRange(double high, double low, double prevClose)
+{
+	double greatest = high - low;
+
+	double val2 = fabs(prevClose - high);
+	if (val2 > greatest)
+		greatest = val2;
+
+	double val3 = fabs(prevClose - low);
+	if (val3 > greatest)
+		greatest = val3;
+
+	return greatest;
+}
+
+static void maInit(taStreamMA &ma, int typeMA, int period)
+{
+	ma.typeMA = typeMA;
+	ma.period = period;
+	ma.bars = 0;
+	ma.k = 2.0 / double(period + 1);
+	ma.total = 0;
+	ma.subTotal = 0;
+	ma.trailing = 0;
+	ma.window.assign(typeMA == 1 ? 0 : period, 0);
+}
+
+// Take the next value.  Returns the average, NaN until 'period' values have been taken
+static double maPush(taStreamMA &ma, double value)
+{
+	const int period = ma.period;
+	const int bar = ma.bars++;
+	double average = s_nan;
+
+	switch (ma.typeMA)
+	{
+		case 0:
+			// TA_INT_SMA: the window sum is taken with the new value and the oldest value is then removed
+			ma.window[bar % period] = value;
+			ma.total += value;
+			if (bar >= period - 1)
+			{
+				average = ma.total / period;
+				ma.total -= ma.window[(bar + 1) % period];
+			}
+			break;
+
+		case 1:
+			// TA_INT_EMA: seeded with the mean of the first 'period' values
+			if (bar < period)
+			{
+				ma.total += value;
+				if (bar == period - 1)
+				{
+					ma.total = ma.total / period;
+					average = ma.total;
+				}
+			}
+			else
+			{
+				ma.total = ((value - ma.total) * ma.k) + ma.total;
+				average = ma.total;
+			}
+			break;
+
+		default:
+			// TA_WMA: the window sum is dropped from the weighted sum each bar rather than reweighting the window
+			ma.window[bar % period] = value;
+			ma.subTotal += value;
+			if (bar < period - 1)
+				ma.total += value * (bar + 1);
+			else
+			{
+				ma.subTotal -= ma.trailing;
+				ma.total += value * period;
+				ma.trailing = ma.window[(bar + 1) % period];
+				average = ma.total / ((period * (period + 1)) >> 1);
+				ma.total -= ma.subTotal;
+			}
+			break;
+	}
+
+	return average;
+}
+
+// TA_RSI: Wilder's average gain (sum1) and loss (sum2) seeded with the mean of the first 'period' changes
+static void rsiStep(taStreamState &st, int tt, double close)
+{
+	const int period = int(st.opts[0]);
+
+	if (tt > 0)
+	{
+		const double change = close - st.prevClose;
+
+		if (tt > period)
+		{
+			st.sum2 *= (period - 1);
+			st.sum1 *= (period - 1);
+		}
+		if (change < 0)
+			st.sum2 -= change;
+		else
+			st.sum1 += change;
+
+		if (tt >= period)
+		{
+			st.sum2 /= period;
+			st.sum1 /= period;
+
+			if (tt >= st.lookback)
+			{
+				const double total = st.sum1 + st.sum2;
+				st.values[0] = isZero(total) ? 0.0 : 100.0 * (st.sum1 / total);
+			}
+		}
+	}
+
+	st.prevClose = close;
+}
+
+// TA_ATR: Wilder's average true range (sum1) seeded with the mean of the first 'period' true ranges
+static void atrStep(taStreamState &st, int tt, const double *bar)
+{
+	const int period = int(st.opts[0]);
+
+	if (tt > 0)
+	{
+		const double range = trueRange(bar[0], bar[1], st.prevClose);
+
+		if (period == 1)
+			st.sum1 = range;
+		else if (tt < period)
+			st.sum1 += range;
+		else if (tt == period)
+		{
+			st.sum1 += range;
+			st.sum1 = st.sum1 / period;
+		}
+		else
+		{
+			st.sum1 *= period - 1;
+			st.sum1 += range;
+			st.sum1 /= period;
+		}
+
+		if (tt >= st.lookback)
+			st.values[0] = st.sum1;
+	}
+
+	st.prevClose = bar[2];
+}
+
+// TA_ADX: Wilder's sums of +DM (sum1), -DM (sum2) and the true range (sum3) are seeded over bars 1 to period - 1.
+// The DX of the next 'period' bars are summed (sum4) in to the first ADX (sum5), which is then smoothed by Wilder
+static void adxStep(taStreamState &st, int tt, const double *bar)
+{
+	const int period = int(st.opts[0]);
+	const double high = bar[0];
+	const double low = bar[1];
+
+	if (tt > 0)
+	{
+		const double diffP = high - st.prevHigh;
+		const double diffM = st.prevLow - low;
+		const double range = trueRange(high, low, st.prevClose);
+
+		if (tt >= period)
+		{
+			st.sum2 -= st.sum2 / period;
+			st.sum1 -= st.sum1 / period;
+		}
+		if (diffM > 0 && diffP < diffM)
+			st.sum2 += diffM;
+		else if (diffP > 0 && diffP > diffM)
+			st.sum1 += diffP;
+
+		if (tt < period)
+			st.sum3 += range;
+		else
+		{
+			st.sum3 = st.sum3 - (st.sum3 / period) + range;
+
+			if (!isZero(st.sum3))
+			{
+				const double minusDI = 100.0 * (st.sum2 / st.sum3);
+				const double plusDI = 100.0 * (st.sum1 / st.sum3);
+				const double sumDI = minusDI + plusDI;
+				if (!isZero(sumDI))
+				{
+					const double dx = 100.0 * (fabs(minusDI - plusDI) / sumDI);
+					if (tt < 2 * period)
+						st.sum4 += dx;
+					else
+						st.sum5 = ((st.sum5 * (period - 1)) + dx) / period;
+				}
+			}
+
+			if (tt == 2 * period - 1)
+				st.sum5 = st.sum4 / period;
+			if (tt >= st.lookback)
+				st.values[0] = st.sum5;
+		}
+	}
+
+	st.prevHigh = high;
+	st.prevLow = low;
+	st.prevClose = bar[2];
+}
+
+// TA_MACD: the slow EMA starts at the first bar and the fast EMA slow - fast bars later so both first give a value
+// at the slow EMA's lookback.  The signal EMA is taken over the MACD from there
+static void macdStep(taStreamState &st, int tt, double close)
+{
+	const int fast = int(st.opts[0]);
+	const int slow = int(st.opts[1]);
+
+	const double slowMA = maPush(st.ma[0], close);
+	const double fastMA = (tt >= slow - fast) ? maPush(st.ma[1], close) : s_nan;
+
+	if (tt >= slow - 1 + st.unstable)
+	{
+		const double macd = fastMA - slowMA;
+		const double signal = maPush(st.ma[2], macd);
+
+		if (tt >= st.lookback)
+		{
+			st.values[0] = macd;
+			st.values[1] = signal;
+			st.values[2] = macd - signal;
+		}
+	}
+}
+
+// TA_SAR: the first position is long unless bar 1 has a positive -DM.  The SAR of a bar is the one projected from
+// the bar before unless the bar penetrates it, when the position is reversed at the extreme point
+static void sarStep(taStreamState &st, int tt, const double *bar)
+{
+	const double acceleration = st.opts[0];
+	const double maximum = st.opts[1];
+	const double newHigh = bar[0];
+	const double newLow = bar[1];
+	double prevHigh = st.prevHigh;
+	double prevLow = st.prevLow;
+
+	if (tt == 1)
+	{
+		const double diffP = newHigh - prevHigh;
+		const double diffM = prevLow - newLow;
+		st.isLong = (diffM > 0 && diffP < diffM) ? 0 : 1;
+
+		if (st.isLong)
+		{
+			st.ep = newHigh;
+			st.sar = prevLow;
+		}
+		else
+		{
+			st.ep = newLow;
+			st.sar = prevHigh;
+		}
+
+		// TA-Lib takes the first output bar as its own previous bar
+		prevHigh = newHigh;
+		prevLow = newLow;
+	}
+
+	if (tt > 0)
+	{
+		if (st.isLong)
+		{
+			if (newLow <= st.sar)
+			{
+				st.isLong = 0;
+				st.sar = st.ep;
+				if (st.sar < prevHigh)
+					st.sar = prevHigh;
+				if (st.sar < newHigh)
+					st.sar = newHigh;
+				st.values[0] = st.sar;
+
+				st.af = acceleration;
+				st.ep = newLow;
+				st.sar = st.sar + st.af * (st.ep - st.sar);
+				if (st.sar < prevHigh)
+					st.sar = prevHigh;
+				if (st.sar < newHigh)
+					st.sar = newHigh;
+			}
+			else
+			{
+				st.values[0] = st.sar;
+
+				if (newHigh > st.ep)
+				{
+					st.ep = newHigh;
+					st.af += acceleration;
+					if (st.af > maximum)
+						st.af = maximum;
+				}
+				st.sar = st.sar + st.af * (st.ep - st.sar);
+				if (st.sar > prevLow)
+					st.sar = prevLow;
+				if (st.sar > newLow)
+					st.sar = newLow;
+			}
+		}
+		else
+		{
+			if (newHigh >= st.sar)
+			{
+				st.isLong = 1;
+				st.sar = st.ep;
+				if (st.sar > prevLow)
+					st.sar = prevLow;
+				if (st.sar > newLow)
+					st.sar = newLow;
+				st.values[0] = st.sar;
+
+				st.af = acceleration;
+				st.ep = newHigh;
+				st.sar = st.sar + st.af * (st.ep - st.sar);
+				if (st.sar > prevLow)
+					st.sar = prevLow;
+				if (st.sar > newLow)
+					st.sar = newLow;
+			}
+			else
+			{
+				st.values[0] = st.sar;
+
+				if (newLow < st.ep)
+				{
+					st.ep = newLow;
+					st.af += acceleration;
+					if (st.af > maximum)
+						st.af = maximum;
+				}
+				st.sar = st.sar + st.af * (st.ep - st.sar);
+				if (st.sar < prevHigh)
+					st.sar = prevHigh;
+				if (st.sar < newHigh)
+					st.sar = newHigh;
+			}
+		}
+	}
+
+	st.prevHigh = newHigh;
+	st.prevLow = newLow;
+}
+
+// TA_BBANDS: the middle band is the moving average and the deviation is TA_INT_VAR's window sums of the values
+// (sum1) and their squares (sum2), started where TA-Lib starts the deviation (after the unstable period of an EMA)
+static void bbandsStep(taStreamState &st, int tt, double close)
+{
+	const int period = int(st.opts[0]);
+	const int varStart = (st.ma[0].typeMA == 1) ? st.unstable : 0;
+	const double middle = maPush(st.ma[0], close);
+
+	if (tt < varStart)
+		return;
+
+	const int jj = tt - varStart;
+	st.window[jj % period] = close;
+	st.sum1 += close;
+	st.sum2 += close * close;
+
+	if (jj >= period - 1)
+	{
+		const double mean1 = st.sum1 / period;
+		const double mean2 = st.sum2 / period;
+		const double oldest = st.window[(jj + 1) % period];
+		st.sum1 -= oldest;
+		st.sum2 -= oldest * oldest;
+
+		const double variance = mean2 - mean1 * mean1;
+		const double deviation = (variance < TA_STREAM_MIN_VAR) ? 0.0 : sqrt(variance);
+
+		st.values[0] = middle + deviation * st.opts[1];
+		st.values[1] = middle;
+		st.values[2] = middle - deviation * st.opts[2];
+	}
+}
+
+int taStreamNumSeries(int func)
+{
+	switch (func)
+	{
+		case TA_STREAM_ATR:
+		case TA_STREAM_ADX:
+			return 3;
+		case TA_STREAM_SAR:
+			return 2;
+		default:
+			return 1;
+	}
+}
+
+int taStreamNumOutputs(int func)
+{
+	return (func == TA_STREAM_MACD || func == TA_STREAM_BBANDS) ? 3 : 1;
+}
+
+int taStreamInit(taStreamState &st, int func, const double *opts, int unstable)
+{
+	const int numOpts = (func == TA_STREAM_BBANDS) ? 4 : (func == TA_STREAM_MACD) ? 3 : (func == TA_STREAM_SAR) ? 2 : 1;
+	const int period = int(opts[0]);
+
+	st.func = func;
+	for (int ii = 0; ii < TA_STREAM_MAX_OPTS; ii++)
+		st.opts[ii] = (ii < numOpts) ? opts[ii] : 0;
+	st.unstable = unstable;
+	st.lookback = 0;
+	st.bars = 0;
+	for (int ii = 0; ii < TA_STREAM_MAX_OUTPUTS; ii++)
+		st.values[ii] = s_nan;
+
+	st.sum1 = st.sum2 = st.sum3 = st.sum4 = st.sum5 = 0;
+	st.window.clear();
+	st.prevHigh = st.prevLow = st.prevClose = 0;
+	st.isLong = 0;
+	st.af = st.ep = st.sar = 0;
+
+	switch (func)
+	{
+		case TA_STREAM_SMA:
+		case TA_STREAM_EMA:
+		case TA_STREAM_WMA:
+			if (!validPeriod(opts[0], 2))
+				return 1;
+			maInit(st.ma[0], func - TA_STREAM_SMA, period);
+			st.lookback = period - 1 + (func == TA_STREAM_EMA ? unstable : 0);
+			break;
+
+		case TA_STREAM_RSI:
+			if (!validPeriod(opts[0], 2))
+				return 1;
+			st.lookback = period + unstable;
+			break;
+
+		case TA_STREAM_ATR:
+			if (!validPeriod(opts[0], 1))
+				return 1;
+			st.lookback = period + unstable;
+			break;
+
+		case TA_STREAM_ADX:
+			if (!validPeriod(opts[0], 2))
+				return 1;
+			st.lookback = 2 * period - 1 + unstable;
+			break;
+
+		case TA_STREAM_MACD:
+		{
+			if (!validPeriod(opts[0], 2) || !validPeriod(opts[1], 2) || !validPeriod(opts[2], 1) || opts[0] > opts[1])
+				return 1;
+			const int slow = int(opts[1]);
+			const int signal = int(opts[2]);
+			maInit(st.ma[0], 1, slow);
+			maInit(st.ma[1], 1, period);
+			maInit(st.ma[2], 1, signal);
+			st.lookback = (slow - 1 + unstable) + (signal - 1 + unstable);
+			break;
+		}
+
+		case TA_STREAM_SAR:
+			if (!(opts[0] >= 0) || !(opts[1] >= 0))
+				return 1;
+			// As TA_SAR an acceleration above the maximum is taken as the maximum
+			if (st.opts[0] > st.opts[1])
+				st.opts[0] = st.opts[1];
+			st.af = st.opts[0];
+			st.lookback = 1;
+			break;
+
+		case TA_STREAM_BBANDS:
+			if (!validPeriod(opts[0], 2) || !(opts[3] >= 0 && opts[3] <= 2))
+				return 1;
+			st.opts[3] = int(opts[3]);
+			maInit(st.ma[0], int(opts[3]), period);
+			st.window.assign(period, 0);
+			st.lookback = period - 1 + (int(opts[3]) == 1 ? unstable : 0);
+			break;
+
+		default:
+			return 1;
+	}
+
+	return 0;
+}
+
+void taStreamPush(taStreamState &st, const double *bar)
+{
+	const int tt = st.bars++;
+
+	for (int ii = 0; ii < TA_STREAM_MAX_OUTPUTS; ii++)
+		st.values[ii] = s_nan;
+
+	switch (st.func)
+	{
+		case TA_STREAM_SMA:
+		case TA_STREAM_EMA:
+		case TA_STREAM_WMA:
+		{
+			const double average = maPush(st.ma[0], bar[0]);
+			if (tt >= st.lookback)
+				st.values[0] = average;
+			break;
+		}
+		case TA_STREAM_RSI:
+			rsiStep(st, tt, bar[0]);
+			break;
+		case TA_STREAM_ATR:
+			atrStep(st, tt, bar);
+			break;
+		case TA_STREAM_ADX:
+			adxStep(st, tt, bar);
+			break;
+		case TA_STREAM_MACD:
+			macdStep(st, tt, bar[0]);
+			break;
+		case TA_STREAM_SAR:
+			sarStep(st, tt, bar);
+			break;
+		case TA_STREAM_BBANDS:
+			bbandsStep(st, tt, bar[0]);
+			break;
+	}
+}
+
+//
+//  -------------------------------------------------------------------------
+//                                  _    _ 
+//         ___  _ __   ___ _ __    / \  | | __ _  ___   ___  _ __ __ _ 
+//        / _ \| '_ \ / _ \ '_ \  / _ \ | |/ _` |/ _ \ / _ \| '__/ _` |
+//       | (_) | |_) |  __/ | | |/ ___ \| | (_| | (_) | (_) | | | (_| |
+//        \___/| .__/ \___|_| |_/_/   \_\_|\__, |\___(_)___/|_|  \__, |
+//             |_|                         |___/                 |___/
+//  -------------------------------------------------------------------------
+//        This code is distributed in the hope that it will be useful,
+//
+//                      	 WITHOUT ANY WARRANTY
+//
+//                  WITHOUT CLAIM AS TO MERCHANTABILITY
+//
+//                  OR FITNESS FOR A PARTICULAR PURPOSE
+//
+//                           expressed or implied.
+//
+//   Use of this code, pseudocode, algorithmic or trading logic contained
+//   herein, whether sound or faulty for any purpose is the sole
+//   responsibility of the USER. Any such use of these algorithms, coding
+//   logic or concepts in whole or in part carry no covenant of correctness
+//   or recommended usage from the AUTHOR or any of the possible
+//   contributors listed or unlisted, known or unknown.
+//
+//   Any reference of this code or to this code including any variants from
+//   this code, or any other credits due this AUTHOR from this code shall be
+//   clearly and unambiguously cited and evident during any use, whether in
+//   whole or in part.
+//
+//   The public sharing of this code does not relinquish, reduce, restrict or
+//   encumber any rights the AUTHOR has in respect to claims of intellectual
+//   property.
+//
+//   IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY
+//   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+//   OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+//   ANY WAY OUT OF THE USE OF THIS SOFTWARE, CODE, OR CODE FRAGMENT(S), EVEN
+//   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//   -------------------------------------------------------------------------
+//
+//                             ALL RIGHTS RESERVED
+//
+//   -------------------------------------------------------------------------
+//
+//   Author:	Mark Tompkins
+//   Copyright:	(c)2013
+//
@@ -0,0 +1,138 @@
+#ifndef TASTREAM_H
+#define TASTREAM_H
+
+#include <vector>
+
+// Streaming (bar by bar) TA-Lib functions used by taInvoke('create',...)
+//
+// The functions that are simple recurrences keep their running sums and averages between bars so a new bar is an
+// O(1) update rather than a call over the whole history.  Each state follows its TA-Lib function operation for
+// operation, seeding where TA-Lib seeds (e.g. MACD's fast EMA starts slow - fast bars in), so the values match the
+// batch function over the same bars.  bench/checkTaStream checks them row by row against the ordinary call's layout
+// without TA-Lib, and benchTaInvoke against TA-Lib itself when it is found.  TA-Lib's unstable period is given when
+// the state is created: values are computed from the first bar as TA-Lib does and are NaN until TA-Lib's lookback
+// including it.
+// TA-Lib's default compatibility (TA_COMPATIBILITY_DEFAULT) is assumed.
+// The routines hold no state of their own so any number of streams may be pushed concurrently.
+
+enum taStreamFunc { TA_STREAM_SMA, TA_STREAM_EMA, TA_STREAM_WMA, TA_STREAM_RSI, TA_STREAM_ATR, TA_STREAM_ADX,
+	TA_STREAM_MACD, TA_STREAM_SAR, TA_STREAM_BBANDS };
+
+#define TA_STREAM_MAX_OUTPUTS 3
+#define TA_STREAM_MAX_OPTS 4
+
+// Running moving average of TA-Lib type 0 (SMA), 1 (EMA) or 2 (WMA)
+typedef struct taStreamMA
+{
+	int typeMA;
+	int period;
+	int bars;			// Values taken
+	double k;			// EMA smoothing, 2 / (period + 1)
+	double total;			// SMA window sum | EMA seed sum, then the EMA | WMA weighted sum
+	double subTotal;		// WMA window sum
+	double trailing;		// WMA value leaving the window
+	std::vector<double> window;	// Last 'period' values (SMA, WMA) as a ring indexed by bars % period
+} taStreamMA;
+
+// Running state of one streaming function
+typedef struct taStreamState
+{
+	int func;			// taStreamFunc
+	double opts[TA_STREAM_MAX_OPTS];	// Optional inputs in TA-Lib's order
+	int unstable;			// TA-Lib's unstable period of the function (or of its EMAs)
+	int lookback;			// First bar with values, as TA_xxx_Lookback
+	int bars;			// Bars taken
+	double values[TA_STREAM_MAX_OUTPUTS];	// Outputs of the last bar.  NaN before the lookback
+
+	taStreamMA ma[3];		// SMA | EMA | WMA, BBANDS' middle band, MACD's slow, fast and signal EMAs
+
+	// RSI average gain & loss, ATR, ADX's smoothed +DM, -DM, true range, DX sum and ADX, BBANDS' window sums
+	double sum1;
+	double sum2;
+	double sum3;
+	double sum4;
+	double sum5;
+	std::vector<double> window;	// BBANDS' last 'period' values as a ring
+
+	double prevHigh;		// Previous bar (ATR, ADX, SAR)
+	double prevLow;
+	double prevClose;		// Previous close (RSI, ATR, ADX)
+
+	int isLong;			// SAR position, acceleration factor, extreme point and the SAR of the next bar
+	double af;
+	double ep;
+	double sar;
+} taStreamState;
+
+// Data series taken each bar (1 = Close, 2 = H | L, 3 = H | L | C) and outputs given (1 or 3)
+int taStreamNumSeries(int func);
+int taStreamNumOutputs(int func);
+
+// Flat, empty state.  'opts' holds every optional input of the function in TA-Lib's order:
+//	SMA, EMA, WMA, RSI, ATR, ADX	period
+//	MACD				fast period, slow period, signal period
+//	SAR				acceleration, maximum
+//	BBANDS				period, upper multiplier, lower multiplier, typeMA (0 - 2)
+// 'unstable' is TA_GetUnstablePeriod of the function (of TA_FUNC_UNST_EMA for EMA, MACD and an EMA BBANDS, 0 for
+// the others).  Returns 0, or 1 when an optional input is outside TA-Lib's range or a MACD's fast period is above
+// its slow period (as taInvoke)
+int taStreamInit(taStreamState &st, int func, const double *opts, int unstable);
+
+// Take the next bar.  'bar' holds one value of each series.  The outputs of the bar are left in st.values
+void taStreamPush(taStreamState &st, const double *bar);
+
+#endif // TASTREAM_H
+
+//
+//  -------------------------------------------------------------------------
+//                                  _    _ 
+//         ___  _ __   ___ _ __    / \  | | __ _  ___   ___  _ __ __ _ 
+//        / _ \| '_ \ / _ \ '_ \  / _ \ | |/ _` |/ _ \ / _ \| '__/ _` |
+//       | (_) | |_) |  __/ | | |/ ___ \| | (_| | (_) | (_) | | | (_| |
+//        \___/| .__/ \___|_| |_/_/   \_\_|\__, |\___(_)___/|_|  \__, |
+//             |_|                         |___/                 |___/
+//  -------------------------------------------------------------------------
+//        This code is distributed in the hope that it will be useful,
+//
+//                      	 WITHOUT ANY WARRANTY
+//
+//                  WITHOUT CLAIM AS TO MERCHANTABILITY
+//
+//                  OR FITNESS FOR A PARTICULAR PURPOSE
+//
+//                           expressed or implied.
+//
+//   Use of this code, pseudocode, algorithmic or trading logic contained
+//   herein, whether sound or faulty for any purpose is the sole
+//   responsibility of the USER. Any such use of these algorithms, coding
+//   logic or concepts in whole or in part carry no covenant of correctness
+//   or recommended usage from the AUTHOR or any of the possible
+//   contributors listed or unlisted, known or unknown.
+//
+//   Any reference of this code or to this code including any variants from
+//   this code, or any other credits due this AUTHOR from this code shall be
+//   clearly and unambiguously cited and evident during any use, whether in
+//   whole or in part.
+//
+//   The public sharing of this code does not relinquish, reduce, restrict or
+//   encumber any rights the AUTHOR has in respect to claims of intellectual
+//   property.
+//
+//   IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY
+//   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+//   OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+//   ANY WAY OUT OF THE USE OF THIS SOFTWARE, CODE, OR CODE FRAGMENT(S), EVEN
+//   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//   -------------------------------------------------------------------------
+//
+//                             ALL RIGHTS RESERVED
+//
+//   -------------------------------------------------------------------------
+//
+//   Author:	Mark Tompkins
+//   Copyright:	(c)2013
+//
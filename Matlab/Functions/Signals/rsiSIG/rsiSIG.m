@@ -89,14 +89,26 @@ if M > rows
 end; %if
 
 %% Detrend with a moving average
-if M == 0
-    ma = zeros(length(fClose),1);
+% relStrIdx subtracts a simple average within its own pass.  Other types are
+% detrended here.  The average itself is only built when it is returned.
+% The in pass average rounds differently from fClose - movAvg_mex(...), so ri
+% differs from the explicit detrend by up to 1e-9 (bench/checkRelStrIdx).
+if type == 0
+    ri = relStrIdx(fClose, N, M);
+    if nargout > 4 && M ~= 0
+        ma = movAvg_mex(fClose,M,M,type);
+    else
+        ma = zeros(rows,1);
+    end; %if
 else
-    ma = movAvg_mex(fClose,M,M,type);
-end
-
-%ri = rsindex(fClose - ma, N);
-ri = relStrIdx(fClose - ma, N);                 % RSI
+    if M == 0
+        ma = zeros(rows,1);
+    else
+        ma = movAvg_mex(fClose,M,M,type);
+    end; %if
+    %ri = rsindex(fClose - ma, N);
+    ri = relStrIdx(fClose - ma, N);
+end; %if
 
 %% Generate SIGNAL
 % Crossing the lower threshold (oversold)
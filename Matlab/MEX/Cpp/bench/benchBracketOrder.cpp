@@ -0,0 +1,91 @@
+// benchBracketOrder.cpp
+//
+// Native benchmark of bracketOrder over synthetic OHLC series and signal patterns.
+// Each pattern is measured with a profit target, stop and trailing stop together, through the fused bracket
+// and P&L ('pl') command returning only the P&L arrays, and as a 40 bracket exit rule sweep ('pl' with 'stats').
+
+#define SWEEP_BRACKETS 40
+
+#include "mex.h"
+#include "benchUtil.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+	benchOptions opts;
+	if (!parseBenchOptions(argc, argv, opts))
+		return 2;
+
+	vector<size_t> sizes = benchSizes(opts);
+	benchHeader("bracketOrder(barsIn,sigIn,minTick,profitTicks,stopTicks,trailTicks)");
+
+	for (size_t ss = 0; ss < sizes.size(); ss++)
+	{
+		const size_t rows = sizes[ss];
+		vector<double> ohlc, sig;
+		makeOHLC(rows, opts.seed, 0.25, ohlc);
+
+		mxArray *bars = benchArray(&ohlc[0], rows, 4);
+		mxArray *minTick = mxCreateDoubleScalar(0.25);
+		mxArray *profitTicks = mxCreateDoubleScalar(16);
+		mxArray *stopTicks = mxCreateDoubleScalar(12);
+		mxArray *trailTicks = mxCreateDoubleScalar(20);
+		mxArray *plCmd = mxCreateString("pl");
+		mxArray *bigPoint = mxCreateDoubleScalar(50);
+		mxArray *cost = mxCreateDoubleScalar(2.5);
+		mxArray *statsOpt = mxCreateString("stats");
+
+		// 8 profit targets by 5 stops with a common trailing stop
+		mxArray *sweepProfit = mxCreateDoubleMatrix(1, SWEEP_BRACKETS, mxREAL);
+		mxArray *sweepStop = mxCreateDoubleMatrix(1, SWEEP_BRACKETS, mxREAL);
+		for (int br = 0; br < SWEEP_BRACKETS; br++)
+		{
+			mxGetPr(sweepProfit)[br] = 4 + 4 * (br % 8);
+			mxGetPr(sweepStop)[br] = 4 + 4 * (br / 8);
+		}
+
+		for (int pattern = 0; pattern < SIG_NUM_PATTERNS; pattern++)
+		{
+			makeSignal(rows, pattern, opts.seed + pattern, sig);
+			mxArray *sigArr = benchArray(&sig[0], rows, 1);
+			const mxArray *prhs[6] = {bars, sigArr, minTick, profitTicks, stopTicks, trailTicks};
+			benchResult result;
+
+			if (!benchMex(2, 6, prhs, rows, opts.reps, result))
+				return 1;
+			benchReport("bracketOrder", sigPatternName(pattern), rows, result);
+
+			const mxArray *plIn[9] = {plCmd, bars, sigArr, minTick, profitTicks, stopTicks, trailTicks, bigPoint, cost};
+
+			if (!benchMex(4, 9, plIn, rows, opts.reps, result))
+				return 1;
+			benchReport("bracketOrder", (string(sigPatternName(pattern)) + "+pl").c_str(), rows, result);
+
+			const mxArray *sweepIn[10] = {plCmd, bars, sigArr, minTick, sweepProfit, sweepStop, trailTicks, bigPoint, cost, statsOpt};
+
+			if (!benchMex(1, 10, sweepIn, rows, opts.reps, result))
+				return 1;
+			benchReport("bracketOrder", (string(sigPatternName(pattern)) + "+sweep x40").c_str(), rows, result);
+
+			mxDestroyArray(sigArr);
+		}
+
+		mxDestroyArray(bars);
+		mxDestroyArray(minTick);
+		mxDestroyArray(profitTicks);
+		mxDestroyArray(stopTicks);
+		mxDestroyArray(trailTicks);
+		mxDestroyArray(plCmd);
+		mxDestroyArray(bigPoint);
+		mxDestroyArray(cost);
+		mxDestroyArray(statsOpt);
+		mxDestroyArray(sweepProfit);
+		mxDestroyArray(sweepStop);
+	}
+
+	return 0;
+}
@@ -0,0 +1,207 @@
+// benchCalcProfitLoss.cpp
+//
+// Native benchmark of calcProfitLoss over synthetic OHLC series and signal patterns.
+// Each pattern is measured producing the per bar arrays, in 'stats' mode and from compact
+// (int32 tick prices and int8 signals) inputs.  Before timing, the compact outputs are checked against the
+// double outputs on 0.25 and 0.01 ticks (see COMPACT_TOLERANCE).
+// The 'portfolio' command is measured with the bars of each size split across PORT_INST instruments.
+
+#include "mex.h"
+#include "mexShim.h"
+#include "benchUtil.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+const int PORT_INST = 8;			// Instruments in the portfolio case
+
+// Compact outputs must agree with the double outputs to this tolerance relative to max(1, |double output|).
+// The double prices are given as ticks * tickSize, the values the compact prices represent.  On a tick such as
+// 0.01 a random walk of double prices drifts from ticks * tickSize by rounding and the ledger's exact
+// comparisons (e.g. the openEQ cleaning) may then treat a bar differently, so that case is not comparable
+const double COMPACT_TOLERANCE = 1e-9;
+
+// P&L one signal pattern from double and from compact inputs and compare every output.
+// Returns the largest relative difference, or a negative value if either call failed
+static double compactDifference(size_t rows, unsigned seed, int pattern, double minTick)
+{
+	vector<double> ohlc, sig;
+	makeOHLC(rows, seed, minTick, ohlc);
+	makeSignal(rows, pattern, seed + pattern, sig);
+
+	// The prices the int32 ticks represent
+	for (size_t ii = 0; ii < ohlc.size(); ii++)
+		ohlc[ii] = floor(ohlc[ii] / minTick + 0.5) * minTick;
+
+	mxArray *data = benchArray(&ohlc[0], rows, 4);
+	mxArray *sigArr = benchArray(&sig[0], rows, 1);
+	mxArray *bigPoint = mxCreateDoubleScalar(50);
+	mxArray *cost = mxCreateDoubleScalar(2.5);
+	mxArray *dataTicks = benchTicksArray(&ohlc[0], rows, 4, minTick);
+	mxArray *sigCompact = benchInt8Signal(&sig[0], rows);
+	mxArray *tickSizeOpt = mxCreateString("tickSize");
+	mxArray *tickSize = mxCreateDoubleScalar(minTick);
+	mxArray *doubledOpt = mxCreateString("doubledSig");
+
+	const mxArray *doubleIn[4] = {data, sigArr, bigPoint, cost};
+	const mxArray *compactIn[7] = {dataTicks, sigCompact, bigPoint, cost, tickSizeOpt, tickSize, doubledOpt};
+	mxArray *doubleOut[4] = {NULL, NULL, NULL, NULL};
+	mxArray *compactOut[4] = {NULL, NULL, NULL, NULL};
+	double worst = -1;
+
+	try
+	{
+		mexFunction(4, doubleOut, 4, doubleIn);
+		mexFunction(4, compactOut, 7, compactIn);
+
+		worst = 0;
+		for (int out = 0; out < 4; out++)
+		{
+			const double *refPtr = mxGetPr(doubleOut[out]);
+			const double *cmpPtr = mxGetPr(compactOut[out]);
+			for (size_t ii = 0; ii < rows; ii++)
+				worst = max(worst, fabs(cmpPtr[ii] - refPtr[ii]) / max(1.0, fabs(refPtr[ii])));
+		}
+	}
+	catch (const mexShimError &err)
+	{
+		fprintf(stderr, "Kernel error %s: %s\n", err.identifier.c_str(), err.what());
+	}
+
+	for (int out = 0; out < 4; out++)
+	{
+		mxDestroyArray(doubleOut[out]);
+		mxDestroyArray(compactOut[out]);
+	}
+	mxDestroyArray(data);
+	mxDestroyArray(sigArr);
+	mxDestroyArray(bigPoint);
+	mxDestroyArray(cost);
+	mxDestroyArray(dataTicks);
+	mxDestroyArray(sigCompact);
+	mxDestroyArray(tickSizeOpt);
+	mxDestroyArray(tickSize);
+	mxDestroyArray(doubledOpt);
+
+	return worst;
+}
+
+int main(int argc, char *argv[])
+{
+	benchOptions opts;
+	if (!parseBenchOptions(argc, argv, opts))
+		return 2;
+
+	vector<size_t> sizes = benchSizes(opts);
+
+	// Compact inputs must reproduce the double inputs before they are timed
+	const double checkTicks[2] = {0.25, 0.01};
+	for (int tt = 0; tt < 2; tt++)
+	{
+		for (int pattern = 0; pattern < SIG_NUM_PATTERNS; pattern++)
+		{
+			double worst = compactDifference(sizes[0], opts.seed, pattern, checkTicks[tt]);
+			printf("compact vs double, tick %g, %s: largest difference %.3g\n", checkTicks[tt], sigPatternName(pattern), worst);
+			if (worst < 0 || worst > COMPACT_TOLERANCE)
+			{
+				fprintf(stderr, "Compact inputs differ from double inputs beyond %g\n", COMPACT_TOLERANCE);
+				return 1;
+			}
+		}
+	}
+
+	benchHeader("calcProfitLoss(data,sig,bigPoint,cost)");
+
+	for (size_t ss = 0; ss < sizes.size(); ss++)
+	{
+		const size_t rows = sizes[ss];
+		vector<double> ohlc, sig;
+		makeOHLC(rows, opts.seed, 0.25, ohlc);
+
+		mxArray *data = benchArray(&ohlc[0], rows, 4);
+		mxArray *bigPoint = mxCreateDoubleScalar(50);
+		mxArray *cost = mxCreateDoubleScalar(2.5);
+		mxArray *statsOpt = mxCreateString("stats");
+		mxArray *dataTicks = benchTicksArray(&ohlc[0], rows, 4, 0.25);
+		mxArray *tickSizeOpt = mxCreateString("tickSize");
+		mxArray *tickSize = mxCreateDoubleScalar(0.25);
+		mxArray *doubledOpt = mxCreateString("doubledSig");
+
+		for (int pattern = 0; pattern < SIG_NUM_PATTERNS; pattern++)
+		{
+			makeSignal(rows, pattern, opts.seed + pattern, sig);
+			mxArray *sigArr = benchArray(&sig[0], rows, 1);
+			const mxArray *prhs[5] = {data, sigArr, bigPoint, cost, statsOpt};
+			benchResult result;
+
+			if (!benchMex(4, 4, prhs, rows, opts.reps, result))
+				return 1;
+			benchReport("calcProfitLoss", sigPatternName(pattern), rows, result);
+
+			if (!benchMex(1, 5, prhs, rows, opts.reps, result))
+				return 1;
+			benchReport("calcProfitLoss", (string(sigPatternName(pattern)) + "+stats").c_str(), rows, result);
+
+			mxArray *sigCompact = benchInt8Signal(&sig[0], rows);
+			const mxArray *compactIn[7] = {dataTicks, sigCompact, bigPoint, cost, tickSizeOpt, tickSize, doubledOpt};
+
+			if (!benchMex(4, 7, compactIn, rows, opts.reps, result))
+				return 1;
+			benchReport("calcProfitLoss", (string(sigPatternName(pattern)) + "+compact").c_str(), rows, result);
+
+			mxDestroyArray(sigArr);
+			mxDestroyArray(sigCompact);
+		}
+
+		mxDestroyArray(data);
+		mxDestroyArray(bigPoint);
+		mxDestroyArray(cost);
+		mxDestroyArray(statsOpt);
+		mxDestroyArray(dataTicks);
+		mxDestroyArray(tickSizeOpt);
+		mxDestroyArray(tickSize);
+		mxDestroyArray(doubledOpt);
+
+		// Portfolio of instruments with their own prices, signals, tick values and commissions
+		const size_t instRows = rows / PORT_INST;
+		vector<double> openPanel(instRows * PORT_INST), closePanel(instRows * PORT_INST), sigPanel(instRows * PORT_INST);
+		vector<double> bigPoints(PORT_INST), costs(PORT_INST);
+
+		for (int inst = 0; inst < PORT_INST; inst++)
+		{
+			makeOHLC(instRows, opts.seed + 100 + inst, 0.25, ohlc);
+			makeSignal(instRows, inst % SIG_NUM_PATTERNS, opts.seed + 200 + inst, sig);
+			copy(ohlc.begin(), ohlc.begin() + instRows, openPanel.begin() + inst * instRows);
+			copy(ohlc.begin() + instRows * 3, ohlc.end(), closePanel.begin() + inst * instRows);
+			copy(sig.begin(), sig.end(), sigPanel.begin() + inst * instRows);
+			bigPoints[inst] = 12.5 * (inst + 1);
+			costs[inst] = 2.5;
+		}
+
+		mxArray *portCmd = mxCreateString("portfolio");
+		mxArray *openArr = benchArray(&openPanel[0], instRows, PORT_INST);
+		mxArray *closeArr = benchArray(&closePanel[0], instRows, PORT_INST);
+		mxArray *sigArr = benchArray(&sigPanel[0], instRows, PORT_INST);
+		mxArray *bigPointArr = benchArray(&bigPoints[0], 1, PORT_INST);
+		mxArray *costArr = benchArray(&costs[0], 1, PORT_INST);
+		const mxArray *portIn[6] = {portCmd, openArr, closeArr, sigArr, bigPointArr, costArr};
+		benchResult result;
+
+		if (!benchMex(6, 6, portIn, instRows * PORT_INST, opts.reps, result))
+			return 1;
+		benchReport("calcProfitLoss", "portfolio x8", instRows * PORT_INST, result);
+
+		mxDestroyArray(portCmd);
+		mxDestroyArray(openArr);
+		mxDestroyArray(closeArr);
+		mxDestroyArray(sigArr);
+		mxDestroyArray(bigPointArr);
+		mxDestroyArray(costArr);
+	}
+
+	return 0;
+}
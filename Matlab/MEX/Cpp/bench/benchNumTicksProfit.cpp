@@ -0,0 +1,95 @@
+// benchNumTicksProfit.cpp
+//
+// Native benchmark of numTicksProfit over synthetic OHLC series and signal patterns.
+// Each pattern is also measured from compact (int32 tick prices and int8 signals) inputs and
+// through the fused profit target and P&L ('pl') command returning only the P&L arrays.
+// A 40 target sweep ('pl' with 'stats' and numTicks = 1:40) is measured per pattern as well.
+
+#define SWEEP_TARGETS 40
+
+#include "mex.h"
+#include "benchUtil.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+	benchOptions opts;
+	if (!parseBenchOptions(argc, argv, opts))
+		return 2;
+
+	vector<size_t> sizes = benchSizes(opts);
+	benchHeader("numTicksProfit(barsIn,sigIn,minTick,numTicks,openAvg)");
+
+	for (size_t ss = 0; ss < sizes.size(); ss++)
+	{
+		const size_t rows = sizes[ss];
+		vector<double> ohlc, sig;
+		makeOHLC(rows, opts.seed, 0.25, ohlc);
+
+		mxArray *bars = benchArray(&ohlc[0], rows, 4);
+		mxArray *minTick = mxCreateDoubleScalar(0.25);
+		mxArray *numTicks = mxCreateDoubleScalar(8);
+		mxArray *openAvg = mxCreateDoubleScalar(0);
+		mxArray *barsTicks = benchTicksArray(&ohlc[0], rows, 4, 0.25);
+		mxArray *plCmd = mxCreateString("pl");
+		mxArray *bigPoint = mxCreateDoubleScalar(50);
+		mxArray *cost = mxCreateDoubleScalar(2.5);
+		mxArray *statsOpt = mxCreateString("stats");
+		mxArray *doubledOpt = mxCreateString("doubledSig");
+		mxArray *sweepTicks = mxCreateDoubleMatrix(1, SWEEP_TARGETS, mxREAL);
+		for (int tgt = 0; tgt < SWEEP_TARGETS; tgt++)
+			mxGetPr(sweepTicks)[tgt] = tgt + 1;
+
+		for (int pattern = 0; pattern < SIG_NUM_PATTERNS; pattern++)
+		{
+			makeSignal(rows, pattern, opts.seed + pattern, sig);
+			mxArray *sigArr = benchArray(&sig[0], rows, 1);
+			const mxArray *prhs[5] = {bars, sigArr, minTick, numTicks, openAvg};
+			benchResult result;
+
+			if (!benchMex(2, 5, prhs, rows, opts.reps, result))
+				return 1;
+			benchReport("numTicksProfit", sigPatternName(pattern), rows, result);
+
+			mxArray *sigCompact = benchInt8Signal(&sig[0], rows);
+			const mxArray *compactIn[6] = {barsTicks, sigCompact, minTick, numTicks, openAvg, doubledOpt};
+
+			if (!benchMex(2, 6, compactIn, rows, opts.reps, result))
+				return 1;
+			benchReport("numTicksProfit", (string(sigPatternName(pattern)) + "+compact").c_str(), rows, result);
+
+			const mxArray *plIn[8] = {plCmd, bars, sigArr, minTick, numTicks, openAvg, bigPoint, cost};
+
+			if (!benchMex(4, 8, plIn, rows, opts.reps, result))
+				return 1;
+			benchReport("numTicksProfit", (string(sigPatternName(pattern)) + "+pl").c_str(), rows, result);
+
+			const mxArray *sweepIn[9] = {plCmd, bars, sigArr, minTick, sweepTicks, openAvg, bigPoint, cost, statsOpt};
+
+			if (!benchMex(1, 9, sweepIn, rows, opts.reps, result))
+				return 1;
+			benchReport("numTicksProfit", (string(sigPatternName(pattern)) + "+sweep x40").c_str(), rows, result);
+
+			mxDestroyArray(sigArr);
+			mxDestroyArray(sigCompact);
+		}
+
+		mxDestroyArray(bars);
+		mxDestroyArray(minTick);
+		mxDestroyArray(numTicks);
+		mxDestroyArray(openAvg);
+		mxDestroyArray(barsTicks);
+		mxDestroyArray(plCmd);
+		mxDestroyArray(bigPoint);
+		mxDestroyArray(cost);
+		mxDestroyArray(statsOpt);
+		mxDestroyArray(doubledOpt);
+		mxDestroyArray(sweepTicks);
+	}
+
+	return 0;
+}
@@ -0,0 +1,108 @@
+// benchRelStrIdx.cpp
+//
+// Native benchmark of relStrIdx over synthetic Close series.
+// The lookback sweep N = 5:5:50 is measured in one call as well, and the same bars as a panel of
+// PANEL_COLS instruments (rows / PANEL_COLS each, with staggered NaN listing history).
+// Detrended calls sweep the detrend length M = 10:10:100 at N=14 as rsiSTA parameter sweeps do.
+// The streaming variant pushes every bar through an 'update' of one handle
+
+#define PANEL_COLS 16
+
+#include "mex.h"
+#include "benchUtil.h"
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+	benchOptions opts;
+	if (!parseBenchOptions(argc, argv, opts))
+		return 2;
+
+	vector<size_t> sizes = benchSizes(opts);
+	benchHeader("relStrIdx(data,N)");
+
+	for (size_t ss = 0; ss < sizes.size(); ss++)
+	{
+		const size_t rows = sizes[ss];
+		vector<double> ohlc;
+		makeOHLC(rows, opts.seed, 0.25, ohlc);
+
+		// Close column only
+		mxArray *data = benchArray(&ohlc[rows * 3], rows, 1);
+		mxArray *lookback = mxCreateDoubleScalar(14);
+		mxArray *sweep = mxCreateDoubleMatrix(1, 10, mxREAL);
+		for (int pp = 0; pp < 10; pp++)
+			mxGetPr(sweep)[pp] = 5 * (pp + 1);
+		const mxArray *prhs[2] = {data, lookback};
+		benchResult result;
+
+		if (!benchMex(1, 2, prhs, rows, opts.reps, result))
+			return 1;
+		benchReport("relStrIdx", "N=14", rows, result);
+
+		const mxArray *sweepIn[2] = {data, sweep};
+
+		if (!benchMex(1, 2, sweepIn, rows, opts.reps, result))
+			return 1;
+		benchReport("relStrIdx", "N=5:5:50", rows, result);
+
+		mxArray *detrend = mxCreateDoubleScalar(15 * 14);
+		mxArray *detrendSweep = mxCreateDoubleMatrix(1, 10, mxREAL);
+		for (int pp = 0; pp < 10; pp++)
+			mxGetPr(detrendSweep)[pp] = 10 * (pp + 1);
+		const mxArray *detrendIn[3] = {data, lookback, detrend};
+
+		if (!benchMex(1, 3, detrendIn, rows, opts.reps, result))
+			return 1;
+		benchReport("relStrIdx", "N=14 M=210", rows, result);
+
+		const mxArray *detrendSweepIn[3] = {data, lookback, detrendSweep};
+
+		if (!benchMex(1, 3, detrendSweepIn, rows, opts.reps, result))
+			return 1;
+		benchReport("relStrIdx", "N=14 M=10:10:100", rows, result);
+
+		// Streaming.  Repeated updates keep extending the same state
+		mxArray *create = mxCreateString("create");
+		mxArray *update = mxCreateString("update");
+		const mxArray *createIn[2] = {create, lookback};
+		mxArray *handle[1] = {NULL};
+		mexFunction(1, handle, 2, createIn);
+		const mxArray *updateIn[3] = {update, handle[0], data};
+
+		if (!benchMex(1, 3, updateIn, rows, opts.reps, result))
+			return 1;
+		benchReport("relStrIdx", "stream N=14", rows, result);
+
+		// Panel of the same number of bars
+		const size_t panelRows = rows / PANEL_COLS;
+		vector<double> panel(ohlc.begin() + rows * 3, ohlc.begin() + rows * 3 + panelRows * PANEL_COLS);
+		for (size_t col = 0; col < PANEL_COLS; col++)
+		{
+			for (size_t ii = 0; ii < col * panelRows / (4 * PANEL_COLS); ii++)
+				panel[col * panelRows + ii] = mxGetNaN();
+		}
+
+		mxArray *panelArr = benchArray(&panel[0], panelRows, PANEL_COLS);
+		const mxArray *panelIn[2] = {panelArr, lookback};
+
+		if (!benchMex(1, 2, panelIn, panelRows * PANEL_COLS, opts.reps, result))
+			return 1;
+		benchReport("relStrIdx", "panel x16 N=14", panelRows * PANEL_COLS, result);
+
+		mxDestroyArray(data);
+		mxDestroyArray(lookback);
+		mxDestroyArray(sweep);
+		mxDestroyArray(detrend);
+		mxDestroyArray(detrendSweep);
+		mxDestroyArray(panelArr);
+		mxDestroyArray(create);
+		mxDestroyArray(update);
+		mxDestroyArray(handle[0]);
+	}
+
+	return 0;
+}
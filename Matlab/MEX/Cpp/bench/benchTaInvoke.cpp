@@ -0,0 +1,396 @@
+// benchTaInvoke.cpp
+//
+// Native benchmark of taInvoke dispatching to TA-Lib over synthetic Close series.
+// Each function is also called by the numeric handle from taInvoke('handle',name), which skips the name lookup,
+// and all of them together in one taInvoke('pipeline',data,specs) call.  A ta_bbands parameter grid is timed as one
+// taInvoke('grid',data,spec) call and ta_rsi over an O | H | L | C panel as one call of four columns.
+// ta_atr is timed with taInvoke('cache',megabytes) enabled, where every call after the first is a hit, and as a
+// stream updated with every bar, which is checked against the call over the same bars split between history and update.
+// The functions with native implementations are then timed on each taInvoke('backend',name) and every native
+// output is checked against TA-Lib's to the tolerance documented in taNative.h.
+// Only built when TA-Lib is available.
+
+#include "mex.h"
+#include "benchUtil.h"
+#include "taNative.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// A function with a native implementation and the inputs it is timed with
+typedef struct nativeCase
+{
+	const char *funcName;
+	bool hlc;			// H | L | C, otherwise Close
+	int numOpts;
+	double opts[4];
+	int numOutputs;
+} nativeCase;
+
+static const nativeCase s_nativeCases[] =
+{
+	{"ta_sma", false, 1, {30}, 1},
+	{"ta_ema", false, 1, {30}, 1},
+	{"ta_wma", false, 1, {30}, 1},
+	{"ta_stddev", false, 2, {20, 2}, 1},
+	{"ta_bbands", false, 4, {20, 2, 1.5, 0}, 3},
+	{"ta_atr", true, 1, {14}, 1},
+	{"ta_willr", true, 1, {14}, 1},
+	{"ta_max", false, 1, {30}, 1},
+	{"ta_min", false, 1, {30}, 1}
+};
+
+// Switch taInvoke's backend
+static void setBackend(const char *name)
+{
+	mxArray *prhs[2] = {mxCreateString("backend"), mxCreateString(name)};
+	mxArray *plhs[1] = {NULL};
+
+	mexFunction(1, plhs, 2, (const mxArray**)prhs);
+
+	mxDestroyArray(plhs[0]);
+	mxDestroyArray(prhs[0]);
+	mxDestroyArray(prhs[1]);
+}
+
+// Compared value of output 'kk' at 'row'.  STDDEV and the outer bands are compared as variances
+static double comparedValue(const nativeCase &nc, mxArray *outputs[], int kk, size_t row)
+{
+	double value = mxGetPr(outputs[kk])[row];
+
+	if (strcmp(nc.funcName, "ta_stddev") == 0)
+		value = (value / nc.opts[1]) * (value / nc.opts[1]);
+	else if (strcmp(nc.funcName, "ta_bbands") == 0 && kk != 1)
+	{
+		double sd = (value - mxGetPr(outputs[1])[row]) / nc.opts[kk == 0 ? 1 : 2];
+		value = sd * sd;
+	}
+
+	return value;
+}
+
+// Largest |native - TA-Lib| as a multiple of rows x S (S^2 for variances, see taNative.h).  NaNs must agree
+static double nativeError(const nativeCase &nc, mxArray *native[], mxArray *talib[], size_t rows, double scale)
+{
+	bool isVariance = strcmp(nc.funcName, "ta_stddev") == 0 || strcmp(nc.funcName, "ta_bbands") == 0;
+	double worst = 0;
+
+	for (int kk = 0; kk < nc.numOutputs; kk++)
+	{
+		double bound = double(rows) * ((isVariance && !(strcmp(nc.funcName, "ta_bbands") == 0 && kk == 1)) ? scale * scale : scale);
+
+		for (size_t row = 0; row < rows; row++)
+		{
+			double a = comparedValue(nc, native, kk, row);
+			double b = comparedValue(nc, talib, kk, row);
+
+			if ((a != a) != (b != b))
+				return HUGE_VAL;
+			if (a == a)
+				worst = max(worst, fabs(a - b) / bound);
+		}
+	}
+
+	return worst;
+}
+
+// Resize the cache (0 disables it) and return its hits
+static double setCache(double megabytes)
+{
+	mxArray *prhs[2] = {mxCreateString("cache"), mxCreateDoubleScalar(megabytes)};
+	mxArray *plhs[1] = {NULL};
+
+	mexFunction(1, plhs, 2, (const mxArray**)prhs);
+	double hits = mxGetScalar(mxGetField(plhs[0], 0, "hits"));
+
+	mxDestroyArray(plhs[0]);
+	mxDestroyArray(prhs[0]);
+	mxDestroyArray(prhs[1]);
+	return hits;
+}
+
+// ta_atr(H, L, C, 20) streamed with the first half of the bars as history and the rest as one update.  True when
+// every bar equals 'batch', the call over all of the bars
+static bool streamMatches(const vector<double> &ohlc, size_t rows, const mxArray *batch)
+{
+	const size_t history = rows / 2;
+	mxArray *createIn[6] = {mxCreateString("create"), mxCreateString("ta_atr"), benchArray(&ohlc[rows], history, 1),
+		benchArray(&ohlc[rows * 2], history, 1), benchArray(&ohlc[rows * 3], history, 1), mxCreateDoubleScalar(20)};
+	mxArray *created[2] = {NULL, NULL};
+	mexFunction(2, created, 6, (const mxArray**)createIn);
+
+	mxArray *updateIn[5] = {mxCreateString("update"), created[0], benchArray(&ohlc[rows + history], rows - history, 1),
+		benchArray(&ohlc[rows * 2 + history], rows - history, 1), benchArray(&ohlc[rows * 3 + history], rows - history, 1)};
+	mxArray *updated[1] = {NULL};
+	mexFunction(1, updated, 5, (const mxArray**)updateIn);
+
+	const double *batchPtr = mxGetPr(batch);
+	bool same = true;
+	for (size_t ii = 0; ii < rows; ii++)
+	{
+		double value = (ii < history) ? mxGetPr(created[1])[ii] : mxGetPr(updated[0])[ii - history];
+		if (std::isnan(value) != std::isnan(batchPtr[ii]) || (!std::isnan(value) && value != batchPtr[ii]))
+			same = false;
+	}
+
+	mxArray *destroyIn[2] = {mxCreateString("destroy"), created[0]};
+	mexFunction(0, NULL, 2, (const mxArray**)destroyIn);
+
+	mxDestroyArray(destroyIn[0]);
+	mxDestroyArray(created[1]);
+	mxDestroyArray(updated[0]);
+	for (int ii = 0; ii < 6; ii++)
+		mxDestroyArray(createIn[ii]);
+	for (int ii = 0; ii < 5; ii++)
+		mxDestroyArray(updateIn[ii]);
+	return same;
+}
+
+// Time and check every native function on the 'scalar' and (when supported) 'avx2' backends against 'talib'
+static int benchBackends(const benchOptions &opts)
+{
+	const int numCases = sizeof(s_nativeCases) / sizeof(s_nativeCases[0]);
+	vector<const char*> backends;
+	backends.push_back("talib");
+	backends.push_back("scalar");
+	if (taNativeHasAvx2())
+		backends.push_back("avx2");
+
+	vector<size_t> sizes = benchSizes(opts);
+	benchHeader("taInvoke('backend',name)");
+
+	for (size_t ss = 0; ss < sizes.size(); ss++)
+	{
+		const size_t rows = sizes[ss];
+		vector<double> ohlc;
+		makeOHLC(rows, opts.seed, 0.25, ohlc);
+
+		double scale = 0;
+		for (size_t ii = rows; ii < rows * 4; ii++)
+			scale = max(scale, fabs(ohlc[ii]));
+
+		for (int cc = 0; cc < numCases; cc++)
+		{
+			const nativeCase &nc = s_nativeCases[cc];
+			vector<mxArray*> prhs;
+			prhs.push_back(mxCreateString(nc.funcName));
+			if (nc.hlc)
+			{
+				for (int col = 1; col < 4; col++)
+					prhs.push_back(benchArray(&ohlc[rows * col], rows, 1));
+			}
+			else
+				prhs.push_back(benchArray(&ohlc[rows * 3], rows, 1));
+			for (int oo = 0; oo < nc.numOpts; oo++)
+				prhs.push_back(mxCreateDoubleScalar(nc.opts[oo]));
+
+			mxArray *talib[3] = {NULL, NULL, NULL};
+			mxArray *native[3] = {NULL, NULL, NULL};
+
+			for (size_t bb = 0; bb < backends.size(); bb++)
+			{
+				setBackend(backends[bb]);
+
+				benchResult result;
+				if (!benchMex(nc.numOutputs, int(prhs.size()), (const mxArray**)&prhs[0], rows, opts.reps, result))
+					return 1;
+
+				string variant = string(nc.funcName) + " " + backends[bb];
+				benchReport("taInvoke", variant.c_str(), rows, result);
+
+				// Outputs of one more call are kept to check against TA-Lib
+				mxArray **outputs = (bb == 0) ? talib : native;
+				mexFunction(nc.numOutputs, outputs, int(prhs.size()), (const mxArray**)&prhs[0]);
+
+				if (bb > 0)
+				{
+					double error = nativeError(nc, native, talib, rows, scale);
+					if (error > TA_NATIVE_TOLERANCE)
+					{
+						fprintf(stderr, "%s on '%s' differs from TA-Lib by %g x rows x S (tolerance %g)\n",
+							nc.funcName, backends[bb], error, TA_NATIVE_TOLERANCE);
+						return 1;
+					}
+
+					for (int kk = 0; kk < nc.numOutputs; kk++)
+						mxDestroyArray(native[kk]);
+				}
+			}
+
+			for (int kk = 0; kk < nc.numOutputs; kk++)
+				mxDestroyArray(talib[kk]);
+			for (size_t ii = 0; ii < prhs.size(); ii++)
+				mxDestroyArray(prhs[ii]);
+		}
+	}
+
+	setBackend("talib");
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	benchOptions opts;
+	if (!parseBenchOptions(argc, argv, opts))
+		return 2;
+
+	// Function name and lookback of each measured call
+	const char *funcNames[] = {"ta_rsi", "ta_sma", "ta_ema"};
+	const double lookbacks[] = {14, 30, 30};
+	const int numFuncs = sizeof(funcNames) / sizeof(funcNames[0]);
+
+	vector<size_t> sizes = benchSizes(opts);
+	benchHeader("taInvoke(taFunction,data,N)");
+
+	for (size_t ss = 0; ss < sizes.size(); ss++)
+	{
+		const size_t rows = sizes[ss];
+		vector<double> ohlc;
+		makeOHLC(rows, opts.seed, 0.25, ohlc);
+
+		// Close column only
+		mxArray *data = benchArray(&ohlc[rows * 3], rows, 1);
+
+		for (int ff = 0; ff < numFuncs; ff++)
+		{
+			mxArray *funcName = mxCreateString(funcNames[ff]);
+			mxArray *lookback = mxCreateDoubleScalar(lookbacks[ff]);
+			const mxArray *prhs[3] = {funcName, data, lookback};
+			benchResult result;
+
+			if (!benchMex(1, 3, prhs, rows, opts.reps, result))
+				return 1;
+			benchReport("taInvoke", funcNames[ff], rows, result);
+
+			// Resolve the name once and call by handle
+			mxArray *command = mxCreateString("handle");
+			const mxArray *handleIn[2] = {command, funcName};
+			mxArray *handle[1] = {NULL};
+			mexFunction(1, handle, 2, handleIn);
+
+			string variant = string(funcNames[ff]) + " handle";
+			const mxArray *byHandle[3] = {handle[0], data, lookback};
+
+			if (!benchMex(1, 3, byHandle, rows, opts.reps, result))
+				return 1;
+			benchReport("taInvoke", variant.c_str(), rows, result);
+
+			mxDestroyArray(command);
+			mxDestroyArray(handle[0]);
+			mxDestroyArray(funcName);
+			mxDestroyArray(lookback);
+		}
+
+		// Every function in one call: {{'ta_rsi',14}, {'ta_sma',30}, {'ta_ema',30}}
+		mxArray *specs = mxCreateCellMatrix(1, numFuncs);
+		for (int ff = 0; ff < numFuncs; ff++)
+		{
+			mxArray *spec = mxCreateCellMatrix(1, 2);
+			mxSetCell(spec, 0, mxCreateString(funcNames[ff]));
+			mxSetCell(spec, 1, mxCreateDoubleScalar(lookbacks[ff]));
+			mxSetCell(specs, ff, spec);
+		}
+
+		mxArray *command = mxCreateString("pipeline");
+		const mxArray *pipeIn[3] = {command, data, specs};
+		benchResult result;
+
+		if (!benchMex(1, 3, pipeIn, rows, opts.reps, result))
+			return 1;
+		benchReport("taInvoke", "pipeline rsi+sma+ema", rows, result);
+
+		mxDestroyArray(command);
+		mxDestroyArray(specs);
+
+		// {'ta_bbands', [10 20 30], [1.5 2], 2}: the moving averages and deviations are shared by the multipliers
+		const double gridLookbacks[] = {10, 20, 30};
+		const double gridUpMults[] = {1.5, 2};
+		mxArray *spec = mxCreateCellMatrix(1, 4);
+		mxSetCell(spec, 0, mxCreateString("ta_bbands"));
+		mxSetCell(spec, 1, benchArray(gridLookbacks, 1, 3));
+		mxSetCell(spec, 2, benchArray(gridUpMults, 1, 2));
+		mxSetCell(spec, 3, mxCreateDoubleScalar(2));
+
+		command = mxCreateString("grid");
+		const mxArray *gridIn[3] = {command, data, spec};
+
+		if (!benchMex(1, 3, gridIn, rows, opts.reps, result))
+			return 1;
+		benchReport("taInvoke", "grid bbands 3x2", rows, result);
+
+		mxDestroyArray(command);
+		mxDestroyArray(spec);
+
+		// O | H | L | C as a rows x 4 panel, one RSI column per series
+		mxArray *panel = benchArray(&ohlc[0], rows, 4);
+		mxArray *funcName = mxCreateString("ta_rsi");
+		mxArray *lookback = mxCreateDoubleScalar(14);
+		const mxArray *panelIn[3] = {funcName, panel, lookback};
+
+		if (!benchMex(1, 3, panelIn, rows, opts.reps, result))
+			return 1;
+		benchReport("taInvoke", "ta_rsi panel x4", rows, result);
+
+		mxDestroyArray(funcName);
+		mxDestroyArray(lookback);
+		mxDestroyArray(panel);
+
+		// ta_atr(H, L, C, 20) uncached and then answered from the cache.  A hit only hashes the inputs
+		mxArray *atrIn[5] = {mxCreateString("ta_atr"), benchArray(&ohlc[rows], rows, 1), benchArray(&ohlc[rows * 2], rows, 1),
+			benchArray(&ohlc[rows * 3], rows, 1), mxCreateDoubleScalar(20)};
+		mxArray *uncached[1] = {NULL};
+		mxArray *cached[1] = {NULL};
+
+		if (!benchMex(1, 5, (const mxArray**)atrIn, rows, opts.reps, result))
+			return 1;
+		benchReport("taInvoke", "ta_atr", rows, result);
+		mexFunction(1, uncached, 5, (const mxArray**)atrIn);
+
+		double hits = setCache(256);
+		if (!benchMex(1, 5, (const mxArray**)atrIn, rows, opts.reps, result))
+			return 1;
+		benchReport("taInvoke", "ta_atr cached", rows, result);
+		mexFunction(1, cached, 5, (const mxArray**)atrIn);
+
+		bool same = memcmp(mxGetPr(cached[0]), mxGetPr(uncached[0]), rows * sizeof(double)) == 0;
+		if (setCache(0) <= hits || !same)
+		{
+			fprintf(stderr, "ta_atr from the cache differs from an uncached call or was not a hit\n");
+			return 1;
+		}
+
+		// ta_atr streamed.  Repeated updates of every bar keep extending the same state
+		mxArray *empty = mxCreateDoubleMatrix(0, 1, mxREAL);
+		mxArray *createIn[6] = {mxCreateString("create"), atrIn[0], empty, empty, empty, atrIn[4]};
+		mxArray *handle[1] = {NULL};
+		mexFunction(1, handle, 6, (const mxArray**)createIn);
+		mxArray *updateIn[5] = {mxCreateString("update"), handle[0], atrIn[1], atrIn[2], atrIn[3]};
+
+		if (!benchMex(1, 5, (const mxArray**)updateIn, rows, opts.reps, result))
+			return 1;
+		benchReport("taInvoke", "ta_atr stream", rows, result);
+
+		if (!streamMatches(ohlc, rows, uncached[0]))
+		{
+			fprintf(stderr, "ta_atr streamed differs from a call over the same bars\n");
+			return 1;
+		}
+
+		mxDestroyArray(createIn[0]);
+		mxDestroyArray(updateIn[0]);
+		mxDestroyArray(handle[0]);
+		mxDestroyArray(empty);
+		mxDestroyArray(cached[0]);
+		mxDestroyArray(uncached[0]);
+		for (int ii = 0; ii < 5; ii++)
+			mxDestroyArray(atrIn[ii]);
+		mxDestroyArray(data);
+	}
+
+	return benchBackends(opts);
+}
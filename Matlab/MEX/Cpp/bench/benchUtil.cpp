@@ -0,0 +1,309 @@
+// benchUtil.cpp
+//
+// Synthetic data, timing and reporting shared by the MEX kernel benchmarks
+
+#include "benchUtil.h"
+#include "mexShim.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <sys/resource.h>
+
+using namespace std;
+
+/////////////
+//
+// HEAP ACCOUNTING
+//
+/////////////
+
+// Every operator new made by the kernel (containers, new[] scratch, ...) is counted so that
+// alternative ledger designs can be compared by allocation count as well as by time
+static atomic<long long> s_heapAllocs(0);
+
+void *operator new(size_t size)
+{
+	s_heapAllocs++;
+	void *ptr = malloc(size == 0 ? 1 : size);
+	if (ptr == NULL)
+		throw bad_alloc();
+	return ptr;
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+	free(ptr);
+}
+
+/////////////
+//
+// OPTIONS
+//
+/////////////
+
+static void benchUsage(const char *exe)
+{
+	fprintf(stderr, "Usage: %s [--min bars] [--max bars] [--reps n] [--seed n]\n", exe);
+	fprintf(stderr, "       Sizes step by decade from --min (default 1e4) to --max (default 1e6, up to 1e8)\n");
+}
+
+bool parseBenchOptions(int argc, char *argv[], benchOptions &opts)
+{
+	opts.minBars = 1e4;
+	opts.maxBars = 1e6;
+	opts.reps = 3;
+	opts.seed = 20130101;
+
+	for (int ii = 1; ii < argc; ii++)
+	{
+		if (ii + 1 >= argc)
+		{
+			benchUsage(argv[0]);
+			return false;
+		}
+
+		double value = atof(argv[ii + 1]);
+
+		if (strcmp(argv[ii], "--min") == 0)
+			opts.minBars = value;
+		else if (strcmp(argv[ii], "--max") == 0)
+			opts.maxBars = value;
+		else if (strcmp(argv[ii], "--reps") == 0)
+			opts.reps = int(value);
+		else if (strcmp(argv[ii], "--seed") == 0)
+			opts.seed = unsigned(value);
+		else
+		{
+			benchUsage(argv[0]);
+			return false;
+		}
+		ii++;
+	}
+
+	if (opts.minBars < 10 || opts.maxBars < opts.minBars || opts.maxBars > 1e8 || opts.reps < 1)
+	{
+		benchUsage(argv[0]);
+		return false;
+	}
+
+	return true;
+}
+
+vector<size_t> benchSizes(const benchOptions &opts)
+{
+	vector<size_t> sizes;
+	for (double bars = opts.minBars; bars <= opts.maxBars * 1.000001; bars *= 10)
+	{
+		sizes.push_back(size_t(bars + 0.5));
+	}
+
+	return sizes;
+}
+
+/////////////
+//
+// SYNTHETIC DATA
+//
+/////////////
+
+void makeOHLC(size_t rows, unsigned seed, double minTick, vector<double> &ohlc)
+{
+	mt19937 gen(seed);
+	normal_distribution<double> barMove(0, 8);		// Open to Close in ticks
+	uniform_int_distribution<int> gap(-2, 2);		// Close to next Open in ticks
+	uniform_int_distribution<int> wick(0, 4);		// Extension beyond the body in ticks
+
+	ohlc.assign(rows * 4, 0);
+	double *openPtr = &ohlc[0];
+	double *highPtr = openPtr + rows;
+	double *lowPtr = highPtr + rows;
+	double *closePtr = lowPtr + rows;
+
+	double lastClose = 4000 * minTick;
+	for (size_t ii = 0; ii < rows; ii++)
+	{
+		double openPrice = lastClose + gap(gen) * minTick;
+		double closePrice = openPrice + floor(barMove(gen) + 0.5) * minTick;
+
+		// Keep the walk well away from zero
+		if (closePrice < 1000 * minTick)
+			closePrice = openPrice + fabs(closePrice - openPrice);
+
+		openPtr[ii] = openPrice;
+		closePtr[ii] = closePrice;
+		highPtr[ii] = max(openPrice, closePrice) + wick(gen) * minTick;
+		lowPtr[ii] = min(openPrice, closePrice) - wick(gen) * minTick;
+		lastClose = closePrice;
+	}
+}
+
+void makeSignal(size_t rows, int pattern, unsigned seed, vector<double> &sig)
+{
+	mt19937 gen(seed);
+	uniform_real_distribution<double> coin(0, 1);
+
+	double prob;
+	switch (pattern)
+	{
+	case SIG_SPARSE:	prob = 0.01;	break;		// Occasional round trips
+	case SIG_DENSE:		prob = 0.5;	break;		// A transaction every other bar
+	default:		prob = 0.05;	break;
+	}
+
+	sig.assign(rows, 0);
+	int netPos = 0;
+
+	for (size_t ii = 0; ii < rows; ii++)
+	{
+		if (coin(gen) >= prob)
+			continue;
+
+		int side = (netPos > 0) - (netPos < 0);
+
+		if (netPos == 0)
+		{
+			// Initiate
+			sig[ii] = (coin(gen) < 0.5) ? 1 : -1;
+			netPos = int(sig[ii]);
+		}
+		else if (pattern == SIG_PYRAMID && abs(netPos) < 5 && coin(gen) < 0.75)
+		{
+			// Add to the position
+			sig[ii] = side;
+			netPos += side;
+		}
+		else if (pattern == SIG_REVERSAL)
+		{
+			// Reverse to a 1 lot on the other side
+			sig[ii] = -side * 1.5;
+			netPos = -side;
+		}
+		else
+		{
+			// Flatten
+			sig[ii] = -side * 0.5;
+			netPos = 0;
+		}
+	}
+}
+
+const char *sigPatternName(int pattern)
+{
+	switch (pattern)
+	{
+	case SIG_SPARSE:	return "sparse";
+	case SIG_DENSE:		return "dense";
+	case SIG_PYRAMID:	return "pyramiding";
+	case SIG_REVERSAL:	return "reversal";
+	default:		return "unknown";
+	}
+}
+
+mxArray *benchArray(const double *data, size_t rows, size_t cols)
+{
+	return mexShimCreateFromData(data, rows, cols);
+}
+
+mxArray *benchTicksArray(const double *data, size_t rows, size_t cols, double minTick)
+{
+	mxArray *ticks = mxCreateNumericMatrix(rows, cols, mxINT32_CLASS, mxREAL);
+	int32_t *ticksPtr = (int32_t*)mxGetData(ticks);
+
+	for (size_t ii = 0; ii < rows * cols; ii++)
+		ticksPtr[ii] = int32_t(floor(data[ii] / minTick + 0.5));
+
+	return ticks;
+}
+
+mxArray *benchInt8Signal(const double *sig, size_t rows)
+{
+	mxArray *sigArr = mxCreateNumericMatrix(rows, 1, mxINT8_CLASS, mxREAL);
+	int8_t *sigPtr = (int8_t*)mxGetData(sigArr);
+
+	for (size_t ii = 0; ii < rows; ii++)
+		sigPtr[ii] = int8_t(sig[ii] * 2);
+
+	return sigArr;
+}
+
+/////////////
+//
+// MEASUREMENT
+//
+/////////////
+
+static double peakRssMB()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss / 1024.0;		// Linux reports kilobytes
+}
+
+bool benchMex(int nlhs, int nrhs, const mxArray *prhs[], size_t rows, int reps, benchResult &result)
+{
+	vector<mxArray*> plhs(nlhs > 0 ? nlhs : 1, (mxArray*)NULL);
+	double bestNs = -1;
+
+	for (int rep = 0; rep < reps; rep++)
+	{
+		mexShimResetAllocStats();
+		long long heapStart = s_heapAllocs.load();
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+		try
+		{
+			mexFunction(nlhs, &plhs[0], nrhs, prhs);
+		}
+		catch (const mexShimError &err)
+		{
+			fprintf(stderr, "Kernel error %s: %s\n", err.identifier.c_str(), err.what());
+			return false;
+		}
+
+		double elapsedNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+		result.heapAllocs = s_heapAllocs.load() - heapStart;
+		result.mxAllocs = mexShimGetAllocStats().allocations;
+
+		if (bestNs < 0 || elapsedNs < bestNs)
+			bestNs = elapsedNs;
+
+		for (int ii = 0; ii < nlhs; ii++)
+		{
+			mxDestroyArray(plhs[ii]);
+			plhs[ii] = NULL;
+		}
+	}
+
+	result.nsPerBar = bestNs / double(rows);
+	result.peakRssMB = peakRssMB();
+	return true;
+}
+
+void benchHeader(const char *kernel)
+{
+	printf("\n%s\n", kernel);
+	printf("%-16s %-18s %12s %12s %12s %12s %12s\n", "kernel", "variant", "bars", "ns/bar", "mxAllocs", "heapAllocs", "peakRSS(MB)");
+}
+
+void benchReport(const char *kernel, const char *variant, size_t rows, const benchResult &result)
+{
+	printf("%-16s %-18s %12zu %12.2f %12lld %12lld %12.1f\n", kernel, variant, rows, result.nsPerBar,
+		result.mxAllocs, result.heapAllocs, result.peakRssMB);
+	fflush(stdout);
+}
@@ -0,0 +1,63 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include "mex.h"
+#include <vector>
+
+// Native benchmark harness shared by the MEX kernel benchmarks
+//
+// Each kernel is linked in to its own executable against the mex.h shim, so the
+// harness simply calls 'mexFunction' with synthetic inputs and measures the call.
+
+// Command line options common to every benchmark
+typedef struct benchOptions
+{
+	double minBars;			// Smallest series length
+	double maxBars;			// Largest series length.  Sizes step by a factor of 10 from minBars
+	int reps;			// Repetitions per case.  The fastest is reported
+	unsigned seed;			// Seed for the synthetic data
+} benchOptions;
+
+// Synthetic signal patterns
+enum sigPattern { SIG_SPARSE, SIG_DENSE, SIG_PYRAMID, SIG_REVERSAL, SIG_NUM_PATTERNS };
+
+// Measurements of a single case
+typedef struct benchResult
+{
+	double nsPerBar;		// Wall time of the fastest repetition / bars
+	long long mxAllocs;		// mx heap allocations (mxCreate*, mxCalloc ...) of one call
+	long long heapAllocs;		// operator new allocations of one call
+	double peakRssMB;		// Peak resident set size of the process so far
+} benchResult;
+
+// Parse --min N --max N --reps N --seed N.  Returns false (after printing usage) on bad input
+bool parseBenchOptions(int argc, char *argv[], benchOptions &opts);
+
+// Series lengths from opts.minBars to opts.maxBars by decade
+std::vector<size_t> benchSizes(const benchOptions &opts);
+
+// Column major Open | High | Low | Close random walk on a 'minTick' grid
+void makeOHLC(size_t rows, unsigned seed, double minTick, std::vector<double> &ohlc);
+
+// Signal column following 'pattern'.  Signals are generated against the net position they create so that
+// the fractional reverse / flatten conventions are always valid
+void makeSignal(size_t rows, int pattern, unsigned seed, std::vector<double> &sig);
+const char *sigPatternName(int pattern);
+
+// Copy a column major block in to a new double mxArray
+mxArray *benchArray(const double *data, size_t rows, size_t cols);
+
+// Compact copies: int32 tick counts of tick aligned prices and int8 signals holding twice the signal.
+// The kernels read the int8 signal as doubled only when 'doubledSig' is given
+mxArray *benchTicksArray(const double *data, size_t rows, size_t cols, double minTick);
+mxArray *benchInt8Signal(const double *sig, size_t rows);
+
+// Time 'reps' calls of mexFunction.  Outputs are released between calls outside of the timed region.
+// Returns false if the kernel raised an error
+bool benchMex(int nlhs, int nrhs, const mxArray *prhs[], size_t rows, int reps, benchResult &result);
+
+// Tabular report
+void benchHeader(const char *kernel);
+void benchReport(const char *kernel, const char *variant, size_t rows, const benchResult &result);
+
+#endif // BENCHUTIL_H
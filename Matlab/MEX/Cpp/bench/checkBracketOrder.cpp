@@ -0,0 +1,499 @@
+// checkBracketOrder.cpp
+//
+// Check of the bracket order engine (bracketLedger.cpp) and its bracketOrder gateway against the rules stated in
+// bracketLedger.h.  For every signal pattern and a set of profit / stop / trailing stop distances this check
+//	- P&L's the gateway's barsOut and sigOut with plColumn and compares the fused 'pl' outputs bit for bit
+//	- rebuilds sigOut from the engine's exit ledger (each exit follows the original row of its barIndex)
+//	- walks the expanded rows through plStep and checks each exit reduces the position the P&L ledger holds
+//	  when it is executed, without flipping it, and is executed on a virtual bar flat at its price
+//	- checks each exit is priced inside the range of the bar it was taken on
+//	- runs a reference of the rules (gap through a level at the Open exits at the Open, otherwise the stop before
+//	  the target, a level exceeded rather than touched on the bar of entry, the trailing stop from the bars before
+//	  and the Open) and compares its exits with the engine's.  Gap and both-hit exits must occur
+//	- compares each bracket of one 'stats' sweep with plColumnStats of its own scalar run
+//
+// The engine closes line items in true FIFO order while plLedger keeps the baseline signed test of a long
+// reduction (the front line item absorbs the whole reduction).  Only the net position is shared, so a case
+// reducing several long line items is checked for the same net position and the same cash over the round trip
+// while the line items themselves differ.
+
+#include "mex.h"
+#include "mexShim.h"
+#include "benchUtil.h"
+#include "bracketLedger.h"
+#include "plLedger.h"
+#include "myMath.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+#define CHECK_SEEDS 6				// Seeds per pattern
+#define CHECK_BARS 3000
+#define CHECK_TICK 0.25
+#define CHECK_BIGPOINT 50.0
+#define CHECK_COST 2.5
+
+// Every bench pattern plus a mixed stream of adds, partial reductions and integer and fractional reversals
+#define SIG_MIXED SIG_NUM_PATTERNS
+
+// Profit, stop and trailing stop distances in ticks.  0 disables a leg.  The 1 tick bracket is reached at both
+// ends on most bars
+static const double s_brackets[][3] = {{8, 0, 0}, {0, 6, 0}, {0, 0, 5}, {8, 6, 0}, {12, 8, 5}, {4, 4, 3}, {1, 1, 0},
+	{0, 0, 0}};
+static const int s_numBrackets = sizeof(s_brackets) / sizeof(s_brackets[0]);
+
+// Exits of the reference by the rule that took them
+typedef struct ruleCounts
+{
+	long long gapExits;			// Exited at the Open through a level
+	long long bothHit;			// Reached the stop and the target on one bar and exited at the stop
+	long long stopExits;			// Exited at the stop (hard or trailing)
+	long long targetExits;			// Exited at the target
+} ruleCounts;
+
+// Reference line item
+typedef struct refItem
+{
+	int sigIndex;
+	int qty;
+	double target;				// +/-HUGE_VAL when disabled
+	double stop;				// Hard stop.  +/-HUGE_VAL when disabled
+	double best;				// Most favourable price known before the range of the bar being checked
+} refItem;
+
+// Mixed signal stream of several lots generated against the net position it creates
+static void makeMixedSignal(size_t rows, unsigned seed, vector<double> &sig)
+{
+	mt19937 gen(seed);
+	uniform_real_distribution<double> coin(0, 1);
+	uniform_int_distribution<int> lots(1, 3);
+
+	sig.assign(rows, 0);
+	int netPos = 0;
+
+	for (size_t ii = 0; ii < rows; ii++)
+	{
+		if (coin(gen) >= 0.2)
+			continue;
+
+		int side = (netPos > 0) - (netPos < 0);
+		int qty = lots(gen);
+		double pick = coin(gen);
+
+		if (netPos == 0)
+		{
+			side = (pick < 0.5) ? 1 : -1;
+			sig[ii] = side * qty;
+			netPos = side * qty;
+		}
+		else if (pick < 0.35 && abs(netPos) < 8)
+		{
+			sig[ii] = side * qty;
+			netPos += side * qty;
+		}
+		else if (pick < 0.6 && abs(netPos) > 1)
+		{
+			int reduce = 1 + (qty % (abs(netPos) - 1));
+			sig[ii] = -side * reduce;
+			netPos -= side * reduce;
+		}
+		else if (pick < 0.8)
+		{
+			sig[ii] = -side * (abs(netPos) + qty);
+			netPos = -side * qty;
+		}
+		else
+		{
+			sig[ii] = -side * (qty + 0.5);
+			netPos = -side * qty;
+		}
+	}
+}
+
+// Reference of the bracket rules over 'rows' bars.  Exits are folded as the engine folds them
+static void refExits(const vector<double> &ohlc, const vector<double> &sig, int rows, const double *ticks,
+	vector<profitEntry> &exits, ruleCounts &counts)
+{
+	const double *open = &ohlc[0];
+	const double *high = &ohlc[rows];
+	const double *low = &ohlc[2 * rows];
+	const double profitTgt = ticks[0] * CHECK_TICK;
+	const double stopTgt = ticks[1] * CHECK_TICK;
+	const double trailTgt = ticks[2] * CHECK_TICK;
+
+	vector<refItem> items;
+	int position = 0;
+	int first = 0;
+
+	exits.clear();
+	while (first < rows && abs(sig[first]) < 1)
+		first++;
+
+	for (int bar = first; bar < rows - 1; bar++)
+	{
+		// Signals as the P&L ledger takes them
+		if (sig[bar] != 0)
+		{
+			const bool additive = (position <= 0 && sig[bar] <= -1) || (position >= 0 && sig[bar] >= 1);
+			if (fraction(sig[bar]) && !additive)
+			{
+				items.clear();
+				position = 0;
+			}
+
+			int qty = int(sig[bar]);
+			while (qty != 0 && position != 0 && (qty > 0) != (position > 0))
+			{
+				// True FIFO: the oldest line item is reduced by at most its own quantity
+				int take = (abs(items.front().qty) < abs(qty)) ? -items.front().qty : qty;
+				items.front().qty += take;
+				position += take;
+				qty -= take;
+				if (items.front().qty == 0)
+					items.erase(items.begin());
+			}
+
+			if (qty != 0)
+			{
+				const double side = (qty > 0) ? 1 : -1;
+				const double price = open[bar + 1];
+				refItem item = {bar, qty, price + side * (profitTgt > 0 ? profitTgt : HUGE_VAL),
+					price - side * (stopTgt > 0 ? stopTgt : HUGE_VAL), price};
+				items.push_back(item);
+				position += qty;
+			}
+		}
+
+		// The bar the signal was executed on
+		const int bb = bar + 1;
+		for (size_t ii = 0; ii < items.size(); )
+		{
+			refItem &item = items[ii];
+			const bool isLong = (item.qty > 0);
+			const bool entryBar = (item.sigIndex == bar);
+			bool exited = false;
+			double price = 0;
+
+			// The tighter of the hard stop and the stop trailing the best price known so far
+			double stop = item.stop;
+			if (trailTgt > 0)
+				stop = isLong ? max(stop, item.best - trailTgt) : min(stop, item.best + trailTgt);
+
+			if (!entryBar && (isLong ? (open[bb] <= stop || open[bb] >= item.target)
+				: (open[bb] >= stop || open[bb] <= item.target)))
+			{
+				exited = true;
+				price = open[bb];
+				counts.gapExits++;
+			}
+			else
+			{
+				if (!entryBar)
+				{
+					item.best = isLong ? max(item.best, open[bb]) : min(item.best, open[bb]);
+					if (trailTgt > 0)
+						stop = isLong ? max(item.stop, item.best - trailTgt) : min(item.stop, item.best + trailTgt);
+				}
+
+				const bool stopHit = isLong ? (entryBar ? low[bb] < stop : low[bb] <= stop)
+					: (entryBar ? high[bb] > stop : high[bb] >= stop);
+				const bool targetHit = isLong ? (entryBar ? high[bb] > item.target : high[bb] >= item.target)
+					: (entryBar ? low[bb] < item.target : low[bb] <= item.target);
+
+				if (stopHit)
+				{
+					exited = true;
+					price = stop;
+					counts.stopExits++;
+					counts.bothHit += targetHit;
+				}
+				else if (targetHit)
+				{
+					exited = true;
+					price = item.target;
+					counts.targetExits++;
+				}
+			}
+
+			if (!exited)
+			{
+				item.best = isLong ? max(item.best, high[bb]) : min(item.best, low[bb]);
+				ii++;
+				continue;
+			}
+
+			// Same bar, same price exits are one virtual bar
+			if (!exits.empty() && exits.back().barIndex == bar && exits.back().profitPrice == price)
+				exits.back().qtyProfit -= item.qty;
+			else
+			{
+				profitEntry exit = {bar, -item.qty, price};
+				exits.push_back(exit);
+			}
+			position -= item.qty;
+			items.erase(items.begin() + ii);
+		}
+	}
+}
+
+// Both NaN or bit for bit equal
+static bool same(double a, double b)
+{
+	return (std::isnan(a) && std::isnan(b)) || a == b;
+}
+
+// Multi-line long reduction.  Long 1, long 2 more, sell 2, then flatten
+static bool checkLongReduction()
+{
+	const int rows = 9;
+	vector<double> ohlc(4 * rows);
+	const double opens[rows] = {100, 101, 102, 103, 104, 105, 106, 107, 108};
+	for (int ii = 0; ii < rows; ii++)
+	{
+		ohlc[ii] = opens[ii];
+		ohlc[rows + ii] = opens[ii] + 0.5;
+		ohlc[2 * rows + ii] = opens[ii] - 0.5;
+		ohlc[3 * rows + ii] = opens[ii] + 0.25;
+	}
+	const double sig[rows] = {1, 0, 2, 0, -2, 0, -1, 0, 0};
+
+	// Brackets too wide to be reached, so the signals alone move the position
+	vector<bracketState> brackets(1);
+	initBracket(brackets[0], 1000, 1000, 0);
+	double badSig = 0;
+
+	// Stop before the flatten so the open line items can be compared
+	const profitContext partCtx = createProfitContext(&ohlc[0], sig, 6, CHECK_TICK, 0);
+	if (findExits(partCtx, brackets, badSig) != 0)
+		return false;
+
+	plState st;
+	plInit(st, 1, 0);
+	for (int ii = 0; ii < 6; ii++)
+		plStep(st, ohlc[ii], ohlc[3 * rows + ii], sig[ii], badSig);
+
+	// The sell of 2 was executed on bar 5.  Engine: the bar 0 item closed and the bar 2 item reduced to 1.
+	// Ledger: the bar 0 item absorbs the whole sale (-1) and the bar 2 item keeps 2
+	const bracketState &br = brackets[0];
+	const bool engineFifo = (br.openLedger.size() == 1 && br.openLedger.front().open.sigIndex == 2
+		&& br.openLedger.front().open.qtyOpen == 1);
+	const bool ledgerSigned = (st.openLedger.lines.size() == 2 && st.openLedger.lines[0].quantity == -1
+		&& st.openLedger.lines[1].quantity == 2);
+	const bool sameNet = (br.openPosition == st.openPosition && st.openPosition == 1);
+
+	// Over the round trip the ledger books the cash of true FIFO
+	plInit(st, 1, 0);
+	for (int ii = 0; ii < rows; ii++)
+		plStep(st, ohlc[ii], ohlc[3 * rows + ii], sig[ii], badSig);
+	const double fifoCash = (opens[5] - opens[1]) + (opens[5] - opens[3]) + (opens[7] - opens[3]);
+	const bool sameCash = (st.runSum == fifoCash && st.openPosition == 0);
+
+	printf("checkBracketOrder: multi-line long reduction  engine FIFO item %s  ledger signed items %s  net position %s  "
+		"round trip cash %s  %s\n", engineFifo ? "yes" : "no", ledgerSigned ? "yes" : "no", sameNet ? "same" : "differs",
+		sameCash ? "same" : "differs", (engineFifo && ledgerSigned && sameNet && sameCash) ? "ok" : "FAILED");
+
+	return engineFifo && ledgerSigned && sameNet && sameCash;
+}
+
+int main()
+{
+	const int rows = CHECK_BARS;
+	int failures = 0;
+
+	mxArray *minTick = mxCreateDoubleScalar(CHECK_TICK);
+	mxArray *bigPoint = mxCreateDoubleScalar(CHECK_BIGPOINT);
+	mxArray *cost = mxCreateDoubleScalar(CHECK_COST);
+	mxArray *plCmd = mxCreateString("pl");
+	mxArray *statsOpt = mxCreateString("stats");
+
+	for (int pattern = 0; pattern <= SIG_MIXED; pattern++)
+	{
+		ruleCounts counts = {0, 0, 0, 0};
+		long long numExits = 0;
+		int plMismatch = 0, sigMismatch = 0, flipExits = 0, virtualMismatch = 0, rangeMismatch = 0;
+		int ruleMismatch = 0, statsMismatch = 0, errors = 0;
+
+		for (unsigned seed = 0; seed < CHECK_SEEDS; seed++)
+		{
+			vector<double> ohlc, sig;
+			makeOHLC(rows, 20130101 + seed, CHECK_TICK, ohlc);
+			if (pattern == SIG_MIXED)
+				makeMixedSignal(rows, seed, sig);
+			else
+				makeSignal(rows, pattern, seed, sig);
+
+			mxArray *bars = benchArray(&ohlc[0], rows, 4);
+			mxArray *sigIn = benchArray(&sig[0], rows, 1);
+			const profitContext ctx = createProfitContext(&ohlc[0], &sig[0], rows, CHECK_TICK, 0);
+
+			vector<double> tickVecs[3];
+			for (int leg = 0; leg < 3; leg++)
+				for (int bb = 0; bb < s_numBrackets; bb++)
+					tickVecs[leg].push_back(s_brackets[bb][leg]);
+
+			// Every bracket in one 'stats' sweep
+			mxArray *sweepTicks[3];
+			for (int leg = 0; leg < 3; leg++)
+				sweepTicks[leg] = benchArray(&tickVecs[leg][0], 1, s_numBrackets);
+			const mxArray *sweepIn[10] = {plCmd, bars, sigIn, minTick, sweepTicks[0], sweepTicks[1], sweepTicks[2],
+				bigPoint, cost, statsOpt};
+			mxArray *sweepOut[2] = {NULL, NULL};
+			try
+			{
+				mexFunction(1, sweepOut, 10, sweepIn);
+			}
+			catch (const mexShimError &err)
+			{
+				fprintf(stderr, "checkBracketOrder: %s\n", err.what());
+				errors++;
+				continue;
+			}
+
+			for (int bb = 0; bb < s_numBrackets; bb++)
+			{
+				const double *ticks = s_brackets[bb];
+
+				// Engine exits
+				vector<bracketState> brackets(1);
+				initBracket(brackets[0], ticks[0] * CHECK_TICK, ticks[1] * CHECK_TICK, ticks[2] * CHECK_TICK);
+				double badSig = 0;
+				if (findExits(ctx, brackets, badSig) != 0)
+				{
+					errors++;
+					continue;
+				}
+				const vector<profitEntry> &exits = brackets[0].exitLedger;
+				numExits += exits.size();
+
+				// Fused P&L of the scalar run
+				mxArray *tickArgs[3];
+				for (int leg = 0; leg < 3; leg++)
+					tickArgs[leg] = mxCreateDoubleScalar(ticks[leg]);
+				const mxArray *plIn[9] = {plCmd, bars, sigIn, minTick, tickArgs[0], tickArgs[1], tickArgs[2], bigPoint, cost};
+				mxArray *plOut[6] = {NULL, NULL, NULL, NULL, NULL, NULL};
+				try
+				{
+					mexFunction(6, plOut, 9, plIn);
+				}
+				catch (const mexShimError &err)
+				{
+					fprintf(stderr, "checkBracketOrder: %s\n", err.what());
+					errors++;
+					continue;
+				}
+
+				const int newRows = int(mxGetM(plOut[4]));
+				const double *barsOut = mxGetPr(plOut[4]);
+				const double *sigOut = mxGetPr(plOut[5]);
+				if (newRows != rows + int(exits.size()))
+				{
+					sigMismatch++;
+					continue;
+				}
+
+				// Fused P&L equals plColumn of barsOut and sigOut
+				vector<double> cash(newRows), openEQ(newRows), netLiq(newRows), returns(newRows);
+				plColumn(barsOut, barsOut + 3 * newRows, sigOut, newRows, CHECK_BIGPOINT, CHECK_COST,
+					&cash[0], &openEQ[0], &netLiq[0], &returns[0], badSig);
+				for (int ii = 0; ii < newRows; ii++)
+				{
+					plMismatch += !same(cash[ii], mxGetPr(plOut[0])[ii]) || !same(openEQ[ii], mxGetPr(plOut[1])[ii])
+						|| !same(netLiq[ii], mxGetPr(plOut[2])[ii]) || !same(returns[ii], mxGetPr(plOut[3])[ii]);
+				}
+
+				// sigOut rebuilt from the exit ledger.  isExit marks the expanded rows holding an exit
+				vector<bool> isExit(newRows, false);
+				vector<int> exitOf(newRows, -1);
+				size_t ee = 0;
+				int kk = 0;
+				for (int row = 0; row < rows; row++)
+				{
+					sigMismatch += (sigOut[kk] != sig[row]);
+					kk++;
+					for (; ee < exits.size() && exits[ee].barIndex == row; ee++, kk++)
+					{
+						sigMismatch += (sigOut[kk] != exits[ee].qtyProfit);
+						isExit[kk] = true;
+						exitOf[kk] = int(ee);
+					}
+				}
+
+				// Each exit reduces the ledger's position without flipping it, on a virtual bar flat at its price
+				plState st;
+				plInit(st, CHECK_BIGPOINT, CHECK_COST);
+				for (int ii = 0; ii < newRows; ii++)
+				{
+					if (ii > 0 && isExit[ii - 1])
+					{
+						const profitEntry &exit = exits[exitOf[ii - 1]];
+						const int pos = st.openPosition;
+						flipExits += (pos == 0 || (exit.qtyProfit > 0) == (pos > 0) || abs(exit.qtyProfit) > abs(pos));
+						for (int col = 0; col < 4; col++)
+							virtualMismatch += (barsOut[ii + col * newRows] != exit.profitPrice);
+					}
+					plStep(st, barsOut[ii], barsOut[ii + 3 * newRows], sigOut[ii], badSig);
+				}
+
+				// Exits are priced inside the bar they were taken on
+				for (size_t xx = 0; xx < exits.size(); xx++)
+				{
+					const int bar = exits[xx].barIndex + 1;
+					rangeMismatch += (exits[xx].profitPrice < ohlc[2 * rows + bar] || exits[xx].profitPrice > ohlc[rows + bar]);
+				}
+
+				// The rules
+				vector<profitEntry> expected;
+				refExits(ohlc, sig, rows, ticks, expected, counts);
+				if (expected.size() != exits.size())
+					ruleMismatch++;
+				else
+				{
+					for (size_t xx = 0; xx < exits.size(); xx++)
+						ruleMismatch += (expected[xx].barIndex != exits[xx].barIndex || expected[xx].qtyProfit != exits[xx].qtyProfit
+							|| expected[xx].profitPrice != exits[xx].profitPrice);
+				}
+
+				// The sweep's bracket equals the summary of its own scalar run
+				plStats stats;
+				plColumnStats(barsOut, barsOut + 3 * newRows, sigOut, newRows, CHECK_BIGPOINT, CHECK_COST, stats, badSig);
+				const mxArray *sweepStats = sweepOut[0];
+				statsMismatch += !same(mxGetPr(mxGetField(sweepStats, 0, "sharpe"))[bb], plSharpe(stats))
+					|| !same(mxGetPr(mxGetField(sweepStats, 0, "maxDD"))[bb], stats.maxDD)
+					|| !same(mxGetPr(mxGetField(sweepStats, 0, "profitFactor"))[bb], plProfitFactor(stats))
+					|| !same(mxGetPr(mxGetField(sweepStats, 0, "numTrades"))[bb], stats.numTrades)
+					|| !same(mxGetPr(mxGetField(sweepStats, 0, "winRate"))[bb], plWinRate(stats));
+
+				for (int oo = 0; oo < 6; oo++)
+					mxDestroyArray(plOut[oo]);
+				for (int leg = 0; leg < 3; leg++)
+					mxDestroyArray(tickArgs[leg]);
+			}
+
+			mxDestroyArray(sweepOut[0]);
+			for (int leg = 0; leg < 3; leg++)
+				mxDestroyArray(sweepTicks[leg]);
+			mxDestroyArray(bars);
+			mxDestroyArray(sigIn);
+		}
+
+		const bool pass = (errors == 0 && plMismatch == 0 && sigMismatch == 0 && flipExits == 0 && virtualMismatch == 0
+			&& rangeMismatch == 0 && ruleMismatch == 0 && statsMismatch == 0 && counts.gapExits > 0 && counts.bothHit > 0);
+		failures += !pass;
+
+		printf("checkBracketOrder: %-10s exits %-6lld (gap %lld, stop %lld of which both hit %lld, target %lld)  "
+			"P&L rows differ %d  sigOut %d  flipping exits %d  virtual bars %d  outside bar %d  rules %d  stats %d  %s\n",
+			(pattern == SIG_MIXED) ? "mixed" : sigPatternName(pattern), numExits, counts.gapExits, counts.stopExits,
+			counts.bothHit, counts.targetExits, plMismatch, sigMismatch, flipExits, virtualMismatch, rangeMismatch,
+			ruleMismatch, statsMismatch, pass ? "ok" : "FAILED");
+	}
+
+	failures += !checkLongReduction();
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,337 @@
+// checkPlLedger.cpp
+//
+// Regression check of the plLedger open equity aggregates against the original calcProfitLoss ledger.
+// The open equity of a bar used to be marked by walking every open line item.  plLedger now marks it from
+// the running netQty / netCost of the open book.  For every signal pattern and tick size this check
+//	- walks the open line items after every plStep and compares the walk with bookOpenEQ, netQty and netCost
+//	- runs the original deque walking calcProfitLoss kernel (legacyColumn) and compares each output with plColumn
+// Values must agree to CHECK_TOLERANCE of the larger magnitude, which allows for the different order of rounding
+// on non binary tick sizes.  On the 0.25 tick grid the values are exact.
+
+#include "mex.h"
+#include "benchUtil.h"
+#include "plLedger.h"
+#include "myMath.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+#define CHECK_TOLERANCE 1e-9			// Relative to max(1, |reference|)
+#define CHECK_SEEDS 8				// Seeds per pattern and tick size
+#define CHECK_BARS 5000
+
+// Every bench pattern plus a mixed stream of partial reductions, integer reversals and fractional +/-X.5
+// reversals of several lots
+#define SIG_MIXED SIG_NUM_PATTERNS
+
+static const double s_tickSizes[] = {0.25, 0.01};
+
+// Mixed signal stream generated against the net position it creates
+static void makeMixedSignal(size_t rows, unsigned seed, vector<double> &sig)
+{
+	mt19937 gen(seed);
+	uniform_real_distribution<double> coin(0, 1);
+	uniform_int_distribution<int> lots(1, 3);
+
+	sig.assign(rows, 0);
+	int netPos = 0;
+
+	for (size_t ii = 0; ii < rows; ii++)
+	{
+		if (coin(gen) >= 0.2)
+			continue;
+
+		int side = (netPos > 0) - (netPos < 0);
+		int qty = lots(gen);
+		double pick = coin(gen);
+
+		if (netPos == 0)
+		{
+			// Initiate
+			side = (pick < 0.5) ? 1 : -1;
+			sig[ii] = side * qty;
+			netPos = side * qty;
+		}
+		else if (pick < 0.2 && abs(netPos) < 8)
+		{
+			// Add to the position
+			sig[ii] = side * qty;
+			netPos += side * qty;
+		}
+		else if (pick < 0.3 && abs(netPos) < 8)
+		{
+			// Additive fractional signal.  The reverse instruction is ignored and the integer portion is added
+			sig[ii] = side * (qty + 0.5);
+			netPos += side * qty;
+		}
+		else if (pick < 0.5 && abs(netPos) > 1)
+		{
+			// Partial reduction
+			int reduce = 1 + (qty % (abs(netPos) - 1));
+			sig[ii] = -side * reduce;
+			netPos -= side * reduce;
+		}
+		else if (pick < 0.65)
+		{
+			// Integer reversal.  The remainder opens on the other side
+			sig[ii] = -side * (abs(netPos) + qty);
+			netPos = -side * qty;
+		}
+		else if (pick < 0.85)
+		{
+			// Fractional reversal.  Liquidate, then open X lots on the other side
+			sig[ii] = -side * (qty + 0.5);
+			netPos = -side * qty;
+		}
+		else
+		{
+			// Flatten
+			sig[ii] = -side * 0.5;
+			netPos = 0;
+		}
+	}
+}
+
+static bool knownAdvSig(double advSig)
+{
+	return abs(advSig - int(advSig)) == 0.5;
+}
+
+// The calcProfitLoss ledger as it was before the open book aggregates, reduced to a single column.
+// Open equity is marked by walking every open line item.
+// Returns 1 on an unknown advanced signal
+static int legacyColumn(const double *dataInPtr, const double *sigInPtr, int rowsData, int shiftClose, double bigPoint, double cost,
+						double *cashIdx, double *openEQIdx, double *netLiqIdx, double *returnsIdx)
+{
+	int	sigIdx;
+	bool anyTrades = false;
+
+	for (int mm = 0; mm < rowsData; mm++)
+	{
+		cashIdx[mm] = 0;
+		openEQIdx[mm] = 0;
+		netLiqIdx[mm] = 0;
+		returnsIdx[mm] = 0;
+	}
+
+	for (sigIdx = 0; sigIdx < rowsData; sigIdx++)
+	{
+		if (abs(sigInPtr[sigIdx]) >= 1)
+		{
+			anyTrades = true;
+			break;
+		}
+	}
+
+	if (!anyTrades || sigIdx >= rowsData)
+		return 0;
+
+	deque<tradeEntry> openLedger;
+	openLedger.push_back(createLineEntry(sigIdx, int(sigInPtr[sigIdx]), dataInPtr[sigIdx+1]));
+	int openPosition = int(sigInPtr[sigIdx]);
+
+	for (int ii = sigIdx+1; ii < rowsData-1; ii++)
+	{
+		if (sigInPtr[ii] != 0)
+		{
+			if (fraction(sigInPtr[ii]))
+			{
+				if (!knownAdvSig(sigInPtr[ii]))
+					return 1;
+
+				if (!((openPosition <= 0 && sigInPtr[ii] <= -1) || (openPosition >= 0 && sigInPtr[ii] >= 1)))
+				{
+					// Reverse instruction.  Liquidate any open position
+					while (!openLedger.empty())
+					{
+						cashIdx[ii+1] = cashIdx[ii+1] + ((dataInPtr[ii+1] - openLedger.front().price) * openLedger.front().quantity * bigPoint) -
+							(abs(openLedger.front().quantity)* cost);
+						openLedger.pop_front();
+					}
+					openPosition = 0;
+				}
+			}
+
+			if ((openPosition <= 0 && sigInPtr[ii] <= -1) || (openPosition >= 0 && sigInPtr[ii] >= 1))
+			{
+				// Additive
+				openLedger.push_back(createLineEntry(ii, int(sigInPtr[ii]), dataInPtr[ii+1]));
+				openPosition = openPosition + int(sigInPtr[ii]);
+			}
+			else if (int(abs(sigInPtr[ii])) >= abs(openPosition))
+			{
+				// Reverse or liquidate
+				while (!openLedger.empty())
+				{
+					cashIdx[ii+1] = cashIdx[ii+1] + ((dataInPtr[ii+1] - openLedger.front().price) * openLedger.front().quantity * bigPoint) -
+						(abs(openLedger.front().quantity)* cost);
+					openLedger.pop_front();
+				}
+
+				openPosition = int(sigInPtr[ii]) + openPosition;
+				if (openPosition != 0)
+				{
+					openLedger.push_back(createLineEntry(ii,openPosition,dataInPtr[ii+1]));
+				}
+			}
+			else
+			{
+				// Partial liquidation
+				int needQty = int(sigInPtr[ii]);
+				while (needQty !=0)
+				{
+					if (abs(openLedger.front().quantity) > needQty)
+					{
+						cashIdx[ii+1] = cashIdx[ii+1] + ((dataInPtr[ii+1] - openLedger.front().price) * -needQty * bigPoint) -
+							(abs(needQty) * cost);
+						openLedger.front().quantity = openLedger.front().quantity + needQty;
+						needQty = 0;
+					}
+					else
+					{
+						cashIdx[ii+1] = cashIdx[ii+1] + ((dataInPtr[ii+1] - openLedger.front().price) * -openLedger.front().quantity * bigPoint) -
+							(abs(openLedger.front().quantity) * cost);
+						needQty = needQty + openLedger.front().quantity;
+						openLedger.pop_front();
+					}
+				}
+				openPosition = int(openPosition + sigInPtr[ii]);
+			}
+		}
+
+		// Mark every open line item
+		if (openPosition != 0)
+		{
+			for (size_t jj = 0; jj < openLedger.size(); jj++)
+			{
+				openEQIdx[ii+1] = openEQIdx[ii+1] + ((dataInPtr[ii+1+shiftClose] - openLedger[jj].price) * openLedger[jj].quantity * bigPoint);
+			}
+		}
+	}
+
+	for (int ll = 1; ll < rowsData - 1; ll++)
+	{
+		if (openEQIdx[ll] != cashIdx[ll+1] && openEQIdx[ll+1] == 0 && cashIdx[ll+1] > 0)
+		{
+			openEQIdx[ll] = cashIdx[ll+1];
+		}
+	}
+
+	double runSum = 0;
+	for (int kk=0; kk < rowsData; kk++)
+	{
+		runSum = runSum + cashIdx[kk];
+		netLiqIdx[kk] = runSum + openEQIdx[kk];
+		if (kk>0)
+		{
+			returnsIdx[kk] = netLiqIdx[kk] - netLiqIdx[kk-1];
+		}
+	}
+
+	return 0;
+}
+
+// Largest difference relative to max(1, |reference|)
+static double relDiff(double value, double reference)
+{
+	return fabs(value - reference) / max(1.0, fabs(reference));
+}
+
+// Walk the open line items of every bar and compare the walk with the book aggregates.
+// Returns the largest relative difference
+static double checkAggregates(const double *openPtr, const double *closePtr, const double *sigPtr, int rows, double bigPoint, double cost)
+{
+	plState st;
+	plInit(st, bigPoint, cost);
+	double worst = 0;
+
+	for (int ii = 0; ii < rows; ii++)
+	{
+		double badSig = 0;
+		if (plStep(st, openPtr[ii], closePtr[ii], sigPtr[ii], badSig) != 0)
+			return HUGE_VAL;
+
+		int walkQty = 0;
+		double walkCost = 0;
+		double walkEQ = 0;
+		for (size_t jj = 0; jj < st.openLedger.lines.size(); jj++)
+		{
+			const tradeEntry &line = st.openLedger.lines[jj];
+			walkQty = walkQty + line.quantity;
+			walkCost = walkCost + (line.quantity * line.price);
+			walkEQ = walkEQ + ((closePtr[ii] - line.price) * line.quantity * bigPoint);
+		}
+
+		if (walkQty != st.openLedger.netQty || walkQty != st.openPosition)
+			return HUGE_VAL;
+
+		worst = max(worst, relDiff(st.openLedger.netCost, walkCost));
+		worst = max(worst, relDiff(bookOpenEQ(st.openLedger, closePtr[ii], bigPoint), walkEQ));
+	}
+
+	return worst;
+}
+
+int main()
+{
+	const int rows = CHECK_BARS;
+	const double bigPoint = 50;
+	const double cost = 2.5;
+	int failures = 0;
+
+	vector<double> ohlc, sig;
+	vector<double> outNew(rows * 4), outOld(rows * 4);
+
+	for (size_t tt = 0; tt < sizeof(s_tickSizes) / sizeof(s_tickSizes[0]); tt++)
+	{
+		for (int pattern = 0; pattern <= SIG_MIXED; pattern++)
+		{
+			double worstBook = 0;
+			double worstColumn = 0;
+			int exact = 0;
+
+			for (unsigned seed = 0; seed < CHECK_SEEDS; seed++)
+			{
+				makeOHLC(rows, 20130101 + seed, s_tickSizes[tt], ohlc);
+				if (pattern == SIG_MIXED)
+					makeMixedSignal(rows, 20130101 + seed, sig);
+				else
+					makeSignal(rows, pattern, 20130101 + seed, sig);
+
+				const double *openPtr = &ohlc[0];
+				const double *closePtr = &ohlc[rows * 3];
+
+				worstBook = max(worstBook, checkAggregates(openPtr, closePtr, &sig[0], rows, bigPoint, cost));
+
+				double badSig = 0;
+				if (plColumn(openPtr, closePtr, &sig[0], rows, bigPoint, cost,
+					&outNew[0], &outNew[rows], &outNew[rows * 2], &outNew[rows * 3], badSig) != 0 ||
+					legacyColumn(&ohlc[0], &sig[0], rows, rows * 3, bigPoint, cost,
+					&outOld[0], &outOld[rows], &outOld[rows * 2], &outOld[rows * 3]) != 0)
+				{
+					worstColumn = HUGE_VAL;
+					continue;
+				}
+
+				for (int ii = 0; ii < rows * 4; ii++)
+					worstColumn = max(worstColumn, relDiff(outNew[ii], outOld[ii]));
+				exact += (memcmp(&outNew[0], &outOld[0], outNew.size() * sizeof(double)) == 0);
+			}
+
+			bool pass = (worstBook <= CHECK_TOLERANCE && worstColumn <= CHECK_TOLERANCE);
+			failures += !pass;
+
+			printf("checkPlLedger: tick %-5g %-10s book %.3g  columns %.3g (%d of %d bit-identical)  %s\n",
+				s_tickSizes[tt], pattern == SIG_MIXED ? "mixed" : sigPatternName(pattern),
+				worstBook, worstColumn, exact, CHECK_SEEDS, pass ? "ok" : "FAILED");
+		}
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+// checkRelStrIdx.cpp
+//
+// Regression check of the detrend folded in to relStrIdx against the path rsiSTA and rsiSIG used before it.
+// With a simple average (type 0) they used to subtract movAvg_mex(price,M,M,0), which is filter(ones(M,1)/M,1,price),
+// and pass the detrended copy to relStrIdx.  They now pass M to relStrIdx, which keeps the average as a running sum
+// within its own pass (rsiPanel).  For each lookback and detrend this check
+//	- runs the old path: price less its filter average, then rsiColumn
+//	- runs rsiPanel of the raw prices with the detrend
+//	- compares the two column by column, including the leading NaN rows
+//	- counts the bars on which the two fall on different sides of the rsiSIG thresholds
+// The running sum rounds differently from the filter sum, so values agree to CHECK_TOLERANCE (RSI is 0 - 100)
+// rather than bit for bit.  A threshold side that differs would change a signal or state and fails the check.
+
+#include "mex.h"
+#include "benchUtil.h"
+#include "rsiCalc.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+#define CHECK_TOLERANCE 1e-9			// Absolute, on the 0 - 100 RSI scale
+#define CHECK_SEEDS 8
+#define CHECK_BARS 5000
+
+static const int s_lookbacks[] = {2, 14, 30};
+static const double s_thresholds[] = {20, 30, 50, 70, 80};
+
+// movAvg(price,M,M,0) as filter(ones(M,1)/M,1,price).  The leading partial window averages over the full length
+static void filterAverage(const double *price, int rows, int M, vector<double> &ma)
+{
+	const double weight = 1.0 / M;
+
+	ma.assign(rows, 0);
+	for (int ii = 0; ii < rows; ii++)
+	{
+		for (int kk = 0; kk < M && kk <= ii; kk++)
+		{
+			ma[ii] = ma[ii] + weight * price[ii - kk];
+		}
+	}
+}
+
+// Side of a threshold: -1 below, 0 on, 1 above.  NaN has no side
+static int side(double value, double level)
+{
+	return (value > level) - (value < level);
+}
+
+int main()
+{
+	const int rows = CHECK_BARS;
+	int failures = 0;
+
+	vector<double> ohlc, ma, detrended(rows), rsiOld(rows), rsiNew(rows);
+
+	for (size_t nn = 0; nn < sizeof(s_lookbacks) / sizeof(s_lookbacks[0]); nn++)
+	{
+		const int N = s_lookbacks[nn];
+
+		// As rsiSTA / rsiSIG: a short average, the 15 * N default and one cut to a third of the bars
+		const int detrends[] = {10, 15 * N, int(floor(rows / 3.0 + 0.5))};
+
+		for (size_t mm = 0; mm < sizeof(detrends) / sizeof(detrends[0]); mm++)
+		{
+			const int M = detrends[mm];
+			double worst = 0;
+			int nanMismatch = 0;
+			int sideMismatch = 0;
+
+			for (unsigned seed = 0; seed < CHECK_SEEDS; seed++)
+			{
+				makeOHLC(rows, 20130101 + seed, 0.25, ohlc);
+				const double *closePtr = &ohlc[rows * 3];
+
+				// Old path
+				filterAverage(closePtr, rows, M, ma);
+				for (int ii = 0; ii < rows; ii++)
+				{
+					detrended[ii] = closePtr[ii] - ma[ii];
+				}
+				rsiColumn(&detrended[0], rows, N, &rsiOld[0]);
+
+				// Folded detrend
+				rsiPanel(closePtr, rows, 1, &N, &M, 1, &rsiNew[0]);
+
+				for (int ii = 0; ii < rows; ii++)
+				{
+					if (std::isnan(rsiOld[ii]) || std::isnan(rsiNew[ii]))
+					{
+						nanMismatch += (std::isnan(rsiOld[ii]) != std::isnan(rsiNew[ii]));
+						continue;
+					}
+
+					worst = max(worst, fabs(rsiNew[ii] - rsiOld[ii]));
+					for (size_t tt = 0; tt < sizeof(s_thresholds) / sizeof(s_thresholds[0]); tt++)
+					{
+						sideMismatch += (side(rsiNew[ii], s_thresholds[tt]) != side(rsiOld[ii], s_thresholds[tt]));
+					}
+				}
+			}
+
+			bool pass = (worst <= CHECK_TOLERANCE && nanMismatch == 0 && sideMismatch == 0);
+			failures += !pass;
+
+			printf("checkRelStrIdx: N %-3d M %-5d largest difference %.3g  NaN rows differ %d  threshold sides differ %d  %s\n",
+				N, M, worst, nanMismatch, sideMismatch, pass ? "ok" : "FAILED");
+		}
+	}
+
+	return failures == 0 ? 0 : 1;
+}
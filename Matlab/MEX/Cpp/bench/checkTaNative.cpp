@@ -0,0 +1,376 @@
+// checkTaNative.cpp
+//
+// Check of the native taInvoke backend (taNative.cpp) that runs without TA-Lib.
+// Every native function is run on the scalar and, when the processor supports it, the AVX2 path and
+//	- the number of values written must be rows - lookback, TA-Lib's convention
+//	- the scalar values are compared with a direct evaluation of each function's definition (every window summed
+//	  afresh, so none of the running sums of the native loops are shared)
+//	- the AVX2 values are compared with the scalar values
+// Differences are measured as in taNative.h: |a - b| / (rows x S), with STDDEV and the bands compared as variances
+// against S^2.  Both comparisons must be within TA_NATIVE_TOLERANCE.  MAX and MIN must equal the definition bit for
+// bit, and ATR, WILLR, MAX and MIN must be bit-identical between the two paths.
+//
+// This does not compare with TA-Lib itself.  benchTaInvoke does that when TA-Lib is found.
+
+#include "taNative.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+#define CHECK_SEEDS 4
+#define CHECK_BARS 5000
+#define CHECK_UNWRITTEN -12345.0		// Marks the output rows a function must not write
+
+static const int s_periods[] = {2, 5, 14, 30, 200};
+
+// Series of one case
+typedef struct checkData
+{
+	vector<double> high, low, close;
+	double scale;				// S: the largest |price|
+} checkData;
+
+// Results of one function over every case
+typedef struct checkResult
+{
+	const char *name;
+	double scalarError;			// Largest scalar vs definition difference, as a multiple of rows x S
+	double avx2Error;			// Largest AVX2 vs scalar difference, as a multiple of rows x S
+	bool countsOk;				// Every call wrote rows - lookback values
+	bool exactOk;				// Every value that must be bit-identical was
+} checkResult;
+
+// High | Low | Close random walk on a 'minTick' grid about 'level'.  Half of the bars do not move so short windows
+// are often flat, which takes STDDEV to TA-Lib's variance floor
+static void makeData(int rows, unsigned seed, double level, double minTick, checkData &data)
+{
+	mt19937 gen(seed);
+	uniform_int_distribution<int> step(-4, 4);
+	uniform_int_distribution<int> range(0, 6);
+	uniform_real_distribution<double> coin(0, 1);
+
+	data.high.resize(rows);
+	data.low.resize(rows);
+	data.close.resize(rows);
+
+	double ticks = level / minTick;
+	for (int ii = 0; ii < rows; ii++)
+	{
+		if (coin(gen) < 0.5)
+			ticks = ticks + step(gen);
+		data.close[ii] = ticks * minTick;
+		data.high[ii] = (ticks + range(gen)) * minTick;
+		data.low[ii] = (ticks - range(gen)) * minTick;
+	}
+
+	data.scale = *max_element(data.high.begin(), data.high.end());
+}
+
+// Definitions evaluated directly from the window ending at row 'ii'
+static double defSma(const double *x, int ii, int period)
+{
+	double sum = 0;
+	for (int jj = ii - period + 1; jj <= ii; jj++)
+		sum = sum + x[jj];
+	return sum / period;
+}
+
+static double defWma(const double *x, int ii, int period)
+{
+	double sum = 0;
+	for (int jj = 0; jj < period; jj++)
+		sum = sum + (period - jj) * x[ii - jj];
+	return sum / (period * (period + 1) / 2.0);
+}
+
+// Population variance about the mean of the window
+static double defVariance(const double *x, int ii, int period)
+{
+	const double mean = defSma(x, ii, period);
+	double sum = 0;
+	for (int jj = ii - period + 1; jj <= ii; jj++)
+		sum = sum + (x[jj] - mean) * (x[jj] - mean);
+	return sum / period;
+}
+
+static double defTrueRange(const checkData &data, int ii)
+{
+	return max(data.high[ii] - data.low[ii],
+		max(fabs(data.high[ii] - data.close[ii - 1]), fabs(data.low[ii] - data.close[ii - 1])));
+}
+
+static double defExtreme(const double *x, int ii, int period, bool isMax)
+{
+	double extreme = x[ii];
+	for (int jj = ii - period + 1; jj <= ii; jj++)
+		extreme = isMax ? max(extreme, x[jj]) : min(extreme, x[jj]);
+	return extreme;
+}
+
+// Exponential average seeded with the SMA of the first period, as TA-Lib's default
+static void defEma(const double *x, int rows, int period, vector<double> &out)
+{
+	const double k = 2.0 / (period + 1);
+	out.assign(rows - period + 1, 0);
+	out[0] = defSma(x, period - 1, period);
+	for (int ii = period; ii < rows; ii++)
+		out[ii - period + 1] = k * x[ii] + (1 - k) * out[ii - period];
+}
+
+// Average true range: the mean of the first 'period' true ranges, then Wilder's smoothing
+static void defAtr(const checkData &data, int rows, int period, vector<double> &out)
+{
+	if (period == 1)
+	{
+		out.assign(rows - 1, 0);
+		for (int ii = 1; ii < rows; ii++)
+			out[ii - 1] = defTrueRange(data, ii);
+		return;
+	}
+
+	out.assign(rows - period, 0);
+	double sum = 0;
+	for (int ii = 1; ii <= period; ii++)
+		sum = sum + defTrueRange(data, ii);
+	out[0] = sum / period;
+	for (int ii = period + 1; ii < rows; ii++)
+		out[ii - period] = (out[ii - period - 1] * (period - 1) + defTrueRange(data, ii)) / period;
+}
+
+// Difference of two values as a multiple of rows x scale
+static double scaledDiff(double a, double b, int rows, double scale)
+{
+	return fabs(a - b) / (rows * scale);
+}
+
+// Difference of two variances.  A variance within the tolerance of TA-Lib's floor may be 0 on one side only
+static double varianceDiff(double a, double b, int rows, double scale)
+{
+	const double floorBand = 1e-8 + TA_NATIVE_TOLERANCE * rows * scale * scale;
+	if ((a == 0 && b < floorBand) || (b == 0 && a < floorBand))
+		return 0;
+	return fabs(a - b) / (rows * scale * scale);
+}
+
+// The values written to 'out' (sized rows + 1 and filled with CHECK_UNWRITTEN) must be exactly 'numOut'
+static bool writtenCount(const vector<double> &out, int numOut)
+{
+	for (int ii = 0; ii < numOut; ii++)
+	{
+		if (out[ii] == CHECK_UNWRITTEN || std::isnan(out[ii]))
+			return false;
+	}
+	return out[numOut] == CHECK_UNWRITTEN;
+}
+
+static void fresh(vector<double> &out, int rows)
+{
+	out.assign(rows + 1, CHECK_UNWRITTEN);
+}
+
+// Single output function of one series on one path
+typedef int (*realFunction)(const double *inReal, int rows, int period, int path, double *out);
+
+static void runReal(realFunction fn, const double *x, int rows, int period, int path, vector<double> &out)
+{
+	fresh(out, rows);
+	fn(x, rows, period, path, &out[0]);
+}
+
+int main()
+{
+	const int rows = CHECK_BARS;
+	const bool hasAvx2 = taNativeHasAvx2();
+	const int paths[] = {TA_NATIVE_SCALAR, TA_NATIVE_AVX2};
+	const int numPaths = hasAvx2 ? 2 : 1;
+
+	enum { SMA, EMA, WMA, STDDEV, BBANDS, ATR, WILLR, MAX, MIN, NUM_FUNCTIONS };
+	checkResult results[NUM_FUNCTIONS] = {
+		{"sma", 0, 0, true, true}, {"ema", 0, 0, true, true}, {"wma", 0, 0, true, true},
+		{"stddev", 0, 0, true, true}, {"bbands", 0, 0, true, true}, {"atr", 0, 0, true, true},
+		{"willr", 0, 0, true, true}, {"max", 0, 0, true, true}, {"min", 0, 0, true, true}};
+
+	checkData data;
+	vector<double> out[2], mid[2], low[2], def;
+
+	for (unsigned seed = 0; seed < CHECK_SEEDS; seed++)
+	{
+		// Prices near 100 on a 0.25 tick and near 100000 on a 0.01 tick, where the variance sums cancel heavily
+		const bool large = (seed % 2 == 1);
+		makeData(rows, 20130101 + seed, large ? 100000 : 100, large ? 0.01 : 0.25, data);
+		const double *x = &data.close[0];
+		const double S = data.scale;
+
+		for (size_t pp = 0; pp < sizeof(s_periods) / sizeof(s_periods[0]); pp++)
+		{
+			const int period = s_periods[pp];
+			const int numOut = rows - period + 1;
+
+			// SMA, EMA, WMA, MAX and MIN
+			realFunction realFns[] = {taNativeSma, taNativeEma, taNativeWma, taNativeMax, taNativeMin};
+			const int realIds[] = {SMA, EMA, WMA, MAX, MIN};
+			for (int ff = 0; ff < 5; ff++)
+			{
+				checkResult &res = results[realIds[ff]];
+				if (realIds[ff] == EMA)
+					defEma(x, rows, period, def);
+
+				for (int pa = 0; pa < numPaths; pa++)
+				{
+					runReal(realFns[ff], x, rows, period, paths[pa], out[pa]);
+					res.countsOk = res.countsOk && writtenCount(out[pa], numOut);
+				}
+
+				for (int ii = 0; ii < numOut; ii++)
+				{
+					const int row = ii + period - 1;
+					double value;
+					switch (realIds[ff])
+					{
+						case SMA:	value = defSma(x, row, period);			break;
+						case EMA:	value = def[ii];				break;
+						case WMA:	value = defWma(x, row, period);			break;
+						case MAX:	value = defExtreme(x, row, period, true);	break;
+						default:	value = defExtreme(x, row, period, false);	break;
+					}
+
+					res.scalarError = max(res.scalarError, scaledDiff(out[0][ii], value, rows, S));
+					if (realIds[ff] == MAX || realIds[ff] == MIN)
+						res.exactOk = res.exactOk && (out[0][ii] == value);
+					if (numPaths > 1)
+						res.avx2Error = max(res.avx2Error, scaledDiff(out[1][ii], out[0][ii], rows, S));
+				}
+
+				if (numPaths > 1 && (realIds[ff] == MAX || realIds[ff] == MIN))
+					res.exactOk = res.exactOk && (memcmp(&out[0][0], &out[1][0], numOut * sizeof(double)) == 0);
+			}
+
+			// STDDEV x 2, compared as variances
+			for (int pa = 0; pa < numPaths; pa++)
+			{
+				fresh(out[pa], rows);
+				taNativeStdDev(x, rows, period, 2.0, paths[pa], &out[pa][0]);
+				results[STDDEV].countsOk = results[STDDEV].countsOk && writtenCount(out[pa], numOut);
+			}
+			for (int ii = 0; ii < numOut; ii++)
+			{
+				const double var0 = (out[0][ii] / 2.0) * (out[0][ii] / 2.0);
+				results[STDDEV].scalarError = max(results[STDDEV].scalarError,
+					varianceDiff(var0, defVariance(x, ii + period - 1, period), rows, S));
+				if (numPaths > 1)
+					results[STDDEV].avx2Error = max(results[STDDEV].avx2Error,
+						varianceDiff((out[1][ii] / 2.0) * (out[1][ii] / 2.0), var0, rows, S));
+			}
+
+			// BBANDS of each middle band type.  The middle is compared as a value, the bands as variances
+			for (int typeMA = 0; typeMA <= 2; typeMA++)
+			{
+				const double upMult = 2.0;
+				const double dnMult = 1.5;
+				if (typeMA == 1)
+					defEma(x, rows, period, def);
+
+				for (int pa = 0; pa < numPaths; pa++)
+				{
+					fresh(out[pa], rows);
+					fresh(mid[pa], rows);
+					fresh(low[pa], rows);
+					taNativeBbands(x, rows, period, upMult, dnMult, typeMA, paths[pa], &out[pa][0], &mid[pa][0], &low[pa][0]);
+					results[BBANDS].countsOk = results[BBANDS].countsOk && writtenCount(out[pa], numOut) &&
+						writtenCount(mid[pa], numOut) && writtenCount(low[pa], numOut);
+				}
+
+				for (int ii = 0; ii < numOut; ii++)
+				{
+					const int row = ii + period - 1;
+					const double middle = (typeMA == 0) ? defSma(x, row, period) : (typeMA == 1) ? def[ii] : defWma(x, row, period);
+					const double variance = defVariance(x, row, period);
+
+					double bandVar[2][2];
+					for (int pa = 0; pa < numPaths; pa++)
+					{
+						bandVar[pa][0] = ((out[pa][ii] - mid[pa][ii]) / upMult) * ((out[pa][ii] - mid[pa][ii]) / upMult);
+						bandVar[pa][1] = ((mid[pa][ii] - low[pa][ii]) / dnMult) * ((mid[pa][ii] - low[pa][ii]) / dnMult);
+					}
+
+					double &scalarError = results[BBANDS].scalarError;
+					scalarError = max(scalarError, scaledDiff(mid[0][ii], middle, rows, S));
+					scalarError = max(scalarError, varianceDiff(bandVar[0][0], variance, rows, S));
+					scalarError = max(scalarError, varianceDiff(bandVar[0][1], variance, rows, S));
+					if (numPaths > 1)
+					{
+						double &avx2Error = results[BBANDS].avx2Error;
+						avx2Error = max(avx2Error, scaledDiff(mid[1][ii], mid[0][ii], rows, S));
+						avx2Error = max(avx2Error, varianceDiff(bandVar[1][0], bandVar[0][0], rows, S));
+						avx2Error = max(avx2Error, varianceDiff(bandVar[1][1], bandVar[0][1], rows, S));
+					}
+				}
+			}
+
+			// ATR (lookback = period) and WILLR (lookback = period - 1).  Both are bit-identical between the paths
+			const int atrPeriods[] = {1, period};
+			for (int aa = 0; aa < 2; aa++)
+			{
+				const int atrPeriod = atrPeriods[aa];
+				const int atrOut = rows - atrPeriod;
+				defAtr(data, rows, atrPeriod, def);
+
+				for (int pa = 0; pa < numPaths; pa++)
+				{
+					fresh(out[pa], rows);
+					taNativeAtr(&data.high[0], &data.low[0], &data.close[0], rows, atrPeriod, paths[pa], &out[pa][0]);
+					results[ATR].countsOk = results[ATR].countsOk && writtenCount(out[pa], atrOut);
+				}
+				for (int ii = 0; ii < atrOut; ii++)
+					results[ATR].scalarError = max(results[ATR].scalarError, scaledDiff(out[0][ii], def[ii], rows, S));
+				if (numPaths > 1)
+					results[ATR].exactOk = results[ATR].exactOk && (memcmp(&out[0][0], &out[1][0], atrOut * sizeof(double)) == 0);
+			}
+
+			for (int pa = 0; pa < numPaths; pa++)
+			{
+				fresh(out[pa], rows);
+				taNativeWillr(&data.high[0], &data.low[0], &data.close[0], rows, period, paths[pa], &out[pa][0]);
+				results[WILLR].countsOk = results[WILLR].countsOk && writtenCount(out[pa], numOut);
+			}
+			for (int ii = 0; ii < numOut; ii++)
+			{
+				const int row = ii + period - 1;
+				const double highest = defExtreme(&data.high[0], row, period, true);
+				const double lowest = defExtreme(&data.low[0], row, period, false);
+				const double value = (highest != lowest) ? -100.0 * (highest - data.close[row]) / (highest - lowest) : 0.0;
+
+				// %R is bounded by 100 whatever the prices
+				results[WILLR].scalarError = max(results[WILLR].scalarError, scaledDiff(out[0][ii], value, rows, 100));
+			}
+			if (numPaths > 1)
+				results[WILLR].exactOk = results[WILLR].exactOk && (memcmp(&out[0][0], &out[1][0], numOut * sizeof(double)) == 0);
+		}
+	}
+
+	int failures = 0;
+	for (int ff = 0; ff < NUM_FUNCTIONS; ff++)
+	{
+		const checkResult &res = results[ff];
+		const bool pass = res.countsOk && res.exactOk && res.scalarError <= TA_NATIVE_TOLERANCE && res.avx2Error <= TA_NATIVE_TOLERANCE;
+		failures += !pass;
+
+		if (numPaths > 1)
+			printf("checkTaNative: %-7s scalar vs definition %.3g  avx2 vs scalar %.3g  (x rows x S)  %s\n",
+				res.name, res.scalarError, res.avx2Error, pass ? "ok" : "FAILED");
+		else
+			printf("checkTaNative: %-7s scalar vs definition %.3g  (x rows x S)  avx2 not supported  %s\n",
+				res.name, res.scalarError, pass ? "ok" : "FAILED");
+		if (!res.countsOk)
+			printf("checkTaNative: %-7s wrote a number of values other than rows - lookback\n", res.name);
+		if (!res.exactOk)
+			printf("checkTaNative: %-7s values that must be bit-identical differ\n", res.name);
+	}
+
+	return failures == 0 ? 0 : 1;
+}
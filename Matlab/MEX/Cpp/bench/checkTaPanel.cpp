@@ -0,0 +1,348 @@
+// checkTaPanel.cpp
+//
+// Check of taInvoke's panel calls (data series given as N x M panels) against the ordinary call of each column.
+// Needs TA-Lib.  For each function, with its optional inputs omitted and given:
+//	- the panel holds three columns: one complete, one whose series all start with CHECK_LEAD NaN rows (a contract
+//	  listed later) and one whose Close alone starts with CHECK_CLOSE_LEAD NaN rows, so the column's first complete
+//	  row depends on the series the function takes
+//	- each column is also called on its own as a vector, from its first complete row
+//	- the panel column must be NaN (0 in integer outputs) before that row and equal the single call from it, bit for
+//	  bit including the NaN rows of the lookback.  Indices (ta_maxindex ...) are rows of the column
+// Series longer than every lookback and one shorter than most are checked, the short one also holding a column with
+// no complete row.  Options outside a function's limits, or given in a number the ordinary call refuses, must raise an
+// error in both calls.
+
+#include "mex.h"
+#include "mexShim.h"
+#include "benchUtil.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+#define CHECK_COLS 3
+#define CHECK_LEAD 37				// NaN rows leading every series of the second column
+#define CHECK_CLOSE_LEAD 5			// NaN rows leading the Close of the third column
+#define CHECK_MAX_OPTS 8
+
+// One call: the data series the function takes, in order, its outputs and optional inputs
+//	O, H, L, C	Open, High, Low and Close panels
+//	V		Volume panel
+//	P		Period panel (ta_mavp)
+//	B		A Close shared by every column as an N x 1 vector (the index of ta_beta)
+typedef struct panelCase
+{
+	const char *funcName;
+	const char *series;
+	int numOutputs;
+	int numOpts;
+	double opts[CHECK_MAX_OPTS];
+	bool isError;				// Both calls must raise an error
+} panelCase;
+
+static const panelCase s_cases[] = {
+	// Ordinary defaults that differ from TA-Lib's
+	{"ta_accbands", "HLC", 3, 0, {0}, false}, {"ta_accbands", "HLC", 3, 1, {9}, false},
+	{"ta_ma", "C", 1, 0, {0}, false}, {"ta_ma", "C", 1, 2, {10, 1}, false},
+	{"ta_mom", "C", 1, 0, {0}, false}, {"ta_mom", "C", 1, 1, {5}, false},
+	{"ta_cdldarkcloudcover", "OHLC", 1, 0, {0}, false}, {"ta_cdldarkcloudcover", "OHLC", 1, 1, {0.5}, false},
+	{"ta_cdlmathold", "OHLC", 1, 0, {0}, false},
+	// TA-Lib's defaults, several outputs, integer outputs and indices
+	{"ta_cdldoji", "OHLC", 1, 0, {0}, false},
+	{"ta_rsi", "C", 1, 0, {0}, false}, {"ta_rsi", "C", 1, 1, {2}, false},
+	{"ta_stddev", "C", 1, 2, {10, 1.5}, false},
+	{"ta_bbands", "C", 3, 0, {0}, false}, {"ta_bbands", "C", 3, 4, {10, 1.5, 2.5, 1}, false},
+	{"ta_macd", "C", 3, 0, {0}, false}, {"ta_macd", "C", 3, 3, {5, 35, 5}, false},
+	{"ta_macdext", "C", 3, 6, {12, 1, 26, 1, 9, 0}, false},
+	{"ta_mama", "C", 2, 0, {0}, false}, {"ta_mama", "C", 2, 2, {0.6, 0.1}, false},
+	{"ta_mavp", "CP", 1, 0, {0}, false}, {"ta_mavp", "CP", 1, 3, {4, 20, 1}, false},
+	{"ta_apo", "C", 1, 0, {0}, false}, {"ta_apo", "C", 1, 3, {5, 20, 1}, false},
+	{"ta_t3", "C", 1, 2, {7, 0.5}, false},
+	{"ta_stochrsi", "C", 2, 0, {0}, false}, {"ta_stochrsi", "C", 2, 2, {10, 4}, false},
+	{"ta_adx", "HLC", 1, 0, {0}, false},
+	{"ta_willr", "HLC", 1, 1, {10}, false},
+	{"ta_stoch", "HLC", 2, 0, {0}, false}, {"ta_stoch", "HLC", 2, 5, {9, 4, 1, 4, 1}, false},
+	{"ta_ultosc", "HLC", 1, 3, {5, 10, 20}, false},
+	{"ta_trange", "HLC", 1, 0, {0}, false},
+	{"ta_aroon", "HL", 2, 0, {0}, false}, {"ta_aroon", "HL", 2, 1, {10}, false},
+	{"ta_sar", "HL", 1, 0, {0}, false}, {"ta_sar", "HL", 1, 2, {0.05, 0.1}, false},
+	{"ta_sarext", "HL", 1, 0, {0}, false},
+	{"ta_maxindex", "C", 1, 0, {0}, false}, {"ta_maxindex", "C", 1, 1, {10}, false},
+	{"ta_minmaxindex", "C", 2, 1, {10}, false},
+	{"ta_ht_trendmode", "C", 1, 0, {0}, false},
+	{"ta_ad", "HLCV", 1, 0, {0}, false},
+	{"ta_adosc", "HLCV", 1, 0, {0}, false}, {"ta_adosc", "HLCV", 1, 2, {5, 20}, false},
+	{"ta_obv", "CV", 1, 0, {0}, false},
+	{"ta_bop", "OHLC", 1, 0, {0}, false},
+	{"ta_beta", "CB", 1, 0, {0}, false}, {"ta_beta", "CB", 1, 1, {20}, false},
+	// Limits of the ordinary call
+	{"ta_mama", "C", 2, 2, {0.05, 0.5}, true},
+	{"ta_mavp", "CP", 1, 2, {30, 2}, true},
+	{"ta_adosc", "HLCV", 1, 2, {10, 3}, true},
+	{"ta_macd", "C", 3, 3, {26, 12, 9}, true},
+	{"ta_rsi", "C", 1, 1, {1}, true},
+	{"ta_cdldarkcloudcover", "OHLC", 1, 1, {1.5}, true},
+	// Option counts the ordinary call refuses
+	{"ta_apo", "C", 1, 1, {12}, true},
+	{"ta_bbands", "C", 3, 2, {10, 2}, true}};
+
+// Series of one length, each column major rows x CHECK_COLS but for the shared index
+typedef struct panelData
+{
+	int rows;
+	vector<double> open, high, low, close, volume, periods, index;
+} panelData;
+
+static void makeData(int rows, unsigned seed, panelData &data)
+{
+	data.rows = rows;
+	data.open.resize(rows * CHECK_COLS);
+	data.high.resize(rows * CHECK_COLS);
+	data.low.resize(rows * CHECK_COLS);
+	data.close.resize(rows * CHECK_COLS);
+	data.volume.resize(rows * CHECK_COLS);
+	data.periods.resize(rows * CHECK_COLS);
+
+	mt19937 gen(seed);
+	uniform_real_distribution<double> volume(100, 10000);
+	uniform_int_distribution<int> period(2, 30);
+	vector<double> ohlc;
+
+	for (int col = 0; col < CHECK_COLS; col++)
+	{
+		makeOHLC(rows, seed + 1 + col, 0.25, ohlc);
+		copy(ohlc.begin(), ohlc.begin() + rows, data.open.begin() + col * rows);
+		copy(ohlc.begin() + rows, ohlc.begin() + 2 * rows, data.high.begin() + col * rows);
+		copy(ohlc.begin() + 2 * rows, ohlc.begin() + 3 * rows, data.low.begin() + col * rows);
+		copy(ohlc.begin() + 3 * rows, ohlc.begin() + 4 * rows, data.close.begin() + col * rows);
+
+		for (int ii = 0; ii < rows; ii++)
+		{
+			data.volume[col * rows + ii] = volume(gen);
+			data.periods[col * rows + ii] = period(gen);
+		}
+	}
+
+	makeOHLC(rows, seed + 1 + CHECK_COLS, 0.25, ohlc);
+	data.index.assign(ohlc.begin() + 3 * rows, ohlc.begin() + 4 * rows);
+
+	// A contract listed later and a Close missing its first bars
+	double nan = mxGetNaN();
+	vector<double> *series[] = {&data.open, &data.high, &data.low, &data.close, &data.volume, &data.periods};
+	for (size_t ss = 0; ss < sizeof(series) / sizeof(series[0]); ss++)
+		fill(series[ss]->begin() + rows, series[ss]->begin() + rows + min(CHECK_LEAD, rows), nan);
+	fill(data.close.begin() + 2 * rows, data.close.begin() + 2 * rows + min(CHECK_CLOSE_LEAD, rows), nan);
+}
+
+static const vector<double> &seriesOf(const panelData &data, char code)
+{
+	switch (code)
+	{
+		case 'O': return data.open;
+		case 'H': return data.high;
+		case 'L': return data.low;
+		case 'V': return data.volume;
+		case 'P': return data.periods;
+		case 'B': return data.index;
+		default: return data.close;
+	}
+}
+
+// Call taInvoke.  Returns false if it raised an error
+static bool callTaInvoke(const panelCase &pc, vector<mxArray*> &inputs, vector<mxArray*> &outputs)
+{
+	for (int oo = 0; oo < pc.numOpts; oo++)
+		inputs.push_back(mxCreateDoubleScalar(pc.opts[oo]));
+
+	outputs.assign(pc.numOutputs, (mxArray*)NULL);
+	bool ok = true;
+	try
+	{
+		mexFunction(pc.numOutputs, &outputs[0], int(inputs.size()), (const mxArray**)&inputs[0]);
+	}
+	catch (const mexShimError &)
+	{
+		ok = false;
+	}
+
+	for (size_t ii = 0; ii < inputs.size(); ii++)
+		mxDestroyArray(inputs[ii]);
+	return ok;
+}
+
+static void freeOutputs(vector<mxArray*> &outputs)
+{
+	for (size_t kk = 0; kk < outputs.size(); kk++)
+	{
+		if (outputs[kk] != NULL)
+			mxDestroyArray(outputs[kk]);
+	}
+	outputs.clear();
+}
+
+// Bit for bit, a NaN equalling a NaN
+static bool sameValue(double a, double b)
+{
+	return (a != a && b != b) || memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+// TA-Lib's lookback of the index functions: period - 1 (default 30)
+static int indexLookback(const panelCase &pc)
+{
+	return (pc.numOpts > 0 ? int(pc.opts[0]) : 30) - 1;
+}
+
+// Compare column 'col' of each panel output with its single call.  Returns the number of rows that differ
+static int compareColumn(const panelCase &pc, const panelData &data, int col, const vector<mxArray*> &panel)
+{
+	const int rows = data.rows;
+	const bool isIndex = strstr(pc.funcName, "index") != NULL;
+
+	// The column's first complete row across the series the function takes
+	int start = 0;
+	for (const char *code = pc.series; *code; code++)
+	{
+		const vector<double> &series = seriesOf(data, *code);
+		const double *colPtr = &series[(series.size() == (size_t)rows) ? 0 : (size_t)col * rows];
+		int first = 0;
+		while (first < rows && colPtr[first] != colPtr[first])
+			first++;
+		start = max(start, first);
+	}
+
+	vector<mxArray*> single;
+	if (start < rows)
+	{
+		vector<mxArray*> inputs(1, mxCreateString(pc.funcName));
+		for (const char *code = pc.series; *code; code++)
+		{
+			const vector<double> &series = seriesOf(data, *code);
+			const double *colPtr = &series[(series.size() == (size_t)rows) ? 0 : (size_t)col * rows];
+			inputs.push_back(benchArray(colPtr + start, rows - start, 1));
+		}
+		if (!callTaInvoke(pc, inputs, single))
+		{
+			printf("checkTaPanel: %s column %d: the single call failed\n", pc.funcName, col + 1);
+			return rows;
+		}
+	}
+
+	int mismatches = 0;
+	for (int kk = 0; kk < pc.numOutputs; kk++)
+	{
+		if (mxIsInt32(panel[kk]))
+		{
+			const int *panelCol = (const int*)mxGetData(panel[kk]) + (size_t)col * rows;
+			const int *singleCol = (start < rows) ? (const int*)mxGetData(single[kk]) : NULL;
+			const int firstValue = start + min(indexLookback(pc), rows - start);
+
+			for (int ii = 0; ii < rows; ii++)
+			{
+				int expected = (ii < start) ? 0 : singleCol[ii - start];
+				if (isIndex && ii >= firstValue)
+					expected += start;
+				mismatches += (panelCol[ii] != expected);
+			}
+		}
+		else
+		{
+			const double *panelCol = mxGetPr(panel[kk]) + (size_t)col * rows;
+			const double *singleCol = (start < rows) ? mxGetPr(single[kk]) : NULL;
+
+			for (int ii = 0; ii < rows; ii++)
+				mismatches += !sameValue(panelCol[ii], (ii < start) ? mxGetNaN() : singleCol[ii - start]);
+		}
+	}
+
+	freeOutputs(single);
+	return mismatches;
+}
+
+// Run one case over one length.  Returns false on failure
+static bool checkCase(const panelCase &pc, const panelData &data)
+{
+	const int rows = data.rows;
+
+	vector<mxArray*> inputs(1, mxCreateString(pc.funcName));
+	for (const char *code = pc.series; *code; code++)
+	{
+		const vector<double> &series = seriesOf(data, *code);
+		inputs.push_back(benchArray(&series[0], rows, series.size() / rows));
+	}
+
+	vector<mxArray*> panel;
+	bool panelOk = callTaInvoke(pc, inputs, panel);
+
+	if (pc.isError)
+	{
+		// The ordinary call of the first column must refuse the options as well
+		vector<mxArray*> single, singleIn(1, mxCreateString(pc.funcName));
+		for (const char *code = pc.series; *code; code++)
+			singleIn.push_back(benchArray(&seriesOf(data, *code)[0], rows, 1));
+		bool singleOk = callTaInvoke(pc, singleIn, single);
+
+		freeOutputs(panel);
+		freeOutputs(single);
+		if (panelOk || singleOk)
+			printf("checkTaPanel: %s rows %d: %s call accepted options outside its limits\n",
+				pc.funcName, rows, panelOk ? "the panel" : "the single");
+		return !panelOk && !singleOk;
+	}
+
+	if (!panelOk)
+	{
+		printf("checkTaPanel: %s rows %d: the panel call failed\n", pc.funcName, rows);
+		return false;
+	}
+
+	bool ok = true;
+	for (int col = 0; col < CHECK_COLS; col++)
+	{
+		int mismatches = compareColumn(pc, data, col, panel);
+		if (mismatches > 0)
+		{
+			printf("checkTaPanel: %s rows %d column %d: %d values differ from the single call\n",
+				pc.funcName, rows, col + 1, mismatches);
+			ok = false;
+		}
+	}
+
+	freeOutputs(panel);
+	return ok;
+}
+
+int main()
+{
+	int failures = 0;
+
+	// Past every lookback, and shorter than most with the second column entirely NaN
+	const int lengths[] = {500, 20};
+	panelData data[2];
+	for (int ll = 0; ll < 2; ll++)
+		makeData(lengths[ll], 20130101 + ll, data[ll]);
+
+	for (size_t cs = 0; cs < sizeof(s_cases) / sizeof(s_cases[0]); cs++)
+	{
+		const panelCase &pc = s_cases[cs];
+		bool ok = true;
+
+		for (int ll = 0; ll < 2; ll++)
+			ok = checkCase(pc, data[ll]) && ok;
+
+		char opts[96] = "defaults";
+		if (pc.numOpts > 0)
+		{
+			int used = 0;
+			for (int oo = 0; oo < pc.numOpts; oo++)
+				used += snprintf(opts + used, sizeof(opts) - used, oo ? ", %g" : "%g", pc.opts[oo]);
+		}
+		printf("checkTaPanel: %-22s %-28s %s\n", pc.funcName, opts, ok ? (pc.isError ? "refused ok" : "ok") : "FAILED");
+		failures += !ok;
+	}
+
+	printf("checkTaPanel: %s\n", failures ? "FAILED" : "ok");
+	return failures == 0 ? 0 : 1;
+}
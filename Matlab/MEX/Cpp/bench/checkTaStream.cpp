@@ -0,0 +1,460 @@
+// checkTaStream.cpp
+//
+// Check of the streaming taInvoke states (taStream.cpp) against the ordinary, batch call of each function over the
+// same bars, row by row including the warm-up rows.  It runs without TA-Lib.  For every function, optional inputs,
+// unstable period and length of series:
+//	- the batch column is laid out as taInvoke's ordinary call lays it out: a zeroed output, the function's values
+//	  written from outStart(lookback, rows) and the rows before the lookback NaN
+//	- the values come from the native scalar backend (taNative.cpp) for SMA, EMA, WMA, ATR and BBANDS, and from
+//	  a transcription of TA-Lib's batch loop for RSI, ADX, MACD and SAR
+//	- the lookback is TA-Lib's (TA_xxx_Lookback), written out here rather than taken from the stream
+//	- the stream takes the bars one at a time and its outputs after each bar are compared with that row
+// Both must be NaN on the same rows, there must be exactly min(lookback, rows) of them and every other row must agree
+// to CHECK_TOLERANCE x S, S being the largest price.  An unstable period is checked as TA-Lib applies it: the
+// values are computed from the first bar and only the leading NaN rows grow.
+//
+// This does not compare with TA-Lib itself.  benchTaInvoke does that when TA-Lib is found.
+
+#include "taNative.h"
+#include "taStream.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+#define CHECK_TOLERANCE 1e-12			// Of S, the largest price
+#define CHECK_SEEDS 4
+#define CHECK_BARS 2000
+#define CHECK_UNSTABLE 7			// Unstable period given to the functions that take one
+
+static const double s_nan = numeric_limits<double>::quiet_NaN();
+static const char *s_funcNames[] = {"SMA", "EMA", "WMA", "RSI", "ATR", "ADX", "MACD", "SAR", "BBANDS"};
+
+// Series of one case
+typedef struct checkData
+{
+	vector<double> high, low, close;
+	double scale;				// S: the largest price
+} checkData;
+
+// One function and its optional inputs
+typedef struct checkCase
+{
+	int func;				// taStreamFunc
+	double opts[TA_STREAM_MAX_OPTS];
+} checkCase;
+
+static const checkCase s_cases[] = {
+	{TA_STREAM_SMA, {2}}, {TA_STREAM_SMA, {14}}, {TA_STREAM_SMA, {30}},
+	{TA_STREAM_EMA, {2}}, {TA_STREAM_EMA, {14}}, {TA_STREAM_EMA, {30}},
+	{TA_STREAM_WMA, {2}}, {TA_STREAM_WMA, {14}}, {TA_STREAM_WMA, {30}},
+	{TA_STREAM_RSI, {2}}, {TA_STREAM_RSI, {14}}, {TA_STREAM_RSI, {30}},
+	{TA_STREAM_ATR, {1}}, {TA_STREAM_ATR, {14}}, {TA_STREAM_ATR, {30}},
+	{TA_STREAM_ADX, {2}}, {TA_STREAM_ADX, {14}}, {TA_STREAM_ADX, {30}},
+	{TA_STREAM_MACD, {12, 26, 9}}, {TA_STREAM_MACD, {2, 3, 1}}, {TA_STREAM_MACD, {5, 35, 5}},
+	{TA_STREAM_SAR, {0.02, 0.20}}, {TA_STREAM_SAR, {0.05, 0.10}}, {TA_STREAM_SAR, {0.30, 0.20}},
+	{TA_STREAM_BBANDS, {5, 2, 2, 0}}, {TA_STREAM_BBANDS, {20, 1.5, 2.5, 1}}, {TA_STREAM_BBANDS, {14, 2, 1, 2}}};
+
+// High | Low | Close random walk on a 0.25 grid about 'level'.  A third of the bars do not move
+static void makeData(int rows, unsigned seed, double level, checkData &data)
+{
+	mt19937 gen(seed);
+	uniform_int_distribution<int> step(-6, 6);
+	uniform_int_distribution<int> range(0, 8);
+	uniform_real_distribution<double> coin(0, 1);
+
+	data.high.resize(rows);
+	data.low.resize(rows);
+	data.close.resize(rows);
+
+	double ticks = level / 0.25;
+	for (int ii = 0; ii < rows; ii++)
+	{
+		if (coin(gen) < 0.67)
+			ticks = ticks + step(gen);
+		data.close[ii] = ticks * 0.25;
+		data.high[ii] = (ticks + range(gen)) * 0.25;
+		data.low[ii] = (ticks - range(gen)) * 0.25;
+	}
+
+	data.scale = *max_element(data.high.begin(), data.high.end());
+}
+
+// Unstable period taken by a function.  MACD and BBANDS are checked without one
+static bool takesUnstable(int func)
+{
+	return func == TA_STREAM_EMA || func == TA_STREAM_RSI || func == TA_STREAM_ATR || func == TA_STREAM_ADX;
+}
+
+// TA_xxx_Lookback
+static int taLookback(const checkCase &cc, int unstable)
+{
+	const int period = int(cc.opts[0]);
+
+	switch (cc.func)
+	{
+		case TA_STREAM_SMA:
+		case TA_STREAM_WMA:
+			return period - 1;
+		case TA_STREAM_EMA:
+			return period - 1 + unstable;
+		case TA_STREAM_RSI:
+		case TA_STREAM_ATR:
+			return period + unstable;
+		case TA_STREAM_ADX:
+			return 2 * period - 1 + unstable;
+		case TA_STREAM_MACD:
+			return int(cc.opts[1]) - 1 + int(cc.opts[2]) - 1;
+		case TA_STREAM_SAR:
+			return 1;
+		default:
+			return period - 1;
+	}
+}
+
+static bool isZero(double value)
+{
+	return -0.00000001 < value && value < 0.00000001;
+}
+
+static double trueRange(const checkData &data, int ii)
+{
+	return max(data.high[ii] - data.low[ii],
+		max(fabs(data.close[ii - 1] - data.high[ii]), fabs(data.close[ii - 1] - data.low[ii])));
+}
+
+// TA_RSI's loop: gains and losses averaged over the first 'period' changes, then smoothed by Wilder
+static void batchRsi(const double *x, int rows, int period, double *out)
+{
+	double prevGain = 0, prevLoss = 0;
+
+	for (int ii = 1; ii < rows; ii++)
+	{
+		double diff = x[ii] - x[ii - 1];
+
+		if (ii > period)
+		{
+			prevLoss *= (period - 1);
+			prevGain *= (period - 1);
+		}
+		if (diff < 0)
+			prevLoss -= diff;
+		else
+			prevGain += diff;
+
+		if (ii >= period)
+		{
+			prevLoss /= period;
+			prevGain /= period;
+			double total = prevGain + prevLoss;
+			out[ii - period] = isZero(total) ? 0.0 : 100.0 * (prevGain / total);
+		}
+	}
+}
+
+// TA_ADX's loop: +DM, -DM and the true range summed over bars 1 to period - 1 and then smoothed by Wilder.  The
+// first ADX is the mean of the next 'period' DX, smoothed by Wilder from there
+static void batchAdx(const checkData &data, int rows, int period, double *out)
+{
+	double prevPlusDM = 0, prevMinusDM = 0, prevTR = 0, sumDX = 0, adx = 0;
+
+	for (int ii = 1; ii < rows; ii++)
+	{
+		double diffP = data.high[ii] - data.high[ii - 1];
+		double diffM = data.low[ii - 1] - data.low[ii];
+		double plusDM = (diffP > 0 && diffP > diffM) ? diffP : 0;
+		double minusDM = (diffM > 0 && diffP < diffM) ? diffM : 0;
+
+		if (ii < period)
+		{
+			prevPlusDM += plusDM;
+			prevMinusDM += minusDM;
+			prevTR += trueRange(data, ii);
+			continue;
+		}
+
+		prevPlusDM = prevPlusDM - prevPlusDM / period + plusDM;
+		prevMinusDM = prevMinusDM - prevMinusDM / period + minusDM;
+		prevTR = prevTR - (prevTR / period) + trueRange(data, ii);
+
+		if (!isZero(prevTR))
+		{
+			double minusDI = 100.0 * (prevMinusDM / prevTR);
+			double plusDI = 100.0 * (prevPlusDM / prevTR);
+			double sumDI = minusDI + plusDI;
+			if (!isZero(sumDI))
+			{
+				double dx = 100.0 * (fabs(minusDI - plusDI) / sumDI);
+				if (ii < 2 * period)
+					sumDX += dx;
+				else
+					adx = ((adx * (period - 1)) + dx) / period;
+			}
+		}
+
+		if (ii == 2 * period - 1)
+			adx = sumDX / period;
+		if (ii >= 2 * period - 1)
+			out[ii - (2 * period - 1)] = adx;
+	}
+}
+
+// TA_INT_EMA of x[first ... rows - 1] seeded with the mean of its first 'period' values.  Writes from
+// out[first + period - 1]
+static void emaFrom(const double *x, int first, int rows, int period, double *out)
+{
+	const double k = 2.0 / double(period + 1);
+	double ema = 0;
+
+	for (int ii = first; ii < first + period && ii < rows; ii++)
+		ema += x[ii];
+	ema = ema / period;
+
+	for (int ii = first + period - 1; ii < rows; ii++)
+	{
+		if (ii > first + period - 1)
+			ema = ((x[ii] - ema) * k) + ema;
+		out[ii] = ema;
+	}
+}
+
+// TA_MACD: the slow EMA from the first bar and the fast EMA from slow - fast so both first give a value at bar
+// slow - 1.  The signal is the EMA of the MACD from there
+static void batchMacd(const double *x, int rows, int fast, int slow, int signal, double *macdOut, double *sigOut,
+	double *histOut)
+{
+	const int first = slow - 1;
+	const int lookback = first + signal - 1;
+	vector<double> slowMA(rows), fastMA(rows), macd(rows), sig(rows);
+
+	emaFrom(x, 0, rows, slow, &slowMA[0]);
+	emaFrom(x, slow - fast, rows, fast, &fastMA[0]);
+	for (int ii = first; ii < rows; ii++)
+		macd[ii] = fastMA[ii] - slowMA[ii];
+	emaFrom(&macd[0], first, rows, signal, &sig[0]);
+
+	for (int ii = lookback; ii < rows; ii++)
+	{
+		macdOut[ii - lookback] = macd[ii];
+		sigOut[ii - lookback] = sig[ii];
+		histOut[ii - lookback] = macd[ii] - sig[ii];
+	}
+}
+
+// TA_SAR's loop.  The first position is long unless bar 1 has a positive -DM, and the first output bar is taken as
+// its own previous bar
+static void batchSar(const checkData &data, int rows, double acceleration, double maximum, double *out)
+{
+	if (acceleration > maximum)
+		acceleration = maximum;
+
+	double diffP = data.high[1] - data.high[0];
+	double diffM = data.low[0] - data.low[1];
+	bool isLong = !(diffM > 0 && diffP < diffM);
+	double af = acceleration;
+	double ep = isLong ? data.high[1] : data.low[1];
+	double sar = isLong ? data.low[0] : data.high[0];
+	double newHigh = data.high[1];
+	double newLow = data.low[1];
+
+	for (int ii = 1; ii < rows; ii++)
+	{
+		double prevLow = newLow;
+		double prevHigh = newHigh;
+		newLow = data.low[ii];
+		newHigh = data.high[ii];
+
+		if (isLong)
+		{
+			if (newLow <= sar)
+			{
+				isLong = false;
+				sar = max(max(ep, prevHigh), newHigh);
+				out[ii - 1] = sar;
+				af = acceleration;
+				ep = newLow;
+				sar = max(max(sar + af * (ep - sar), prevHigh), newHigh);
+			}
+			else
+			{
+				out[ii - 1] = sar;
+				if (newHigh > ep)
+				{
+					ep = newHigh;
+					af = min(af + acceleration, maximum);
+				}
+				sar = min(min(sar + af * (ep - sar), prevLow), newLow);
+			}
+		}
+		else
+		{
+			if (newHigh >= sar)
+			{
+				isLong = true;
+				sar = min(min(ep, prevLow), newLow);
+				out[ii - 1] = sar;
+				af = acceleration;
+				ep = newHigh;
+				sar = min(min(sar + af * (ep - sar), prevLow), newLow);
+			}
+			else
+			{
+				out[ii - 1] = sar;
+				if (newLow < ep)
+				{
+					ep = newLow;
+					af = min(af + acceleration, maximum);
+				}
+				sar = max(max(sar + af * (ep - sar), prevHigh), newHigh);
+			}
+		}
+	}
+}
+
+// Outputs of the ordinary call of a case, laid out as taInvoke lays them out.  The function writes its values
+// (without an unstable period) from row 'natural', then those before 'lookback' are NaN as TA-Lib would leave them
+static void batchCall(const checkCase &cc, const checkData &data, int rows, int lookback, vector<double> out[])
+{
+	const int numOut = taStreamNumOutputs(cc.func);
+	const int period = int(cc.opts[0]);
+	const int natural = taLookback(cc, 0);
+	vector<double> values[TA_STREAM_MAX_OUTPUTS];
+
+	for (int kk = 0; kk < numOut; kk++)
+		values[kk].assign(rows, 0);
+
+	// Values start at row 'natural' of the series
+	if (natural < rows)
+	{
+		double *v0 = &values[0][natural];
+		double *v1 = (numOut > 1) ? &values[1][natural] : 0;
+		double *v2 = (numOut > 1) ? &values[2][natural] : 0;
+
+		switch (cc.func)
+		{
+			case TA_STREAM_SMA:
+				taNativeSma(&data.close[0], rows, period, TA_NATIVE_SCALAR, v0);
+				break;
+			case TA_STREAM_EMA:
+				taNativeEma(&data.close[0], rows, period, TA_NATIVE_SCALAR, v0);
+				break;
+			case TA_STREAM_WMA:
+				taNativeWma(&data.close[0], rows, period, TA_NATIVE_SCALAR, v0);
+				break;
+			case TA_STREAM_RSI:
+				batchRsi(&data.close[0], rows, period, v0);
+				break;
+			case TA_STREAM_ATR:
+				taNativeAtr(&data.high[0], &data.low[0], &data.close[0], rows, period, TA_NATIVE_SCALAR, v0);
+				break;
+			case TA_STREAM_ADX:
+				batchAdx(data, rows, period, v0);
+				break;
+			case TA_STREAM_MACD:
+				batchMacd(&data.close[0], rows, period, int(cc.opts[1]), int(cc.opts[2]), v0, v1, v2);
+				break;
+			case TA_STREAM_SAR:
+				batchSar(data, rows, cc.opts[0], cc.opts[1], v0);
+				break;
+			case TA_STREAM_BBANDS:
+				taNativeBbands(&data.close[0], rows, period, cc.opts[1], cc.opts[2], int(cc.opts[3]), TA_NATIVE_SCALAR,
+					v0, v1, v2);
+				break;
+		}
+	}
+
+	// As taInvoke: written from outStart(lookback, rows) in to a zeroed output, then min(lookback, rows) rows NaN
+	for (int kk = 0; kk < numOut; kk++)
+	{
+		out[kk].assign(rows, 0);
+		for (int ii = (lookback < rows) ? lookback : rows; ii < rows; ii++)
+			out[kk][ii] = values[kk][ii];
+		for (int ii = 0; ii < min(lookback, rows); ii++)
+			out[kk][ii] = s_nan;
+	}
+}
+
+int main()
+{
+	int failures = 0;
+	checkData data;
+	vector<double> batch[TA_STREAM_MAX_OUTPUTS];
+
+	for (size_t cs = 0; cs < sizeof(s_cases) / sizeof(s_cases[0]); cs++)
+	{
+		const checkCase &cc = s_cases[cs];
+		const int numOut = taStreamNumOutputs(cc.func);
+		const int numSeries = taStreamNumSeries(cc.func);
+
+		for (int unstable = 0; unstable <= (takesUnstable(cc.func) ? CHECK_UNSTABLE : 0); unstable += CHECK_UNSTABLE)
+		{
+			const int lookback = taLookback(cc, unstable);
+
+			// Series shorter than, as long as and just past the lookback, and a long one
+			const int lengths[] = {max(lookback - 1, 2), max(lookback, 2), lookback + 1, CHECK_BARS};
+			double worst = 0;
+			int nanMismatch = 0;
+			int warmUpMismatch = 0;
+			bool lookbackOk = true;
+
+			for (unsigned seed = 0; seed < CHECK_SEEDS; seed++)
+			{
+				for (size_t ll = 0; ll < sizeof(lengths) / sizeof(lengths[0]); ll++)
+				{
+					const int rows = lengths[ll];
+					makeData(rows, 20130101 + seed, 1500 + 500 * seed, data);
+					batchCall(cc, data, rows, lookback, batch);
+
+					taStreamState st;
+					if (taStreamInit(st, cc.func, cc.opts, unstable) != 0 || st.lookback != lookback)
+						lookbackOk = false;
+
+					for (int ii = 0; ii < rows; ii++)
+					{
+						double bar[3];
+						if (numSeries == 1)
+							bar[0] = data.close[ii];
+						else
+						{
+							bar[0] = data.high[ii];
+							bar[1] = data.low[ii];
+							bar[2] = data.close[ii];
+						}
+						taStreamPush(st, bar);
+
+						for (int kk = 0; kk < numOut; kk++)
+						{
+							const double streamed = st.values[kk];
+							const double called = batch[kk][ii];
+
+							// Warm-up rows are NaN in both, and no others
+							warmUpMismatch += (ii < lookback) != std::isnan(called);
+							if (std::isnan(streamed) || std::isnan(called))
+							{
+								nanMismatch += (std::isnan(streamed) != std::isnan(called));
+								continue;
+							}
+
+							worst = max(worst, fabs(streamed - called) / data.scale);
+						}
+					}
+				}
+			}
+
+			bool pass = (lookbackOk && worst <= CHECK_TOLERANCE && nanMismatch == 0 && warmUpMismatch == 0);
+			failures += !pass;
+
+			printf("checkTaStream: %-6s %-4g %-4g %-4g unstable %d  lookback %-3d largest difference %.3g (x S)  "
+				"NaN rows differ %d  %s\n", s_funcNames[cc.func], cc.opts[0], cc.opts[1], cc.opts[2], unstable, lookback,
+				worst, nanMismatch + warmUpMismatch, pass ? "ok" : "FAILED");
+			if (!lookbackOk)
+				printf("checkTaStream: %-6s the stream's lookback is not TA-Lib's\n", s_funcNames[cc.func]);
+		}
+	}
+
+	return failures == 0 ? 0 : 1;
+}
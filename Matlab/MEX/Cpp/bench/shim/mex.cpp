@@ -0,0 +1,423 @@
+// mex.cpp (shim)
+//
+// Minimal native implementation of the mx / mex API declared in the shim mex.h.
+// Arrays are column-major like Matlab. Shared data copies share the underlying
+// buffer so kernels returning their inputs behave as they do inside Matlab.
+
+#include "mex.h"
+#include "mexShim.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <atomic>
+
+using namespace std;
+
+struct mxArray_tag
+{
+	mxClassID classID;
+	vector<mwSize> dims;
+	shared_ptr<vector<unsigned char> > data;	// Raw element storage
+	vector<string> fieldNames;			// Struct arrays only
+	vector<mxArray*> children;			// Struct fields (element major) or cell contents
+};
+
+static atomic<long long> s_allocations(0);
+static atomic<long long> s_bytes(0);
+
+static void countAlloc(size_t bytes)
+{
+	s_allocations++;
+	s_bytes += (long long)bytes;
+}
+
+mexShimAllocStats mexShimGetAllocStats()
+{
+	mexShimAllocStats stats;
+	stats.allocations = s_allocations.load();
+	stats.bytes = s_bytes.load();
+	return stats;
+}
+
+void mexShimResetAllocStats()
+{
+	s_allocations = 0;
+	s_bytes = 0;
+}
+
+static size_t elementSize(mxClassID classid)
+{
+	switch (classid)
+	{
+	case mxDOUBLE_CLASS: case mxINT64_CLASS: case mxUINT64_CLASS:	return 8;
+	case mxSINGLE_CLASS: case mxINT32_CLASS: case mxUINT32_CLASS:	return 4;
+	case mxINT16_CLASS: case mxUINT16_CLASS: case mxCHAR_CLASS:	return 2;
+	case mxINT8_CLASS: case mxUINT8_CLASS: case mxLOGICAL_CLASS:	return 1;
+	default:							return 0;
+	}
+}
+
+static mxArray *newArray(mxClassID classid, mwSize ndim, const mwSize *dims)
+{
+	mxArray *pa = new mxArray_tag;
+	pa->classID = classid;
+	pa->dims.assign(dims, dims + ndim);
+	while (pa->dims.size() < 2)
+		pa->dims.push_back(1);
+
+	size_t numel = 1;
+	for (size_t ii = 0; ii < pa->dims.size(); ii++)
+		numel *= pa->dims[ii];
+
+	size_t bytes = numel * elementSize(classid);
+	pa->data = make_shared<vector<unsigned char> >(bytes, 0);
+	countAlloc(bytes);
+	return pa;
+}
+
+extern "C"
+{
+
+mxArray *mxCreateDoubleMatrix(mwSize m, mwSize n, mxComplexity flag)
+{
+	if (flag != mxREAL)
+		mexErrMsgIdAndTxt("mexShim:complex", "Complex arrays are not supported by the shim.");
+	mwSize dims[2] = {m, n};
+	return newArray(mxDOUBLE_CLASS, 2, dims);
+}
+
+mxArray *mxCreateDoubleScalar(double value)
+{
+	mxArray *pa = mxCreateDoubleMatrix(1, 1, mxREAL);
+	*mxGetPr(pa) = value;
+	return pa;
+}
+
+mxArray *mxCreateNumericMatrix(mwSize m, mwSize n, mxClassID classid, mxComplexity flag)
+{
+	mwSize dims[2] = {m, n};
+	return mxCreateNumericArray(2, dims, classid, flag);
+}
+
+mxArray *mxCreateNumericArray(mwSize ndim, const mwSize *dims, mxClassID classid, mxComplexity flag)
+{
+	if (flag != mxREAL)
+		mexErrMsgIdAndTxt("mexShim:complex", "Complex arrays are not supported by the shim.");
+	return newArray(classid, ndim, dims);
+}
+
+mxArray *mxCreateString(const char *str)
+{
+	size_t len = strlen(str);
+	mwSize dims[2] = {(mwSize)(len > 0 ? 1 : 0), len};
+	mxArray *pa = newArray(mxCHAR_CLASS, 2, dims);
+	mxChar *chars = (mxChar*)mxGetData(pa);
+	for (size_t ii = 0; ii < len; ii++)
+		chars[ii] = (mxChar)(unsigned char)str[ii];
+	return pa;
+}
+
+mxArray *mxCreateStructMatrix(mwSize m, mwSize n, int nfields, const char **fieldnames)
+{
+	mwSize dims[2] = {m, n};
+	mxArray *pa = newArray(mxSTRUCT_CLASS, 2, dims);
+	for (int ii = 0; ii < nfields; ii++)
+		pa->fieldNames.push_back(fieldnames[ii]);
+	pa->children.assign(m * n * nfields, (mxArray*)NULL);
+	return pa;
+}
+
+mxArray *mxCreateCellMatrix(mwSize m, mwSize n)
+{
+	mwSize dims[2] = {m, n};
+	mxArray *pa = newArray(mxCELL_CLASS, 2, dims);
+	pa->children.assign(m * n, (mxArray*)NULL);
+	return pa;
+}
+
+mxArray *mxDuplicateArray(const mxArray *pa)
+{
+	mxArray *dup = new mxArray_tag(*pa);
+	dup->data = make_shared<vector<unsigned char> >(*pa->data);
+	countAlloc(dup->data->size());
+	for (size_t ii = 0; ii < dup->children.size(); ii++)
+		if (dup->children[ii] != NULL)
+			dup->children[ii] = mxDuplicateArray(dup->children[ii]);
+	return dup;
+}
+
+void mxDestroyArray(mxArray *pa)
+{
+	if (pa == NULL)
+		return;
+	for (size_t ii = 0; ii < pa->children.size(); ii++)
+		mxDestroyArray(pa->children[ii]);
+	delete pa;
+}
+
+double *mxGetPr(const mxArray *pa)
+{
+	return pa->data->empty() ? NULL : (double*)&(*pa->data)[0];
+}
+
+void *mxGetData(const mxArray *pa)
+{
+	return pa->data->empty() ? NULL : (void*)&(*pa->data)[0];
+}
+
+mwSize mxGetM(const mxArray *pa)
+{
+	return pa->dims[0];
+}
+
+mwSize mxGetN(const mxArray *pa)
+{
+	// Matlab folds trailing dimensions into N
+	mwSize n = 1;
+	for (size_t ii = 1; ii < pa->dims.size(); ii++)
+		n *= pa->dims[ii];
+	return n;
+}
+
+mwSize mxGetNumberOfDimensions(const mxArray *pa)
+{
+	return pa->dims.size();
+}
+
+const mwSize *mxGetDimensions(const mxArray *pa)
+{
+	return &pa->dims[0];
+}
+
+mwSize mxGetNumberOfElements(const mxArray *pa)
+{
+	return mxGetM(pa) * mxGetN(pa);
+}
+
+mxClassID mxGetClassID(const mxArray *pa)
+{
+	return pa->classID;
+}
+
+size_t mxGetElementSize(const mxArray *pa)
+{
+	return elementSize(pa->classID);
+}
+
+bool mxIsComplex(const mxArray *)
+{
+	return false;
+}
+
+bool mxIsSparse(const mxArray *)
+{
+	return false;
+}
+
+bool mxIsDouble(const mxArray *pa)	{ return pa->classID == mxDOUBLE_CLASS; }
+bool mxIsChar(const mxArray *pa)	{ return pa->classID == mxCHAR_CLASS; }
+bool mxIsStruct(const mxArray *pa)	{ return pa->classID == mxSTRUCT_CLASS; }
+bool mxIsCell(const mxArray *pa)	{ return pa->classID == mxCELL_CLASS; }
+bool mxIsInt8(const mxArray *pa)	{ return pa->classID == mxINT8_CLASS; }
+bool mxIsInt16(const mxArray *pa)	{ return pa->classID == mxINT16_CLASS; }
+bool mxIsInt32(const mxArray *pa)	{ return pa->classID == mxINT32_CLASS; }
+bool mxIsUint64(const mxArray *pa)	{ return pa->classID == mxUINT64_CLASS; }
+bool mxIsEmpty(const mxArray *pa)	{ return mxGetNumberOfElements(pa) == 0; }
+
+double mxGetScalar(const mxArray *pa)
+{
+	if (mxGetNumberOfElements(pa) == 0)
+		return 0;
+	const void *p = mxGetData(pa);
+	switch (pa->classID)
+	{
+	case mxDOUBLE_CLASS:	return *(const double*)p;
+	case mxSINGLE_CLASS:	return *(const float*)p;
+	case mxINT8_CLASS:	return *(const int8_t*)p;
+	case mxUINT8_CLASS:	return *(const uint8_t*)p;
+	case mxLOGICAL_CLASS:	return *(const uint8_t*)p;
+	case mxINT16_CLASS:	return *(const int16_t*)p;
+	case mxUINT16_CLASS:	return *(const uint16_t*)p;
+	case mxCHAR_CLASS:	return *(const mxChar*)p;
+	case mxINT32_CLASS:	return *(const int32_t*)p;
+	case mxUINT32_CLASS:	return *(const uint32_t*)p;
+	case mxINT64_CLASS:	return (double)*(const int64_t*)p;
+	case mxUINT64_CLASS:	return (double)*(const uint64_t*)p;
+	default:		return 0;
+	}
+}
+
+int mxGetString(const mxArray *pa, char *buf, mwSize buflen)
+{
+	if (pa->classID != mxCHAR_CLASS || buflen == 0)
+		return 1;
+	mwSize len = mxGetNumberOfElements(pa);
+	const mxChar *chars = (const mxChar*)mxGetData(pa);
+	mwSize ii = 0;
+	for (; ii < len && ii < buflen - 1; ii++)
+		buf[ii] = (char)chars[ii];
+	buf[ii] = '\0';
+	return len < buflen ? 0 : 1;
+}
+
+char *mxArrayToString(const mxArray *pa)
+{
+	if (pa->classID != mxCHAR_CLASS)
+		return NULL;
+	mwSize len = mxGetNumberOfElements(pa) + 1;
+	char *buf = (char*)mxCalloc(len, sizeof(char));
+	mxGetString(pa, buf, len);
+	return buf;
+}
+
+static int fieldIndex(const mxArray *pa, const char *fieldname)
+{
+	for (size_t ii = 0; ii < pa->fieldNames.size(); ii++)
+		if (pa->fieldNames[ii] == fieldname)
+			return (int)ii;
+	return -1;
+}
+
+void mxSetField(mxArray *pa, mwIndex i, const char *fieldname, mxArray *value)
+{
+	int fld = fieldIndex(pa, fieldname);
+	if (fld < 0)
+		mexErrMsgIdAndTxt("mexShim:field", "Unknown struct field '%s'.", fieldname);
+	mxArray *&slot = pa->children[i * pa->fieldNames.size() + fld];
+	mxDestroyArray(slot);
+	slot = value;
+}
+
+mxArray *mxGetField(const mxArray *pa, mwIndex i, const char *fieldname)
+{
+	int fld = fieldIndex(pa, fieldname);
+	if (fld < 0)
+		return NULL;
+	return pa->children[i * pa->fieldNames.size() + fld];
+}
+
+int mxGetNumberOfFields(const mxArray *pa)
+{
+	return (int)pa->fieldNames.size();
+}
+
+const char *mxGetFieldNameByNumber(const mxArray *pa, int n)
+{
+	return pa->fieldNames[n].c_str();
+}
+
+void mxSetCell(mxArray *pa, mwIndex i, mxArray *value)
+{
+	mxDestroyArray(pa->children[i]);
+	pa->children[i] = value;
+}
+
+mxArray *mxGetCell(const mxArray *pa, mwIndex i)
+{
+	return pa->children[i];
+}
+
+void *mxCalloc(size_t n, size_t size)
+{
+	countAlloc(n * size);
+	return calloc(n == 0 ? 1 : n, size == 0 ? 1 : size);
+}
+
+void *mxMalloc(size_t n)
+{
+	countAlloc(n);
+	return malloc(n == 0 ? 1 : n);
+}
+
+void *mxRealloc(void *ptr, size_t size)
+{
+	countAlloc(size);
+	return realloc(ptr, size == 0 ? 1 : size);
+}
+
+void mxFree(void *ptr)
+{
+	free(ptr);
+}
+
+double mxGetNaN(void)
+{
+	return numeric_limits<double>::quiet_NaN();
+}
+
+double mxGetInf(void)
+{
+	return numeric_limits<double>::infinity();
+}
+
+bool mxIsNaN(double value)
+{
+	return value != value;
+}
+
+mxArray *mxCreateSharedDataCopy(const mxArray *pr)
+{
+	mxArray *pa = new mxArray_tag(*pr);
+	pa->children.clear();
+	return pa;
+}
+
+void mexErrMsgIdAndTxt(const char *identifier, const char *err_msg, ...)
+{
+	char buf[1024];
+	va_list args;
+	va_start(args, err_msg);
+	vsnprintf(buf, sizeof(buf), err_msg, args);
+	va_end(args);
+	throw mexShimError(identifier, buf);
+}
+
+void mexErrMsgTxt(const char *err_msg)
+{
+	throw mexShimError("", err_msg);
+}
+
+void mexWarnMsgIdAndTxt(const char *, const char *warn_msg, ...)
+{
+	va_list args;
+	va_start(args, warn_msg);
+	fprintf(stderr, "Warning: ");
+	vfprintf(stderr, warn_msg, args);
+	fprintf(stderr, "\n");
+	va_end(args);
+}
+
+void mexWarnMsgTxt(const char *warn_msg)
+{
+	fprintf(stderr, "Warning: %s\n", warn_msg);
+}
+
+int mexPrintf(const char *fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	int ret = vprintf(fmt, args);
+	va_end(args);
+	return ret;
+}
+
+void mexMakeMemoryPersistent(void *) {}
+void mexMakeArrayPersistent(mxArray *) {}
+int mexAtExit(void (*)(void)) { return 0; }
+void mexLock(void) {}
+void mexUnlock(void) {}
+
+} // extern "C"
+
+mxArray *mexShimCreateFromData(const double *data, mwSize m, mwSize n)
+{
+	mxArray *pa = mxCreateDoubleMatrix(m, n, mxREAL);
+	if (m * n > 0)
+		memcpy(mxGetPr(pa), data, m * n * sizeof(double));
+	return pa;
+}
@@ -0,0 +1,110 @@
+// mex.h (shim)
+//
+// Stand-in for the Matlab external interface so the MEX kernels can be compiled
+// and exercised natively. Only the subset of the mx / mex API used by the
+// openAlgo kernels is provided. Errors raised through mexErrMsgIdAndTxt are
+// thrown as mexShimError rather than returning control to Matlab.
+
+#ifndef MEX_SHIM_H
+#define MEX_SHIM_H
+
+#include <cstddef>
+#include <cstdint>
+
+typedef size_t mwSize;
+typedef size_t mwIndex;
+typedef char16_t mxChar;
+typedef struct mxArray_tag mxArray;
+
+typedef enum
+{
+	mxUNKNOWN_CLASS = 0, mxCELL_CLASS, mxSTRUCT_CLASS, mxLOGICAL_CLASS, mxCHAR_CLASS, mxVOID_CLASS,
+	mxDOUBLE_CLASS, mxSINGLE_CLASS, mxINT8_CLASS, mxUINT8_CLASS, mxINT16_CLASS, mxUINT16_CLASS,
+	mxINT32_CLASS, mxUINT32_CLASS, mxINT64_CLASS, mxUINT64_CLASS, mxFUNCTION_CLASS
+} mxClassID;
+
+typedef enum { mxREAL = 0, mxCOMPLEX } mxComplexity;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	// Creation & destruction
+	mxArray *mxCreateDoubleMatrix(mwSize m, mwSize n, mxComplexity flag);
+	mxArray *mxCreateDoubleScalar(double value);
+	mxArray *mxCreateNumericMatrix(mwSize m, mwSize n, mxClassID classid, mxComplexity flag);
+	mxArray *mxCreateNumericArray(mwSize ndim, const mwSize *dims, mxClassID classid, mxComplexity flag);
+	mxArray *mxCreateString(const char *str);
+	mxArray *mxCreateStructMatrix(mwSize m, mwSize n, int nfields, const char **fieldnames);
+	mxArray *mxCreateCellMatrix(mwSize m, mwSize n);
+	mxArray *mxDuplicateArray(const mxArray *pa);
+	void mxDestroyArray(mxArray *pa);
+
+	// Inspection
+	double *mxGetPr(const mxArray *pa);
+	void *mxGetData(const mxArray *pa);
+	mwSize mxGetM(const mxArray *pa);
+	mwSize mxGetN(const mxArray *pa);
+	mwSize mxGetNumberOfDimensions(const mxArray *pa);
+	const mwSize *mxGetDimensions(const mxArray *pa);
+	mwSize mxGetNumberOfElements(const mxArray *pa);
+	mxClassID mxGetClassID(const mxArray *pa);
+	size_t mxGetElementSize(const mxArray *pa);
+	bool mxIsComplex(const mxArray *pa);
+	bool mxIsSparse(const mxArray *pa);
+	bool mxIsDouble(const mxArray *pa);
+	bool mxIsChar(const mxArray *pa);
+	bool mxIsStruct(const mxArray *pa);
+	bool mxIsCell(const mxArray *pa);
+	bool mxIsInt8(const mxArray *pa);
+	bool mxIsInt16(const mxArray *pa);
+	bool mxIsInt32(const mxArray *pa);
+	bool mxIsUint64(const mxArray *pa);
+	bool mxIsEmpty(const mxArray *pa);
+	double mxGetScalar(const mxArray *pa);
+	int mxGetString(const mxArray *pa, char *buf, mwSize buflen);
+	char *mxArrayToString(const mxArray *pa);
+
+	// Struct & cell access
+	void mxSetField(mxArray *pa, mwIndex i, const char *fieldname, mxArray *value);
+	mxArray *mxGetField(const mxArray *pa, mwIndex i, const char *fieldname);
+	int mxGetNumberOfFields(const mxArray *pa);
+	const char *mxGetFieldNameByNumber(const mxArray *pa, int n);
+	void mxSetCell(mxArray *pa, mwIndex i, mxArray *value);
+	mxArray *mxGetCell(const mxArray *pa, mwIndex i);
+
+	// Memory
+	void *mxCalloc(size_t n, size_t size);
+	void *mxMalloc(size_t n);
+	void *mxRealloc(void *ptr, size_t size);
+	void mxFree(void *ptr);
+
+	// Numerics
+	double mxGetNaN(void);
+	double mxGetInf(void);
+	bool mxIsNaN(double value);
+
+	// Undocumented
+	mxArray *mxCreateSharedDataCopy(const mxArray *pr);
+
+	// Gateway services
+	void mexErrMsgIdAndTxt(const char *identifier, const char *err_msg, ...);
+	void mexErrMsgTxt(const char *err_msg);
+	void mexWarnMsgIdAndTxt(const char *identifier, const char *warn_msg, ...);
+	void mexWarnMsgTxt(const char *warn_msg);
+	int mexPrintf(const char *fmt, ...);
+	void mexMakeMemoryPersistent(void *ptr);
+	void mexMakeArrayPersistent(mxArray *pa);
+	int mexAtExit(void (*exit_fcn)(void));
+	void mexLock(void);
+	void mexUnlock(void);
+
+	// Entry point every kernel provides
+	void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEX_SHIM_H
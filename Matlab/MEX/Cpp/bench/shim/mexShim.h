@@ -0,0 +1,34 @@
+// mexShim.h
+//
+// Native-only helpers layered over the mex.h shim. These are not part of the
+// Matlab API and are only visible to harness code such as the benchmarks.
+
+#ifndef MEX_SHIM_EXTRAS_H
+#define MEX_SHIM_EXTRAS_H
+
+#include "mex.h"
+#include <stdexcept>
+#include <string>
+
+// Raised in place of returning control to Matlab from mexErrMsgIdAndTxt
+class mexShimError : public std::runtime_error
+{
+public:
+	mexShimError(const std::string &id, const std::string &msg) : std::runtime_error(msg), identifier(id) {}
+	std::string identifier;
+};
+
+// Running totals of mx heap activity since the last reset
+typedef struct mexShimAllocStats
+{
+	long long allocations;		// Number of mxArray and mxMalloc / mxCalloc allocations
+	long long bytes;		// Bytes requested by those allocations
+} mexShimAllocStats;
+
+mexShimAllocStats mexShimGetAllocStats();
+void mexShimResetAllocStats();
+
+// Convenience creators for test data
+mxArray *mexShimCreateFromData(const double *data, mwSize m, mwSize n);
+
+#endif // MEX_SHIM_EXTRAS_H
@@ -0,0 +1,208 @@
+// stressConcurrent.cpp
+//
+// Concurrency check of the reentrant kernel cores (numTicksProfitStats, rsiColumn and the streaming rsiPush).
+// A serial reference is taken for every case, the numTicksProfit one through its mexFunction, and thousands of
+// calls are then run from several threads at once.  Every concurrent result must equal its serial reference exactly.
+//
+//	./build/stressConcurrent [--calls n] [--threads n] [--bars n]
+
+#include "mex.h"
+#include "mexShim.h"
+#include "benchUtil.h"
+#include "plLedger.h"
+#include "profitTarget.h"
+#include "rsiCalc.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+#define STRESS_TARGETS 8			// numTicks = 1:STRESS_TARGETS per call
+#define STRESS_LOOKBACKS 3			// RSI lookbacks per call
+
+static const double s_lookbacks[STRESS_LOOKBACKS] = {2, 14, 50};
+
+// Inputs and serial results of one case
+typedef struct stressCase
+{
+	vector<double> ohlc;
+	vector<double> sig;
+	double openAvg;
+	vector<double> stats;			// sharpe | maxDD | profitFactor | numTrades | winRate per target
+	vector<double> rsi;			// rows per lookback
+} stressCase;
+
+static void flattenStats(const vector<plStats> &tgtStats, vector<double> &flat)
+{
+	flat.clear();
+	for (size_t tgt = 0; tgt < tgtStats.size(); tgt++)
+	{
+		flat.push_back(plSharpe(tgtStats[tgt]));
+		flat.push_back(tgtStats[tgt].maxDD);
+		flat.push_back(plProfitFactor(tgtStats[tgt]));
+		flat.push_back(tgtStats[tgt].numTrades);
+		flat.push_back(plWinRate(tgtStats[tgt]));
+	}
+}
+
+// Bitwise equality so that matching NaNs compare equal
+static bool sameBits(const vector<double> &a, const vector<double> &b)
+{
+	return a.size() == b.size() && (a.empty() || memcmp(&a[0], &b[0], a.size() * sizeof(double)) == 0);
+}
+
+// numTicksProfit('pl',...,'stats') through the MEX gateway
+static bool mexStats(const stressCase &sc, size_t rows, const vector<double> &numTicks, vector<double> &flat)
+{
+	mxArray *prhs[9];
+	prhs[0] = mxCreateString("pl");
+	prhs[1] = benchArray(&sc.ohlc[0], rows, 4);
+	prhs[2] = benchArray(&sc.sig[0], rows, 1);
+	prhs[3] = mxCreateDoubleScalar(0.25);
+	prhs[4] = benchArray(&numTicks[0], 1, numTicks.size());
+	prhs[5] = mxCreateDoubleScalar(sc.openAvg);
+	prhs[6] = mxCreateDoubleScalar(50);
+	prhs[7] = mxCreateDoubleScalar(2.5);
+	prhs[8] = mxCreateString("stats");
+
+	mxArray *plhs[1] = {NULL};
+	bool ok = true;
+
+	try
+	{
+		mexFunction(1, plhs, 9, (const mxArray**)prhs);
+
+		const char *fieldNames[] = {"sharpe", "maxDD", "profitFactor", "numTrades", "winRate"};
+		flat.assign(numTicks.size() * 5, 0);
+		for (int ff = 0; ff < 5; ff++)
+		{
+			const double *fieldPtr = mxGetPr(mxGetField(plhs[0], 0, fieldNames[ff]));
+			for (size_t tgt = 0; tgt < numTicks.size(); tgt++)
+				flat[tgt * 5 + ff] = fieldPtr[tgt];
+		}
+		mxDestroyArray(plhs[0]);
+	}
+	catch (const mexShimError &err)
+	{
+		fprintf(stderr, "Kernel error %s: %s\n", err.identifier.c_str(), err.what());
+		ok = false;
+	}
+
+	for (int ii = 0; ii < 9; ii++)
+		mxDestroyArray(prhs[ii]);
+
+	return ok;
+}
+
+// One concurrent call of each core.  Returns the number of results that differ from the serial reference
+static int runCase(const stressCase &sc, size_t rows, const vector<double> &numTicks)
+{
+	int mismatches = 0;
+	vector<plStats> tgtStats;
+	vector<double> flat;
+	double badSig = 0;
+
+	if (numTicksProfitStats(&sc.ohlc[0], &sc.sig[0], int(rows), 0.25, &numTicks[0], int(numTicks.size()),
+		sc.openAvg, 50, 2.5, tgtStats, badSig) != 0)
+		mismatches++;
+	else
+	{
+		flattenStats(tgtStats, flat);
+		mismatches += !sameBits(flat, sc.stats);
+	}
+
+	vector<double> rsi(rows * STRESS_LOOKBACKS);
+	for (int lb = 0; lb < STRESS_LOOKBACKS; lb++)
+		rsiColumn(&sc.ohlc[rows * 3], int(rows), int(s_lookbacks[lb]), &rsi[rows * lb]);
+	mismatches += !sameBits(rsi, sc.rsi);
+
+	// Streaming states are private to the caller and must reproduce the batch columns
+	for (int lb = 0; lb < STRESS_LOOKBACKS; lb++)
+	{
+		rsiState st;
+		rsiInit(st, int(s_lookbacks[lb]), 0);
+		for (size_t ii = 0; ii < rows; ii++)
+			rsi[rows * lb + ii] = rsiPush(st, sc.ohlc[rows * 3 + ii]);
+	}
+	mismatches += !sameBits(rsi, sc.rsi);
+
+	return mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+	int calls = 4000;
+	int numThreads = int(thread::hardware_concurrency());
+	size_t rows = 2000;
+
+	for (int ii = 1; ii + 1 < argc; ii += 2)
+	{
+		if (strcmp(argv[ii], "--calls") == 0)
+			calls = atoi(argv[ii + 1]);
+		else if (strcmp(argv[ii], "--threads") == 0)
+			numThreads = atoi(argv[ii + 1]);
+		else if (strcmp(argv[ii], "--bars") == 0)
+			rows = size_t(atof(argv[ii + 1]));
+	}
+
+	if (argc % 2 == 0 || calls < 1 || rows < 100)
+	{
+		fprintf(stderr, "Usage: %s [--calls n] [--threads n] [--bars n]\n", argv[0]);
+		return 2;
+	}
+	if (numThreads < 4)
+		numThreads = 4;
+
+	vector<double> numTicks(STRESS_TARGETS);
+	for (int tgt = 0; tgt < STRESS_TARGETS; tgt++)
+		numTicks[tgt] = tgt + 1;
+
+	// Serial references: every signal pattern with atomic and averaged profit taking
+	vector<stressCase> cases(SIG_NUM_PATTERNS * 2);
+	for (size_t cc = 0; cc < cases.size(); cc++)
+	{
+		stressCase &sc = cases[cc];
+		makeOHLC(rows, 20130101 + unsigned(cc), 0.25, sc.ohlc);
+		makeSignal(rows, int(cc % SIG_NUM_PATTERNS), 20130101 + unsigned(cc), sc.sig);
+		sc.openAvg = double(cc / SIG_NUM_PATTERNS);
+
+		if (!mexStats(sc, rows, numTicks, sc.stats))
+			return 1;
+
+		sc.rsi.assign(rows * STRESS_LOOKBACKS, 0);
+		for (int lb = 0; lb < STRESS_LOOKBACKS; lb++)
+			rsiColumn(&sc.ohlc[rows * 3], int(rows), int(s_lookbacks[lb]), &sc.rsi[rows * lb]);
+
+		// The pure C++ entry point must agree with the gateway before any threads are started
+		if (runCase(sc, rows, numTicks) != 0)
+		{
+			fprintf(stderr, "Serial numTicksProfitStats differs from numTicksProfit for case %zu\n", cc);
+			return 1;
+		}
+	}
+
+	// Concurrent calls.  Threads take the next call from a shared counter so the cases interleave
+	atomic<int> nextCall(0);
+	atomic<int> mismatches(0);
+	vector<thread> pool;
+
+	for (int tt = 0; tt < numThreads; tt++)
+	{
+		pool.push_back(thread([&]()
+		{
+			for (int call = nextCall++; call < calls; call = nextCall++)
+				mismatches += runCase(cases[call % cases.size()], rows, numTicks);
+		}));
+	}
+	for (size_t tt = 0; tt < pool.size(); tt++)
+		pool[tt].join();
+
+	printf("stressConcurrent: %d calls of numTicksProfitStats (%d targets) and rsiColumn / rsiPush (%d lookbacks) on %d threads, %zu bars: %d mismatches\n",
+		calls, STRESS_TARGETS, STRESS_LOOKBACKS, numThreads, rows, mismatches.load());
+
+	return mismatches.load() == 0 ? 0 : 1;
+}
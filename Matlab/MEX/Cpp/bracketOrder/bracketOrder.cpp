@@ -0,0 +1,405 @@
+// bracketOrder.cpp
+//
+// nlhs Number of output variables nargout 
+// plhs Array of mxArray pointers to the output variables varargout
+// nrhs Number of input variables nargin
+// prhs Array of mxArray pointers to the input variables varargin
+//
+// Matlab MEX function:
+// [barsOut,sigOut] = bracketOrder(barsIn,sigIn,minTick,profitTicks,stopTicks,trailTicks)
+//
+// Fused bracket and P&L usage:
+// [cash,openEQ,netLiq,returns,barsOut,sigOut] = bracketOrder('pl',barsIn,sigIn,minTick,profitTicks,stopTicks,trailTicks,bigPoint,cost)
+// [stats,sigOut] = bracketOrder('pl',barsIn,sigIn,minTick,profitTicks,stopTicks,trailTicks,bigPoint,cost,'stats')
+// 
+// Inputs:
+//		barsIn		A matrix array of prices in the form of Open | High | Low | Close
+//		sigIn		An 1-D array the same length as barsIn, which gives the quantity bought or sold on a given bar
+//		minTick		Double representing the per contract minimum tick increment
+//		profitTicks	Double representing the number of ticks beyond the entry price to take a profit (0 = no profit target)
+//		stopTicks	Double representing the number of ticks against the entry price to stop out (0 = no stop)
+//		trailTicks	Double representing the number of ticks the stop trails the most favourable price (0 = no trailing stop)
+//				With 'stats' each of profitTicks, stopTicks and trailTicks may be a vector of T brackets.
+//				Scalars apply to every bracket
+//		bigPoint	('pl' only) Double representing the full tick dollar value of the contract being P&L'd
+//		cost		('pl' only) Double representing the per contract commission
+//		'stats'		('pl' only) Return summary statistics of each bracket in place of the per bar arrays
+//
+// Outputs:
+//		barsOut		A 2-D array of prices with the addition of a virtual bar at each exit price in the form of Open | High | Low | Close
+//		sigOut		An array the same length as barsOut which includes the exit signals
+//
+//		cash, openEQ, netLiq, returns	('pl' only) The P&L of barsOut and sigOut as given by calcProfitLoss(barsOut,sigOut,bigPoint,cost)
+//
+//		stats		('stats' only) A struct of 1 x T fields, one per bracket, as calcProfitLoss(...,'stats')
+//				of each bracket's barsOut and sigOut:  sharpe | maxDD | profitFactor | numTrades | winRate
+//		sigOut		('stats' only) (Optional) A 1 x T cell array of each bracket's expanded signal
+//
+//	NOTE: The profit target, stop and trailing stop are evaluated together on each bar for every open line item and
+//		their exits are merged in to one signal and virtual bar stream.  A gap through a level exits at the Open.
+//		A bar reaching both the stop and the target is taken to have reached the stop first.  On the bar of entry
+//		a level must be exceeded rather than touched, as in numTicksProfit.  See bracketLedger.h
+//		mex bracketOrder.cpp bracketLedger.cpp profitTarget.cpp myMath.cpp plLedger.cpp
+//
+//	NOTE: An exit rule sweep is evaluated in one call.  All brackets are advanced on a bar before the next bar is read,
+//		once to find the exits and once to P&L the expanded rows.
+//
+// NOTES	We will assume the following standard:	+/- 1 lot is additive	+/- 2 lots is a reverse
+//		This is the version that should be used with a SIGNAL input.
+//
+
+#include "mex.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "plLedger.h"
+#include "profitTarget.h"
+#include "bracketLedger.h"
+
+using namespace std;
+
+// Prototypes
+bool isOption(const mxArray *option_IN, const char *name);
+void checkCommand(const mxArray *command_IN);
+mxArray *createStatsStruct(const vector<plStats> &tgtStats);
+
+// Macros
+#define isReal2Dfull(P) (!mxIsComplex(P) && mxGetNumberOfDimensions(P) == 2 && !mxIsSparse(P))
+#define isReal2DfullDouble(P) (isReal2Dfull(P) && mxIsDouble(P))
+#define isRealScalar(P) (isReal2DfullDouble(P) && mxGetNumberOfElements(P) == 1)
+#define isRealVector(P) (isReal2DfullDouble(P) && mxGetNumberOfElements(P) >= 1 && (mxGetM(P) == 1 || mxGetN(P) == 1))
+
+void mexFunction(int nlhs, mxArray *plhs[], /* Output variables */
+				 int nrhs, const mxArray *prhs[]) /* Input variables */
+{
+	// The fused bracket and P&L command is given as a leading string
+	const bool plMode = (nrhs > 0 && mxIsChar(prhs[0]));
+	if (plMode)
+		checkCommand(prhs[0]);
+
+	const int arg0 = plMode ? 1 : 0;			// Index of 'barsIn'
+	const int barsOutIdx = plMode ? 4 : 0;			// Index of 'barsOut'.  'sigOut' follows
+
+	// Check number of inputs.  'pl' may be followed by 'stats'
+	if (nrhs != (plMode ? 9 : 6) && !(plMode && nrhs == 10))
+		mexErrMsgIdAndTxt( "MATLAB:bracketOrder:NumInputs",
+		"Number of input arguments is not correct. Aborting.");
+
+	if (plMode && nrhs == 10 && !isOption(prhs[9], "stats"))
+		mexErrMsgIdAndTxt( "MATLAB:bracketOrder:UnknownOption",
+		"The only option of 'pl' is 'stats'. Aborting.");
+
+	const bool statsMode = (plMode && nrhs == 10);
+
+	// Check number of output assignments
+	if (statsMode ? (nlhs > 2) : plMode ? (nlhs < 4 || nlhs > 6) : (nlhs != 2))
+		mexErrMsgIdAndTxt( "MATLAB:bracketOrder:NumOutputs",
+		"Number of output assignments is not correct. Aborting.");
+
+	// Define constants (#define assigns a variable as either a constant or a macro)
+	// Inputs
+#define bars_IN		prhs[arg0]
+#define sig_IN		prhs[arg0 + 1]
+#define minTick_IN	prhs[arg0 + 2]
+#define profitTicks_IN	prhs[arg0 + 3]
+#define stopTicks_IN	prhs[arg0 + 4]
+#define trailTicks_IN	prhs[arg0 + 5]
+#define bigPoint_IN	prhs[arg0 + 6]
+#define cost_IN		prhs[arg0 + 7]
+	// Outputs
+#define bars_OUT	plhs[barsOutIdx]
+#define sig_OUT		plhs[barsOutIdx + 1]
+#define cash_OUT	plhs[0]
+#define openEQ_OUT	plhs[1]
+#define netLiq_OUT	plhs[2]
+#define returns_OUT	plhs[3]
+#define stats_OUT	plhs[0]
+#define tgtSig_OUT	plhs[1]
+
+	// Init variables
+	double  *barsOutPtr = NULL, *sigOutPtr = NULL;
+	double *cashPtr = NULL, *openEQPtr = NULL, *netLiqPtr = NULL, *returnsPtr = NULL;
+	double bigPoint = 0, cost = 0;
+
+	// Check type of supplied inputs
+	if (!isReal2DfullDouble(bars_IN) || mxGetN(bars_IN) != 4)
+		mexErrMsgIdAndTxt( "MATLAB:bracketOrder:BadInputType",
+		"Input 'barsIn' must be a 2 dimensional full double array of type Open | High | Low | Close. Aborting.");
+
+	if (!isReal2DfullDouble(sig_IN) || mxGetN(sig_IN) > 1)
+		mexErrMsgIdAndTxt( "MATLAB:bracketOrder:BadInputType",
+		"Input 'sigIn' must be a single column double array. Aborting.");
+
+	if (mxGetM(bars_IN) != mxGetM(sig_IN))
+		mexErrMsgIdAndTxt( "MATLAB:bracketOrder:ArrayMismatch",
+		"The number of rows in the price array and the signal array are different. Aborting.");
+
+	if (!isRealScalar(minTick_IN) || mxGetScalar(minTick_IN) < 0)
+		mexErrMsgIdAndTxt( "MATLAB:bracketOrder:BadInputType",
+		"Input 'minTick' must be a double scalar greater than or equal to zero. Aborting.");
+
+	// Tick distances are scalars, or with 'stats' vectors of a common length T
+	const mxArray *ticks_IN[3] = {profitTicks_IN, stopTicks_IN, trailTicks_IN};
+	mwSize numBrackets = 1;
+
+	for (int leg = 0; leg < 3; leg++)
+	{
+		if (!(statsMode ? isRealVector(ticks_IN[leg]) : isRealScalar(ticks_IN[leg])))
+			mexErrMsgIdAndTxt( "MATLAB:bracketOrder:BadInputType",
+			"Inputs 'profitTicks', 'stopTicks' and 'trailTicks' must be double scalars (or vectors with 'stats'). Aborting.");
+
+		const mwSize numTicks = mxGetNumberOfElements(ticks_IN[leg]);
+		if (numTicks > 1 && numBrackets > 1 && numTicks != numBrackets)
+			mexErrMsgIdAndTxt( "MATLAB:bracketOrder:ArrayMismatch",
+			"Vectors of 'profitTicks', 'stopTicks' and 'trailTicks' must be the same length. Aborting.");
+
+		numBrackets = max(numBrackets, numTicks);
+
+		const double *ticksPtr = mxGetPr(ticks_IN[leg]);
+		for (mwSize ii = 0; ii < numTicks; ii++)
+		{
+			if (!(ticksPtr[ii] >= 0))
+				mexErrMsgIdAndTxt( "MATLAB:bracketOrder:BadInputType",
+				"Tick distances must be greater than or equal to zero. Aborting.");
+		}
+	}
+
+	if (plMode && (!isRealScalar(bigPoint_IN) || !isRealScalar(cost_IN)))
+		mexErrMsgIdAndTxt( "MATLAB:bracketOrder:BadInputType",
+		"Inputs 'bigPoint' and 'cost' must be single scalar doubles. Aborting.");
+
+	/* Assign scalar values */
+	const mwSize rowsPrice = mxGetM(bars_IN);
+	const double minTick = mxGetScalar(minTick_IN);
+
+	if (plMode)
+	{
+		bigPoint =	mxGetScalar(bigPoint_IN);
+		cost =		mxGetScalar(cost_IN);
+	}
+
+	// START //
+	const profitContext ctx = createProfitContext(mxGetPr(bars_IN), mxGetPr(sig_IN), int(rowsPrice), minTick, 0);
+
+	// A scalar distance applies to every bracket
+	vector<bracketState> brackets(numBrackets);
+	for (mwSize br = 0; br < numBrackets; br++)
+	{
+		double tgt[3];
+		for (int leg = 0; leg < 3; leg++)
+		{
+			tgt[leg] = minTick * mxGetPr(ticks_IN[leg])[mxGetNumberOfElements(ticks_IN[leg]) > 1 ? br : 0];
+		}
+		initBracket(brackets[br], tgt[0], tgt[1], tgt[2]);
+	}
+
+	double badSig = 0;
+	if (findExits(ctx, brackets, badSig) != 0)
+		mexErrMsgIdAndTxt( "MATLAB:AdvancedSignal:fractionUnknown",
+			"A signal contained an advanced fractional instruction %f that we could not interpret. Aborting.", badSig);
+
+	/////////////
+	//
+	// OUTPUT PROCESSING
+	//
+	/////////////
+	if (statsMode)
+	{
+		// Per bracket summaries and, if asked for, the expanded signal of each bracket
+		vector<plStats> tgtStats(numBrackets);
+		vector<double*> tgtSigPtrs(numBrackets, (double*)NULL);
+		vector<const vector<profitEntry>*> ledgers(numBrackets);
+
+		for (mwSize br = 0; br < numBrackets; br++)
+		{
+			ledgers[br] = &brackets[br].exitLedger;
+		}
+
+		if (nlhs > 1)
+		{
+			tgtSig_OUT = mxCreateCellMatrix(1, numBrackets);
+			for (mwSize br = 0; br < numBrackets; br++)
+			{
+				mxArray *sigCol = mxCreateDoubleMatrix(rowsPrice + ledgers[br]->size(), 1, mxREAL);
+				tgtSigPtrs[br] = mxGetPr(sigCol);
+				mxSetCell(tgtSig_OUT, br, sigCol);
+			}
+		}
+
+		if (statsLedgers(ctx, ledgers, bigPoint, cost, tgtStats, tgtSigPtrs, badSig) != 0)
+			mexErrMsgIdAndTxt( "MATLAB:AdvancedSignal:fractionUnknown",
+				"A signal contained an advanced fractional instruction %f that we could not interpret. Aborting.", badSig);
+
+		stats_OUT = createStatsStruct(tgtStats);
+		return;
+	}
+
+	// A single bracket
+	const vector<profitEntry> &exitLedger = brackets[0].exitLedger;
+	const mwSize numNewRows = rowsPrice + (mwSize)exitLedger.size();	// Original rows plus the virtual exit rows
+
+	// Expanded bars and signals are only built when they are asked for ('pl' may leave them out)
+	if (exitLedger.empty())
+	{
+		// Return what we were given
+		if (nlhs > barsOutIdx)
+			bars_OUT = mxDuplicateArray(bars_IN);
+		if (nlhs > barsOutIdx + 1)
+			sig_OUT = mxDuplicateArray(sig_IN);
+	}
+	else
+	{
+		if (nlhs > barsOutIdx)
+		{
+			bars_OUT = mxCreateDoubleMatrix(numNewRows, 4, mxREAL);
+			barsOutPtr = mxGetPr(bars_OUT);
+		}
+		if (nlhs > barsOutIdx + 1)
+		{
+			sig_OUT = mxCreateDoubleMatrix(numNewRows, 1, mxREAL);
+			sigOutPtr = mxGetPr(sig_OUT);
+		}
+	}
+
+	if (plMode)
+	{
+		cash_OUT = mxCreateDoubleMatrix(numNewRows, 1, mxREAL);
+		openEQ_OUT = mxCreateDoubleMatrix(numNewRows, 1, mxREAL);
+		netLiq_OUT = mxCreateDoubleMatrix(numNewRows, 1, mxREAL);
+		returns_OUT = mxCreateDoubleMatrix(numNewRows, 1, mxREAL);
+
+		cashPtr = mxGetPr(cash_OUT);
+		openEQPtr = mxGetPr(openEQ_OUT);
+		netLiqPtr = mxGetPr(netLiq_OUT);
+		returnsPtr = mxGetPr(returns_OUT);
+	}
+
+	// Merge the original rows and the virtual exit rows in bar order straight in to the requested outputs
+	if (barsOutPtr != NULL || sigOutPtr != NULL || cashPtr != NULL)
+	{
+		if (expandRows(ctx, exitLedger, numNewRows, barsOutPtr, sigOutPtr, bigPoint, cost,
+			cashPtr, openEQPtr, netLiqPtr, returnsPtr, badSig) != 0)
+			mexErrMsgIdAndTxt( "MATLAB:AdvancedSignal:fractionUnknown",
+				"A signal contained an advanced fractional instruction %f that we could not interpret. Aborting.", badSig);
+	}
+
+	return;
+}
+
+/////////////
+//
+// FUNCTIONS & METHODS
+//
+/////////////
+
+// Case insensitive match of a string input
+bool isOption(const mxArray *option_IN, const char *name)
+{
+	if (!mxIsChar(option_IN))
+		return false;
+
+	int optNumChars = (int)mxGetN(option_IN)+1;		// +1 for the NULL added at the end
+	char *optAsChars = (char*)mxCalloc(optNumChars, sizeof(char));
+
+	if (mxGetString(option_IN, optAsChars, optNumChars) != 0)
+		mexErrMsgIdAndTxt( "MATLAB:bracketOrder:Parsing",
+		"Could not parse the given option. Aborting.");
+
+	string opt(optAsChars);
+	transform(opt.begin(), opt.end(), opt.begin(), ::tolower);
+	mxFree(optAsChars);
+
+	return opt == name;
+}
+
+// Accept only the commands bracketOrder understands
+void checkCommand(const mxArray *command_IN)
+{
+	if (!isOption(command_IN, "pl"))
+		mexErrMsgIdAndTxt( "MATLAB:bracketOrder:UnknownCommand",
+		"Unknown command. The only command is 'pl'. Aborting.");
+}
+
+// Build the 'stats' output with one column per bracket
+mxArray *createStatsStruct(const vector<plStats> &tgtStats)
+{
+	const char *fieldNames[] = {"sharpe", "maxDD", "profitFactor", "numTrades", "winRate"};
+	const int numFields = sizeof(fieldNames) / sizeof(fieldNames[0]);
+	const mwSize numBrackets = tgtStats.size();
+
+	mxArray *stats = mxCreateStructMatrix(1, 1, numFields, fieldNames);
+	double *fieldPtr[numFields];
+
+	for (int ff = 0; ff < numFields; ff++)
+	{
+		mxArray *field = mxCreateDoubleMatrix(1, numBrackets, mxREAL);
+		fieldPtr[ff] = mxGetPr(field);
+		mxSetField(stats, 0, fieldNames[ff], field);
+	}
+
+	for (mwSize br = 0; br < numBrackets; br++)
+	{
+		fieldPtr[0][br] = plSharpe(tgtStats[br]);
+		fieldPtr[1][br] = tgtStats[br].maxDD;
+		fieldPtr[2][br] = plProfitFactor(tgtStats[br]);
+		fieldPtr[3][br] = tgtStats[br].numTrades;
+		fieldPtr[4][br] = plWinRate(tgtStats[br]);
+	}
+
+	return stats;
+}
+
+//
+//  -------------------------------------------------------------------------
+//                                  _    _ 
+//         ___  _ __   ___ _ __    / \  | | __ _  ___   ___  _ __ __ _ 
+//        / _ \| '_ \ / _ \ '_ \  / _ \ | |/ _` |/ _ \ / _ \| '__/ _` |
+//       | (_) | |_) |  __/ | | |/ ___ \| | (_| | (_) | (_) | | | (_| |
+//        \___/| .__/ \___|_| |_/_/   \_\_|\__, |\___(_)___/|_|  \__, |
+//             |_|                         |___/                 |___/
+//  -------------------------------------------------------------------------
+//        This code is distributed in the hope that it will be useful,
+//
+//                      	 WITHOUT ANY WARRANTY
+//
+//                  WITHOUT CLAIM AS TO MERCHANTABILITY
+//
+//                  OR FITNESS FOR A PARTICULAR PURPOSE
+//
+//                           expressed or implied.
+//
+//   Use of this code, pseudocode, algorithmic or trading logic contained
+//   herein, whether sound or faulty for any purpose is the sole
+//   responsibility of the USER. Any such use of these algorithms, coding
+//   logic or concepts in whole or in part carry no covenant of correctness
+//   or recommended usage from the AUTHOR or any of the possible
+//   contributors listed or unlisted, known or unknown.
+//
+//   Any reference of this code or to this code including any variants from
+//   this code, or any other credits due this AUTHOR from this code shall be
+//   clearly and unambiguously cited and evident during any use, whether in
+//   whole or in part.
+//
+//   The public sharing of this code does not relinquish, reduce, restrict or
+//   encumber any rights the AUTHOR has in respect to claims of intellectual
+//   property.
+//
+//   IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY
+//   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//   DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+//   OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+//   HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+//   STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+//   ANY WAY OUT OF THE USE OF THIS SOFTWARE, CODE, OR CODE FRAGMENT(S), EVEN
+//   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//   -------------------------------------------------------------------------
+//
+//                             ALL RIGHTS RESERVED
+//
+//   -------------------------------------------------------------------------
+//
+//   Author:	Mark Tompkins
+//   Copyright:	(c)2013
+//
@@ -8,12 +8,37 @@
 //
 // Matlab function:
 // [cash,openEQ,netLiq,returns] = calcProfitLoss(data,sig,bigPoint,cost)
+// stats = calcProfitLoss(data,sig,bigPoint,cost,'stats')
+// mets = calcProfitLoss(data,sig,bigPoint,cost,'mets',testPts)
+// [...] = calcProfitLoss(dataTicks,sig,bigPoint,cost,...,'tickSize',tickSize)
+// [...] = calcProfitLoss(data,sigX2,bigPoint,cost,...,'doubledSig')
+//
+// Streaming (live bar) usage:
+// h = calcProfitLoss('create',bigPoint,cost)
+// [cash,openEQ,netLiq,returns] = calcProfitLoss('update',h,data,sig)
+// calcProfitLoss('destroy',h)
+//
+// Portfolio usage:
+// [cash,openEQ,netLiq,returns,portNetLiq,portReturns] = calcProfitLoss('portfolio',open,close,sig,bigPoint,cost)
 // 
 // Inputs:
 //		data		A 2-D array of prices in the form of Open | Close
+//				May be given as int32 tick counts with 'tickSize' (price = ticks * tickSize)
+//				Results equal those of double 'data' holding ticks * tickSize.  Double prices that are only close to
+//				ticks * tickSize (e.g. the nearest double of 40.37 rather than 4037 * 0.01) may give different results,
+//				because the ledger compares some values exactly.  Binary tick sizes such as 0.25 are always exact
 //		sig		An array the same length as data, which gives the quantity bought or sold on a given bar.  Consider Matlab remEchosMEX
+//				A matrix of K columns may be given to P&L K independent signals against the same data in a single call
+//				May be given as int8 or int16.  Integer signals are read as given, e.g. int8(sig) where 1 buys 1,
+//				so the fractional instructions cannot be expressed unless 'doubledSig' is also given
 //		bigPoint	Double representing the full tick dollar value of the contract being P&L'd
 //		cost		Double representing the per contract commission
+//		'stats'		(Optional) Return only summary statistics accumulated during the ledger pass
+//		'mets'		(Optional) Return only the test / validation Sharpe ratios and METS score of a single ledger pass
+//		testPts		Number of leading bars in the test segment when 'mets' is given.  The remaining bars are the validation segment
+//		'tickSize'	(Optional) Followed by the price of one tick.  Required when 'data' is int32 ticks
+//		'doubledSig'	(Optional) An int8 or int16 'sig' holds TWICE the signal so the fractional instructions are representable
+//				e.g. int8(2 * sig) where 1.5 -> 3 and -0.5 -> -1.  Only applies to int8 or int16 'sig'
 //
 // Outputs:
 //		cash		A 2D array of cash debits and credits
@@ -21,6 +46,49 @@
 //		netLiq		A 2D array of aggregated cash transactions plus the current openEQ if any up to a given observation
 //		returns		A 2D array of bar to bar returns
 //
+//		Each output has one column per column of 'sig'.
+//
+//		stats		When 'stats' is given, a struct of 1 x K fields in place of the per bar arrays:
+//				sharpe		mean(returns) / std(returns) as Matlab sharpe(returns,0) (apply any scaling in Matlab)
+//				maxDD		Largest decline of netLiq from a prior peak
+//				profitFactor	Gross profit / gross loss of closing transactions
+//				numTrades	Number of bars with a closing transaction
+//				winRate		Fraction of closing bars with a positive cash result
+//
+//		mets		When 'mets' is given, a struct of 1 x K fields:
+//				sharpeTest	Sharpe ratio of the returns of bars 1 : testPts
+//				sharpeVal	Sharpe ratio of the returns of bars testPts+1 : end
+//				mets		(2 * sharpeTest + sharpeVal) / 3 as used by the *PARMETS optimizers (apply any scaling in Matlab)
+//
+//	NOTE: When 'sig' has more than one column the columns are processed in parallel if compiled with OpenMP
+//		e.g. mex calcProfitLoss.cpp myMath.cpp plLedger.cpp COMPFLAGS="$COMPFLAGS /openmp"
+//
+//	NOTE: 'mets' scores both segments from one pass over the full series so indicators are warm at the split.
+//		This differs from P&L'ing a separate validation slice from a cold start: a position open at the split
+//		is carried in to the validation segment and the first validation return is the change across the split.
+//
+//	NOTE: 'portfolio' P&Ls a basket of M instruments in one call. Each instrument's ledger is run on its own thread
+//		(if compiled with OpenMP) and the results are aggregated across instruments.
+//		open		An N x M panel of Open prices.  The instruments must be aligned on a common bar index
+//		close		An N x M panel of Close prices
+//		sig		An N x M panel of signals, one column per instrument
+//		bigPoint	A 1 x M vector of per instrument tick values (a scalar applies to every instrument)
+//		cost		A 1 x M vector of per instrument commissions (a scalar applies to every instrument)
+//		cash, openEQ, netLiq, returns	N x M per instrument results
+//		portNetLiq	N x 1 sum of netLiq across instruments
+//		portReturns	N x 1 sum of returns across instruments
+//
+//	NOTE: The streaming commands keep the open ledger between calls so that only newly closed bars are processed.
+//		'create'	Returns a handle to a new flat ledger
+//		'update'	Processes the bars appended since the last update. 'data' and 'sig' hold only the new rows.
+//				The last bar of the previous update is restated as the first output row, because its openEQ
+//				may be cleaned once the following bar is known. The first update has no restated row.
+//				Replacing the last row of the accumulated outputs with the returned rows reproduces the
+//				batch result for the same data.
+//				A signal that cannot be interpreted fails the whole update: the ledger is left as it was before
+//				the call, so the same rows may be sent again once corrected.
+//		'destroy'	Releases the ledger. All ledgers are released when the MEX is cleared.
+//
 //	NOTE: This function accepts both advanced (fractional) and standard SIGNAL inputs
 //
 //		By leveraging fractions as additional logic, we are able to construct more meaningful signals beyond the scope of a simple Buy or Sell of quantity X.
@@ -61,9 +129,12 @@
 //
 
 #include "mex.h"
-#include <deque>
-#include <cmath>
+#include <map>
+#include <vector>
+#include <algorithm>	// So we can transform the command string input ...
+#include <string>	// from char to string ensuring lowercase
 #include "myMath.h"
+#include "plLedger.h"
 
 // Declare external reference to undocumented C function
 #ifdef __cplusplus
@@ -80,22 +151,25 @@ extern "C"
 
 using namespace std;
 
-// Create a struct for convenience
-typedef struct tradeEntry
-{
-	int index;
-	int quantity;
-	double price;
-} tradeEntry;
-
 // Prototypes
-tradeEntry createLineEntry(int ID, int qty, double price);
-int sumQty(const deque<tradeEntry>& x);
-bool fraction(double num);
-bool knownAdvSig(double advSig);
+void plCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void plPortfolio(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+int parseOption(const mxArray *option_IN);
+mxArray *createStatsStruct(const vector<plStats> &colStats);
+mxArray *createMetsStruct(const vector<plStats> &testStats, const vector<plStats> &valStats);
+plState *getStream(const mxArray *handle_IN);
+static void clearStreams();
+
+// Trailing options
+enum plOption { OPT_NONE, OPT_STATS, OPT_METS, OPT_TICKSIZE, OPT_DOUBLEDSIG, OPT_UNKNOWN };
+
+// Streaming ledgers by handle
+static map<int, plState*> s_plStreams;
+static int s_plNextHandle = 1;
 
 // Macros
-#define isReal2DfullDouble(P) (!mxIsComplex(P) && mxGetNumberOfDimensions(P) == 2 && !mxIsSparse(P) && mxIsDouble(P))
+#define isReal2Dfull(P) (!mxIsComplex(P) && mxGetNumberOfDimensions(P) == 2 && !mxIsSparse(P))
+#define isReal2DfullDouble(P) (isReal2Dfull(P) && mxIsDouble(P))
 #define isRealScalar(P) (isReal2DfullDouble(P) && mxGetNumberOfElements(P) == 1)
 
 void mexFunction(int nlhs, mxArray *plhs[], /* Output variables */
@@ -110,12 +184,55 @@ void mexFunction(int nlhs, mxArray *plhs[], /* Output variables */
 	// mexWarnMsgTxt	Issue warning message
 	// mexPrintf("Hello, world!"); /* Do something interesting */
 
+	// Streaming and portfolio commands are given as a leading string
+	if (nrhs > 0 && mxIsChar(prhs[0]))
+	{
+		plCommand(nlhs, plhs, nrhs, prhs);
+		return;
+	}
+
 	// Check number of inputs
-	if (nrhs != 4)
+	if (nrhs < 4)
 		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:NumInputs",
 		"Number of input arguments is not correct. Aborting (116).");
 
-	if (nlhs != 4)
+	// Trailing options.  'stats' or 'mets' select summary statistics in place of the per bar arrays
+	int option = OPT_NONE;
+	const mxArray *testPts_IN = NULL;
+	const mxArray *tickSize_IN = NULL;
+	bool doubledSig = false;
+
+	for (int arg = 4; arg < nrhs; arg++)
+	{
+		int thisOption = parseOption(prhs[arg]);
+
+		if (thisOption == OPT_UNKNOWN)
+			mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:BadOption",
+			"The supported options are 'stats', 'mets', 'tickSize' and 'doubledSig'. Aborting.");
+
+		if ((thisOption == OPT_STATS || thisOption == OPT_METS) && option != OPT_NONE)
+			mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:BadOption",
+			"Only one of 'stats' or 'mets' may be given. Aborting.");
+
+		if ((thisOption == OPT_METS || thisOption == OPT_TICKSIZE) && arg + 1 >= nrhs)
+			mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:NumInputs",
+			"Usage is calcProfitLoss(data,sig,bigPoint,cost,'mets',testPts) or calcProfitLoss(...,'tickSize',tickSize). Aborting.");
+
+		if (thisOption == OPT_TICKSIZE)
+			tickSize_IN = prhs[++arg];
+		else if (thisOption == OPT_DOUBLEDSIG)
+			doubledSig = true;
+		else
+		{
+			option = thisOption;
+			if (option == OPT_METS)
+				testPts_IN = prhs[++arg];
+		}
+	}
+
+	const bool statsMode = (option != OPT_NONE);
+
+	if ((!statsMode && nlhs != 4) || (statsMode && nlhs > 1))
 		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:NumOutputs",
 		"Number of output assignments is not correct. Aborting (120).");
 
@@ -133,16 +250,28 @@ void mexFunction(int nlhs, mxArray *plhs[], /* Output variables */
 
 	// Init Global variables
 	mwSize rowsData, colsData, rowsSig, colsSig;
-	double *cashIdx, *openEQIdx, *netLiqIdx, *returnsIdx, *dataInPtr, *sigInPtr; // *bigPointPtr, *costPtr;
+	double *cashIdx, *openEQIdx, *netLiqIdx, *returnsIdx; // *bigPointPtr, *costPtr;
 
 	// Check type of supplied inputs
-	if (!isReal2DfullDouble(data_IN)) 
+	if (!isReal2Dfull(data_IN) || !(mxIsDouble(data_IN) || mxIsInt32(data_IN)))
+		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:BadInputType",
+		"Input 'data' must be a 2 dimensional full double or int32 (ticks) array. Aborting (141).");
+
+	if (!isReal2Dfull(sig_IN) || !(mxIsDouble(sig_IN) || mxIsInt8(sig_IN) || mxIsInt16(sig_IN)))
 		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:BadInputType",
-		"Input 'data' must be a 2 dimensional full double array. Aborting (141).");
+		"Input 'sig' must be a 2 dimensional full double, int8 or int16 array. Aborting (145).");
 
-	if (!isReal2DfullDouble(sig_IN)) 
+	if (mxIsInt32(data_IN) && (tickSize_IN == NULL || !isRealScalar(tickSize_IN) || mxGetScalar(tickSize_IN) <= 0))
 		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:BadInputType",
-		"Input 'sig' must be a 2 dimensional full double array. Aborting (145).");
+		"Input 'data' given in int32 ticks requires a positive scalar 'tickSize'. Aborting.");
+
+	if (!mxIsInt32(data_IN) && tickSize_IN != NULL)
+		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:BadOption",
+		"Option 'tickSize' only applies to int32 (ticks) 'data'. Aborting.");
+
+	if (doubledSig && mxIsDouble(sig_IN))
+		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:BadOption",
+		"Option 'doubledSig' only applies to int8 or int16 'sig'. Aborting.");
 
 	if (!isRealScalar(bigPoint_IN)) 
 		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:BadInputType",
@@ -162,10 +291,6 @@ void mexFunction(int nlhs, mxArray *plhs[], /* Output variables */
 		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:ArrayMismatch",
 		"The number of rows in the data array and the signal array are different. Aborting (163).");
 
-	if (colsSig > 1)
-		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:ArrayMismatch",
-		"Input 'sig' must be a single column array. Aborting (167).");
-
 	if (colsData != 2 && colsData != 4)
 		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:ArrayMismatch",
 		"Input 'data' must be in the form of 'O | C'. Aborting (171).");
@@ -186,300 +311,484 @@ void mexFunction(int nlhs, mxArray *plhs[], /* Output variables */
 	}
 
 	const int SHIFT_OPEN = 0;								// For readability
-	const int SHIFT_CLOSE = rowsData * shifter;
-
-	/* Create matrices for the return arguments */ 
-	// http://www.mathworks.com/help/matlab/matlab_external/c-c-source-mex-files.html
-	cash_OUT = mxCreateDoubleMatrix(rowsData, 1, mxREAL);
-	openEQ_OUT = mxCreateDoubleMatrix(rowsData, 1, mxREAL); 
-	netLiq_OUT = mxCreateDoubleMatrix(rowsData, 1, mxREAL); 
-	returns_OUT = mxCreateDoubleMatrix(rowsData, 1, mxREAL); 
-
-	/* Assign pointers to the arrays */ 
-	dataInPtr = mxGetPr(prhs[0]);
-	sigInPtr = mxGetPr(prhs[1]);
+	const mwSize SHIFT_CLOSE = rowsData * shifter;
+
+	/* Assign the input series */ 
+	// int32 prices are tick counts.  With 'doubledSig' integer signals hold twice the signal so that the
+	// +/- X.5 instructions are representable
+	const double sigScale = doubledSig ? 0.5 : 1.0;
+	const plSeries dataIn = mxIsInt32(data_IN) ? createSeries(mxGetData(data_IN), PL_INT32, mxGetScalar(tickSize_IN))
+		: createSeries(mxGetPr(data_IN));
+	const plSeries sigIn = mxIsInt8(sig_IN) ? createSeries(mxGetData(sig_IN), PL_INT8, sigScale)
+		: mxIsInt16(sig_IN) ? createSeries(mxGetData(sig_IN), PL_INT16, sigScale)
+		: createSeries(mxGetPr(sig_IN));
 
 	// assign values to the two variables passed as arrays
 	const double BIG_POINT = mxGetScalar(bigPoint_IN);
 	const double COST = mxGetScalar(cost_IN);
 
-	// assign the index variables for manipulating the arrays 
-	cashIdx = mxGetPr(cash_OUT);
-	openEQIdx = mxGetPr(openEQ_OUT);
-	netLiqIdx = mxGetPr(netLiq_OUT);
-	returnsIdx = mxGetPr(returns_OUT);
+	// Bars before the split are scored as the test segment
+	int splitIdx = int(rowsData);
+	if (option == OPT_METS)
+	{
+		if (!isRealScalar(testPts_IN) || mxGetScalar(testPts_IN) < 1 || mxGetScalar(testPts_IN) >= double(rowsData)
+			|| mxGetScalar(testPts_IN) != int(mxGetScalar(testPts_IN)))
+			mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:BadInputType",
+			"Input 'testPts' must be an integer scalar between 1 and the number of bars less 1. Aborting.");
 
-	// START //
-	// Initialize variables
-	int	sigIdx;					// Iterator that will store the index of the referenced signal
-	int barIdx;					// Iterator that will store the index of the referenced bar
-	bool anyTrades = false;				// Variable that indicates if we have any trades
+		splitIdx = int(mxGetScalar(testPts_IN));
+	}
 
-	// Check that we have at least one signal (at least one trade)
-	for (sigIdx=0; sigIdx < rowsSig; sigIdx++)	// Remember C++ starts counting at '0'
+	// Summary statistics are accumulated per column without any per bar arrays
+	vector<plStats> colStats(statsMode ? colsSig : 0);
+	vector<plStats> valStats(option == OPT_METS ? colsSig : 0);
+	cashIdx = openEQIdx = netLiqIdx = returnsIdx = NULL;
+
+	if (!statsMode)
+	{
+		/* Create matrices for the return arguments */ 
+		// http://www.mathworks.com/help/matlab/matlab_external/c-c-source-mex-files.html
+		// One output column per signal column
+		cash_OUT = mxCreateDoubleMatrix(rowsData, colsSig, mxREAL);
+		openEQ_OUT = mxCreateDoubleMatrix(rowsData, colsSig, mxREAL); 
+		netLiq_OUT = mxCreateDoubleMatrix(rowsData, colsSig, mxREAL); 
+		returns_OUT = mxCreateDoubleMatrix(rowsData, colsSig, mxREAL); 
+
+		// assign the index variables for manipulating the arrays 
+		cashIdx = mxGetPr(cash_OUT);
+		openEQIdx = mxGetPr(openEQ_OUT);
+		netLiqIdx = mxGetPr(netLiq_OUT);
+		returnsIdx = mxGetPr(returns_OUT);
+	}
+
+	// START //
+	// Each signal column is P&L'd independently against the shared price data.
+	// mexErrMsgIdAndTxt cannot be called from a worker thread so any failure is
+	// recorded and reported once all columns have been processed.
+	int errCol = -1;				// Lowest column that could not be processed
+	double errSig = 0;				// The signal value that could not be interpreted
+
+#pragma omp parallel for schedule(dynamic)
+	for (int col = 0; col < int(colsSig); col++)
 	{
-		if (abs(sigInPtr[sigIdx]) >=1)		// See if we have a signal that generates a position
+		const mwSize colOffset = mwSize(col) * rowsData;
+		double badSig = 0;
+		int retCode;
+
+		const plSeries openIn = seriesOffset(dataIn, SHIFT_OPEN);
+		const plSeries closeIn = seriesOffset(dataIn, SHIFT_CLOSE);
+		const plSeries colSig = seriesOffset(sigIn, colOffset);
+
+		if (option == OPT_METS)
+			retCode = plColumnSplitStats(openIn, closeIn, colSig, int(rowsData), BIG_POINT, COST,
+				splitIdx, colStats[col], valStats[col], badSig);
+		else if (statsMode)
+			retCode = plColumnStats(openIn, closeIn, colSig, int(rowsData), BIG_POINT, COST,
+				colStats[col], badSig);
+		else
+			retCode = plColumn(openIn, closeIn, colSig, int(rowsData), BIG_POINT, COST,
+				cashIdx + colOffset, openEQIdx + colOffset, netLiqIdx + colOffset, returnsIdx + colOffset, badSig);
+
+		if (retCode != 0)
 		{
-			anyTrades=true;			// Trade found
-			break;				// Exit the for loop
+#pragma omp critical
+			{
+				if (errCol < 0 || col < errCol)
+				{
+					errCol = col;
+					errSig = badSig;
+				}
+			}
 		}
-	}	
+	}
+
+	if (errCol >= 0)
+		// Unknown advanced signal.  Throw an error.
+		mexErrMsgIdAndTxt( "calcProfitLoss:AdvancedSignal:fractionUnknown",
+		"A signal contained an advanced fractional instruction %f that we could not interpret (column %d). Aborting (286).", errSig, errCol + 1);
+
+	if (option == OPT_METS)
+		plhs[0] = createMetsStruct(colStats, valStats);
+	else if (statsMode)
+		plhs[0] = createStatsStruct(colStats);
+
+	return;
+}
+
+/////////////
+//
+// FUNCTIONS & METHODS
+//
+/////////////
+
+// Dispatch a command given as a leading string
+void plCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	// Parse the command
+	int cmdNumChars = (int)mxGetN(prhs[0])+1;		// +1 for the NULL added at the end
+	char *cmdAsChars = (char*)mxCalloc(cmdNumChars, sizeof(char));
+
+	if (mxGetString(prhs[0], cmdAsChars, cmdNumChars) != 0)
+		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:Parsing",
+		"Could not parse the given command. Aborting.");
 
-	// We have trades
-	// RETURN zeros if the signal is the last bar
-	if (anyTrades && sigIdx < rowsSig)
+	string cmd(cmdAsChars);
+	transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
+	mxFree(cmdAsChars);
+
+	if (cmd == "create")
 	{
-		// Initialize a ledger for open positions
-		deque<tradeEntry> openLedger;
+		// h = calcProfitLoss('create',bigPoint,cost)
+		if (nrhs != 3 || nlhs > 1)
+			mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:NumInputs",
+			"Usage is h = calcProfitLoss('create',bigPoint,cost). Aborting.");
 
-		// Put first trade on ledger
-		// price is 'sigIdx+1' because execution price lags signal by one observation
-		// We only need the integer portion of the first trade
-		openLedger.push_back(createLineEntry(sigIdx, int(sigInPtr[sigIdx]), dataInPtr[sigIdx+1]));
+		if (!isRealScalar(prhs[1])) 
+			mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:BadInputType",
+			"Input 'bigPoint' must be a single scalar double. Aborting.");
 
-		// Initialize position trackers
-		int openPosition = int(sigInPtr[sigIdx]);
+		if (!isRealScalar(prhs[2])) 
+			mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:BadInputType",
+			"Input 'cost' must be a single scalar double. Aborting.");
 
-		// ITERATE
-		// Start iterating at next observation
-		// Finish at observation before last in signal array
-		for (int ii = sigIdx+1; ii < rowsSig-1; ii++)
-		{
-			if (sigInPtr[ii] != 0)
-			{
-				// Is this an advanced signal?
-				if (fraction(sigInPtr[ii]))
-					// Advanced signal
-				{
-					// Check for known advanced signal type
-					if (knownAdvSig(sigInPtr[ii]))
-					// Known
-					{
-						// Check for additive or reductive
-						if ((openPosition <= 0 && sigInPtr[ii] <= -1) || (openPosition >= 0 && sigInPtr[ii] >= 1))
-						// Additive
-						{
-							// We ignore reverse advance instructions when they are additive
-						}
-						// Reductive
-						else
-						{
-							// Confirm instruction is fractional reverse
-							if (abs(sigInPtr[ii] - int(sigInPtr[ii])) == 0.5)			// Reverse instruction
-							{
-								// Liquidate any open position
-								while (!openLedger.empty())
-								{
-									// Aggregate cash for corresponding observations (signal + 1)
-									cashIdx[ii+1] = cashIdx[ii+1] + ((dataInPtr[ii+1] - openLedger.front().price) * openLedger.front().quantity * BIG_POINT) - 
-										(abs(openLedger.front().quantity)* COST);
-									openLedger.pop_front();
-								}
-
-								openPosition = 0;
-							}
-							else
-							{
-								//	This is here for ease of adding additional instructions later.
-								// Unknown advanced signal.  Throw an error.
-								mexErrMsgIdAndTxt( "calcProfitLoss:AdvancedSignal:fractionUnknown",
-									"A signal contained an advanced fractional instruction %f that we could not interpret. Aborting (286).",sigInPtr[ii]);
-							}
-						}
-					}
-					else
-						// Unknown instruction
-					{
-						// Unknown advanced signal.  Throw an error.
-						mexErrMsgIdAndTxt( "calcProfitLoss:AdvancedSignal:fractionUnknown",
-							"A signal contained an advanced fractional instruction %f that we could not interpret. Aborting (295).",sigInPtr[ii]);
-					}
-				}
+		// Release any ledgers left open when the MEX is cleared
+		if (s_plStreams.empty())
+			mexAtExit(clearStreams);
 
-				// Any integer and if so Additive or reductive ?
-				if ((openPosition <= 0 && sigInPtr[ii] <= -1) || (openPosition >= 0 && sigInPtr[ii] >= 1))
-					// Additive
-				{
-					// Trade is additive. Add or create existing position --> openLedger
-					openLedger.push_back(createLineEntry(ii, int(sigInPtr[ii]), dataInPtr[ii+1]));
-					openPosition = openPosition + int(sigInPtr[ii]);
-				}
-				// Reductive
-				else
-				{
-					// Signal is effectively a reverse or liquidate
-					if (int(abs(sigInPtr[ii])) >= abs(openPosition))
-					{
-						// New trade is larger than or equal to existing position. Calculate cash on all ledger lines
-						while (!openLedger.empty())
-						{
-							// Aggregate cash for corresponding observations (signal + 1)
-							cashIdx[ii+1] = cashIdx[ii+1] + ((dataInPtr[ii+1] - openLedger.front().price) * openLedger.front().quantity * BIG_POINT) - 
-								(abs(openLedger.front().quantity)* COST);
-							openLedger.pop_front();
-						}
-
-						// update open position tracker
-						openPosition = int(sigInPtr[ii]) + openPosition;
-
-						// if there is a 'remainder', this is the new net open position
-						// put it on the openLedger
-						if (openPosition != 0)
-						{
-							openLedger.push_back(createLineEntry(ii,openPosition,dataInPtr[ii+1]));
-						}
-					}
-					// partial liquidation
-					else
-					{
-						// New trade is smaller than the current open position.
-						// How many do we need to reduce by?
-						int needQty = sigInPtr[ii];
-
-						// Prepare to iterate until we are satisfied
-						while (needQty !=0)
-						{
-							// Is the current line item quantity larger than what we need?
-							if (abs(openLedger.front().quantity) > needQty)
-							{
-								// If so we will P&L the quantity we need and reduce the open position size
-								cashIdx[ii+1] = cashIdx[ii+1] + ((dataInPtr[ii+1] - openLedger.front().price) * -needQty * BIG_POINT) - 
-									(abs(needQty) * COST);
-								// Reduce the position size.  We are aggregating so we add (e.g. 5 Purchases + 4 Sales = 1 Long)
-								openLedger.front().quantity = openLedger.front().quantity + needQty;
-								// We are satisfied and don't need any more contracts
-								needQty = 0;
-							}
-							// Current line item quantity is equal to or smaller than what we need.  Process P&L and remove.
-							else
-							{
-								// P&L entire quantity
-								cashIdx[ii+1] = cashIdx[ii+1] + ((dataInPtr[ii+1] - openLedger.front().price) * -openLedger.front().quantity * BIG_POINT) - 
-									(abs(openLedger.front().quantity) * COST);
-								// Reduce needed quantity by what we've been provided
-								needQty = needQty + openLedger.front().quantity;
-								// Remove the line item (FIFO)
-								openLedger.pop_front();
-							}
-						}
-						// update open position tracker
-						openPosition = openPosition + sigInPtr[ii];
-					}
-				}
+		plState *st = new plState;
+		plInit(*st, mxGetScalar(prhs[1]), mxGetScalar(prhs[2]));
 
-			}
+		int handle = s_plNextHandle++;
+		s_plStreams[handle] = st;
 
-			// Calculate current openEQ if there are any positions
-			// !!!!!!!!!!!!!!!!!!!!!!
-			// !! IMPORTANT
-			// !!!!!!!!!!!!!!!!!!!!!!
-			// Because we are using virtual bars for calculations, we have introduced a known issue
-			// that a profit may occur within an observation High or Low.  To offset this we will
-			// clean certain openEQ calculations below. This will cause some invalid depictions
-			// of open equity between observations but would be effectively be a margining issue
-			if (openPosition != 0)
-			{
-				//// We will aggregate all line items
-				for (int jj = 0; jj < openLedger.size(); jj++)
-				{
-					openEQIdx[ii+1] = openEQIdx[ii+1] + ((dataInPtr[ii+1+SHIFT_CLOSE] - openLedger[jj].price) * openLedger[jj].quantity * BIG_POINT);
-				}
-			}
-		} // end for
+		plhs[0] = mxCreateDoubleScalar(handle);
+	}
+	else if (cmd == "update")
+	{
+		// [cash,openEQ,netLiq,returns] = calcProfitLoss('update',h,data,sig)
+		if (nrhs != 4)
+			mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:NumInputs",
+			"Usage is [cash,openEQ,netLiq,returns] = calcProfitLoss('update',h,data,sig). Aborting.");
+
+		if (nlhs != 4)
+			mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:NumOutputs",
+			"Number of output assignments is not correct. Aborting.");
+
+		plState *st = getStream(prhs[1]);
+
+		if (!isReal2DfullDouble(prhs[2])) 
+			mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:BadInputType",
+			"Input 'data' must be a 2 dimensional full double array. Aborting.");
+
+		if (!isReal2DfullDouble(prhs[3])) 
+			mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:BadInputType",
+			"Input 'sig' must be a 2 dimensional full double array. Aborting.");
+
+		mwSize rowsData = mxGetM(prhs[2]);
+		mwSize colsData = mxGetN(prhs[2]);
+
+		if (rowsData != mxGetM(prhs[3]))
+			mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:ArrayMismatch",
+			"The number of rows in the data array and the signal array are different. Aborting.");
+
+		if (mxGetN(prhs[3]) != 1)
+			mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:ArrayMismatch",
+			"Input 'sig' must be a single column array when streaming. Aborting.");
+
+		if (colsData != 2 && colsData != 4)
+			mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:ArrayMismatch",
+			"Input 'data' must be in the form of 'O | C'. Aborting.");
 
-		// destroy the deque
-		openLedger.~deque();
+		const double *openPtr = mxGetPr(prhs[2]);
+		const double *closePtr = openPtr + rowsData * (colsData == 4 ? 3 : 1);
+		const double *sigPtr = mxGetPr(prhs[3]);
 
-		// These are for convenience and could be removed for optimization
+		// The last bar of the previous update is restated first
+		const int restate = (st->bars > 0) ? 1 : 0;
+		const mwSize rowsOut = rowsData + restate;
 
-		// Calculate a cumulative sum of closed trades and open equity per observation
+		plhs[0] = mxCreateDoubleMatrix(rowsOut, 1, mxREAL);
+		plhs[1] = mxCreateDoubleMatrix(rowsOut, 1, mxREAL);
+		plhs[2] = mxCreateDoubleMatrix(rowsOut, 1, mxREAL);
+		plhs[3] = mxCreateDoubleMatrix(rowsOut, 1, mxREAL);
 
-		// This loop is a 'dirty' cleaning of trades that were closed on the next observation.
-		// Because we are creating a vBar for profit objectives, if the openEquity is greater than the next
-		// observation's cash, we'll reduce openEquity to equal cash.  This should normalize some spikes.
-		for (int ll = 1; ll < rowsData - 1; ll++)
+		double *cashIdx = mxGetPr(plhs[0]);
+		double *openEQIdx = mxGetPr(plhs[1]);
+		double *netLiqIdx = mxGetPr(plhs[2]);
+		double *returnsIdx = mxGetPr(plhs[3]);
+
+		// An update is applied whole or not at all. On failure the ledger is restored to its state before
+		// this update, so the caller can correct the signals and send the same rows again
+		const plState saved = *st;
+		double badSig = 0;
+
+		for (int ii = 0; ii < int(rowsData); ii++)
 		{
-			if (openEQIdx[ll] != cashIdx[ll+1] && openEQIdx[ll+1] == 0 && cashIdx[ll+1] > 0)
+			if (plStep(*st, openPtr[ii], closePtr[ii], sigPtr[ii], badSig) != 0)
 			{
-				openEQIdx[ll] = cashIdx[ll+1];
+				*st = saved;
+				mexErrMsgIdAndTxt( "calcProfitLoss:AdvancedSignal:fractionUnknown",
+				"A signal contained an advanced fractional instruction %f that we could not interpret (row %d). Aborting.", badSig, ii);
 			}
-		}
-
-		double runSum = 0;
-		returnsIdx[0] = 0;
-		for (int kk=0; kk < rowsData; kk++)
-		{
-			runSum = runSum + cashIdx[kk];
-			netLiqIdx[kk] = runSum + openEQIdx[kk];
 
-			// Calculate a return from day to day based on the change in value observation to observation
-			if (kk>0)
+			// The prior bar is final once this bar has been processed
+			int outRow = ii + restate - 1;
+			if (outRow >= 0)
 			{
-				returnsIdx[kk] = netLiqIdx[kk] - netLiqIdx[kk-1];
+				cashIdx[outRow] = st->prev.cash;
+				openEQIdx[outRow] = st->prev.openEQ;
+				netLiqIdx[outRow] = st->prev.netLiq;
+				returnsIdx[outRow] = st->prev.returns;
 			}
+		}
 
-		} //for
+		// The signal of the last row is only executed on the next update. Check it now so that it is
+		// reported with the update that gave it
+		if (rowsData > 0 && plCheckPending(*st, badSig) != 0)
+		{
+			*st = saved;
+			mexErrMsgIdAndTxt( "calcProfitLoss:AdvancedSignal:fractionUnknown",
+			"A signal contained an advanced fractional instruction %f that we could not interpret (row %d). Aborting.", badSig, int(rowsData));
+		}
 
+		// Last (provisional) observation
+		if (rowsOut > 0)
+		{
+			cashIdx[rowsOut-1] = st->cur.cash;
+			openEQIdx[rowsOut-1] = st->cur.openEQ;
+			netLiqIdx[rowsOut-1] = st->cur.netLiq;
+			returnsIdx[rowsOut-1] = st->cur.returns;
+		}
+	}
+	else if (cmd == "portfolio")
+	{
+		plPortfolio(nlhs, plhs, nrhs, prhs);
+	}
+	else if (cmd == "destroy")
+	{
+		// calcProfitLoss('destroy',h)
+		if (nrhs != 2 || nlhs > 0)
+			mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:NumInputs",
+			"Usage is calcProfitLoss('destroy',h). Aborting.");
+
+		plState *st = getStream(prhs[1]);
+		s_plStreams.erase(int(mxGetScalar(prhs[1])));
+		delete st;
 	}
-	// No trades or signal on the last observation. Return zeros.
 	else
 	{
-		for (int mm=0; mm < rowsData; mm++)
+		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:UnknownCommand",
+			"Unknown command '%s'. Expected 'create', 'update', 'destroy' or 'portfolio'. Aborting.", cmd.c_str());
+	}
+}
+
+// P&L a basket of instruments with per instrument bigPoint and cost and aggregate the results
+void plPortfolio(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	// [cash,openEQ,netLiq,returns,portNetLiq,portReturns] = calcProfitLoss('portfolio',open,close,sig,bigPoint,cost)
+	if (nrhs != 6)
+		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:NumInputs",
+		"Usage is [cash,openEQ,netLiq,returns,portNetLiq,portReturns] = calcProfitLoss('portfolio',open,close,sig,bigPoint,cost). Aborting.");
+
+	if (nlhs != 6)
+		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:NumOutputs",
+		"Number of output assignments is not correct. Aborting.");
+
+	const mxArray *openPanel = prhs[1];
+	const mxArray *closePanel = prhs[2];
+	const mxArray *sigPanel = prhs[3];
+	const mxArray *bigPointVec = prhs[4];
+	const mxArray *costVec = prhs[5];
+
+	if (!isReal2DfullDouble(openPanel) || !isReal2DfullDouble(closePanel) || !isReal2DfullDouble(sigPanel))
+		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:BadInputType",
+		"Inputs 'open', 'close' and 'sig' must be 2 dimensional full double arrays. Aborting.");
+
+	const mwSize rowsData = mxGetM(openPanel);
+	const mwSize numInst = mxGetN(openPanel);
+
+	if (mxGetM(closePanel) != rowsData || mxGetN(closePanel) != numInst || mxGetM(sigPanel) != rowsData || mxGetN(sigPanel) != numInst)
+		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:ArrayMismatch",
+		"Inputs 'open', 'close' and 'sig' must be panels of the same size (bars x instruments). Aborting.");
+
+	if (!isReal2DfullDouble(bigPointVec) || (mxGetNumberOfElements(bigPointVec) != 1 && mxGetNumberOfElements(bigPointVec) != numInst))
+		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:ArrayMismatch",
+		"Input 'bigPoint' must be a scalar or a vector with one value per instrument. Aborting.");
+
+	if (!isReal2DfullDouble(costVec) || (mxGetNumberOfElements(costVec) != 1 && mxGetNumberOfElements(costVec) != numInst))
+		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:ArrayMismatch",
+		"Input 'cost' must be a scalar or a vector with one value per instrument. Aborting.");
+
+	const double *openPtr = mxGetPr(openPanel);
+	const double *closePtr = mxGetPr(closePanel);
+	const double *sigPtr = mxGetPr(sigPanel);
+	const double *bigPointPtr = mxGetPr(bigPointVec);
+	const double *costPtr = mxGetPr(costVec);
+
+	// A scalar is applied to every instrument
+	const int bigPointStep = (mxGetNumberOfElements(bigPointVec) == 1) ? 0 : 1;
+	const int costStep = (mxGetNumberOfElements(costVec) == 1) ? 0 : 1;
+
+	plhs[0] = mxCreateDoubleMatrix(rowsData, numInst, mxREAL);
+	plhs[1] = mxCreateDoubleMatrix(rowsData, numInst, mxREAL);
+	plhs[2] = mxCreateDoubleMatrix(rowsData, numInst, mxREAL);
+	plhs[3] = mxCreateDoubleMatrix(rowsData, numInst, mxREAL);
+	plhs[4] = mxCreateDoubleMatrix(rowsData, 1, mxREAL);
+	plhs[5] = mxCreateDoubleMatrix(rowsData, 1, mxREAL);
+
+	double *cashIdx = mxGetPr(plhs[0]);
+	double *openEQIdx = mxGetPr(plhs[1]);
+	double *netLiqIdx = mxGetPr(plhs[2]);
+	double *returnsIdx = mxGetPr(plhs[3]);
+	double *portNetLiqIdx = mxGetPr(plhs[4]);
+	double *portReturnsIdx = mxGetPr(plhs[5]);
+
+	// Each instrument's ledger is independent. Failures are reported once all instruments have been processed.
+	int errCol = -1;
+	double errSig = 0;
+
+#pragma omp parallel for schedule(dynamic)
+	for (int col = 0; col < int(numInst); col++)
+	{
+		const mwSize colOffset = mwSize(col) * rowsData;
+		double badSig = 0;
+
+		if (plColumn(openPtr + colOffset, closePtr + colOffset, sigPtr + colOffset, int(rowsData),
+			bigPointPtr[col * bigPointStep], costPtr[col * costStep],
+			cashIdx + colOffset, openEQIdx + colOffset, netLiqIdx + colOffset, returnsIdx + colOffset, badSig) != 0)
 		{
-			cashIdx[mm] = 0;
-			openEQIdx[mm]=0;
-			netLiqIdx[mm]=0;
-			returnsIdx[mm]=0;
+#pragma omp critical
+			{
+				if (errCol < 0 || col < errCol)
+				{
+					errCol = col;
+					errSig = badSig;
+				}
+			}
 		}
 	}
 
-	return;
+	if (errCol >= 0)
+		mexErrMsgIdAndTxt( "calcProfitLoss:AdvancedSignal:fractionUnknown",
+		"A signal contained an advanced fractional instruction %f that we could not interpret (instrument %d). Aborting.", errSig, errCol + 1);
+
+	// Aggregate in instrument order so the sums do not depend on thread scheduling
+	for (mwSize col = 0; col < numInst; col++)
+	{
+		const mwSize colOffset = col * rowsData;
+		for (mwSize row = 0; row < rowsData; row++)
+		{
+			portNetLiqIdx[row] += netLiqIdx[colOffset + row];
+			portReturnsIdx[row] += returnsIdx[colOffset + row];
+		}
+	}
 }
 
-/////////////
-//
-// FUNCTIONS & METHODS
-//
-/////////////
+// Identify a trailing option (case insensitive)
+int parseOption(const mxArray *option_IN)
+{
+	if (!mxIsChar(option_IN))
+		return OPT_UNKNOWN;
+
+	char optAsChars[16];
+	if (mxGetString(option_IN, optAsChars, sizeof(optAsChars)) != 0)
+		return OPT_UNKNOWN;
+
+	string opt(optAsChars);
+	transform(opt.begin(), opt.end(), opt.begin(), ::tolower);
+
+	if (opt == "stats")
+		return OPT_STATS;
+	if (opt == "mets")
+		return OPT_METS;
+	if (opt == "ticksize")
+		return OPT_TICKSIZE;
+	if (opt == "doubledsig")
+		return OPT_DOUBLEDSIG;
+
+	return OPT_UNKNOWN;
+}
 
-// Constructor for ledger line item creation
-tradeEntry createLineEntry(int ID, int qty, double price)
+// Package per column statistics as a struct of 1 x K fields
+mxArray *createStatsStruct(const vector<plStats> &colStats)
 {
-	tradeEntry lineEntry;
-	lineEntry.index = ID;
-	lineEntry.quantity = qty;
-	lineEntry.price = price;
+	const char *fieldNames[] = {"sharpe", "maxDD", "profitFactor", "numTrades", "winRate"};
+	const int numFields = sizeof(fieldNames) / sizeof(fieldNames[0]);
+	const mwSize numCols = colStats.size();
+
+	mxArray *stats_OUT = mxCreateStructMatrix(1, 1, numFields, fieldNames);
+	double *fieldPtr[numFields];
+
+	for (int ff = 0; ff < numFields; ff++)
+	{
+		mxArray *field = mxCreateDoubleMatrix(1, numCols, mxREAL);
+		fieldPtr[ff] = mxGetPr(field);
+		mxSetField(stats_OUT, 0, fieldNames[ff], field);
+	}
+
+	for (mwSize col = 0; col < numCols; col++)
+	{
+		fieldPtr[0][col] = plSharpe(colStats[col]);
+		fieldPtr[1][col] = colStats[col].maxDD;
+		fieldPtr[2][col] = plProfitFactor(colStats[col]);
+		fieldPtr[3][col] = colStats[col].numTrades;
+		fieldPtr[4][col] = plWinRate(colStats[col]);
+	}
 
-	return lineEntry;
+	return stats_OUT;
 }
 
-// Method to sum the quantity values in any struct of type tradeEntry
-int sumQty(const deque<tradeEntry>& x)
+// Package per column test / validation scores as a struct of 1 x K fields
+mxArray *createMetsStruct(const vector<plStats> &testStats, const vector<plStats> &valStats)
 {
-	int sumOfQty = 0;  // the sum is accumulated here
-	for (deque<tradeEntry>::const_iterator it=x.begin();it!=x.end();it++)
+	const char *fieldNames[] = {"sharpeTest", "sharpeVal", "mets"};
+	const int numFields = sizeof(fieldNames) / sizeof(fieldNames[0]);
+	const mwSize numCols = testStats.size();
+
+	mxArray *mets_OUT = mxCreateStructMatrix(1, 1, numFields, fieldNames);
+	double *fieldPtr[numFields];
+
+	for (int ff = 0; ff < numFields; ff++)
+	{
+		mxArray *field = mxCreateDoubleMatrix(1, numCols, mxREAL);
+		fieldPtr[ff] = mxGetPr(field);
+		mxSetField(mets_OUT, 0, fieldNames[ff], field);
+	}
+
+	for (mwSize col = 0; col < numCols; col++)
 	{
-		//sumOfQty += x[i].price;
-		sumOfQty += it->quantity;
+		fieldPtr[0][col] = plSharpe(testStats[col]);
+		fieldPtr[1][col] = plSharpe(valStats[col]);
+		fieldPtr[2][col] = plMETS(fieldPtr[0][col], fieldPtr[1][col]);
 	}
 
-	return sumOfQty;
+	return mets_OUT;
 }
 
-bool knownAdvSig(double advSig)
+// Look up a streaming ledger by handle
+plState *getStream(const mxArray *handle_IN)
 {
-	// We can check for known advanced signals to help in debugging
-	// by registering them here.  This can be a searchable array when
-	// more than one advanced signal exists.
-	// For now we only need to check for |0.5|
+	if (!isRealScalar(handle_IN))
+		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:BadHandle",
+		"The ledger handle must be a scalar as returned by 'create'. Aborting.");
 
-	double frac = abs(advSig - int(advSig));
+	map<int, plState*>::iterator iter = s_plStreams.find(int(mxGetScalar(handle_IN)));
 
-	if (frac == 0.5)		// Close any opposing open position
+	if (iter == s_plStreams.end())
+		mexErrMsgIdAndTxt( "MATLAB:calcProfitLoss:BadHandle",
+		"The ledger handle is not valid or has been destroyed. Aborting.");
+
+	return iter->second;
+}
+
+// Release all streaming ledgers
+static void clearStreams()
+{
+	for (map<int, plState*>::iterator iter = s_plStreams.begin(); iter != s_plStreams.end(); iter++)
 	{
-		return true;
+		delete iter->second;
 	}
-	return false;
+	s_plStreams.clear();
 }
 
 //
@@ -7,20 +7,55 @@
 //
 // Matlab MEX function:
 // [barsOut,sigOut,sharpeOut] = numTicksProfit(barsIn,sigIn,sharpeIn,minTick,numTicks,openAvg)
+//
+// Fused profit target and P&L usage:
+// [cash,openEQ,netLiq,returns,barsOut,sigOut] = numTicksProfit('pl',barsIn,sigIn,minTick,numTicks,openAvg,bigPoint,cost)
+// [stats,sigOut] = numTicksProfit('pl',barsIn,sigIn,minTick,numTicks,openAvg,bigPoint,cost,'stats')
+// [...] = numTicksProfit(...,'doubledSig')
 // 
 // Inputs:
 //		barsIn		A matrix array of prices in the form of Open | High | Low | Close
+//				May be given as int32 tick counts (price = ticks * minTick).  Results equal those of double prices
+//				holding ticks * minTick.  Double prices only close to that (e.g. the nearest double of 40.37 rather than
+//				4037 * 0.01) may give different results.  Binary tick sizes such as 0.25 are always exact
 //		sigIn		An 1-D array the same length as barsIn, which gives the quantity bought or sold on a given bar.  Consider Matlab remEchosMEX
+//				May be given as int8 or int16.  Integer signals are read as given, e.g. int8(sig) where 1 buys 1,
+//				so the fractional instructions cannot be expressed unless 'doubledSig' is also given
 //		minTick		Double representing the per contract minimum tick increment
 //		numTicks	Double representing the number of ticks for the open position price to take a profit
+//				With 'stats' a vector of targets may be given and every target is evaluated in the same pass
 //		openAvg		One of two ways to handle multiple entries in the open ledger.
 //					0	Each trade individually
 //					1	Average the open position	(only logically useful when there is more than a 1 lot open position)
+//		bigPoint	('pl' only) Double representing the full tick dollar value of the contract being P&L'd
+//		cost		('pl' only) Double representing the per contract commission
+//		'stats'		('pl' only) Return summary statistics of each profit target in place of the per bar arrays
+//		'doubledSig'	(Optional) An int8 or int16 'sigIn' holds TWICE the signal so the fractional instructions are representable
+//				e.g. int8(2 * sig) where 1.5 -> 3 and -0.5 -> -1.  Only applies to int8 or int16 'sigIn'
 //
 // Outputs:
 //		barsOut		A 2-D array of prices with the addition of any virtual bars where a profit is taken in the form of Open | High | Low | Close
 //		sigOut		An array the same length as barsOut which includes any profit taking signals generated by numTicksProfitCPP
 //
+//		Outputs are always double.  Compact inputs are read in place and scaled as each element is read, as in calcProfitLoss.
+//
+//		cash, openEQ, netLiq, returns	('pl' only) The P&L of barsOut and sigOut as given by calcProfitLoss(barsOut,sigOut,bigPoint,cost)
+//
+//		stats		('stats' only) A struct of 1 x T fields, one per element of 'numTicks', as calcProfitLoss(...,'stats')
+//				of each target's barsOut and sigOut:  sharpe | maxDD | profitFactor | numTrades | winRate
+//		sigOut		('stats' only) (Optional) A 1 x T cell array of each target's expanded signal
+//
+//	NOTE: 'pl' applies the profit targets and P&Ls the result in the same call.  The virtual profit bars are fed straight
+//		to the ledger as they are merged so barsOut and sigOut are only built when they are asked for.
+//		e.g. [~,~,~,R] = numTicksProfit('pl',...) replaces numTicksProfit followed by calcProfitLoss without copying the bars.
+//		mex numTicksProfit.cpp profitTarget.cpp myMath.cpp plLedger.cpp
+//
+//	NOTE: The profit target ledger lives in profitTarget.cpp and holds no global state.  numTicksProfitStats is the
+//		pure C++ equivalent of the 'stats' sweep and may be called from several threads at once.
+//
+//	NOTE: A 'numTicks' sweep (e.g. 1:40) is evaluated in one call.  Each target keeps its own ledgers and all targets are
+//		advanced on a bar before the next bar is read, once to find the profits and once to P&L the expanded rows.
+//
 // NOTES	We will assume the following standard:	+/- 1 lot is additive	+/- 2 lots is a reverse
 //		This is the version that should be used with a SIGNAL input.
 //		There is (will be) a version that should be used when a STATE input is supplied to allow for continued reentry
@@ -54,9 +89,12 @@ plhs[0] = getMexArray(v);
 
 
 #include "mex.h"
-#include <list>
-#include <iterator>
-#include "myMath.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "plLedger.h"
+#include "profitTarget.h"
 
 // Declare external reference to undocumented C function
 #ifdef __cplusplus
@@ -77,62 +115,18 @@ using namespace std;
 // http://www.mathworks.com/support/solutions/en/data/1-6NU359/index.html
 
 
-// Typedefs
-// Create a struct for open position
-typedef struct openEntry
-{
-	int sigIndex;				// Array index of signal that created open position
-	int qtyOpen;				// Quantity of created open position
-	double openPrice;			// Entry price of open position
-	double profitPrice;			// Price where position will be closed with a profit
-} openEntry;
-
-// Create struct for profit ledger
-typedef struct profitEntry
-{
-	int barIndex;				// Array index of observation that create the profit taking
-	int qtyProfit;				// Quantity bought or sold at the profit taking price
-	double profitPrice;			// Profit price
-} profitEntry;
-
-
 // Prototypes
-openEntry createOpenLedgerEntry(int ID, int qty, double price);
-profitEntry createProfitLedgerEntry(int ID, int qty, double price);
-
-bool isTrade(double isSig);
-bool knownAdvSig(double advSig);
-int sumQty(const list<openEntry> &theList);
-double getAvgPftPrice(const list<openEntry> &openLedger);
-void shrinkProfitLedger(list<profitEntry> &profitLedger);
-//void moveOpenLedger(list<openEntry> &openLedger, const int ID, int qty, int &openPosition);
-void moveProfitLedger(list<profitEntry> &profitLedger, const int ID, int qty, double price);
-void checkOpen(list<openEntry> &openLedger, list<profitEntry> &profitLedger, const int ID, int &openPosition);
-void newAvgChk(list<openEntry> &openLedger, list<profitEntry> &profitLedger, const int ID, int &openPosition, double &minMax);
-void newMinMax(list<openEntry> &openLedger,  list<profitEntry> &profitLedger, const int ID, int &openPosition, double &minMax);
-void checkMinMax(list<openEntry> &openLedger, list<profitEntry> &profitLedger, const int ID, int &openPosition, double &minMax);
-void chkOpenMethod(int &openPosition, const int curBar, double &minMax, list<openEntry> &openLedger, list<profitEntry> &profitLedger);
-void sameBarProfitCheck(list<openEntry> &openLedger, list<profitEntry> &profitLedger, const int ID, int qty, int &openPosition, double &minMax);
+plSeries inputSeries(const mxArray *array_IN, double scale);
+mxArray *returnInput(const mxArray *array_IN, const plSeries &series);
+bool isOption(const mxArray *option_IN, const char *name);
+void checkCommand(const mxArray *command_IN);
+mxArray *createStatsStruct(const vector<plStats> &tgtStats);
 
 // Macros
-#define isReal2DfullDouble(P) (!mxIsComplex(P) && mxGetNumberOfDimensions(P) == 2 && !mxIsSparse(P) && mxIsDouble(P))
+#define isReal2Dfull(P) (!mxIsComplex(P) && mxGetNumberOfDimensions(P) == 2 && !mxIsSparse(P))
+#define isReal2DfullDouble(P) (isReal2Dfull(P) && mxIsDouble(P))
 #define isRealScalar(P) (isReal2DfullDouble(P) && mxGetNumberOfElements(P) == 1)
 
-// Global Variables
-double PROFIT_TGT;				// Calculated profit target (for readability)
-double numTicks;				// Number of ticks (representing $ multiples) in which to take a profit
-double minTick;					// What a single tick increment is for a given contract
-double openAvg;					// Should we manage profit taking on a per contract basis or average the net position (0 = atomic | 1 = average)
-
-double *barsInPtr;				// Pointer for the price matrix
-double *sigInPtr;				// Pointer for the signal array
-int shiftOpen;					// used for readability 
-int shiftHigh;
-int shiftLow;
-int shiftClose;
-
-
-
 void mexFunction(int nlhs, mxArray *plhs[], /* Output variables */
 				 int nrhs, const mxArray *prhs[]) /* Input variables */
 {
@@ -145,45 +139,87 @@ void mexFunction(int nlhs, mxArray *plhs[], /* Output variables */
 	// mexWarnMsgTxt	Issue warning message
 	// mexPrintf("Hello, world!");
 
-	// Check number of inputs
-	if (nrhs != 5)
+	// The fused profit target and P&L command is given as a leading string
+	const bool plMode = (nrhs > 0 && mxIsChar(prhs[0]));
+	if (plMode)
+		checkCommand(prhs[0]);
+
+	const int arg0 = plMode ? 1 : 0;			// Index of 'barsIn'
+	const int barsOutIdx = plMode ? 4 : 0;			// Index of 'barsOut'.  'sigOut' follows
+
+	// Check number of inputs.  The positional inputs may be followed by 'doubledSig' and, for 'pl', 'stats'
+	const int numPositional = plMode ? 8 : 5;
+	if (nrhs < numPositional || nrhs > numPositional + (plMode ? 2 : 1))
 		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:NumInputs",
 		"Number of input arguments is not correct. Aborting.");
+
+	bool statsMode = false;
+	bool doubledSig = false;
+	for (int arg = numPositional; arg < nrhs; arg++)
+	{
+		if (plMode && !statsMode && isOption(prhs[arg], "stats"))
+			statsMode = true;
+		else if (!doubledSig && isOption(prhs[arg], "doubledsig"))
+			doubledSig = true;
+		else
+			mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:UnknownOption",
+			"The options are 'doubledSig' and, for 'pl' only, 'stats'. Aborting.");
+	}
+
 	// Check number of output assignments
-	if (nlhs != 2)
+	if (statsMode ? (nlhs > 2) : plMode ? (nlhs < 4 || nlhs > 6) : (nlhs != 2))
 		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:NumOutputs",
 		"Number of output assignments is not correct. Aborting.");
 
 	// Define constants (#define assigns a variable as either a constant or a macro)
 	// Inputs
-#define bars_IN		prhs[0]
-#define sig_IN		prhs[1]
-#define minTick_IN	prhs[2]
-#define numTicks_IN	prhs[3]
-#define openAvg_IN	prhs[4]
+#define bars_IN		prhs[arg0]
+#define sig_IN		prhs[arg0 + 1]
+#define minTick_IN	prhs[arg0 + 2]
+#define numTicks_IN	prhs[arg0 + 3]
+#define openAvg_IN	prhs[arg0 + 4]
+#define bigPoint_IN	prhs[arg0 + 5]
+#define cost_IN		prhs[arg0 + 6]
 	// Outputs
-#define bars_OUT	plhs[0]
-#define sig_OUT		plhs[1]
+#define bars_OUT	plhs[barsOutIdx]
+#define sig_OUT		plhs[barsOutIdx + 1]
+#define cash_OUT	plhs[0]
+#define openEQ_OUT	plhs[1]
+#define netLiq_OUT	plhs[2]
+#define returns_OUT	plhs[3]
+#define stats_OUT	plhs[0]
+#define tgtSig_OUT	plhs[1]
 
 	// Init variables
 	mwSize rowsPrice, colsPrice, rowsSig, colsSig;
-	double  *barsOutPtr, *sigOutPtr;
+	double  *barsOutPtr = NULL, *sigOutPtr = NULL;
+	double *cashPtr = NULL, *openEQPtr = NULL, *netLiqPtr = NULL, *returnsPtr = NULL;
+	double bigPoint = 0, cost = 0;
 
 
 	// Check type of supplied inputs
-	if (!isReal2DfullDouble(bars_IN)) 
+	if (!isReal2Dfull(bars_IN) || !(mxIsDouble(bars_IN) || mxIsInt32(bars_IN)))
 		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:BadInputType",
-		"Input 'barsIn' must be a 2 dimensional full double array of type Open | High | Low | Close. Aborting.");
+		"Input 'barsIn' must be a 2 dimensional full double or int32 (ticks) array of type Open | High | Low | Close. Aborting.");
 
-	if (!isReal2DfullDouble(sig_IN)) 
+	if (!isReal2Dfull(sig_IN) || !(mxIsDouble(sig_IN) || mxIsInt8(sig_IN) || mxIsInt16(sig_IN)))
 		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:BadInputType",
-		"Input 'sigIn' must be a 2 dimensional full double array. Aborting.");
+		"Input 'sigIn' must be a 2 dimensional full double, int8 or int16 array. Aborting.");
+
+	if (doubledSig && mxIsDouble(sig_IN))
+		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:UnknownOption",
+		"Option 'doubledSig' only applies to int8 or int16 'sigIn'. Aborting.");
 
 	if (!isRealScalar(minTick_IN)) 
 		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:BadInputType",
 		"Input 'minTick' must be a single scalar double. Aborting.");
 
-	if (!isRealScalar(numTicks_IN)) 
+	if (statsMode && (!isReal2DfullDouble(numTicks_IN) || mxGetNumberOfElements(numTicks_IN) < 1
+		|| (mxGetM(numTicks_IN) > 1 && mxGetN(numTicks_IN) > 1)))
+		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:BadInputType",
+		"Input 'numTicks' must be a double scalar or vector. Aborting.");
+
+	if (!statsMode && !isRealScalar(numTicks_IN)) 
 		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:BadInputType",
 		"Input 'numTicks' must be a single scalar double. Aborting.");
 
@@ -191,19 +227,19 @@ void mexFunction(int nlhs, mxArray *plhs[], /* Output variables */
 		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:BadInputType",
 		"Input 'openAvg_IN' must be a single scalar double. Aborting.");
 
+	if (plMode && !isRealScalar(bigPoint_IN)) 
+		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:BadInputType",
+		"Input 'bigPoint' must be a single scalar double. Aborting.");
+
+	if (plMode && !isRealScalar(cost_IN)) 
+		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:BadInputType",
+		"Input 'cost' must be a single scalar double. Aborting.");
+
 	// Assign variables
 	rowsPrice = mxGetM(bars_IN);
 	colsPrice = mxGetN(bars_IN);
 	rowsSig = mxGetM(sig_IN);
 	colsSig = mxGetN(sig_IN);
-	const double mxLINEAR_SIZE = rowsPrice * colsPrice;	// mxArray is passed as a continuous 1 dimensional array
-
-	// Assign shift variables
-	// This allows up to properly traverse the mxArray which is in an N x 1 form concatenating all columns
-	shiftOpen = 0;						// used for readability 
-	shiftHigh = rowsPrice;
-	shiftLow = 2 * rowsPrice;
-	shiftClose = 3 * rowsPrice;				
 
 	// Additional check of inputs
 	if (rowsPrice != rowsSig)
@@ -218,7 +254,7 @@ void mexFunction(int nlhs, mxArray *plhs[], /* Output variables */
 		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:ScalarMismatch",
 		"Input 'minTick' must be a double scalar value. Aborting.");
 
-	if (!isRealScalar(numTicks_IN)) 
+	if (!statsMode && !isRealScalar(numTicks_IN)) 
 		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:ScalarMismatch",
 		"Input 'numTicks' must be a double scalar value. Aborting.");
 
@@ -226,14 +262,27 @@ void mexFunction(int nlhs, mxArray *plhs[], /* Output variables */
 		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:ArrayMismatch",
 		"Input 'barsIn' must be a 2 dimensional full double array of type Open | High | Low | Close. Aborting.");
 
-	/* Assign pointers to the input arrays */ 
-	barsInPtr =		mxGetPr(bars_IN);
-	sigInPtr =		mxGetPr(sig_IN);
-
 	/* Assign scalar values */
-	minTick =	mxGetScalar(minTick_IN);
-	numTicks =	mxGetScalar(numTicks_IN);
-	openAvg =	mxGetScalar(openAvg_IN);
+	const double minTick =	mxGetScalar(minTick_IN);
+	const double *numTicksPtr = mxGetPr(numTicks_IN);
+	const mwSize numTargets = mxGetNumberOfElements(numTicks_IN);
+	const double openAvg =	mxGetScalar(openAvg_IN);
+
+	if (plMode)
+	{
+		bigPoint =	mxGetScalar(bigPoint_IN);
+		cost =		mxGetScalar(cost_IN);
+	}
+
+	if (mxIsInt32(bars_IN) && minTick <= 0)
+		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:minTickError",
+		"Input 'barsIn' given in int32 ticks requires a positive 'minTick'. Aborting.");
+
+	/* Assign the input series */ 
+	// Compact inputs are read in place through the series, each element scaled as it is read
+	// int32 prices are tick counts.  With 'doubledSig' integer signals hold twice the signal
+	const plSeries barsIn = inputSeries(bars_IN, minTick);
+	const plSeries sigIn = inputSeries(sig_IN, doubledSig ? 0.5 : 1.0);
 
 	// Final check of inputs
 	if ((openAvg != 0) && (openAvg != 1))
@@ -248,698 +297,208 @@ void mexFunction(int nlhs, mxArray *plhs[], /* Output variables */
 			"Input 'minTick' must be an integer greater than or equal to zero. \nInput was given as %d. Aborting.", minTick);
 	}
 
-	PROFIT_TGT = (minTick * numTicks);
-
 	// START //
-	// Initialize variables
-	int	sigIndex;					// Iterator that will store the index of the referenced signal
-	bool anyTrades = false;					// Trade logical
+	// The inputs are read through a context and each target keeps its own ledgers so no state outlives the call
+	const profitContext ctx = createProfitContext(barsIn, sigIn, int(rowsPrice), minTick, openAvg);
 
-	// Check that we have at least one signal (at least one trade)
-	for (sigIndex=0; sigIndex < int(rowsSig); sigIndex++)	// Remember C++ starts counting at '0'
+	// Profit taking state of each target.  Every target is advanced on the same bar before moving to the next,
+	// so the inputs are traversed once however many targets are given
+	vector<targetState> targets(numTargets);
+	for (mwSize tgt = 0; tgt < numTargets; tgt++)
 	{
-		if (isTrade(sigInPtr[sigIndex]))		// See if we have a signal
-		{
-			anyTrades = true;
-			break;					// Exit the for loop
-		}
-	}	
+		initTarget(targets[tgt], minTick * numTicksPtr[tgt]);
+	}
 
-	// If there are no trades or the minTick is zero indicating no profit taking then return the original input.
-	// Otherwise start the check for profit targets reached per open position
-	// We have no trades
-	if (!anyTrades || minTick == 0)						
+	// If there are no trades or the minTick is zero indicating no profit taking the profit ledgers stay empty
+	// and the original input is returned
+	double badSig = 0;
+	if (findProfits(ctx, targets, badSig) != 0)
 	{
-		// http://www.mathworks.com/support/solutions/en/data/1-6NU359/index.html
-		// Return what we were given
-		bars_OUT	= mxCreateSharedDataCopy(bars_IN);
-		sig_OUT		= mxCreateSharedDataCopy(sig_IN);
+		mexErrMsgIdAndTxt( "MATLAB:AdvancedSignal:fractionUnknown",
+			"A signal contained an advanced fractional instruction %f that we could not interpret. Aborting.", badSig);
 	}
-	// We have trades
-	else									
-	{
-		double minMax;					// Current minimum | maximum to optimize (minimize) checks
-
-		/////////////
-		//
-		// FIRST SIGNAL PROCESSING
-		//
-		/////////////	
-		
-		// Initialize ledgers for open positions and profits
-		list<openEntry> openLedger;
-		list<profitEntry> profitLedger;
-
-		// Put first detected trade on openLedger
-		openLedger.push_back(createOpenLedgerEntry(sigIndex, int(sigInPtr[sigIndex]), barsInPtr[sigIndex + 1 + shiftOpen]));
-
-		// Short signal.  Assign minMax to LOW
-		if (sigInPtr[sigIndex] < 0)		
-		{
-			minMax = barsInPtr[sigIndex + 1 + shiftLow];
-		}
-		// Long signal. Assign minMax to HIGH
-		else if (sigInPtr[sigIndex] > 0)	
-		{
-			minMax = barsInPtr[sigIndex + 1 + shiftHigh];
-		}
-
-		// Check for profit on same observation
-		// 'minMax' has been updated so we can safely call 'sameBarProfitCheck'
-		int openPosition = 0;
-		sameBarProfitCheck(openLedger, profitLedger, sigIndex, int(sigInPtr[sigIndex]), openPosition, minMax);
 
-		// FIRST BAR END
-
-		/////////////
-		//
-		// ITERATE SECTION
-		//
-		/////////////
+	/////////////
+	//
+	// OUTPUT PROCESSING
+	//
+	/////////////
+	if (statsMode)
+	{
+		// Per target summaries and, if asked for, the expanded signal of each target
+		vector<plStats> tgtStats(numTargets);
+		vector<double*> tgtSigPtrs(numTargets, (double*)NULL);
 
-		// ITERATE REMAINING BARS
-		// sigIndex = first signal index
-		for (int curBar=sigIndex + 1; curBar < int(rowsSig)-1; curBar++)
+		if (nlhs > 1)
 		{
-
-		// ORDER OF SIGNIFICANCE from a signal with an existing position
-			// REVERSE
-			if (fraction(sigInPtr[curBar]))
+			tgtSig_OUT = mxCreateCellMatrix(1, numTargets);
+			for (mwSize tgt = 0; tgt < numTargets; tgt++)
 			{
-				// Is fraction the same sign (additive in nature) ?
-				// Additive
-				if (sign(sigInPtr[curBar] == sign(openPosition)))
-				{
-					// Nothing to do with the current logic
-					// The only fraction currently in use is |0.5| to liquidate entire opposing openPosition
-				}
-				// Reductive (liquidate)
-				else
-				{
-					// Adding logic here for prevention of 'other' fractions or surprising inputs
-					if (knownAdvSig(sigInPtr[curBar]))
-					{
-						// Liquidate any open position
-						openLedger.clear();
-						openPosition = 0;
-					}
-					// Unknown advanced instruction
-					else
-					{
-						mexErrMsgIdAndTxt( "MATLAB:AdvancedSignal:fractionUnknown",
-							"A signal contained an advanced fractional instruction that we could not interpret. Aborting.");
-					}
-				}
-			}
-
-			// REDUCE or ADD
-			// Do we have a signal with an integer portion ?
-			if (abs(int(sigInPtr[curBar])) >= 1)
-			{
-				// Signal is reductive
-				if ((int(sigInPtr[curBar]) > 0 && openPosition < 0) || (int(sigInPtr[curBar]) < 0 && openPosition > 0))					
-				{
-					// Signal is effectively a reverse or liquidate
-					if (int(sigInPtr[curBar]) >= openPosition)
-					{
-						openPosition = int(sigInPtr[curBar]) + openPosition;
-						openLedger.clear();
-						if (openPosition != 0)
-						{
-							openLedger.push_back(createOpenLedgerEntry(curBar, openPosition, barsInPtr[curBar + 1 + shiftOpen]));
-						}
-					}
-					else
-					{
-						// How many do we need to reduce by?
-						int needQty = int(sigInPtr[curBar]);
-						// Prepare to iterate until we are satisfied
-						while (needQty !=0)
-						{
-							// Is the current line item quantity larger than what we need?
-							if (abs(openLedger.front().qtyOpen) > needQty)
-							{
-								// Reduce the position size.  We are aggregating so we add (e.g. 5 Purchases + 4 Sales = 1 Long)
-								openLedger.front().qtyOpen = openLedger.front().qtyOpen + needQty;
-								// We are satisfied and don't need any more contracts
-								needQty = 0;
-							}
-							// Current line item quantity is equal to or smaller than what we need.  Process P&L and remove.
-							else
-							{
-								// Reduce needed quantity by what we've been provided
-								needQty = needQty + openLedger.front().qtyOpen;
-								// Remove the line item (FIFO)
-								openLedger.pop_front();
-							}
-						}
-						openPosition = openPosition + int(sigInPtr[curBar]);
-					}
-				}
-				// Signal is additive
-				else
-				{
-					// Before adding, check if the open qualifies to liquidate any existing position
-					if (openPosition != 0)
-					{
-						chkOpenMethod(openPosition, curBar, minMax, openLedger, profitLedger);
-					}
-					
-					// Process addition
-					// Put trade on openLedger
-					openLedger.push_back(createOpenLedgerEntry(curBar, int(sigInPtr[curBar]), barsInPtr[curBar + 1 + shiftOpen]));
-					sameBarProfitCheck(openLedger, profitLedger, curBar, int(sigInPtr[curBar]), openPosition, minMax);
-				}
-			}
-			// NONE
-			else
-			{
-				// We can just check against the open and leave the range check for all entries on the openLedger below
-				// Only check if necessary
-				if (openPosition !=0)
-				{
-					chkOpenMethod(openPosition, curBar, minMax, openLedger, profitLedger);
-				}
-				
-			}
-
-			// Check for extremes that result in a profit for any openPosition
-			if (openPosition != 0)
-			{
-				checkMinMax(openLedger, profitLedger, curBar, openPosition, minMax);
+				mxArray *sigCol = mxCreateDoubleMatrix(rowsPrice + targets[tgt].profitLedger.size(), 1, mxREAL);
+				tgtSigPtrs[tgt] = mxGetPr(sigCol);
+				mxSetCell(tgtSig_OUT, tgt, sigCol);
 			}
 		}
 
-		/////////////
-		//
-		// OUTPUT PROCESSING
-		//
-		/////////////
-		if (!profitLedger.empty())
+		if (statsTargets(ctx, targets, bigPoint, cost, tgtStats, tgtSigPtrs, badSig) != 0)
 		{
-			shrinkProfitLedger(profitLedger);
-			int numNewObsv = profitLedger.size();	// number of new signals and virtual profit bars to add
-
-			/* Create matrices for the return arguments */ 
-			// http://www.mathworks.com/help/matlab/matlab_external/c-c-source-mex-files.html
-			// http://www.mathworks.com/help/matlab/apiref/mxcreatedoublematrix.html
-			mwSize numNewRows = rowsPrice + (mwSize)numNewObsv;
-
-			bars_OUT = mxCreateDoubleMatrix(numNewRows, 4, mxREAL);
-			sig_OUT = mxCreateDoubleMatrix(numNewRows, 1, mxREAL);
-
-			// assign the variables for manipulating the arrays (by pointer reference)
-			barsOutPtr = mxGetPr(bars_OUT);
-			sigOutPtr = mxGetPr(sig_OUT);
-
-			// Temporary lists
-			list<double> signals;
-			list<double> vBars;
-
-			// List iterators
-			list<double>::const_iterator signalsIter		= signals.begin();
-			list<double>::const_iterator vBarsIter			= vBars.begin();
-			list<double>::const_iterator vBarsOpenIter		= vBars.begin();
-			list<double>::const_iterator vBarsHighIter		= vBars.begin();
-			list<double>::const_iterator vBarsLowIter		= vBars.begin();
-			list<double>::const_iterator vBarsCloseIter		= vBars.begin();
-
-			// Preposition pointers
-			advance(vBarsHighIter, shiftHigh);
-			advance(vBarsLowIter, shiftLow);
-			advance(vBarsCloseIter, shiftClose);
-
-			// deep copy mxArray --> myDblList
-			for (int iter = 0; iter < mxLINEAR_SIZE; iter++)
-			{
-				vBars.push_back(barsInPtr[iter]);
-			}
-
-			for (int iter = 0; iter < int(rowsSig); iter++)
-			{
-				signals.push_back(sigInPtr[iter]);
-			}
-
-			// Inserts based on profitLedger
-			list<profitEntry>::iterator pftIter;
-			int shiftAdd = 0;
-			int lastLoc = 0;
-
-			// Reset pointers
-			signalsIter		= signals.begin();
-			vBarsOpenIter	= vBars.begin();
-			vBarsHighIter	= vBars.begin();
-			vBarsLowIter	= vBars.begin();
-			vBarsCloseIter	= vBars.begin();
-
-			advance(vBarsHighIter, shiftHigh);
-			advance(vBarsLowIter, shiftLow);
-			advance(vBarsCloseIter, shiftClose);
-
-			// Move price pointer to sync with signal pointer (signal lags price by one bar)
-			vBarsOpenIter++;
-			vBarsHighIter++;
-			vBarsLowIter++;
-			vBarsCloseIter++;
-
-			// At this point we should have pointers as
-			// signals[0]
-			// vBarsOpenIter[1]
-			// vBarsHighIter[1 + shiftHigh] ...
-
-			// Because we insert before the current index we move all pointers 'in front' of the insertion point
-			signalsIter++;
-			vBarsOpenIter++;
-			vBarsHighIter++;
-			vBarsLowIter++;
-			vBarsCloseIter++;
-
-			while (!profitLedger.empty())
-			{
-				pftIter = profitLedger.begin();
-
-				shiftAdd = pftIter->barIndex - lastLoc;
-
-				// Advance the pointers to insert location
-				advance(signalsIter, shiftAdd);
-				advance(vBarsOpenIter, shiftAdd);
-				advance(vBarsHighIter, shiftAdd);
-				advance(vBarsLowIter, shiftAdd);
-				advance(vBarsCloseIter, shiftAdd);
-
-				signals.insert(signalsIter, pftIter->qtyProfit);
-				vBars.insert (vBarsOpenIter,pftIter->profitPrice);
-				vBars.insert (vBarsHighIter,pftIter->profitPrice);
-				vBars.insert (vBarsLowIter,pftIter->profitPrice);
-				vBars.insert (vBarsCloseIter,pftIter->profitPrice);
-
-				lastLoc = pftIter->barIndex;
-
-				profitLedger.pop_front();
-			}
-
-			// Reset pointer
-			int outIter = 0;
-
-			for (vBarsIter	= vBars.begin(); vBarsIter != vBars.end(); vBarsIter++)
-			{
-				barsOutPtr[outIter] = *vBarsIter;
-				outIter++;
-			}
-
-			// Reset index
-			outIter = 0;
-			for (signalsIter = signals.begin(); signalsIter != signals.end(); signalsIter++)
-			{
-				sigOutPtr[outIter] = *signalsIter;
-				outIter++;
-			}
+			mexErrMsgIdAndTxt( "MATLAB:AdvancedSignal:fractionUnknown",
+				"A signal contained an advanced fractional instruction %f that we could not interpret. Aborting.", badSig);
 		}
-		else // return inputs
-		{
-			// http://www.mathworks.com/support/solutions/en/data/1-6NU359/index.html
-			// Return what we were given
 
-			bars_OUT = mxCreateSharedDataCopy(bars_IN);
-			sig_OUT = mxCreateSharedDataCopy(sig_IN);
-		}
-		
+		stats_OUT = createStatsStruct(tgtStats);
+
+		return;
 	}
 
-	return;
-}
+	// A single target
+	const vector<profitEntry> &profitLedger = targets[0].profitLedger;
 
-/////////////
-//
-// FUNCTIONS & METHODS
-//
-/////////////
+	/* Create matrices for the return arguments */ 
+	// http://www.mathworks.com/help/matlab/matlab_external/c-c-source-mex-files.html
+	// http://www.mathworks.com/help/matlab/apiref/mxcreatedoublematrix.html
+	const mwSize numNewRows = rowsPrice + (mwSize)profitLedger.size();	// Original rows plus the virtual profit rows
 
-// Constructor for ledger line item creation
-openEntry createOpenLedgerEntry(int ID, int qty, double price)
-{
-	openEntry OpenLedgerEntry;
-	OpenLedgerEntry.sigIndex = ID;
-	OpenLedgerEntry.qtyOpen = qty;
-	OpenLedgerEntry.openPrice = price;
-	if (qty < 0)
+	// Expanded bars and signals are only built when they are asked for ('pl' may leave them out)
+	if (profitLedger.empty())
 	{
-		OpenLedgerEntry.profitPrice = price - (minTick * numTicks);
+		// http://www.mathworks.com/support/solutions/en/data/1-6NU359/index.html
+		// Return what we were given
+		if (nlhs > barsOutIdx)
+			bars_OUT = returnInput(bars_IN, barsIn);
+		if (nlhs > barsOutIdx + 1)
+			sig_OUT = returnInput(sig_IN, sigIn);
 	}
 	else
 	{
-		OpenLedgerEntry.profitPrice = price + (minTick * numTicks);
-	}
-
-	return OpenLedgerEntry;
-}
-
-profitEntry createProfitLedgerEntry(int ID, int qty, double price)
-{
-	profitEntry ProfitLedgerEntry;
-	ProfitLedgerEntry.barIndex = ID;
-	ProfitLedgerEntry.qtyProfit = qty;												// Quantity already transformed at calling function
-	ProfitLedgerEntry.profitPrice = price;
-
-	return ProfitLedgerEntry;
-}
-
-void moveProfitLedger(list<profitEntry> &profitLedger, const int ID, int qty, double price)
-{
-	// We take the price of the next observation for the generated signal
-	// We reverse the quantity to reflect closing of the positions
-	profitLedger.push_back(createProfitLedgerEntry(ID, qty * -1, price));	
-}
-
-void sameBarProfitCheck(list<openEntry> &openLedger, list<profitEntry> &profitLedger, const int ID, int qty, int &openPosition, double &minMax)
-{
-	if (openAvg == 0)
-	{
-		// Is there a profit on the bar of the trade? 
-		// Short signal - check LOW
-		if ((qty < 0) && (barsInPtr[ID + 1 + shiftLow] < barsInPtr[ID + 1 + shiftOpen] - PROFIT_TGT))
+		if (nlhs > barsOutIdx)
 		{
-			// We have a profit on the same observation.  Move the entry in the profit ledger
-			moveProfitLedger(profitLedger, ID, qty, barsInPtr[ID + 1 + shiftOpen] - PROFIT_TGT);
-			openPosition = openPosition - qty;
-			openLedger.pop_back();
+			bars_OUT = mxCreateDoubleMatrix(numNewRows, 4, mxREAL);
+			barsOutPtr = mxGetPr(bars_OUT);
 		}
-		// Long signal - check HIGH
-		else if ((qty > 0) && (barsInPtr[ID + 1 + shiftHigh] > barsInPtr[ID + 1 + shiftOpen] + PROFIT_TGT))	
+		if (nlhs > barsOutIdx + 1)
 		{
-			// We have a profit on the same observation.  Put entry in the profit ledger
-			moveProfitLedger(profitLedger, ID, qty, barsInPtr[ID + 1 + shiftOpen] + PROFIT_TGT);
-			openPosition = openPosition - qty;
-			openLedger.pop_back();
-		} 
-		else
-		{
-			openPosition = openPosition + qty;
+			sig_OUT = mxCreateDoubleMatrix(numNewRows, 1, mxREAL);
+			sigOutPtr = mxGetPr(sig_OUT);
 		}
 	}
-	else
-	{
-
-		// Check same bar using new average
-		// Requires minMax already updated !!
-		newAvgChk(openLedger, profitLedger, ID, openPosition, minMax);
 
+	if (plMode)
+	{
+		cash_OUT = mxCreateDoubleMatrix(numNewRows, 1, mxREAL);
+		openEQ_OUT = mxCreateDoubleMatrix(numNewRows, 1, mxREAL);
+		netLiq_OUT = mxCreateDoubleMatrix(numNewRows, 1, mxREAL);
+		returns_OUT = mxCreateDoubleMatrix(numNewRows, 1, mxREAL);
+
+		cashPtr = mxGetPr(cash_OUT);
+		openEQPtr = mxGetPr(openEQ_OUT);
+		netLiqPtr = mxGetPr(netLiq_OUT);
+		returnsPtr = mxGetPr(returns_OUT);
 	}
-}
 
-// A new High | Low has occurred and we have determined that we have an openPosition
-// Check if profit targets have been reached
-void newMinMax(list<openEntry> &openLedger,  list<profitEntry> &profitLedger, const int ID, int &openPosition, double &minMax)
-{
-	if (!openLedger.empty())
+	// Merge the original rows and the virtual profit rows in bar order straight in to the requested outputs
+	if (barsOutPtr != NULL || sigOutPtr != NULL || cashPtr != NULL)
 	{
-		if (openAvg == 0)
+		if (expandRows(ctx, profitLedger, numNewRows, barsOutPtr, sigOutPtr, bigPoint, cost,
+			cashPtr, openEQPtr, netLiqPtr, returnsPtr, badSig) != 0)
 		{
-			list<openEntry>::iterator iter;
-			for (iter = openLedger.begin(); iter != openLedger.end(); iter++)
-			{
-				// Short. Check minMax <= profitPrice
-				if (openPosition < 0)				
-				{
-					if (minMax <= iter->profitPrice)
-					{
-						moveProfitLedger(profitLedger, ID, iter->qtyOpen, iter->profitPrice);
-						openLedger.erase(iter);
-					}
-				}
-				// Long. Check minMax >= profitPrice
-				else if (openPosition > 0)		
-				{
-					if (minMax >= iter->profitPrice)
-					{
-						moveProfitLedger(profitLedger, ID, iter->qtyOpen, iter->profitPrice);
-						openLedger.erase(iter);
-					}
-				}
-
-				// Update openPosition
-				if(openLedger.empty())
-				{
-					openPosition = 0;
-					// We have deleted the last openLedger entry
-					// This protects against the iterator losing reference
-					break;
-				}
-				else
-				{
-					openPosition = sumQty(openLedger);
-				}
-			}
-		}
-		// Using the average price approach 
-		else
-		{
-			newAvgChk(openLedger, profitLedger, ID, openPosition, minMax);
+			mexErrMsgIdAndTxt( "MATLAB:AdvancedSignal:fractionUnknown",
+				"A signal contained an advanced fractional instruction %f that we could not interpret. Aborting.", badSig);
 		}
 	}
+
+	return;
 }
 
-void newAvgChk(list<openEntry> &openLedger, list<profitEntry> &profitLedger, const int ID, int &openPosition, double &minMax)
-{
-	double profitPrice = getAvgPftPrice(openLedger);
+/////////////
+//
+// FUNCTIONS & METHODS
+//
+/////////////
 
-	if (openPosition < 0)					// Short. Check minMax <= profitPrice
-	{
-		if (minMax <= profitPrice)
-		{
-			while (!openLedger.empty())
-			{
-				moveProfitLedger(profitLedger, openLedger.front().sigIndex, openLedger.front().qtyOpen, profitPrice);
-				profitLedger.pop_front();
-			}
-			openPosition = 0;
-		}
-	}
-	else if (openPosition > 0)				// Long. Check minMax >= profitPrice
-	{
-		if (minMax >= profitPrice)
-		{
-			while (!openLedger.empty())
-			{
-				moveProfitLedger(profitLedger, openLedger.front().sigIndex, openLedger.front().qtyOpen, profitPrice);
-				profitLedger.pop_front();
-			}
-			openPosition = 0;
-		}
-	}
+// Series reading an input in place.  Integer elements are multiplied by 'scale' as they are read, double ones are not
+plSeries inputSeries(const mxArray *array_IN, double scale)
+{
+	if (mxIsInt8(array_IN))
+		return createSeries(mxGetData(array_IN), PL_INT8, scale);
+	if (mxIsInt16(array_IN))
+		return createSeries(mxGetData(array_IN), PL_INT16, scale);
+	if (mxIsInt32(array_IN))
+		return createSeries(mxGetData(array_IN), PL_INT32, scale);
+
+	return createSeries(mxGetPr(array_IN));
 }
 
-double getAvgPftPrice(const list<openEntry> &openLedger)
+// Return an unchanged input.  A compact input is returned as the double values its series represents
+mxArray *returnInput(const mxArray *array_IN, const plSeries &series)
 {
-	int netQty = 0;
-	double wghtPrices = 0;
-	double sumWghts = 0;
-	double wghtAvg = 0;
-	double profitPrice = 0;
+	if (series.type == PL_DOUBLE)
+		return mxCreateSharedDataCopy(array_IN);
 
+	const int numElem = int(mxGetNumberOfElements(array_IN));
+	mxArray *array_OUT = mxCreateDoubleMatrix(mxGetM(array_IN), mxGetN(array_IN), mxREAL);
+	double *outPtr = mxGetPr(array_OUT);
+	for (int ii = 0; ii < numElem; ii++)
+		outPtr[ii] = seriesAt(series, ii);
 
-	list<openEntry>::const_iterator iter;
-	for (iter = openLedger.begin(); iter != openLedger.end(); iter++)
-	{
-		netQty = netQty + iter->qtyOpen;
-		sumWghts = sumWghts + (abs(iter->qtyOpen) * iter->openPrice);
-	}
-
-	wghtAvg = sumWghts / abs(netQty);
-
-	// Short objective
-	if (netQty < 0)
-	{
-		profitPrice = wghtAvg - PROFIT_TGT;
-	}
-	// Long objective
-	else
-	{
-		profitPrice = wghtAvg + PROFIT_TGT;
-	}
-
-	return profitPrice;
+	return array_OUT;
 }
 
-void checkOpen(list<openEntry> &openLedger, list<profitEntry> &profitLedger, const int ID, int &openPosition)
+// Case insensitive match of a string input
+bool isOption(const mxArray *option_IN, const char *name)
 {
-	if (openAvg == 0)
-	{
-		for (list<openEntry>::iterator iter = openLedger.begin(); iter != openLedger.end(); iter++)
-		{
-			// Short
-			if (openPosition < 0)
-			{
-				if (barsInPtr[ID + 1 + shiftOpen] <= iter->profitPrice)
-				{
-					// Open satisfies profit threshold
-					moveProfitLedger(profitLedger, ID, iter->qtyOpen, barsInPtr[ID + 1 + shiftOpen]);
-					openLedger.erase(iter);
-					// Update openPosition
-					if(openLedger.empty())
-					{
-						openPosition = 0;
-						// We have deleted the last openLedger entry
-						// This protects against the iterator losing reference
-						break;
-					}
-					else
-					{
-						openPosition = sumQty(openLedger);
-					}
-				}
-			}
-			// Long
-			else
-			{
-				if (barsInPtr[ID + 1 + shiftOpen] >= iter->profitPrice)
-				{
-					// Open satisfies profit threshold
-					moveProfitLedger(profitLedger, ID, iter->qtyOpen, barsInPtr[ID + 1 + shiftOpen]);
-					openLedger.erase(iter);
-					// Update openPosition
-					if(openLedger.empty())
-					{
-						openPosition = 0;
-						// We have deleted the last openLedger entry
-						// This protects against the iterator losing reference
-						break;
-					}
-					else
-					{
-						openPosition = sumQty(openLedger);
-					}
-				}
-			}
-		}
-	}
-	else
-	{
-		double profitPrice = getAvgPftPrice(openLedger);
+	if (!mxIsChar(option_IN))
+		return false;
 
-		if (openPosition < 0)
-		{
-			if (barsInPtr[ID + 1 + shiftOpen] <= profitPrice)
-			{
-				// Open satisfies profit threshold
-				while (!openLedger.empty())
-				{
-					moveProfitLedger(profitLedger, openLedger.front().sigIndex, openLedger.front().qtyOpen, barsInPtr[ID + 1 + shiftOpen]);
-					profitLedger.pop_front();
-				}
-				openPosition = 0;
-			}
-		}
-		else
-		{
-			if (barsInPtr[ID + 1 + shiftOpen] >= profitPrice)
-			{
-				// Open satisfies profit threshold
-				while (!openLedger.empty())
-				{
-					moveProfitLedger(profitLedger, openLedger.front().sigIndex, openLedger.front().qtyOpen, barsInPtr[ID + 1 + shiftOpen]);
-					profitLedger.pop_front();
-				}
-			}
-			openPosition = 0;
-		}
-	}
-};
+	int optNumChars = (int)mxGetN(option_IN)+1;		// +1 for the NULL added at the end
+	char *optAsChars = (char*)mxCalloc(optNumChars, sizeof(char));
 
-void checkMinMax(list<openEntry> &openLedger, list<profitEntry> &profitLedger, const int ID, int &openPosition, double &minMax)
-{
-	if (openPosition < 0)						// Short.  Check minMax to LOW
-	{
-		if (barsInPtr[ID + 1 + shiftLow] < minMax)		//New minMax
-		{
-			minMax = barsInPtr[ID + 1 + shiftLow];
-			newMinMax(openLedger, profitLedger, ID, openPosition, minMax);
-		}
-	}
-	else if (openPosition > 0)					// Long.  Check minMax to HIGH
-	{
-		if (barsInPtr[ID + 1 + shiftHigh] > minMax)		//New minMax
-		{
-			minMax = barsInPtr[ID + 1 + shiftHigh];
-			newMinMax(openLedger, profitLedger, ID, openPosition, minMax);
-		}			
-	}
-}
+	if (mxGetString(option_IN, optAsChars, optNumChars) != 0)
+		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:Parsing",
+		"Could not parse the given option. Aborting.");
 
-void shrinkProfitLedger(list<profitEntry> &profitLedger)
-{
-	list<profitEntry>::iterator iterMain, iterPlusOne;
+	string opt(optAsChars);
+	transform(opt.begin(), opt.end(), opt.begin(), ::tolower);
+	mxFree(optAsChars);
 
-	iterPlusOne = profitLedger.begin();				// Instantiate look ahead iterator first
-
-	for (iterMain = profitLedger.begin(); iterMain != profitLedger.end(); iterMain++)
-	{
-		++iterPlusOne;						// Advance the look ahead pointer so it is always iterMain+1;
-		if ((iterMain->barIndex == iterPlusOne->barIndex) &&
-			(sign(iterMain->qtyProfit) == sign(iterPlusOne->qtyProfit)))
-		{
-			iterPlusOne->qtyProfit = iterPlusOne->qtyProfit + iterMain->qtyProfit;
-			profitLedger.erase(iterMain);
-		}
-	}
+	return opt == name;
 }
 
-bool isTrade(double isSig)
+// Accept only the commands numTicksProfit understands
+void checkCommand(const mxArray *command_IN)
 {
-	if (abs(isSig)>=1)
-	{
-		return true;
-	}
-	return false;
+	if (!isOption(command_IN, "pl"))
+		mexErrMsgIdAndTxt( "MATLAB:numTicksProfit:UnknownCommand",
+		"Unknown command. The only command is 'pl'. Aborting.");
 }
 
-bool knownAdvSig(double advSig)
+// Build the 'stats' output with one column per profit target
+mxArray *createStatsStruct(const vector<plStats> &tgtStats)
 {
-	// We can check for known advanced signals to help in debugging
-	// by registering them here.  This can be a searchable array when
-	// more than one advanced signal exists.
-	// For now we only need to check for |0.5|
+	const char *fieldNames[] = {"sharpe", "maxDD", "profitFactor", "numTrades", "winRate"};
+	const int numFields = sizeof(fieldNames) / sizeof(fieldNames[0]);
+	const mwSize numTargets = tgtStats.size();
 
-	double frac = abs(advSig - int(advSig));
+	mxArray *stats = mxCreateStructMatrix(1, 1, numFields, fieldNames);
+	double *fieldPtr[numFields];
 
-	if (frac == 0.5)		// Close any opposing open position
+	for (int ff = 0; ff < numFields; ff++)
 	{
-		return true;
+		mxArray *field = mxCreateDoubleMatrix(1, numTargets, mxREAL);
+		fieldPtr[ff] = mxGetPr(field);
+		mxSetField(stats, 0, fieldNames[ff], field);
 	}
-	return false;
-}
 
-// Method to sum the quantity values in any struct of type tradeEntry
-int sumQty(const list<openEntry>& theList)
-{
-	int sumOfQty = 0;  // the sum is accumulated here
-	for (list<openEntry>::const_iterator it=theList.begin(); it!=theList.end(); it++)
+	for (mwSize tgt = 0; tgt < numTargets; tgt++)
 	{
-		sumOfQty += it->qtyOpen;
+		fieldPtr[0][tgt] = plSharpe(tgtStats[tgt]);
+		fieldPtr[1][tgt] = tgtStats[tgt].maxDD;
+		fieldPtr[2][tgt] = plProfitFactor(tgtStats[tgt]);
+		fieldPtr[3][tgt] = tgtStats[tgt].numTrades;
+		fieldPtr[4][tgt] = plWinRate(tgtStats[tgt]);
 	}
 
-	return sumOfQty;
-}
-
-void chkOpenMethod(int &openPosition, const int curBar, double &minMax, list<openEntry> &openLedger, list<profitEntry> &profitLedger )
-{
-	if (openPosition < 0)
-	{
-		// We can add a check to reduce calls to the function unless necessary
-		if(barsInPtr[curBar + 1 + shiftOpen] < minMax)
-		{
-			checkOpen(openLedger, profitLedger, curBar, openPosition);
-			minMax = barsInPtr[curBar + 1 + shiftOpen];
-		}
-	}
-	else if (openPosition > 0)
-	{
-		if(barsInPtr[curBar + 1 + shiftOpen] > minMax)
-		{
-			checkOpen(openLedger, profitLedger, curBar, openPosition);
-			minMax = barsInPtr[curBar + 1 + shiftOpen];
-		}
-	}	
+	return stats;
 }
 
 //
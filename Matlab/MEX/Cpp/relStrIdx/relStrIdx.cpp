@@ -21,29 +21,82 @@
 //
 // Matlab function:
 // rsi = relStrIdx_mex(data,N)
+// rsi = relStrIdx_mex(data,N,M)
+//
+// Streaming (live bar) usage:
+// h = relStrIdx('create',N)
+// h = relStrIdx('create',N,M)
+// rsi = relStrIdx('update',h,data)
+// rsi = relStrIdx('value',h)
+// saved = relStrIdx('save',h)
+// h = relStrIdx('restore',saved)
+// relStrIdx('destroy',h)
 // 
 // Inputs:
-//		data	A 1-D array of prices in the form of PRICE
-//		N	A scalar that defines the lookback period
+//		data	A 1-D array of prices in the form of PRICE, or an N x M panel with one column per instrument.
+//			Leading NaNs of a column are taken as history from before the instrument listed
+//		N	A scalar that defines the lookback period, or a vector of P lookback periods (e.g. 5:5:50)
+//		M	(Optional) Detrend length.  Price less its M bar simple moving average is taken in place of price.
+//			0 (default) does not detrend.  < 0 detrends with a 15*N average as rsiSTA and rsiSIG.
+//			A length beyond the number of observations is reduced to a third of them as rsiSTA and rsiSIG.
+//			May be a vector of P lengths paired with N (a scalar N or M is used for every P) to sweep detrends
 //
 // Outputs:
-//		rsi	The calculated relative strength index (RSI)
+//		rsi	The calculated relative strength index (RSI).  An N x P matrix with one column per lookback.
+//			A panel gives N x M (a single lookback) or N x M x P
+//
+//	NOTE: A lookback sweep is evaluated in one call.  Advances and declines are taken once per bar and the
+//		averages of every lookback are smoothed in the same pass, so each column equals relStrIdx(data,N(p)).
+//
+//	NOTE: The detrend is a running sum in the advance & decline pass, so no detrended copy of the data or separate
+//		average is made.  It rounds differently from relStrIdx(data - movAvg_mex(data,M,M,0),N): the two agree
+//		to 1e-9 RSI points (about 1e-10 at N = 2, 1e-12 at N >= 14) rather than bit for bit.  See bench/checkRelStrIdx
+//		TradeStation's rsiMatLab treats a negative rsiDetrend as a fixed offset of 15*rsiLength, which leaves
+//		the RSI unchanged, so M < 0 follows our Matlab signal functions instead.
+//
+//	NOTE: The streaming commands keep the Wilder smoothed averages and last price between calls so each new bar
+//		is an O(1) update and the results are bit-identical to the batch call on the accumulated data.
+//		'create'	Returns a handle to a new RSI of lookback N (scalar) and optional detrend M.
+//				M < 0 is 15*N as above.  As the length of the data is not known M is not reduced.
+//		'update'	Takes the prices appended since the last update ('data' holds only the new rows)
+//				and returns the RSI of each
+//		'value'		Returns the RSI of the last price taken (NaN while seeding)
+//		'save'		Returns the state as a row vector of doubles that may be stored, e.g. with the session
+//		'restore'	Returns a handle to a state rebuilt from 'save'
+//		'destroy'	Releases the state. All states are released when the MEX is cleared.
+//
+//	NOTE: The calculation lives in rsiCalc.cpp and holds no global state
+//		mex relStrIdx.cpp rsiCalc.cpp
+//
+//	NOTE: Panel columns are computed in place in Matlab's column major layout and are spread over threads when
+//		compiled with OpenMP, e.g. mex CXXFLAGS="\$CXXFLAGS -fopenmp" LDFLAGS="\$LDFLAGS -fopenmp" relStrIdx.cpp rsiCalc.cpp
+//		(COMPFLAGS="\$COMPFLAGS /openmp" with Visual C++).  A column with too little listed history is all NaN.
 //
 
 #include "mex.h"
+#include "rsiCalc.h"
+#include <algorithm>	// So we can transform the command string input ...
 #include <cmath>
-#include <limits>
+#include <map>
+#include <string>	// from char to string ensuring lowercase
+#include <vector>
 
 using namespace std;
 
+// Prototypes
+void rsiCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+mxArray *addStream(rsiState *st);
+rsiState *getStream(const mxArray *handle_IN);
+static void clearStreams();
+
+// Streaming RSI states by handle
+static map<int, rsiState*> s_rsiStreams;
+static int s_rsiNextHandle = 1;
+
 // Macros
 #define isReal2DfullDouble(P) (!mxIsComplex(P) && mxGetNumberOfDimensions(P) == 2 && !mxIsSparse(P) && mxIsDouble(P))
 #define isRealScalar(P) (isReal2DfullDouble(P) && mxGetNumberOfElements(P) == 1)
 
-// Global variables
-int obsvIn;
-double *barsInPtr;	// Pointer for the price matrix
-
 void mexFunction(int nlhs, mxArray *plhs[], /* Output variables */
 int nrhs, const mxArray *prhs[]) /* Input variables */
 {
@@ -56,8 +109,15 @@ int nrhs, const mxArray *prhs[]) /* Input variables */
 	// mexWarnMsgTxt	Issue warning message
 	// mexPrintf("Hello, world!"); /* Do something interesting */
 
+	// Streaming commands are given as a leading string
+	if (nrhs > 0 && mxIsChar(prhs[0]))
+	{
+		rsiCommand(nlhs, plhs, nrhs, prhs);
+		return;
+	}
+
 	// Check number of inputs
-	if (nrhs != 2)
+	if (nrhs != 2 && nrhs != 3)
 		mexErrMsgIdAndTxt( "MATLAB:relStrIdx:NumInputs",
 		"Number of input arguments is not correct. Aborting.");
 
@@ -69,15 +129,11 @@ int nrhs, const mxArray *prhs[]) /* Input variables */
 	// Inputs
 	#define bars_IN		prhs[0]
 	#define obsv_IN		prhs[1]
+	#define detrend_IN	prhs[2]
 
 	// Outputs
 	#define rsi_OUT		plhs[0]
 
-	// Create a NaN value
-	// mxArray *nanvalue;
-	// nanvalue = mxCreateDoubleScalar(mxGetNaN());
-	double m_Nan = std::numeric_limits<double>::quiet_NaN(); 
-
 	// Init variables
 	mwSize rowsData, colsData;
 
@@ -90,124 +146,251 @@ int nrhs, const mxArray *prhs[]) /* Input variables */
 		mexErrMsgIdAndTxt( "MATLAB:relStrIdx:BadInputType",
 		"Input 'data' must be a 2 dimensional full double array. Aborting.");
 
-	if (!isRealScalar(obsv_IN)) 
-		mexErrMsgIdAndTxt( "MATLAB:relStrIdx:BadInputType",
-		"Input 'N' must be a single integer input. Aborting.");
-
-	if (colsData > 1)
+	if (!isReal2DfullDouble(obsv_IN) || mxGetNumberOfElements(obsv_IN) < 1
+		|| (mxGetM(obsv_IN) > 1 && mxGetN(obsv_IN) > 1))
 		mexErrMsgIdAndTxt( "MATLAB:relStrIdx:BadInputType",
-		"We should only be given a 1-D price vector. Aborting.");
+		"Input 'N' must be a single integer input or a vector of integers. Aborting.");
 
 	/* Assign pointers to the input array */ 
-	barsInPtr =	mxGetPr(bars_IN);
+	const double *barsInPtr =	mxGetPr(bars_IN);
 
-	/* Assign scalar values */
-	obsvIn =	int(mxGetScalar(obsv_IN));
+	const mwSize numObsv = mxGetNumberOfElements(obsv_IN);
+	mwSize numDetrend = 0;
 
-	if (obsvIn < 1)
-		mexErrMsgIdAndTxt( "MATLAB:relStrIdx:BadInputType",
-		"The observation lookback must be a positive integer >= 1. Aborting.");
+	if (nrhs == 3)
+	{
+		numDetrend = mxGetNumberOfElements(detrend_IN);
 
-	if (obsvIn > rowsData)
-		mexErrMsgIdAndTxt( "MATLAB:relStrIdx:BadInputType",
-		"The lookback cannot be greater than the number of observations. Aborting.");
+		if (!isReal2DfullDouble(detrend_IN) || numDetrend < 1
+			|| (mxGetM(detrend_IN) > 1 && mxGetN(detrend_IN) > 1))
+			mexErrMsgIdAndTxt( "MATLAB:relStrIdx:BadInputType",
+			"Input 'M' must be a single integer input or a vector of integers. Aborting.");
+
+		if (numObsv > 1 && numDetrend > 1 && numObsv != numDetrend)
+			mexErrMsgIdAndTxt( "MATLAB:relStrIdx:BadInputSize",
+			"Vectors 'N' and 'M' must be the same length. Aborting.");
+	}
+
+	/* Assign lookback and detrend values.  A scalar N or M is used for every period */
+	const mwSize numPeriods = max(numObsv, numDetrend);
+	int *obsvIn = (int*)mxCalloc(numPeriods, sizeof(int));
+	int *detrendIn = (int*)mxCalloc(numPeriods, sizeof(int));
+
+	for (mwSize pp = 0; pp < numPeriods; pp++)
+	{
+		obsvIn[pp] = int(mxGetPr(obsv_IN)[numObsv > 1 ? pp : 0]);
+
+		if (obsvIn[pp] < 1)
+			mexErrMsgIdAndTxt( "MATLAB:relStrIdx:BadInputType",
+			"The observation lookback must be a positive integer >= 1. Aborting.");
+
+		if (mwSize(obsvIn[pp]) > rowsData)
+			mexErrMsgIdAndTxt( "MATLAB:relStrIdx:BadInputType",
+			"The lookback cannot be greater than the number of observations. Aborting.");
+
+		if (numDetrend > 0)
+		{
+			detrendIn[pp] = int(mxGetPr(detrend_IN)[numDetrend > 1 ? pp : 0]);
+
+			if (detrendIn[pp] < 0)
+				detrendIn[pp] = 15 * obsvIn[pp];
+
+			if (mwSize(detrendIn[pp]) > rowsData)
+				detrendIn[pp] = int(floor(rowsData / 3.0 + 0.5));
+		}
+	}
 
 	/* Create matrices for the return arguments */ 
 	// http://www.mathworks.com/help/matlab/matlab_external/c-c-source-mex-files.html
-	rsi_OUT = mxCreateDoubleMatrix(rowsData, 1, mxREAL);
+	if (colsData > 1 && numPeriods > 1)
+	{
+		const mwSize dims[3] = {rowsData, colsData, numPeriods};
+		rsi_OUT = mxCreateNumericArray(3, dims, mxDOUBLE_CLASS, mxREAL);
+	}
+	else
+	{
+		rsi_OUT = mxCreateDoubleMatrix(rowsData, colsData * numPeriods, mxREAL);
+	}
 
 	// assign the variables for manipulating the arrays (by pointer reference)
 	double *RSI = mxGetPr(rsi_OUT);
 
-	// Create temporary arrays for calculations
-	double *advances = new double[rowsData];
-	double *declines = new double[rowsData];
-	double *avgGain = new double[rowsData];
-	double *avgLoss = new double[rowsData];
-
 	/////////////
 	// START
 	/////////////
 
-	// Calculate advances & declines
-	advances[0] = 0;
-	declines[0] = 0;
+	// A single column is a panel of one
+	rsiPanel(barsInPtr, int(rowsData), int(colsData), obsvIn, detrendIn, int(numPeriods), RSI);
+
+	mxFree(obsvIn);
+	mxFree(detrendIn);
+
+	/////////////
+	// FINISHED
+	/////////////
+
+	return;
+}
+
+/////////////
+//
+// FUNCTIONS & METHODS
+//
+/////////////
+
+// Dispatch a streaming command given as a leading string
+void rsiCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	// Parse the command
+	int cmdNumChars = (int)mxGetN(prhs[0])+1;		// +1 for the NULL added at the end
+	char *cmdAsChars = (char*)mxCalloc(cmdNumChars, sizeof(char));
+
+	if (mxGetString(prhs[0], cmdAsChars, cmdNumChars) != 0)
+		mexErrMsgIdAndTxt( "MATLAB:relStrIdx:Parsing",
+		"Could not parse the given command. Aborting.");
+
+	string cmd(cmdAsChars);
+	transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
+	mxFree(cmdAsChars);
 
-	// starting at one because we are doing a difference of the observation prior
-	for (int ii=1;ii != rowsData; ii++)	
+	if (cmd == "create")
 	{
-		if (barsInPtr[ii] - barsInPtr[ii-1] > 0)
-		{
-			advances[ii] = abs(barsInPtr[ii] - barsInPtr[ii-1]);
-			declines[ii] = 0;
-		}
-		else
-		{
-			advances[ii] = 0;
-			declines[ii] = abs(barsInPtr[ii] - barsInPtr[ii-1]);
-		}
+		// h = relStrIdx('create',N,M)
+		if ((nrhs != 2 && nrhs != 3) || nlhs > 1)
+			mexErrMsgIdAndTxt( "MATLAB:relStrIdx:NumInputs",
+			"Usage is h = relStrIdx('create',N) or h = relStrIdx('create',N,M). Aborting.");
+
+		if (!isRealScalar(prhs[1]) || mxGetScalar(prhs[1]) < 1 || (nrhs == 3 && !isRealScalar(prhs[2])))
+			mexErrMsgIdAndTxt( "MATLAB:relStrIdx:BadInputType",
+			"Inputs 'N' and 'M' must be scalars and N a positive integer >= 1. Aborting.");
+
+		const int lookback = int(mxGetScalar(prhs[1]));
+		int detrend = (nrhs == 3) ? int(mxGetScalar(prhs[2])) : 0;
+		if (detrend < 0)
+			detrend = 15 * lookback;
+
+		rsiState *st = new rsiState;
+		rsiInit(*st, lookback, detrend);
+
+		plhs[0] = addStream(st);
 	}
+	else if (cmd == "restore")
+	{
+		// h = relStrIdx('restore',saved)
+		if (nrhs != 2 || nlhs > 1)
+			mexErrMsgIdAndTxt( "MATLAB:relStrIdx:NumInputs",
+			"Usage is h = relStrIdx('restore',saved). Aborting.");
 
-	// Calculate avgGains & avgLosses
-	// Note: these are not averages in the formal sense
-	for (int ii = (obsvIn); ii != rowsData; ii++)
+		rsiState restored;
+
+		if (!isReal2DfullDouble(prhs[1])
+			|| rsiRestore(restored, mxGetPr(prhs[1]), mxGetNumberOfElements(prhs[1])) != 0)
+			mexErrMsgIdAndTxt( "MATLAB:relStrIdx:BadInputType",
+			"Input 'saved' is not a state returned by relStrIdx('save',h). Aborting.");
+
+		plhs[0] = addStream(new rsiState(restored));
+	}
+	else if (cmd == "update")
 	{
-		if (ii == (obsvIn))
-		{
-			double sumAdv = 0;
-			double sumDec = 0;
+		// rsi = relStrIdx('update',h,data)
+		if (nrhs != 3 || nlhs > 1)
+			mexErrMsgIdAndTxt( "MATLAB:relStrIdx:NumInputs",
+			"Usage is rsi = relStrIdx('update',h,data). Aborting.");
 
-			for (int jj = 0; jj != obsvIn; jj++)
-			{
-				sumAdv = sumAdv + advances[ii-jj];
-				sumDec = sumDec + declines[ii-jj];
-			}
+		rsiState *st = getStream(prhs[1]);
 
-			avgGain[ii] = sumAdv / obsvIn;
-			avgLoss[ii] = sumDec / obsvIn;
-		}
-		else
+		if (!isReal2DfullDouble(prhs[2]) || (mxGetM(prhs[2]) > 1 && mxGetN(prhs[2]) > 1))
+			mexErrMsgIdAndTxt( "MATLAB:relStrIdx:BadInputType",
+			"Input 'data' must be a vector of the new prices. Aborting.");
+
+		const mwSize rowsData = mxGetNumberOfElements(prhs[2]);
+		const double *priceIn = mxGetPr(prhs[2]);
+
+		plhs[0] = mxCreateDoubleMatrix(rowsData, 1, mxREAL);
+		double *RSI = mxGetPr(plhs[0]);
+
+		for (mwSize ii = 0; ii < rowsData; ii++)
 		{
-			avgGain[ii] = ((avgGain[ii-1] * (obsvIn - 1)) + advances[ii]) / obsvIn;
-			avgLoss[ii] = ((avgLoss[ii-1] * (obsvIn - 1)) + declines[ii]) / obsvIn;
+			RSI[ii] = rsiPush(*st, priceIn[ii]);
 		}
 	}
+	else if (cmd == "value")
+	{
+		// rsi = relStrIdx('value',h)
+		if (nrhs != 2 || nlhs > 1)
+			mexErrMsgIdAndTxt( "MATLAB:relStrIdx:NumInputs",
+			"Usage is rsi = relStrIdx('value',h). Aborting.");
 
-	// Assign RSI values to output array
-	for (int ii = 0; ii != rowsData; ii++)
+		plhs[0] = mxCreateDoubleScalar(getStream(prhs[1])->value);
+	}
+	else if (cmd == "save")
 	{
-		if (ii < (obsvIn))
-		{
-			RSI[ii] = m_Nan;
-		}
-		else
-		{
-			if (avgLoss[ii] == 0)
-			{
-				RSI[ii] = 100;
-			}
-			else
-			{
-				RSI[ii] = 100 - (100 / (1 + avgGain[ii] / avgLoss[ii]));
-			}
-		}
+		// saved = relStrIdx('save',h)
+		if (nrhs != 2 || nlhs > 1)
+			mexErrMsgIdAndTxt( "MATLAB:relStrIdx:NumInputs",
+			"Usage is saved = relStrIdx('save',h). Aborting.");
+
+		vector<double> saved;
+		rsiSave(*getStream(prhs[1]), saved);
+
+		plhs[0] = mxCreateDoubleMatrix(1, saved.size(), mxREAL);
+		copy(saved.begin(), saved.end(), mxGetPr(plhs[0]));
+	}
+	else if (cmd == "destroy")
+	{
+		// relStrIdx('destroy',h)
+		if (nrhs != 2 || nlhs > 0)
+			mexErrMsgIdAndTxt( "MATLAB:relStrIdx:NumInputs",
+			"Usage is relStrIdx('destroy',h). Aborting.");
+
+		rsiState *st = getStream(prhs[1]);
+		s_rsiStreams.erase(int(mxGetScalar(prhs[1])));
+		delete st;
 	}
+	else
+	{
+		mexErrMsgIdAndTxt( "MATLAB:relStrIdx:UnknownCommand",
+			"Unknown command '%s'. Expected 'create', 'update', 'value', 'save', 'restore' or 'destroy'. Aborting.", cmd.c_str());
+	}
+}
 
-	delete []advances;
-	delete []declines;
-	delete []avgGain;
-	delete []avgLoss;
+// Register a streaming RSI and return its handle
+mxArray *addStream(rsiState *st)
+{
+	// Release any states left open when the MEX is cleared
+	if (s_rsiStreams.empty())
+		mexAtExit(clearStreams);
 
-	advances = NULL;
-	declines = NULL;
-	avgGain = NULL;
-	avgLoss = NULL;
+	int handle = s_rsiNextHandle++;
+	s_rsiStreams[handle] = st;
 
-	/////////////
-	// FINISHED
-	/////////////
+	return mxCreateDoubleScalar(handle);
+}
 
-	return;
+// Look up a streaming RSI by handle
+rsiState *getStream(const mxArray *handle_IN)
+{
+	if (!isRealScalar(handle_IN))
+		mexErrMsgIdAndTxt( "MATLAB:relStrIdx:BadHandle",
+		"The RSI handle must be a scalar as returned by 'create'. Aborting.");
+
+	map<int, rsiState*>::iterator iter = s_rsiStreams.find(int(mxGetScalar(handle_IN)));
+
+	if (iter == s_rsiStreams.end())
+		mexErrMsgIdAndTxt( "MATLAB:relStrIdx:BadHandle",
+		"The RSI handle is not valid or has been destroyed. Aborting.");
+
+	return iter->second;
+}
+
+// Release all streaming states
+static void clearStreams()
+{
+	for (map<int, rsiState*>::iterator iter = s_rsiStreams.begin(); iter != s_rsiStreams.end(); iter++)
+	{
+		delete iter->second;
+	}
+	s_rsiStreams.clear();
 }
 
 //
@@ -4,25 +4,94 @@
 //	taInvoke()	This will return a list of available TA-LIB functions to the MatLab command window
 //
 //	[varout] = taInvoke(taFunction, varin)
+//	h = taInvoke('handle', taFunction)
+//	[varout] = taInvoke(h, varin)
+//	[out, names] = taInvoke('pipeline', ohlcv, specs)
+//	[out, grid] = taInvoke('grid', ohlcv, spec)
+//	previous = taInvoke('backend', name)
+//	stats = taInvoke('cache', megabytes)
+//	[h, varout] = taInvoke('create', taFunction, varin)
+//	[varout] = taInvoke('update', h, data)
+//	[varout] = taInvoke('value', h)
+//	taInvoke('destroy', h)
 //
 // Inputs:
 //	taFunction	The name of the TA-Lib function to call
-//	varin		The input variable(s) as necessary for the called taFunction
+//	h		A numeric handle of a function from taInvoke('handle',taFunction).  Calling by handle skips the
+//			name lookup, e.g. in parameter sweeps over short vectors.  Handles are valid for the loaded build
+//	varin		The input variable(s) as necessary for the called taFunction.  Data series may be N x M panels,
+//			one column per series (e.g. a universe of contracts).  A series given as N x 1 is shared by every column
+//	ohlcv		Price data for a pipeline or grid: rows x 1 (Close), rows x 4 (O | H | L | C) or rows x 5 (O | H | L | C | V)
+//	specs		Cell array of the functions of a pipeline.  Each is a name or handle, or a cell of the name or handle
+//			followed by its optional inputs in the order the function takes them, e.g. {'ta_atr', {'ta_rsi',14}}.
+//			Omitted optional inputs take TA-Lib's defaults.  Functions of a single data series are given Close
+//	spec		A cell of a function name or handle followed by a scalar or vector of each optional input to sweep,
+//			e.g. {'ta_bbands', 10:10:50, 1:0.5:3, 1:0.5:3, [0 1]}.  Every combination of the values is evaluated
+//	name		'talib' (default), 'native' (AVX2 when supported), 'scalar' or 'avx2'.  The native backend
+//			(taNative.cpp) replaces TA-Lib for ta_sma, ta_ema, ta_wma, ta_stddev, ta_bbands, ta_atr, ta_willr,
+//			ta_max and ta_min until changed.  See taNative.h for its tolerance against TA-Lib
+//	megabytes	Size of the output data kept by the call cache.  0 (default) disables it.  'clear' empties it and
+//			taInvoke('cache') only returns its statistics
+//	h		(streams) A handle from taInvoke('create',...)
+//	data		The bars appended since the last update, one vector per data series of the function
 //
 // Outputs:
-//	varout		The output(s) as produced from the call to the taFunction
+//	varout		The output(s) as produced from the call to the taFunction.  N x M for a panel, column m from series m
+//	out		rows x K, one column per output of each spec in order.  Rows before a function's lookback are NaN
+//	names		1 x K cell of 'function.output' column names
+//	out		(grid) rows x P x K, output k of every grid point in out(:,:,k).  Rows before the lookback are NaN
+//	grid		P x numOpts optional inputs of each grid point, first optional input varying fastest (as ndgrid)
+//	previous	The backend before the call.  taInvoke('backend') returns the current backend
+//	stats		capacityMB, usedMB, entries, hits, misses and evictions of the call cache
+//	varout		(streams) One rows x 1 vector per output holding the values of each bar taken, or a scalar for 'value'
+//
+//	NOTE: A pipeline validates the prices and every spec once and then evaluates the functions concurrently over
+//		the same prices through TA-Lib's abstract interface (ta_abstract is added to mexOpts.txt).  Compile with
+//		OpenMP to spread the functions over threads, e.g. mex CXXFLAGS="\$CXXFLAGS -fopenmp" LDFLAGS="\$LDFLAGS -fopenmp"
+//		A grid is evaluated the same way, one call per point.  A ta_bbands grid takes the moving average and
+//		standard deviation once per lookback and typeMA and forms the bands of every multiplier pair from them.
+//		A panel is evaluated the same way, one call per column with the columns spread over threads.  Leading NaNs
+//		of a column (e.g. a contract listed later) stay NaN and its values start from its first complete row.
+//		While the cache is enabled a function call repeated with the same inputs, backend and number of outputs
+//		returns its earlier outputs, least recently used first out when full.  Inputs are matched by a hash of their
+//		contents.  The outputs are shared with the cache and copied by MatLab only when written to.
+//		ta_sma, ta_ema, ta_wma, ta_rsi, ta_atr, ta_adx, ta_macd, ta_sar and ta_bbands (typeMA 0 - 2) may be
+//		streamed (taStream.cpp).  'create' takes the function's arguments, with its data series as the history
+//		(which may be empty), and each 'update' is O(1) per bar.  From the lookback on the values are TA-Lib's
+//		over every bar taken, counting TA-Lib's unstable period as set when the stream was created.  Streams are
+//		released by 'destroy' or when taInvoke is cleared.
 
 #include "mex.h"
 #include "ta_libc.h"
+#include <algorithm>	// So we can search the function name table ...
+#include <cctype>	// ignoring case
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <list>
 #include <map>
-#include <algorithm>	// So we can transform the function name string input ...
-#include <string>	// from char to string ensuring lowercase
+#include <string>
+#include <vector>
 #include "myMath.h"
+#include "taNative.h"
+#include "taStream.h"
+
+// Declare external reference to undocumented C function
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	mxArray *mxCreateSharedDataCopy(const mxArray *pr);
+
+#ifdef __cplusplus
+}
+#endif
 
 using namespace std;
 
 // Value-Definitions of the different String values
-static enum StringValue { 
+enum StringValue { 
 	taNotDefined, ta_accbands, ta_acos, ta_ad, ta_add, ta_adosc, ta_adx, ta_adxr, ta_apo, ta_aroon, ta_aroonosc, ta_asin, ta_atan, ta_atr, ta_avgdev, ta_avgprice, ta_bbands, 
 	ta_beta, ta_bop, ta_cci, 
 	// Candlestick section start
@@ -43,11 +112,26 @@ static enum StringValue {
 	ta_tsf, ta_typprice, ta_ultosc, ta_var, ta_wclprice, ta_willr, ta_wma
 };
 
+// Longest function name plus the NULL, rounded up
+#define TA_FUNC_NAME_CHARS 32
+
 // Prototypes
-// Map to associate the strings with the enum values
-static map<string, StringValue> s_mapStringValues;
+StringValue findTaFunc(char *taFuncNameIn);
+const char *taFuncName(StringValue taFunc);
+int outStart(int lookback, int rows);
+void taPipeline(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void taGrid(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void taPanel(StringValue taFunc, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void taBackend(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+TA_RetCode nativeRetCode(int status);
+void taCacheCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+bool cacheKeyOf(StringValue taFunc, int nlhs, int nrhs, const mxArray *prhs[], vector<unsigned long long> &key);
+bool cacheFind(const vector<unsigned long long> &key, int nlhs, mxArray *plhs[]);
+void cacheInsert(const vector<unsigned long long> &key, int nlhs, mxArray *plhs[]);
+void taStreamCommand(const char *cmd, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+void taInvokeAtExit();
 void taInvokeInfoOnly();
-void taInvokeFuncInfo(string taFuncNameIn);
+void taInvokeFuncInfo(StringValue taFunc, const char *taFuncNameIn);
 void chkSingleVec(int colsD, int lineNum);
 void chkSingleVec(int colsH, int colsL, int lineNum);
 void chkSingleVec(int colsH, int colsL, int colsC, int lineNum);
@@ -58,8 +142,6 @@ void printToMatLab(char *para1, char *para2, char *para3, char *form);
 void printToMatLab(char *para1, char *para2, char *para3, char *para4, char *form);
 void typeMAcheck(string taFuncNameIn, string taFuncDesc, string taFuncOptName, int typeMA);
 
-static void InitSwitchMapping();
-
 // Macros
 #define isReal2DfullDouble(P) (!mxIsComplex(P) && mxGetNumberOfDimensions(P) == 2 && !mxIsSparse(P) && mxIsDouble(P))
 #define isRealScalar(P) (isReal2DfullDouble(P) && mxGetNumberOfElements(P) == 1)
@@ -68,9 +150,24 @@ static void InitSwitchMapping();
 // Global variables
 double m_Nan = std::numeric_limits<double>::quiet_NaN(); 
 
+// Backend of the functions with native implementations (taNative.h) set by taInvoke('backend', name).
+// BACKEND_TALIB or a taNativePath
+#define BACKEND_TALIB -1
+int m_Backend = BACKEND_TALIB;
+
+// Set once taInvokeAtExit is registered.  MATLAB keeps a single exit function per MEX, each mexAtExit replacing the last
+bool m_AtExitSet = false;
+
 void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 	int nrhs, const mxArray *prhs[])	/* Input variables */
 {
+	// Release the cache and any open streams when the MEX is cleared
+	if (!m_AtExitSet)
+	{
+		mexAtExit(taInvokeAtExit);
+		m_AtExitSet = true;
+	}
+
 	// Check number of inputs
 	if (nrhs == 0) 
 	{
@@ -82,37 +179,112 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 	// Inputs
 	#define taFuncName_IN		prhs[0]
 
-	/* Assign pointers to the function string */ 
-	int funcNumChars = (int)mxGetN(taFuncName_IN)+1;	// +1 for the NULL added at the end
-	char *funcAsChars = (char*)mxCalloc(funcNumChars, sizeof(char));	// Allocate space on the heap to store the name
+	StringValue taFunc;
+	const char *taFuncNameIn;			// Name of the function for user feedback
+	char funcAsChars[TA_FUNC_NAME_CHARS];		// Function name or command given as a string
+	string taFuncDesc;				// Descriptive name of function for user feedback
+	string taFuncOptName = "typeMA";		// Descriptive name for the optional input being validated (default to 'typeMA')
+	int outBegIdx;					// Row of an output array TA-Lib's first value is written to
+	int taLookback;					// TA-Lib's lookback of the call.  Rows before it are NaN (0 in integer outputs)
+
+	if (mxIsChar(taFuncName_IN))
+	{
+		// A name too long to be held cannot be a function.  The truncated name is reported
+		int status = mxGetString(taFuncName_IN, funcAsChars, TA_FUNC_NAME_CHARS); 
+		taFunc = (status == 0) ? findTaFunc(funcAsChars) : taNotDefined;
+		taFuncNameIn = funcAsChars;
 
-	if (funcAsChars == NULL) mexErrMsgTxt("Not enough heap space to hold converted string.");
+		// h = taInvoke('handle', taFunction)
+		if (taFunc == taNotDefined && strcmp(funcAsChars, "handle") == 0)
+		{
+			if (nrhs != 2 || nlhs > 1 || !mxIsChar(prhs[1]))
+				mexErrMsgIdAndTxt("MATLAB:taInvoke:NumInputs",
+				"Usage is h = taInvoke('handle', taFunction). Aborting (%d).", codeLine);
 
-	int status = mxGetString(taFuncName_IN, funcAsChars, funcNumChars); 
-	if (status != 0) mexErrMsgIdAndTxt("MATLAB:taInvoke:Parsing",
-		"Could not parse the given function. Aborting (%d).", codeLine);
+			status = mxGetString(prhs[1], funcAsChars, TA_FUNC_NAME_CHARS);
+			taFunc = (status == 0) ? findTaFunc(funcAsChars) : taNotDefined;
 
-	string taFuncNameIn((funcAsChars));
-	string taFuncDesc;				// Descriptive name of function for user feedback
-	string taFuncOptName = "typeMA";		// Descriptive name for the optional input being validated (default to 'typeMA')
+			if (taFunc == taNotDefined)
+				mexErrMsgIdAndTxt( "MATLAB:taInvoke:UnknownFunction",
+				"Unable to find a matching function to: '%s'. Aborting (%d).", funcAsChars, codeLine);
+
+			plhs[0] = mxCreateDoubleScalar(taFunc);
+			return;
+		}
+
+		// [out, names] = taInvoke('pipeline', ohlcv, specs)
+		if (taFunc == taNotDefined && strcmp(funcAsChars, "pipeline") == 0)
+		{
+			taPipeline(nlhs, plhs, nrhs, prhs);
+			return;
+		}
+
+		// [out, grid] = taInvoke('grid', ohlcv, spec)
+		if (taFunc == taNotDefined && strcmp(funcAsChars, "grid") == 0)
+		{
+			taGrid(nlhs, plhs, nrhs, prhs);
+			return;
+		}
 
-	transform(taFuncNameIn.begin(), taFuncNameIn.end(), taFuncNameIn.begin(), ::tolower);
+		// name = taInvoke('backend') | previous = taInvoke('backend', name)
+		if (taFunc == taNotDefined && strcmp(funcAsChars, "backend") == 0)
+		{
+			taBackend(nlhs, plhs, nrhs, prhs);
+			return;
+		}
+
+		// stats = taInvoke('cache') | taInvoke('cache', megabytes) | taInvoke('cache', 'clear')
+		if (taFunc == taNotDefined && strcmp(funcAsChars, "cache") == 0)
+		{
+			taCacheCommand(nlhs, plhs, nrhs, prhs);
+			return;
+		}
 
-	// Quick cleanup
-	mxFree(funcAsChars);
+		// [h, varout] = taInvoke('create', taFunction, varin) | [varout] = taInvoke('update', h, data) |
+		// [varout] = taInvoke('value', h) | taInvoke('destroy', h)
+		if (taFunc == taNotDefined && (strcmp(funcAsChars, "create") == 0 || strcmp(funcAsChars, "update") == 0
+			|| strcmp(funcAsChars, "value") == 0 || strcmp(funcAsChars, "destroy") == 0))
+		{
+			taStreamCommand(funcAsChars, nlhs, plhs, nrhs, prhs);
+			return;
+		}
+	}
+	else
+	{
+		// Handles are the function's position in the name table so no string is touched
+		if (!isRealScalar(taFuncName_IN) || mxGetScalar(taFuncName_IN) < 1 || mxGetScalar(taFuncName_IN) > ta_wma)
+			mexErrMsgIdAndTxt( "MATLAB:taInvoke:BadHandle",
+			"The function must be given as a name or a handle from taInvoke('handle', taFunction). Aborting (%d).", codeLine);
 
-	// Init the switch function string mapping to the enum
-	InitSwitchMapping();
+		taFunc = StringValue(int(mxGetScalar(taFuncName_IN)));
+		taFuncNameIn = taFuncName(taFunc);
+	}
 
 	// If we have no parameters the user is requesting information about a given function.
 	// Provide and exit.
 	if (nrhs == 1)
 	{
-		taInvokeFuncInfo(taFuncNameIn);
+		taInvokeFuncInfo(taFunc, taFuncNameIn);
+		return;
+	}
+
+	// While the cache is enabled a call repeated with the same inputs is answered with its earlier outputs
+	vector<unsigned long long> cacheKey;
+	if (cacheKeyOf(taFunc, nlhs, nrhs, prhs, cacheKey) && cacheFind(cacheKey, nlhs, plhs))
 		return;
+
+	// Data series given as N x M panels, one column per series, are evaluated a column at a time
+	for (int ii = 1; ii < nrhs && taFunc != taNotDefined; ii++)
+	{
+		if (mxIsDouble(prhs[ii]) && mxGetM(prhs[ii]) > 1 && mxGetN(prhs[ii]) > 1)
+		{
+			taPanel(taFunc, nlhs, plhs, nrhs, prhs);
+			cacheInsert(cacheKey, nlhs, plhs);
+			return;
+		}
 	}
 
-	switch (s_mapStringValues[taFuncNameIn])
+	switch (taFunc)
 	{
 		// Acceleration Bands
 		case ta_accbands:
@@ -191,43 +363,32 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				lookback = 14;
 			}
 
-			// Preallocate heap
-			accUpper = (double*)mxCalloc(rows, sizeof(double));
-			accMid	= (double*)mxCalloc(rows, sizeof(double));
-			accLower = (double*)mxCalloc(rows, sizeof(double));
+			// Outputs are written in place by TA-Lib
+			accUpper_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+			accUpper = (double*)mxGetData(accUpper_OUT);
+			accMid_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+			accMid = (double*)mxGetData(accMid_OUT);
+			accLower_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+			accLower = (double*)mxGetData(accLower_OUT);
 
-			retCode = TA_ACCBANDS(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &accIdx, &outElements, accUpper, accMid, accLower);
+			taLookback = TA_ACCBANDS_Lookback(lookback);
+			outBegIdx = outStart(taLookback, rows);
+			retCode = TA_ACCBANDS(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &accIdx, &outElements, accUpper + outBegIdx, accMid + outBegIdx, accLower + outBegIdx);
 
 			// Error handling
 			if (retCode) 
 			{
-				mxFree(accUpper);
-				mxFree(accMid);
-				mxFree(accLower);
 				mexPrintf("%s%i","Return code=",retCode);
 				mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 			}
 
-			// Populate Output
-			accUpper_OUT = mxCreateDoubleMatrix(accIdx + outElements,1, mxREAL);
-			accMid_OUT = mxCreateDoubleMatrix(accIdx + outElements,1, mxREAL);
-			accLower_OUT = mxCreateDoubleMatrix(accIdx + outElements,1, mxREAL);
-			memcpy(((double *) mxGetData(accUpper_OUT)) + accIdx, accUpper, outElements * mxGetElementSize(accUpper_OUT));
-			memcpy(((double *) mxGetData(accMid_OUT)) + accIdx, accMid, outElements * mxGetElementSize(accMid_OUT));
-			memcpy(((double *) mxGetData(accLower_OUT)) + accIdx, accLower, outElements * mxGetElementSize(accLower_OUT));
-
-			// Cleanup
-			mxFree(accUpper); 
-			mxFree(accMid); 
-			mxFree(accLower); 
-
 			// NaN data before lookback
 			// assign the variables for manipulating the arrays (by pointer reference)
 			double *uBandPtr = mxGetPr(accUpper_OUT);
 			double *mBandPtr = mxGetPr(accMid_OUT);
 			double *lBandPtr = mxGetPr(accLower_OUT);
 
-			for (int iter = 0; iter < lookback; iter++)
+			for (int iter = 0; iter < min(taLookback, rows); iter++)
 			{
 				uBandPtr[iter] = m_Nan;
 				mBandPtr[iter] = m_Nan;
@@ -307,47 +468,61 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 			int vecIdx, outElements;
 			double *outReal;
 
-			// Preallocate heap
-			outReal = (double*)mxCalloc(rows, sizeof(double));
+			// Outputs are written in place by TA-Lib
+			vec_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+			outReal = (double*)mxGetData(vec_OUT);
 
 			// Invoke with error catch
-			switch (s_mapStringValues[taFuncNameIn])
+			switch (taFunc)
 			{
 				case ta_acos:
-					retCode = TA_ACOS(startIdx, endIdx, vecPtr, &vecIdx, &outElements, outReal);
+					taLookback = TA_ACOS_Lookback();
+					outBegIdx = outStart(taLookback, rows);
+					retCode = TA_ACOS(startIdx, endIdx, vecPtr, &vecIdx, &outElements, outReal + outBegIdx);
 					break;
 				case ta_sin:
-					retCode = TA_SIN(startIdx, endIdx, vecPtr, &vecIdx, &outElements, outReal);
+					taLookback = TA_SIN_Lookback();
+					outBegIdx = outStart(taLookback, rows);
+					retCode = TA_SIN(startIdx, endIdx, vecPtr, &vecIdx, &outElements, outReal + outBegIdx);
 					break;
 				case ta_sinh:
-					retCode = TA_SINH(startIdx, endIdx, vecPtr, &vecIdx, &outElements, outReal);
+					taLookback = TA_SINH_Lookback();
+					outBegIdx = outStart(taLookback, rows);
+					retCode = TA_SINH(startIdx, endIdx, vecPtr, &vecIdx, &outElements, outReal + outBegIdx);
 					break;
 				case ta_sqrt:
-					retCode = TA_SQRT(startIdx, endIdx, vecPtr, &vecIdx, &outElements, outReal);
+					taLookback = TA_SQRT_Lookback();
+					outBegIdx = outStart(taLookback, rows);
+					retCode = TA_SQRT(startIdx, endIdx, vecPtr, &vecIdx, &outElements, outReal + outBegIdx);
 					break;
 				case ta_tan:
-					retCode = TA_TAN(startIdx, endIdx, vecPtr, &vecIdx, &outElements, outReal);
+					taLookback = TA_TAN_Lookback();
+					outBegIdx = outStart(taLookback, rows);
+					retCode = TA_TAN(startIdx, endIdx, vecPtr, &vecIdx, &outElements, outReal + outBegIdx);
 					break;
 				case ta_tanh:
-					retCode = TA_TANH(startIdx, endIdx, vecPtr, &vecIdx, &outElements, outReal);
+					taLookback = TA_TANH_Lookback();
+					outBegIdx = outStart(taLookback, rows);
+					retCode = TA_TANH(startIdx, endIdx, vecPtr, &vecIdx, &outElements, outReal + outBegIdx);
 					break;
 			}
 
 			// Error handling
 			if (retCode) 
 			{
-				mxFree(outReal);
 				mexPrintf("%s%i","Return code=",retCode);
 				mexErrMsgIdAndTxt( "MATLAB:taInvoke:invokeErr",
 					"Invocation to '%s' failed.. Aborting (%d).", taFuncNameIn, codeLine);
 			}
 
-			// Populate Output
-			vec_OUT = mxCreateDoubleMatrix(vecIdx + outElements,1, mxREAL);
-			memcpy(((double *) mxGetData(vec_OUT)) + vecIdx, outReal, outElements * mxGetElementSize(vec_OUT));
+			// NaN data before lookback
+			// assign the variables for manipulating the arrays (by pointer reference)
+			double *outPtr = mxGetPr(vec_OUT);
 
-			// Cleanup
-			mxFree(outReal); 
+			for (int iter = 0; iter < min(taLookback, rows); iter++)
+			{
+				outPtr[iter] = m_Nan;
+			}
 
 			break;
 		}
@@ -418,26 +593,32 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 			int adIdx, outElements;
 			double *outReal;
 
-			// Preallocate heap
-			outReal = (double*)mxCalloc(rows, sizeof(double));	// added cast
+			// Outputs are written in place by TA-Lib
+			ad_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+			outReal = (double*)mxGetData(ad_OUT);
 
 			// Invoke with error catch
-			retCode = TA_AD(startIdx, endIdx, highPtr, lowPtr, closePtr, volPtr, &adIdx, &outElements, outReal);
+			taLookback = TA_AD_Lookback();
+			outBegIdx = outStart(taLookback, rows);
+			retCode = TA_AD(startIdx, endIdx, highPtr, lowPtr, closePtr, volPtr, &adIdx, &outElements, outReal + outBegIdx);
 		
 			// Error handling
 			if (retCode) 
 			{
-				mxFree(outReal);
 				mexPrintf("%s%i","Return code=",retCode);
 				mexErrMsgTxt("Invocation to 'ta_ad' failed. Aborting.");
 			}
 
-			// Populate Output
-			ad_OUT = mxCreateDoubleMatrix(adIdx + outElements,1, mxREAL);
-			memcpy(((double*) mxGetData(ad_OUT)) + adIdx, outReal, outElements * mxGetElementSize(ad_OUT));
-		
+			// NaN data before lookback
+			// assign the variables for manipulating the arrays (by pointer reference)
+			double *outPtr = mxGetPr(ad_OUT);
+
+			for (int iter = 0; iter < min(taLookback, rows); iter++)
+			{
+				outPtr[iter] = m_Nan;
+			}
+
 			// Cleanup
-			mxFree(outReal);  
 			break;
 		}
 
@@ -497,33 +678,39 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 			int outIdx, outElements;
 			double *outReal;
 
-			// Preallocate heap
-			outReal = (double*)mxCalloc(rows, sizeof(double));
+			// Outputs are written in place by TA-Lib
+			vector_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+			outReal = (double*)mxGetData(vector_OUT);
 
-			switch (s_mapStringValues[taFuncNameIn])
+			switch (taFunc)
 			{
 				case ta_add:
-					retCode = TA_ADD(startIdx, endIdx, firstVecPtr, secondVecPtr, &outIdx, &outElements, outReal);
+					taLookback = TA_ADD_Lookback();
+					outBegIdx = outStart(taLookback, rows);
+					retCode = TA_ADD(startIdx, endIdx, firstVecPtr, secondVecPtr, &outIdx, &outElements, outReal + outBegIdx);
 					break;
 				case ta_sub:
-					retCode = TA_SUB(startIdx, endIdx, firstVecPtr, secondVecPtr, &outIdx, &outElements, outReal);
+					taLookback = TA_SUB_Lookback();
+					outBegIdx = outStart(taLookback, rows);
+					retCode = TA_SUB(startIdx, endIdx, firstVecPtr, secondVecPtr, &outIdx, &outElements, outReal + outBegIdx);
 					break;
 			}
 				
 			// Error handling
 			if (retCode) 
 			{
-				mxFree(outReal);
 				mexPrintf("%s%i","Return code=",retCode);
 				mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 			}
 
-			// Populate Output
-			vector_OUT = mxCreateDoubleMatrix(outIdx + outElements,1, mxREAL);
-			memcpy(((double *) mxGetData(vector_OUT)) + outIdx, outReal, outElements * mxGetElementSize(vector_OUT));
+			// NaN data before lookback
+			// assign the variables for manipulating the arrays (by pointer reference)
+			double *outPtr = mxGetPr(vector_OUT);
 
-			// Cleanup
-			mxFree(outReal); 
+			for (int iter = 0; iter < min(taLookback, rows); iter++)
+			{
+				outPtr[iter] = m_Nan;
+			}
 
 			break;
 		}
@@ -626,26 +813,32 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					slowMA = 10;
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				adosc_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(adosc_OUT);
 
 				// Invoke with error catch
-				retCode = TA_ADOSC(startIdx, endIdx, highPtr, lowPtr, closePtr, volPtr, fastMA, slowMA, &adoscIdx, &outElements, outReal);
+				taLookback = TA_ADOSC_Lookback(fastMA, slowMA);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_ADOSC(startIdx, endIdx, highPtr, lowPtr, closePtr, volPtr, fastMA, slowMA, &adoscIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_adosc' failed. Aborting (577).");
 				}
 
-				// Populate Output
-				adosc_OUT = mxCreateDoubleMatrix(adoscIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(adosc_OUT)) + adoscIdx, outReal, outElements * mxGetElementSize(adosc_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(adosc_OUT);
+
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				// Cleanup
-				mxFree(outReal); 
 				break;
 			}
 
@@ -723,41 +916,38 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				adx_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(adx_OUT);
 
-				if (taFuncNameIn.compare("ta_adx") == 0)
+				if (taFunc == ta_adx)
 				{
 					// Invoke with error catch
-					retCode = TA_ADX(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &adxIdx, &outElements, outReal);
+					taLookback = TA_ADX_Lookback(lookback);
+					outBegIdx = outStart(taLookback, rows);
+					retCode = TA_ADX(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &adxIdx, &outElements, outReal + outBegIdx);
 				}
 				else
 				{
 					// Invoke with error catch
-					retCode = TA_ADXR(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &adxIdx, &outElements, outReal);
+					taLookback = TA_ADXR_Lookback(lookback);
+					outBegIdx = outStart(taLookback, rows);
+					retCode = TA_ADXR(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &adxIdx, &outElements, outReal + outBegIdx);
 				}
 				
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				adx_OUT = mxCreateDoubleMatrix(adxIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(adx_OUT)) + adxIdx, outReal, outElements * mxGetElementSize(adx_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(adx_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -893,16 +1083,21 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				// Validate
 				typeMAcheck(taFuncNameIn, taFuncDesc, taFuncOptName, typeMA);
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));			// added cast
+				// Outputs are written in place by TA-Lib
+				po_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(po_OUT);
 
-				switch (s_mapStringValues[taFuncNameIn])
+				switch (taFunc)
 				{
 					case ta_apo:       
-						retCode = TA_APO(startIdx, endIdx, pricePtr, fastMA, slowMA, (TA_MAType)typeMA, &poIdx, &outElements, outReal);
+						taLookback = TA_APO_Lookback(fastMA, slowMA, (TA_MAType)typeMA);
+						outBegIdx = outStart(taLookback, rows);
+						retCode = TA_APO(startIdx, endIdx, pricePtr, fastMA, slowMA, (TA_MAType)typeMA, &poIdx, &outElements, outReal + outBegIdx);
 						break;
 					case ta_ppo:
-						retCode = TA_PPO(startIdx, endIdx, pricePtr, fastMA, slowMA, (TA_MAType)typeMA, &poIdx, &outElements, outReal);
+						taLookback = TA_PPO_Lookback(fastMA, slowMA, (TA_MAType)typeMA);
+						outBegIdx = outStart(taLookback, rows);
+						retCode = TA_PPO(startIdx, endIdx, pricePtr, fastMA, slowMA, (TA_MAType)typeMA, &poIdx, &outElements, outReal + outBegIdx);
 						break;
 				}
 
@@ -910,17 +1105,20 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_apo' failed. Aborting (843).");
 				}
 
-				// Populate Output
-				po_OUT = mxCreateDoubleMatrix(poIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(po_OUT)) + poIdx, outReal, outElements * mxGetElementSize(po_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(po_OUT);
+
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				// Cleanup
-				mxFree(outReal); 
 				break;
 			}
 
@@ -997,39 +1195,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				aroonUp = (double*)mxCalloc(rows, sizeof(double));
-				aroonDn = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				aroonUp_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				aroonUp = (double*)mxGetData(aroonUp_OUT);
+				aroonDn_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				aroonDn = (double*)mxGetData(aroonDn_OUT);
 
 				// Invoke with error catch
-				retCode = TA_AROON(startIdx, endIdx, highPtr, lowPtr, lookback, &aroonIdx, &outElements, aroonDn, aroonUp);
+				taLookback = TA_AROON_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_AROON(startIdx, endIdx, highPtr, lowPtr, lookback, &aroonIdx, &outElements, aroonDn + outBegIdx, aroonUp + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(aroonUp);
-					mxFree(aroonDn);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				aroonDn_OUT = mxCreateDoubleMatrix(aroonIdx + outElements,1, mxREAL);
-				aroonUp_OUT = mxCreateDoubleMatrix(aroonIdx + outElements,1, mxREAL);
-				
-				memcpy(((double *) mxGetData(aroonDn_OUT)) + aroonIdx, aroonDn, outElements * mxGetElementSize(aroonDn_OUT));
-				memcpy(((double *) mxGetData(aroonUp_OUT)) + aroonIdx, aroonUp, outElements * mxGetElementSize(aroonUp_OUT));
-
-				// Cleanup
-				mxFree(aroonDn); 
-				mxFree(aroonUp);
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *upPtr = mxGetPr(aroonUp_OUT);
 				double *dnPtr = mxGetPr(aroonDn_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					upPtr[iter] = m_Nan;
 					dnPtr[iter] = m_Nan;
@@ -1109,32 +1298,27 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				aroonOsc = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				aroonOsc_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				aroonOsc = (double*)mxGetData(aroonOsc_OUT);
 
 				// Invoke with error catch
-				retCode = TA_AROONOSC(startIdx, endIdx, highPtr, lowPtr, lookback, &aroonoscIdx, &outElements, aroonOsc);
+				taLookback = TA_AROONOSC_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_AROONOSC(startIdx, endIdx, highPtr, lowPtr, lookback, &aroonoscIdx, &outElements, aroonOsc + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(aroonOsc);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				aroonOsc_OUT = mxCreateDoubleMatrix(aroonoscIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(aroonOsc_OUT)) + aroonoscIdx, aroonOsc, outElements * mxGetElementSize(aroonOsc_OUT));
-
-				// Cleanup
-				mxFree(aroonOsc); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(aroonOsc_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -1197,26 +1381,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int asinIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				asin_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(asin_OUT);
 
 				// Invoke with error catch
-				retCode = TA_ASIN(startIdx, endIdx, sinPtr, &asinIdx, &outElements, outReal);
+				taLookback = TA_ASIN_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_ASIN(startIdx, endIdx, sinPtr, &asinIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_acos' failed. Aborting (1140).");
 				}
 
-				// Populate Output
-				asin_OUT = mxCreateDoubleMatrix(asinIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(asin_OUT)) + asinIdx, outReal, outElements * mxGetElementSize(asin_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(asin_OUT);
 
-				// Cleanup
-				mxFree(outReal);
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -1275,26 +1463,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int atanIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				atan_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(atan_OUT);
 
 				// Invoke with error catch
-				retCode = TA_ATAN(startIdx, endIdx, tanPtr, &atanIdx, &outElements, outReal);
+				taLookback = TA_ATAN_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_ATAN(startIdx, endIdx, tanPtr, &atanIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_atan' failed. Aborting (1219).");
 				}
 
-				// Populate Output
-				atan_OUT = mxCreateDoubleMatrix(atanIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(atan_OUT)) + atanIdx, outReal, outElements * mxGetElementSize(atan_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(atan_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -1373,31 +1565,29 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				outReal	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				atr_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(atr_OUT);
 
-				retCode = TA_ATR(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &atrIdx, &outElements, outReal);
+				taLookback = TA_ATR_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				if (m_Backend == BACKEND_TALIB)
+					retCode = TA_ATR(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &atrIdx, &outElements, outReal + outBegIdx);
+				else
+					retCode = nativeRetCode(taNativeAtr(highPtr, lowPtr, closePtr, rows, lookback, m_Backend, outReal + outBegIdx));
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				atr_OUT = mxCreateDoubleMatrix(atrIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(atr_OUT)) + atrIdx, outReal, outElements * mxGetElementSize(atr_OUT));
-
-				// Cleanup
-				mxFree(outReal);
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(atr_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -1475,7 +1665,7 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				//		always positive values.
 
 				// Strings for validation feedback
-				switch (s_mapStringValues[taFuncNameIn])
+				switch (taFunc)
 				{
 				case ta_avgdev:
 					taFuncDesc = "Average Deviation";
@@ -1568,7 +1758,7 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = (int)mxGetScalar(lookback_IN);
 
 					// Validation
-					switch (s_mapStringValues[taFuncNameIn])
+					switch (taFunc)
 					{
 						// Throws an error if ....
 						// < 2
@@ -1599,7 +1789,7 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				else
 				// Default lookback period
 				{
-					switch (s_mapStringValues[taFuncNameIn])
+					switch (taFunc)
 					{
 						case ta_roc:
 						case ta_rocp:
@@ -1624,74 +1814,97 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					}	
 				}
 
-				// Preallocate heap
-				outReal	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				vec_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(vec_OUT);
 
-				switch (s_mapStringValues[taFuncNameIn])
+				switch (taFunc)
 				{
 					case ta_avgdev:
-						retCode = TA_AVGDEV(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal);
+						taLookback = TA_AVGDEV_Lookback(lookback);
+						outBegIdx = outStart(taLookback, rows);
+						retCode = TA_AVGDEV(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal + outBegIdx);
 						break;
 					case ta_roc:
-						retCode = TA_ROC(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal);
+						taLookback = TA_ROC_Lookback(lookback);
+						outBegIdx = outStart(taLookback, rows);
+						retCode = TA_ROC(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal + outBegIdx);
 						break;
 					case ta_rocp:
-						retCode = TA_ROCP(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal);
+						taLookback = TA_ROCP_Lookback(lookback);
+						outBegIdx = outStart(taLookback, rows);
+						retCode = TA_ROCP(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal + outBegIdx);
 						break;
 					case ta_rocr:
-						retCode = TA_ROCR(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal);
+						taLookback = TA_ROCR_Lookback(lookback);
+						outBegIdx = outStart(taLookback, rows);
+						retCode = TA_ROCR(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal + outBegIdx);
 						break;
 					case ta_rocr100:
-						retCode = TA_ROCR100(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal);
+						taLookback = TA_ROCR100_Lookback(lookback);
+						outBegIdx = outStart(taLookback, rows);
+						retCode = TA_ROCR100(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal + outBegIdx);
 						break;
 					case ta_rsi:
-						retCode = TA_RSI(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal);
+						taLookback = TA_RSI_Lookback(lookback);
+						outBegIdx = outStart(taLookback, rows);
+						retCode = TA_RSI(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal + outBegIdx);
 						break;
 					case ta_sma:
-						retCode = TA_SMA(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal);
+						taLookback = TA_SMA_Lookback(lookback);
+						outBegIdx = outStart(taLookback, rows);
+						if (m_Backend == BACKEND_TALIB)
+							retCode = TA_SMA(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal + outBegIdx);
+						else
+							retCode = nativeRetCode(taNativeSma(dataPtr, rows, lookback, m_Backend, outReal + outBegIdx));
 						break;
 					case ta_sum:
-						retCode = TA_SUM(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal);
+						taLookback = TA_SUM_Lookback(lookback);
+						outBegIdx = outStart(taLookback, rows);
+						retCode = TA_SUM(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal + outBegIdx);
 						break;
 					case ta_tema:
-						retCode = TA_TEMA(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal);
-						// Update lookback value for NaN routine
-						lookback = (lookback - 1) * 3;
+						taLookback = TA_TEMA_Lookback(lookback);
+						outBegIdx = outStart(taLookback, rows);
+						retCode = TA_TEMA(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal + outBegIdx);
 						break;
 					case ta_trima:
-						retCode = TA_TRIMA(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal);
+						taLookback = TA_TRIMA_Lookback(lookback);
+						outBegIdx = outStart(taLookback, rows);
+						retCode = TA_TRIMA(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal + outBegIdx);
 						break;
 					case ta_trix:
-						retCode = TA_TRIX(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal);
+						taLookback = TA_TRIX_Lookback(lookback);
+						outBegIdx = outStart(taLookback, rows);
+						retCode = TA_TRIX(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal + outBegIdx);
 						break;
 					case ta_tsf:
-						retCode = TA_TSF(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal);
+						taLookback = TA_TSF_Lookback(lookback);
+						outBegIdx = outStart(taLookback, rows);
+						retCode = TA_TSF(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal + outBegIdx);
 						break;
 					case ta_wma:
-						retCode = TA_WMA(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal);
+						taLookback = TA_WMA_Lookback(lookback);
+						outBegIdx = outStart(taLookback, rows);
+						if (m_Backend == BACKEND_TALIB)
+							retCode = TA_WMA(startIdx, endIdx, dataPtr, lookback, &vecIdx, &outElements, outReal + outBegIdx);
+						else
+							retCode = nativeRetCode(taNativeWma(dataPtr, rows, lookback, m_Backend, outReal + outBegIdx));
 						break;
 				}
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				vec_OUT = mxCreateDoubleMatrix(vecIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(vec_OUT)) + vecIdx, outReal, outElements * mxGetElementSize(vec_OUT));
-
-				// Cleanup
-				mxFree(outReal);
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(vec_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -1758,25 +1971,29 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int avgpriceIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				avgPrice_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(avgPrice_OUT);
 
-				retCode = TA_AVGPRICE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &avgpriceIdx, &outElements, outReal);
+				taLookback = TA_AVGPRICE_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_AVGPRICE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &avgpriceIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				avgPrice_OUT = mxCreateDoubleMatrix(avgpriceIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(avgPrice_OUT)) + avgpriceIdx, outReal, outElements * mxGetElementSize(avgPrice_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(avgPrice_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -1929,43 +2146,37 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				// Validate
 				typeMAcheck(taFuncNameIn, taFuncDesc, taFuncOptName, typeMA);
 
-				// Preallocate heap
-				bbUpper	= (double*)mxCalloc(rows, sizeof(double));
-				bbMid	= (double*)mxCalloc(rows, sizeof(double));
-				bbLower	= (double*)mxCalloc(rows, sizeof(double));
-
-				retCode = TA_BBANDS(startIdx, endIdx, dataPtr, lookback, upMult,dnMult, (TA_MAType)typeMA, &bbandsIdx, &outElements, bbUpper, bbMid, bbLower);
+				// Outputs are written in place by TA-Lib
+				bbUpper_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				bbUpper = (double*)mxGetData(bbUpper_OUT);
+				bbMid_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				bbMid = (double*)mxGetData(bbMid_OUT);
+				bbLower_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				bbLower = (double*)mxGetData(bbLower_OUT);
+
+				// The native backend has the SMA, EMA and WMA middle bands.  Other types are left to TA-Lib
+				taLookback = TA_BBANDS_Lookback(lookback, upMult, dnMult, (TA_MAType)typeMA);
+				outBegIdx = outStart(taLookback, rows);
+				if (m_Backend == BACKEND_TALIB || typeMA > 2)
+					retCode = TA_BBANDS(startIdx, endIdx, dataPtr, lookback, upMult, dnMult, (TA_MAType)typeMA, &bbandsIdx, &outElements, bbUpper + outBegIdx, bbMid + outBegIdx, bbLower + outBegIdx);
+				else
+					retCode = nativeRetCode(taNativeBbands(dataPtr, rows, lookback, upMult, dnMult, typeMA, m_Backend,
+						bbUpper + outBegIdx, bbMid + outBegIdx, bbLower + outBegIdx));
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(bbUpper);
-					mxFree(bbMid);
-					mxFree(bbLower);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_bbands' failed. Aborting (1604).");
 				}
 
-				// Populate Output
-				bbUpper_OUT = mxCreateDoubleMatrix(bbandsIdx + outElements,1, mxREAL);
-				bbMid_OUT = mxCreateDoubleMatrix(bbandsIdx + outElements,1, mxREAL);
-				bbLower_OUT = mxCreateDoubleMatrix(bbandsIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(bbUpper_OUT)) + bbandsIdx, bbUpper, outElements * mxGetElementSize(bbUpper_OUT));
-				memcpy(((double *) mxGetData(bbMid_OUT)) + bbandsIdx, bbMid, outElements * mxGetElementSize(bbMid_OUT));
-				memcpy(((double *) mxGetData(bbLower_OUT)) + bbandsIdx, bbLower, outElements * mxGetElementSize(bbLower_OUT));
-
-				// Cleanup
-				mxFree(bbUpper); 
-				mxFree(bbMid); 
-				mxFree(bbLower); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *uBandPtr = mxGetPr(bbUpper_OUT);
 				double *mBandPtr = mxGetPr(bbMid_OUT);
 				double *lBandPtr = mxGetPr(bbLower_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					uBandPtr[iter] = m_Nan;
 					mBandPtr[iter] = m_Nan;
@@ -2056,25 +2267,29 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 5;
 				}
 
-				// Preallocate heap
-				outReal	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				beta_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(beta_OUT);
 
-				retCode = TA_BETA(startIdx, endIdx, indPtr, basePtr, lookback, &betaIdx, &outElements, outReal);
+				taLookback = TA_BETA_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_BETA(startIdx, endIdx, indPtr, basePtr, lookback, &betaIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				beta_OUT = mxCreateDoubleMatrix(betaIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(beta_OUT)) + betaIdx, outReal, outElements * mxGetElementSize(beta_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(beta_OUT);
 
-				// Cleanup
-				mxFree(outReal);
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -2138,25 +2353,29 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int bopIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				bop_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(bop_OUT);
 
-				retCode = TA_BOP(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &bopIdx, &outElements, outReal);
+				taLookback = TA_BOP_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_BOP(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &bopIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				bop_OUT = mxCreateDoubleMatrix(bopIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(bop_OUT)) + bopIdx, outReal, outElements * mxGetElementSize(bop_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(bop_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -2235,31 +2454,26 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				outReal	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				cci_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(cci_OUT);
 
-				retCode = TA_CCI(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &cciIdx, &outElements, outReal);
+				taLookback = TA_CCI_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_CCI(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &cciIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				cci_OUT = mxCreateDoubleMatrix(cciIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(cci_OUT)) + cciIdx, outReal, outElements * mxGetElementSize(cci_OUT));
-
-				// Cleanup
-				mxFree(outReal);
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(cci_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -2389,45 +2603,60 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int cdlIdx, outElements;
 				int *outInt;
 
-				// Preallocate heap
-				outInt	= (int*)mxCalloc(rows, sizeof(int));
+				// Outputs are written in place by TA-Lib
+				cdl_OUT = mxCreateNumericMatrix(rows, 1, mxINT32_CLASS, mxREAL);
+				outInt = (int*)mxGetData(cdl_OUT);
 
 				// Candlestick Pattern Switch
-				switch (s_mapStringValues[taFuncNameIn])
+				switch (taFunc)
 				{
 					case ta_cdl2crows:
 						{
-							retCode = TA_CDL2CROWS(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDL2CROWS_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDL2CROWS(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdl3blackcrows:   
 						{
-							retCode = TA_CDL3BLACKCROWS(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDL3BLACKCROWS_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDL3BLACKCROWS(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdl3inside:  
 						{
-							retCode = TA_CDL3INSIDE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDL3INSIDE_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDL3INSIDE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdl3linestrike: 
 						{
-							retCode = TA_CDL3LINESTRIKE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDL3LINESTRIKE_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDL3LINESTRIKE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdl3outside:
 						{
-							retCode = TA_CDL3OUTSIDE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDL3OUTSIDE_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDL3OUTSIDE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdl3starsinsouth:  
 						{
-							retCode = TA_CDL3STARSINSOUTH(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDL3STARSINSOUTH_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDL3STARSINSOUTH(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdl3whitesoldiers:   
 						{
-							retCode = TA_CDL3WHITESOLDIERS(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDL3WHITESOLDIERS_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDL3WHITESOLDIERS(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}			
 					case ta_cdlabandonedbaby:
@@ -2464,42 +2693,56 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 								pctPen = .3;
 							}
 
-							switch (s_mapStringValues[taFuncNameIn])
+							switch (taFunc)
 							{
 								case ta_cdlabandonedbaby:
 									{
-										retCode = TA_CDLABANDONEDBABY(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, pctPen, &cdlIdx, &outElements, outInt);
+										taLookback = TA_CDLABANDONEDBABY_Lookback(pctPen);
+										outBegIdx = outStart(taLookback, rows);
+										retCode = TA_CDLABANDONEDBABY(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, pctPen, &cdlIdx, &outElements, outInt + outBegIdx);
 										break;
 									}
 
 								case ta_cdldarkcloudcover:
 									{
-										retCode = TA_CDLDARKCLOUDCOVER(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, pctPen, &cdlIdx, &outElements, outInt);
+										taLookback = TA_CDLDARKCLOUDCOVER_Lookback(pctPen);
+										outBegIdx = outStart(taLookback, rows);
+										retCode = TA_CDLDARKCLOUDCOVER(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, pctPen, &cdlIdx, &outElements, outInt + outBegIdx);
 										break;
 									}
 								case ta_cdleveningdojistar:  
 									{
-										retCode = TA_CDLEVENINGDOJISTAR(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, pctPen, &cdlIdx, &outElements, outInt);
+										taLookback = TA_CDLEVENINGDOJISTAR_Lookback(pctPen);
+										outBegIdx = outStart(taLookback, rows);
+										retCode = TA_CDLEVENINGDOJISTAR(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, pctPen, &cdlIdx, &outElements, outInt + outBegIdx);
 										break;
 									}
 								case ta_cdleveningstar:  
 									{
-										retCode = TA_CDLEVENINGSTAR(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, pctPen, &cdlIdx, &outElements, outInt);
+										taLookback = TA_CDLEVENINGSTAR_Lookback(pctPen);
+										outBegIdx = outStart(taLookback, rows);
+										retCode = TA_CDLEVENINGSTAR(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, pctPen, &cdlIdx, &outElements, outInt + outBegIdx);
 										break;
 									}
 								case ta_cdlmathold:  
 									{
-										retCode = TA_CDLMATHOLD(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr,  pctPen, &cdlIdx, &outElements, outInt);
+										taLookback = TA_CDLMATHOLD_Lookback(pctPen);
+										outBegIdx = outStart(taLookback, rows);
+										retCode = TA_CDLMATHOLD(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, pctPen, &cdlIdx, &outElements, outInt + outBegIdx);
 										break;
 									}
 								case ta_cdlmorningdojistar:  
 									{
-										retCode = TA_CDLMORNINGDOJISTAR(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, pctPen, &cdlIdx, &outElements, outInt);
+										taLookback = TA_CDLMORNINGDOJISTAR_Lookback(pctPen);
+										outBegIdx = outStart(taLookback, rows);
+										retCode = TA_CDLMORNINGDOJISTAR(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, pctPen, &cdlIdx, &outElements, outInt + outBegIdx);
 										break;
 									}
 								case ta_cdlmorningstar:  
 									{
-										retCode = TA_CDLMORNINGSTAR(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, pctPen, &cdlIdx, &outElements, outInt);
+										taLookback = TA_CDLMORNINGSTAR_Lookback(pctPen);
+										outBegIdx = outStart(taLookback, rows);
+										retCode = TA_CDLMORNINGSTAR(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, pctPen, &cdlIdx, &outElements, outInt + outBegIdx);
 										break;
 									}
 							}
@@ -2508,237 +2751,331 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 						}
 					case ta_cdladvanceblock:  
 						{
-							retCode = TA_CDLADVANCEBLOCK(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLADVANCEBLOCK_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLADVANCEBLOCK(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlbelthold:  
 						{
-							retCode = TA_CDLBELTHOLD(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLBELTHOLD_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLBELTHOLD(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlbreakaway:  
 						{
-							retCode = TA_CDLBREAKAWAY(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLBREAKAWAY_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLBREAKAWAY(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlclosingmarubozu:  
 						{
-							retCode = TA_CDLCLOSINGMARUBOZU(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLCLOSINGMARUBOZU_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLCLOSINGMARUBOZU(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlconcealbabyswall:  
 						{
-							retCode = TA_CDLCONCEALBABYSWALL(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLCONCEALBABYSWALL_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLCONCEALBABYSWALL(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlcounterattack:  
 						{
-							retCode = TA_CDLCOUNTERATTACK(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLCOUNTERATTACK_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLCOUNTERATTACK(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdldoji:  
 						{
-							retCode = TA_CDLDOJI(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLDOJI_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLDOJI(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdldojistar:  
 						{
-							retCode = TA_CDLDOJISTAR(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLDOJISTAR_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLDOJISTAR(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdldragonflydoji:  
 						{
-							retCode = TA_CDLDRAGONFLYDOJI(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLDRAGONFLYDOJI_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLDRAGONFLYDOJI(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlengulfing:  
 						{
-							retCode = TA_CDLENGULFING(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLENGULFING_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLENGULFING(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlgapsidesidewhite:  
 						{
-							retCode = TA_CDLGAPSIDESIDEWHITE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLGAPSIDESIDEWHITE_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLGAPSIDESIDEWHITE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlgravestonedoji:  
 						{
-							retCode = TA_CDLGRAVESTONEDOJI(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLGRAVESTONEDOJI_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLGRAVESTONEDOJI(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlhammer:  
 						{
-							retCode = TA_CDLHAMMER(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLHAMMER_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLHAMMER(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlhangingman:  
 						{
-							retCode = TA_CDLHANGINGMAN(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLHANGINGMAN_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLHANGINGMAN(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlharami:  
 						{
-							retCode = TA_CDLHARAMI(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLHARAMI_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLHARAMI(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlharamicross:  
 						{
-							retCode = TA_CDLHARAMICROSS(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLHARAMICROSS_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLHARAMICROSS(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlhighwave:  
 						{
-							retCode = TA_CDLHIGHWAVE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLHIGHWAVE_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLHIGHWAVE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlhikkake:  
 						{
-							retCode = TA_CDLHIKKAKE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLHIKKAKE_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLHIKKAKE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlhikkakemod:  
 						{
-							retCode = TA_CDLHIKKAKEMOD(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLHIKKAKEMOD_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLHIKKAKEMOD(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlhomingpigeon:  
 						{
-							retCode = TA_CDLHIKKAKEMOD(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLHIKKAKEMOD_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLHIKKAKEMOD(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlidentical3crows:  
 						{
-							retCode = TA_CDLIDENTICAL3CROWS(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLIDENTICAL3CROWS_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLIDENTICAL3CROWS(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlinneck:  
 						{
-							retCode = TA_CDLINNECK(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLINNECK_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLINNECK(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlinvertedhammer:  
 						{
-							retCode = TA_CDLINVERTEDHAMMER(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLINVERTEDHAMMER_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLINVERTEDHAMMER(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlkicking:  
 						{
-							retCode = TA_CDLKICKING(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLKICKING_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLKICKING(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlkickingbylength:  
 						{
-							retCode = TA_CDLKICKINGBYLENGTH(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLKICKINGBYLENGTH_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLKICKINGBYLENGTH(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlladderbottom:  
 						{
-							retCode = TA_CDLLADDERBOTTOM(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLLADDERBOTTOM_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLLADDERBOTTOM(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdllongleggeddoji:  
 						{
-							retCode = TA_CDLLONGLEGGEDDOJI(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLLONGLEGGEDDOJI_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLLONGLEGGEDDOJI(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdllongline:  
 						{
-							retCode = TA_CDLLONGLINE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLLONGLINE_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLLONGLINE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlmarubozu:  
 						{
-							retCode = TA_CDLMARUBOZU(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLMARUBOZU_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLMARUBOZU(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlmatchinglow:  
 						{
-							retCode = TA_CDLMATCHINGLOW(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLMATCHINGLOW_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLMATCHINGLOW(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlonneck:  
 						{
-							retCode = TA_CDLONNECK(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLONNECK_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLONNECK(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlpiercing:  
 						{
-							retCode = TA_CDLPIERCING(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLPIERCING_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLPIERCING(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlrickshawman:  
 						{
-							retCode = TA_CDLRICKSHAWMAN(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLRICKSHAWMAN_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLRICKSHAWMAN(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlrisefall3methods:  
 						{
-							retCode = TA_CDLRISEFALL3METHODS(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLRISEFALL3METHODS_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLRISEFALL3METHODS(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlseparatinglines:  
 						{
-							retCode = TA_CDLSEPARATINGLINES(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLSEPARATINGLINES_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLSEPARATINGLINES(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlshootingstar:  
 						{
-							retCode = TA_CDLSHOOTINGSTAR(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLSHOOTINGSTAR_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLSHOOTINGSTAR(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlshortline:  
 						{
-							retCode = TA_CDLSHORTLINE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLSHORTLINE_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLSHORTLINE(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlspinningtop:  
 						{
-							retCode = TA_CDLSPINNINGTOP(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLSPINNINGTOP_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLSPINNINGTOP(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlstalledpattern:  
 						{
-							retCode = TA_CDLSTALLEDPATTERN(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLSTALLEDPATTERN_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLSTALLEDPATTERN(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlsticksandwich:  
 						{
-							retCode = TA_CDLSTICKSANDWICH(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLSTICKSANDWICH_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLSTICKSANDWICH(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdltakuri:  
 						{
-							retCode = TA_CDLTAKURI(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLTAKURI_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLTAKURI(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdltasukigap:  
 						{
-							retCode = TA_CDLTASUKIGAP(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLTASUKIGAP_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLTASUKIGAP(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlthrusting:  
 						{
-							retCode = TA_CDLTHRUSTING(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLTHRUSTING_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLTHRUSTING(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdltristar:  
 						{
-							retCode = TA_CDLTRISTAR(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLTRISTAR_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLTRISTAR(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlunique3river:  
 						{
-							retCode = TA_CDLUNIQUE3RIVER(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLUNIQUE3RIVER_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLUNIQUE3RIVER(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlupsidegap2crows:  
 						{
-							retCode = TA_CDLUPSIDEGAP2CROWS(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLUPSIDEGAP2CROWS_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLUPSIDEGAP2CROWS(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}
 					case ta_cdlxsidegap3methods:  
 						{
-							retCode = TA_CDLXSIDEGAP3METHODS(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt);
+							taLookback = TA_CDLXSIDEGAP3METHODS_Lookback();
+							outBegIdx = outStart(taLookback, rows);
+							retCode = TA_CDLXSIDEGAP3METHODS(startIdx, endIdx, openPtr, highPtr, lowPtr, closePtr, &cdlIdx, &outElements, outInt + outBegIdx);
 							break;
 						}					
 				}
@@ -2746,18 +3083,10 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outInt);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				cdl_OUT = mxCreateNumericMatrix(cdlIdx + outElements,1, mxINT32_CLASS, mxREAL);
-				memcpy((int*)(mxGetData(cdl_OUT)) + cdlIdx, outInt, outElements * mxGetElementSize(cdl_OUT));
-
-				// Cleanup
-				mxFree(outInt); 
-
 				break;
 			}
 
@@ -2814,26 +3143,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int dataIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				ceil_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(ceil_OUT);
 
 				// Invoke with error catch
-				retCode = TA_CEIL(startIdx, endIdx, dataPtr, &dataIdx, &outElements, outReal);
+				taLookback = TA_CEIL_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_CEIL(startIdx, endIdx, dataPtr, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_ceil' failed. Aborting (2562).");
 				}
 
-				// Populate Output
-				ceil_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(ceil_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(ceil_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(ceil_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -2910,32 +3243,27 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				cmo_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(cmo_OUT);
 
 				// Invoke with error catch
-				retCode = TA_CMO(startIdx, endIdx, dataPtr, lookback, &cmoIdx, &outElements, outReal);
+				taLookback = TA_CMO_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_CMO(startIdx, endIdx, dataPtr, lookback, &cmoIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				cmo_OUT = mxCreateDoubleMatrix(cmoIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(cmo_OUT)) + cmoIdx, outReal, outElements * mxGetElementSize(cmo_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(cmo_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -3020,32 +3348,27 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 30;
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				corr_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(corr_OUT);
 
 				// Invoke with error catch
-				retCode = TA_CORREL(startIdx, endIdx, obsAPtr, obsBPtr, lookback, &corrIdx, &outElements, outReal);
+				taLookback = TA_CORREL_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_CORREL(startIdx, endIdx, obsAPtr, obsBPtr, lookback, &corrIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				corr_OUT = mxCreateDoubleMatrix(corrIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(corr_OUT)) + corrIdx, outReal, outElements * mxGetElementSize(corr_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(corr_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -3107,26 +3430,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int cosIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				cos_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(cos_OUT);
 
 				// Invoke with error catch
-				retCode = TA_COS(startIdx, endIdx, thetaPtr, &cosIdx, &outElements, outReal);
+				taLookback = TA_COS_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_COS(startIdx, endIdx, thetaPtr, &cosIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_cos' failed. Aborting (2856).");
 				}
 
-				// Populate Output
-				cos_OUT = mxCreateDoubleMatrix(cosIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(cos_OUT)) + cosIdx, outReal, outElements * mxGetElementSize(cos_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(cos_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -3185,26 +3512,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int coshIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				cosh_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(cosh_OUT);
 
 				// Invoke with error catch
-				retCode = TA_COSH(startIdx, endIdx, thetaPtr, &coshIdx, &outElements, outReal);
+				taLookback = TA_COSH_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_COSH(startIdx, endIdx, thetaPtr, &coshIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_cosh' failed. Aborting (2935).");
 				}
 
-				// Populate Output
-				cosh_OUT = mxCreateDoubleMatrix(coshIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(cos_OUT)) + coshIdx, outReal, outElements * mxGetElementSize(cosh_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(cosh_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -3288,32 +3619,27 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 30;
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				dema_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(dema_OUT);
 
 				// Invoke with error catch
-				retCode = TA_DEMA(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal);
+				taLookback = TA_DEMA_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_DEMA(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				dema_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(dema_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(dema_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(dema_OUT);
 
-				for (int iter = (lookback * 2) - 1; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -3381,25 +3707,29 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int quotIdx, outElements;
 				double *quotient;
 
-				// Preallocate heap
-				quotient = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				quot_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				quotient = (double*)mxGetData(quot_OUT);
 
-				retCode = TA_DIV(startIdx, endIdx, dividPtr, divisPtr, &quotIdx, &outElements, quotient);
+				taLookback = TA_DIV_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_DIV(startIdx, endIdx, dividPtr, divisPtr, &quotIdx, &outElements, quotient + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(quotient);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				quot_OUT = mxCreateDoubleMatrix(quotIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(quot_OUT)) + quotIdx, quotient, outElements * mxGetElementSize(quot_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(quot_OUT);
 
-				// Cleanup
-				mxFree(quotient); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -3489,31 +3819,26 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				}
 
 
-				// Preallocate heap
-				outReal	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				dx_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(dx_OUT);
 
-				retCode = TA_DX(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &dataIdx, &outElements, outReal);
+				taLookback = TA_DX_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_DX(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				dx_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(dx_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(dx_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *dxPtr = mxGetPr(dx_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					dxPtr[iter] = m_Nan;
 				}
@@ -3600,32 +3925,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 30;
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				ema_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(ema_OUT);
 
 				// Invoke with error catch
-				retCode = TA_EMA(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal);
+				taLookback = TA_EMA_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				if (m_Backend == BACKEND_TALIB)
+					retCode = TA_EMA(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal + outBegIdx);
+				else
+					retCode = nativeRetCode(taNativeEma(dataPtr, rows, lookback, m_Backend, outReal + outBegIdx));
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				ema_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(ema_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(ema_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(ema_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -3689,26 +4012,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int dataIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				e_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(e_OUT);
 
 				// Invoke with error catch
-				retCode = TA_EXP(startIdx, endIdx, dataPtr, &dataIdx, &outElements, outReal);
+				taLookback = TA_EXP_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_EXP(startIdx, endIdx, dataPtr, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				e_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(e_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(e_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(e_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -3766,26 +4093,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int dataIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				ceil_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(ceil_OUT);
 
 				// Invoke with error catch
-				retCode = TA_FLOOR(startIdx, endIdx, dataPtr, &dataIdx, &outElements, outReal);
+				taLookback = TA_FLOOR_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_FLOOR(startIdx, endIdx, dataPtr, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_floor' failed. Aborting (3458).");
 				}
 
-				// Populate Output
-				ceil_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(ceil_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(ceil_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(ceil_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -3849,32 +4180,27 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int dataIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				period_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(period_OUT);
 
 				// Invoke with error catch
-				retCode = TA_HT_DCPERIOD(startIdx, endIdx, dataPtr, &dataIdx, &outElements, outReal);
+				taLookback = TA_HT_DCPERIOD_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_HT_DCPERIOD(startIdx, endIdx, dataPtr, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_ht_dcperiod' failed. Aborting (3536).");
 				}
 
-				// Populate Output
-				period_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(period_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(period_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(period_OUT);
 
-				for (int iter = 0; iter < 32; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -3941,32 +4267,27 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int dataIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				phase_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(phase_OUT);
 
 				// Invoke with error catch
-				retCode = TA_HT_DCPHASE(startIdx, endIdx, dataPtr, &dataIdx, &outElements, outReal);
+				taLookback = TA_HT_DCPHASE_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_HT_DCPHASE(startIdx, endIdx, dataPtr, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_ht_dcperiod' failed. Aborting (3536).");
 				}
 
-				// Populate Output
-				phase_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(phase_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(phase_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(phase_OUT);
 
-				for (int iter = 0; iter < 63; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -4040,38 +4361,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int dataIdx, outElements;
 				double *inPhase, *quad;
 
-				// Preallocate heap
-				inPhase = (double*)mxCalloc(rows, sizeof(double));
-				quad = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				inPhase_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				inPhase = (double*)mxGetData(inPhase_OUT);
+				quad_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				quad = (double*)mxGetData(quad_OUT);
 
 				// Invoke with error catch
-				retCode = TA_HT_PHASOR(startIdx, endIdx, dataPtr, &dataIdx, &outElements, inPhase, quad);
+				taLookback = TA_HT_PHASOR_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_HT_PHASOR(startIdx, endIdx, dataPtr, &dataIdx, &outElements, inPhase + outBegIdx, quad + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(inPhase);
-					mxFree(quad);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_ht_dcperiod' failed. Aborting (3736).");
 				}
 
-				// Populate Output
-				inPhase_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				quad_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(inPhase_OUT)) + dataIdx, inPhase, outElements * mxGetElementSize(inPhase_OUT));
-				memcpy(((double *) mxGetData(quad_OUT)) + dataIdx, quad, outElements * mxGetElementSize(quad_OUT));
-
-				// Cleanup
-				mxFree(inPhase); 
-				mxFree(quad); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *inPhasePtr = mxGetPr(inPhase_OUT);
 				double *quadPtr = mxGetPr(quad_OUT);
 
-				for (int iter = 0; iter < 32; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					inPhasePtr[iter] = m_Nan;
 					quadPtr[iter] = m_Nan;
@@ -4164,38 +4477,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int dataIdx, outElements;
 				double *sine, *leadSine;
 
-				// Preallocate heap
-				sine = (double*)mxCalloc(rows, sizeof(double));
-				leadSine = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				sine_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				sine = (double*)mxGetData(sine_OUT);
+				leadSine_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				leadSine = (double*)mxGetData(leadSine_OUT);
 
 				// Invoke with error catch
-				retCode = TA_HT_SINE(startIdx, endIdx, dataPtr, &dataIdx, &outElements, sine, leadSine);
+				taLookback = TA_HT_SINE_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_HT_SINE(startIdx, endIdx, dataPtr, &dataIdx, &outElements, sine + outBegIdx, leadSine + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(sine);
-					mxFree(leadSine);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_ht_sine' failed. Aborting (3861).");
 				}
 
-				// Populate Output
-				sine_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				leadSine_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(sine_OUT)) + dataIdx, sine, outElements * mxGetElementSize(sine_OUT));
-				memcpy(((double *) mxGetData(leadSine_OUT)) + dataIdx, leadSine, outElements * mxGetElementSize(leadSine_OUT));
-
-				// Cleanup
-				mxFree(sine); 
-				mxFree(leadSine); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *sinePtr = mxGetPr(sine_OUT);
 				double *leadSinePtr = mxGetPr(leadSine_OUT);
 
-				for (int iter = 0; iter < 63; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					sinePtr[iter] = m_Nan;
 					leadSinePtr[iter] = m_Nan;
@@ -4263,32 +4568,27 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int dataIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				trend_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(trend_OUT);
 
 				// Invoke with error catch
-				retCode = TA_HT_TRENDLINE(startIdx, endIdx, dataPtr, &dataIdx, &outElements, outReal);
+				taLookback = TA_HT_TRENDLINE_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_HT_TRENDLINE(startIdx, endIdx, dataPtr, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_ht_trendline' failed. Aborting (3959).");
 				}
 
-				// Populate Output
-				trend_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(trend_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(trend_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(trend_OUT);
 
-				for (int iter = 0; iter < 63; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -4355,35 +4655,23 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int dataIdx, outElements;
 				int *outInt;
 
-				// Preallocate heap
-				outInt = (int*)mxCalloc(rows, sizeof(int));
+				// Outputs are written in place by TA-Lib
+				mode_OUT = mxCreateNumericMatrix(rows, 1, mxINT32_CLASS, mxREAL);
+				outInt = (int*)mxGetData(mode_OUT);
 
 				// Invoke with error catch
-				retCode = TA_HT_TRENDMODE(startIdx, endIdx, dataPtr, &dataIdx, &outElements, outInt);
+				taLookback = TA_HT_TRENDMODE_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_HT_TRENDMODE(startIdx, endIdx, dataPtr, &dataIdx, &outElements, outInt + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outInt);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_ht_trendmode' failed. Aborting (4046).");
 				}
 
-				// Populate Output
-				mode_OUT = mxCreateNumericMatrix(dataIdx + outElements,1, mxINT32_CLASS, mxREAL);
-				memcpy(((int *) mxGetData(mode_OUT)) + dataIdx, outInt, outElements * mxGetElementSize(mode_OUT));
-
-				// Cleanup
-				mxFree(outInt); 
-
-				// NaN data before lookback
-				// assign the variables for manipulating the arrays (by pointer reference)
-				double *outPtr = mxGetPr(trend_OUT);
-
-				for (int iter = 0; iter < 63; iter++)
-				{
-					outPtr[iter] = m_Nan;
-				}
+				// An integer output cannot hold NaN.  Rows before the lookback hold 0
 
 				break;
 			}
@@ -4467,32 +4755,27 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 30;
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				kama_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(kama_OUT);
 
 				// Invoke with error catch
-				retCode = TA_KAMA(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal);
+				taLookback = TA_KAMA_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_KAMA(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				kama_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(kama_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(kama_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(kama_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -4579,32 +4862,27 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				linreg_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(linreg_OUT);
 
 				// Invoke with error catch
-				retCode = TA_LINEARREG(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal);
+				taLookback = TA_LINEARREG_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_LINEARREG(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				linreg_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(linreg_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(linreg_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(linreg_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -4703,32 +4981,27 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				linrega_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(linrega_OUT);
 
 				// Invoke with error catch
-				retCode = TA_LINEARREG_ANGLE(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal);
+				taLookback = TA_LINEARREG_ANGLE_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_LINEARREG_ANGLE(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				linrega_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(linrega_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(linrega_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(linrega_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -4827,32 +5100,27 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				linregi_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(linregi_OUT);
 
 				// Invoke with error catch
-				retCode = TA_LINEARREG_INTERCEPT(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal);
+				taLookback = TA_LINEARREG_INTERCEPT_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_LINEARREG_INTERCEPT(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				linregi_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(linregi_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(linregi_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(linregi_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -4951,32 +5219,27 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				linregs_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(linregs_OUT);
 
 				// Invoke with error catch
-				retCode = TA_LINEARREG_SLOPE(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal);
+				taLookback = TA_LINEARREG_SLOPE_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_LINEARREG_SLOPE(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				linregs_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(linregs_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(linregs_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(linregs_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -5037,26 +5300,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int lnIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				ln_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(ln_OUT);
 
 				// Invoke with error catch
-				retCode = TA_LN(startIdx, endIdx, dataPtr, &lnIdx, &outElements, outReal);
+				taLookback = TA_LN_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_LN(startIdx, endIdx, dataPtr, &lnIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_ln' failed. Aborting (4735).");
 				}
 
-				// Populate Output
-				ln_OUT = mxCreateDoubleMatrix(lnIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(ln_OUT)) + lnIdx, outReal, outElements * mxGetElementSize(ln_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(ln_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -5114,26 +5381,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int log10Idx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				log10_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(log10_OUT);
 
 				// Invoke with error catch
-				retCode = TA_LOG10(startIdx, endIdx, dataPtr, &log10Idx, &outElements, outReal);
+				taLookback = TA_LOG10_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_LOG10(startIdx, endIdx, dataPtr, &log10Idx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_log10' failed. Aborting (4813).");
 				}
 
-				// Populate Output
-				log10_OUT = mxCreateDoubleMatrix(log10Idx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(log10_OUT)) + log10Idx, outReal, outElements * mxGetElementSize(log10_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(log10_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -5248,32 +5519,27 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				// Validate
 				typeMAcheck(taFuncNameIn, taFuncDesc, taFuncOptName, typeMA);
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				ma_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(ma_OUT);
 
 				// Invoke with error catch
-				retCode = TA_MA(startIdx, endIdx, dataPtr, lookback, (TA_MAType)typeMA, &dataIdx, &outElements, outReal);
+				taLookback = TA_MA_Lookback(lookback, (TA_MAType)typeMA);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MA(startIdx, endIdx, dataPtr, lookback, (TA_MAType)typeMA, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				ma_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(ma_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(ma_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(ma_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -5419,50 +5685,35 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					}
 				}
 
-				// Preallocate heap
-				macd		= (double*)mxCalloc(rows, sizeof(double));
-				macdSig		= (double*)mxCalloc(rows, sizeof(double));
-				macdHist	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				macd_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				macd = (double*)mxGetData(macd_OUT);
+				macdSig_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				macdSig = (double*)mxGetData(macdSig_OUT);
+				macdHist_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				macdHist = (double*)mxGetData(macdHist_OUT);
 
-				retCode = TA_MACD(startIdx, endIdx, dataPtr, fastMA, slowMA, smoothP, &dataIdx, &outElements, macd, macdSig, macdHist);
+				taLookback = TA_MACD_Lookback(fastMA, slowMA, smoothP);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MACD(startIdx, endIdx, dataPtr, fastMA, slowMA, smoothP, &dataIdx, &outElements, macd + outBegIdx, macdSig + outBegIdx, macdHist + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(macd);
-					mxFree(macdSig);
-					mxFree(macdHist);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				macd_OUT		= mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				macdSig_OUT		= mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				macdHist_OUT	= mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(macd_OUT)) + dataIdx, macd, outElements * mxGetElementSize(macd_OUT));
-				memcpy(((double *) mxGetData(macdSig_OUT)) + dataIdx, macdSig, outElements * mxGetElementSize(macdSig_OUT));
-				memcpy(((double *) mxGetData(macdHist_OUT)) + dataIdx, macdHist, outElements * mxGetElementSize(macdHist_OUT));
-
-				// Cleanup
-				mxFree(macd); 
-				mxFree(macdSig); 
-				mxFree(macdHist); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *macdPtr = mxGetPr(macd_OUT);
 				double *macdSigPtr = mxGetPr(macdSig_OUT);
 				double *macdHistPtr = mxGetPr(macdHist_OUT);
 
-				for (int iter = 0; iter < slowMA; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					macdPtr[iter] = m_Nan;
 					macdSigPtr[iter] = m_Nan;
-				}
-
-				for (int iter = 0; iter < smoothP; iter++)
-				{
 					macdHistPtr[iter] = m_Nan;
 				}
 									
@@ -5637,50 +5888,35 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					}
 				}
 
-				// Preallocate heap
-				macd		= (double*)mxCalloc(rows, sizeof(double));
-				macdSig		= (double*)mxCalloc(rows, sizeof(double));
-				macdHist	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				macd_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				macd = (double*)mxGetData(macd_OUT);
+				macdSig_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				macdSig = (double*)mxGetData(macdSig_OUT);
+				macdHist_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				macdHist = (double*)mxGetData(macdHist_OUT);
 
-				retCode = TA_MACDEXT(startIdx, endIdx, dataPtr, fastMA, (TA_MAType)fastType, slowMA, (TA_MAType)slowType, smoothP, (TA_MAType)smoothType, &dataIdx, &outElements, macd, macdSig, macdHist);
+				taLookback = TA_MACDEXT_Lookback(fastMA, (TA_MAType)fastType, slowMA, (TA_MAType)slowType, smoothP, (TA_MAType)smoothType);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MACDEXT(startIdx, endIdx, dataPtr, fastMA, (TA_MAType)fastType, slowMA, (TA_MAType)slowType, smoothP, (TA_MAType)smoothType, &dataIdx, &outElements, macd + outBegIdx, macdSig + outBegIdx, macdHist + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(macd);
-					mxFree(macdSig);
-					mxFree(macdHist);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				macd_OUT		= mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				macdSig_OUT		= mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				macdHist_OUT	= mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(macd_OUT)) + dataIdx, macd, outElements * mxGetElementSize(macd_OUT));
-				memcpy(((double *) mxGetData(macdSig_OUT)) + dataIdx, macdSig, outElements * mxGetElementSize(macdSig_OUT));
-				memcpy(((double *) mxGetData(macdHist_OUT)) + dataIdx, macdHist, outElements * mxGetElementSize(macdHist_OUT));
-
-				// Cleanup
-				mxFree(macd); 
-				mxFree(macdSig); 
-				mxFree(macdHist); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *macdPtr = mxGetPr(macd_OUT);
 				double *macdSigPtr = mxGetPr(macdSig_OUT);
 				double *macdHistPtr = mxGetPr(macdHist_OUT);
 
-				for (int iter = 0; iter < slowMA; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					macdPtr[iter] = m_Nan;
 					macdSigPtr[iter] = m_Nan;
-				}
-
-				for (int iter = 0; iter < smoothP; iter++)
-				{
 					macdHistPtr[iter] = m_Nan;
 				}
 
@@ -5778,50 +6014,35 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					smoothP = 9;
 				}
 
-				// Preallocate heap
-				macd		= (double*)mxCalloc(rows, sizeof(double));
-				macdSig		= (double*)mxCalloc(rows, sizeof(double));
-				macdHist	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				macd_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				macd = (double*)mxGetData(macd_OUT);
+				macdSig_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				macdSig = (double*)mxGetData(macdSig_OUT);
+				macdHist_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				macdHist = (double*)mxGetData(macdHist_OUT);
 
-				retCode = TA_MACDFIX(startIdx, endIdx, dataPtr, smoothP, &dataIdx, &outElements, macd, macdSig, macdHist);
+				taLookback = TA_MACDFIX_Lookback(smoothP);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MACDFIX(startIdx, endIdx, dataPtr, smoothP, &dataIdx, &outElements, macd + outBegIdx, macdSig + outBegIdx, macdHist + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(macd);
-					mxFree(macdSig);
-					mxFree(macdHist);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				macd_OUT		= mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				macdSig_OUT		= mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				macdHist_OUT	= mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(macd_OUT)) + dataIdx, macd, outElements * mxGetElementSize(macd_OUT));
-				memcpy(((double *) mxGetData(macdSig_OUT)) + dataIdx, macdSig, outElements * mxGetElementSize(macdSig_OUT));
-				memcpy(((double *) mxGetData(macdHist_OUT)) + dataIdx, macdHist, outElements * mxGetElementSize(macdHist_OUT));
-
-				// Cleanup
-				mxFree(macd); 
-				mxFree(macdSig); 
-				mxFree(macdHist); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *macdPtr = mxGetPr(macd_OUT);
 				double *macdSigPtr = mxGetPr(macdSig_OUT);
 				double *macdHistPtr = mxGetPr(macdHist_OUT);
 
-				for (int iter = 0; iter < 26; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					macdPtr[iter] = m_Nan;
 					macdSigPtr[iter] = m_Nan;
-				}
-
-				for (int iter = 0; iter < smoothP; iter++)
-				{
 					macdHistPtr[iter] = m_Nan;
 				}
 
@@ -5959,38 +6180,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 						"The MESA ADAPTIVE MOVING AVERAGE slowLmt must be less than or equal to the fastLmt. Aborting (%d).", codeLine);
 				}
 
-				// Preallocate heap
-				mama = (double*)mxCalloc(rows, sizeof(double));
-				fama = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				mama_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				mama = (double*)mxGetData(mama_OUT);
+				fama_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				fama = (double*)mxGetData(fama_OUT);
 
 				// Invoke with error catch
-				retCode = TA_MAMA(startIdx, endIdx, dataPtr, fastLmt, slowLmt, &dataIdx, &outElements, mama, fama);
+				taLookback = TA_MAMA_Lookback(fastLmt, slowLmt);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MAMA(startIdx, endIdx, dataPtr, fastLmt, slowLmt, &dataIdx, &outElements, mama + outBegIdx, fama + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(mama);
-					mxFree(fama);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				mama_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				fama_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(mama_OUT)) + dataIdx, mama, outElements * mxGetElementSize(mama_OUT));
-				memcpy(((double *) mxGetData(fama_OUT)) + dataIdx, fama, outElements * mxGetElementSize(fama_OUT));
-
-				// Cleanup
-				mxFree(mama); 
-				mxFree(fama); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *mamaPtr = mxGetPr(mama_OUT);
 				double *famaPtr = mxGetPr(fama_OUT);
 
-				for (int iter = 0; iter < 32; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					mamaPtr[iter] = m_Nan;
 					famaPtr[iter] = m_Nan;
@@ -6152,35 +6365,27 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				// Validate
 				typeMAcheck(taFuncNameIn, taFuncDesc, taFuncOptName, typeMA);
 
-				// Preallocate heap
-				mavp = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				mavp_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				mavp = (double*)mxGetData(mavp_OUT);
 
 				// Invoke with error catch
-				retCode = TA_MAVP(startIdx, endIdx, dataPtr, periodPtr, minPeriod, maxPeriod, (TA_MAType)typeMA, &dataIdx, &outElements, mavp);
+				taLookback = TA_MAVP_Lookback(minPeriod, maxPeriod, (TA_MAType)typeMA);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MAVP(startIdx, endIdx, dataPtr, periodPtr, minPeriod, maxPeriod, (TA_MAType)typeMA, &dataIdx, &outElements, mavp + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(mavp);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				mavp_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(mavp_OUT)) + dataIdx, mavp, outElements * mxGetElementSize(mavp_OUT));
-
-				// Cleanup
-				mxFree(mavp); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *mavpPtr = mxGetPr(mavp_OUT);
 
-				// Get the larger of the minPeriod or the original lookback period
-				int isGtr = max((int)*periodPtr, minPeriod);
-
-				for (int iter = 0; iter < isGtr; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					mavpPtr[iter] = m_Nan;
 				}
@@ -6267,26 +6472,33 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 30;
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				max_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(max_OUT);
 
 				// Invoke with error catch
-				retCode = TA_MAX(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal);
+				taLookback = TA_MAX_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				if (m_Backend == BACKEND_TALIB)
+					retCode = TA_MAX(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal + outBegIdx);
+				else
+					retCode = nativeRetCode(taNativeMax(dataPtr, rows, lookback, m_Backend, outReal + outBegIdx));
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				max_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(max_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(max_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(max_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -6370,27 +6582,22 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 30;
 				}
 
-				// Preallocate heap
-				outInt = (int*)mxCalloc(rows, sizeof(int));
+				// Outputs are written in place by TA-Lib
+				maxidx_OUT = mxCreateNumericMatrix(rows, 1, mxINT32_CLASS, mxREAL);
+				outInt = (int*)mxGetData(maxidx_OUT);
 
 				// Invoke with error catch
-				retCode = TA_MAXINDEX(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outInt);
+				taLookback = TA_MAXINDEX_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MAXINDEX(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outInt + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outInt);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				maxidx_OUT = mxCreateNumericMatrix(dataIdx + outElements,1, mxINT32_CLASS, mxREAL);
-				memcpy(((int *) mxGetData(maxidx_OUT)) + dataIdx, outInt, outElements * mxGetElementSize(maxidx_OUT));
-
-				// Cleanup
-				mxFree(outInt); 
-
 				break;
 			}
 
@@ -6453,26 +6660,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int dataIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				med_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(med_OUT);
 
 				// Invoke with error catch
-				retCode = TA_MEDPRICE(startIdx, endIdx, highPtr, lowPtr, &dataIdx, &outElements, outReal);
+				taLookback = TA_MEDPRICE_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MEDPRICE(startIdx, endIdx, highPtr, lowPtr, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				med_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(med_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(med_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(med_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -6567,32 +6778,27 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));			// added cast
+				// Outputs are written in place by TA-Lib
+				mfi_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(mfi_OUT);
 
 				// Invoke with error catch
-				retCode = TA_MFI(startIdx, endIdx, highPtr, lowPtr, closePtr, volPtr, lookback, &adIdx, &outElements, outReal);
+				taLookback = TA_MFI_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MFI(startIdx, endIdx, highPtr, lowPtr, closePtr, volPtr, lookback, &adIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_ad' failed. Aborting.");
 				}
 
-				// Populate Output
-				mfi_OUT = mxCreateDoubleMatrix(adIdx + outElements,1, mxREAL);
-				memcpy(((double*) mxGetData(mfi_OUT)) + adIdx, outReal, outElements * mxGetElementSize(mfi_OUT));
-
-				// Cleanup
-				mxFree(outReal);  
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(ma_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -6679,26 +6885,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				midpt_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(midpt_OUT);
 
 				// Invoke with error catch
-				retCode = TA_MIDPOINT(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal);
+				taLookback = TA_MIDPOINT_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MIDPOINT(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				midpt_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(midpt_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(midpt_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(midpt_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -6786,26 +6996,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				midpr_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(midpr_OUT);
 
 				// Invoke with error catch
-				retCode = TA_MIDPRICE(startIdx, endIdx, highPtr, lowPtr, lookback, &dataIdx, &outElements, outReal);
+				taLookback = TA_MIDPRICE_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MIDPRICE(startIdx, endIdx, highPtr, lowPtr, lookback, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				midpr_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(midpr_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(midpr_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(midpr_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -6889,26 +7103,33 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 30;
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				min_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(min_OUT);
 
 				// Invoke with error catch
-				retCode = TA_MIN(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal);
+				taLookback = TA_MIN_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				if (m_Backend == BACKEND_TALIB)
+					retCode = TA_MIN(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outReal + outBegIdx);
+				else
+					retCode = nativeRetCode(taNativeMin(dataPtr, rows, lookback, m_Backend, outReal + outBegIdx));
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				min_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(min_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(min_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(min_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -6992,27 +7213,22 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 30;
 				}
 
-				// Preallocate heap
-				outInt = (int*)mxCalloc(rows, sizeof(int));
+				// Outputs are written in place by TA-Lib
+				minidx_OUT = mxCreateNumericMatrix(rows, 1, mxINT32_CLASS, mxREAL);
+				outInt = (int*)mxGetData(minidx_OUT);
 
 				// Invoke with error catch
-				retCode = TA_MININDEX(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outInt);
+				taLookback = TA_MININDEX_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MININDEX(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outInt + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outInt);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				minidx_OUT = mxCreateNumericMatrix(dataIdx + outElements,1, mxINT32_CLASS, mxREAL);
-				memcpy(((int*) mxGetData(minidx_OUT)) + dataIdx, outInt, outElements * mxGetElementSize(minidx_OUT));
-
-				// Cleanup
-				mxFree(outInt); 
-
 				break;
 			}
 
@@ -7097,36 +7313,28 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 30;
 				}
 
-				// Preallocate heap
-				outMin = (double*)mxCalloc(rows, sizeof(double));
-				outMax = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				min_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outMin = (double*)mxGetData(min_OUT);
+				max_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outMax = (double*)mxGetData(max_OUT);
 
 				// Invoke with error catch
-				retCode = TA_MINMAX(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outMin, outMax);
+				taLookback = TA_MINMAX_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MINMAX(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outMin + outBegIdx, outMax + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outMin);
-					mxFree(outMax);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				max_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				min_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(min_OUT)) + dataIdx, outMin, outElements * mxGetElementSize(min_OUT));
-				memcpy(((double *) mxGetData(max_OUT)) + dataIdx, outMax, outElements * mxGetElementSize(max_OUT));
-
-				// Cleanup
-				mxFree(outMin); 
-				mxFree(outMax); 
-
 				// NaN those values less than the lookback period
 				double *minPtr = mxGetPr(min_OUT);
 				double *maxPtr = mxGetPr(max_OUT);
-				for (int iter = 0; iter < lookback - 1; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					minPtr[iter] = m_Nan;
 					maxPtr[iter] = m_Nan;
@@ -7218,32 +7426,24 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 30;
 				}
 
-				// Preallocate heap
-				outMinIdx = (int*)mxCalloc(rows, sizeof(int));
-				outMaxIdx = (int*)mxCalloc(rows, sizeof(int));
+				// Outputs are written in place by TA-Lib
+				minIdx_OUT = mxCreateNumericMatrix(rows, 1, mxINT32_CLASS, mxREAL);
+				outMinIdx = (int*)mxGetData(minIdx_OUT);
+				maxIdx_OUT = mxCreateNumericMatrix(rows, 1, mxINT32_CLASS, mxREAL);
+				outMaxIdx = (int*)mxGetData(maxIdx_OUT);
 
 				// Invoke with error catch
-				retCode = TA_MINMAXINDEX(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outMinIdx, outMaxIdx);
+				taLookback = TA_MINMAXINDEX_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MINMAXINDEX(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, outMinIdx + outBegIdx, outMaxIdx + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outMinIdx);
-					mxFree(outMaxIdx);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				maxIdx_OUT = mxCreateNumericMatrix(dataIdx + outElements,1, mxINT32_CLASS, mxREAL);
-				minIdx_OUT = mxCreateNumericMatrix(dataIdx + outElements,1, mxINT32_CLASS, mxREAL);
-				memcpy(((int *) mxGetData(minIdx_OUT)) + dataIdx, outMinIdx, outElements * mxGetElementSize(minIdx_OUT));
-				memcpy(((int *) mxGetData(maxIdx_OUT)) + dataIdx, outMaxIdx, outElements * mxGetElementSize(maxIdx_OUT));
-
-				// Cleanup
-				mxFree(outMinIdx); 
-				mxFree(outMaxIdx); 
-
 				break;
 			}
 
@@ -7264,7 +7464,7 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				//		ta_willr		WPR					Vector of Williams' %R values for the lookback period
 
 				// Strings for validation feedback
-				switch (s_mapStringValues[taFuncNameIn])
+				switch (taFunc)
 				{
 				case ta_minus_di:
 					taFuncDesc = "Minus Directional Indicator";
@@ -7338,7 +7538,7 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				}
 
 				// Validate
-				switch (s_mapStringValues[taFuncNameIn])
+				switch (taFunc)
 				{
 					case ta_minus_di:
 						if (lookback < 1)
@@ -7356,39 +7556,39 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 						break;
 				}
 				
-				// Preallocate heap
-				outReal	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				data_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(data_OUT);
 
-				switch (s_mapStringValues[taFuncNameIn])
+				switch (taFunc)
 				{
 				case ta_minus_di:
-					retCode = TA_MINUS_DI(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &dataIdx, &outElements, outReal);
+					taLookback = TA_MINUS_DI_Lookback(lookback);
+					outBegIdx = outStart(taLookback, rows);
+					retCode = TA_MINUS_DI(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &dataIdx, &outElements, outReal + outBegIdx);
 					break;
 				case ta_willr:
-					retCode = TA_WILLR(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &dataIdx, &outElements, outReal);
+					taLookback = TA_WILLR_Lookback(lookback);
+					outBegIdx = outStart(taLookback, rows);
+					if (m_Backend == BACKEND_TALIB)
+						retCode = TA_WILLR(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &dataIdx, &outElements, outReal + outBegIdx);
+					else
+						retCode = nativeRetCode(taNativeWillr(highPtr, lowPtr, closePtr, rows, lookback, m_Backend, outReal + outBegIdx));
 					break;
 				}
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				data_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(data_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(data_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *dataPtr = mxGetPr(data_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					dataPtr[iter] = m_Nan;
 				}
@@ -7474,31 +7674,26 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				mDM	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				mDM_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				mDM = (double*)mxGetData(mDM_OUT);
 
-				retCode = TA_MINUS_DM(startIdx, endIdx, highPtr, lowPtr, lookback, &dataIdx, &outElements, mDM);
+				taLookback = TA_MINUS_DM_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MINUS_DM(startIdx, endIdx, highPtr, lowPtr, lookback, &dataIdx, &outElements, mDM + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(mDM);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				mDM_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(mDM_OUT)) + dataIdx, mDM, outElements * mxGetElementSize(mDM_OUT));
-
-				// Cleanup
-				mxFree(mDM); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *mDMPtr = mxGetPr(mDM_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					mDMPtr[iter] = m_Nan;
 				}
@@ -7585,31 +7780,26 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				MOM	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				MOM_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				MOM = (double*)mxGetData(MOM_OUT);
 
-				retCode = TA_MOM(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, MOM);
+				taLookback = TA_MOM_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MOM(startIdx, endIdx, dataPtr, lookback, &dataIdx, &outElements, MOM + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(MOM);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				MOM_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(MOM_OUT)) + dataIdx, MOM, outElements * mxGetElementSize(MOM_OUT));
-
-				// Cleanup
-				mxFree(MOM); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *momPtr = mxGetPr(MOM_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					momPtr[iter] = m_Nan;
 				}
@@ -7677,25 +7867,29 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int dataIdx, outElements;
 				double *product;
 
-				// Preallocate heap
-				product = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				product_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				product = (double*)mxGetData(product_OUT);
 
-				retCode = TA_MULT(startIdx, endIdx, mCandPtr, mPlierPtr, &dataIdx, &outElements, product);
+				taLookback = TA_MULT_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_MULT(startIdx, endIdx, mCandPtr, mPlierPtr, &dataIdx, &outElements, product + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(product);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				product_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(product_OUT)) + dataIdx, product, outElements * mxGetElementSize(product_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(product_OUT);
 
-				// Cleanup
-				mxFree(product); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -7782,31 +7976,26 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				outReal	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				natr_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(natr_OUT);
 
-				retCode = TA_NATR(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &natrIdx, &outElements, outReal);
+				taLookback = TA_NATR_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_NATR(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &natrIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				natr_OUT = mxCreateDoubleMatrix(natrIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(natr_OUT)) + natrIdx, outReal, outElements * mxGetElementSize(natr_OUT));
-
-				// Cleanup
-				mxFree(outReal);
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(natr_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -7872,26 +8061,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int dataIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));			// added cast
+				// Outputs are written in place by TA-Lib
+				obv_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(obv_OUT);
 
 				// Invoke with error catch
-				retCode = TA_OBV(startIdx, endIdx, dataPtr, volPtr, &dataIdx, &outElements, outReal);
+				taLookback = TA_OBV_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_OBV(startIdx, endIdx, dataPtr, volPtr, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				obv_OUT = mxCreateDoubleMatrix(dataIdx + outElements, 1, mxREAL);
-				memcpy(((double*) mxGetData(obv_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(obv_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(obv_OUT);
 
-				// Cleanup
-				mxFree(outReal);  
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -7977,31 +8170,26 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				outReal	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				plus_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(plus_OUT);
 
-				retCode = TA_PLUS_DI(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &dataIdx, &outElements, outReal);
+				taLookback = TA_PLUS_DI_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_PLUS_DI(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				plus_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(plus_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(plus_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *plusPtr = mxGetPr(plus_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					plusPtr[iter] = m_Nan;
 				}
@@ -8087,31 +8275,26 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					lookback = 14;
 				}
 
-				// Preallocate heap
-				outReal	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				plus_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(plus_OUT);
 
-				retCode = TA_PLUS_DM(startIdx, endIdx, highPtr, lowPtr, lookback, &dataIdx, &outElements, outReal);
+				taLookback = TA_PLUS_DM_Lookback(lookback);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_PLUS_DM(startIdx, endIdx, highPtr, lowPtr, lookback, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				plus_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(plus_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(plus_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *plusPtr = mxGetPr(plus_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					plusPtr[iter] = m_Nan;
 				}
@@ -8255,27 +8438,28 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 						"The optional inputs must be a scalar greater than or equal to 0. Aborting (%d).",codeLine);
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				vec_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(vec_OUT);
 
 				// Invoke with error catch
-				retCode = TA_SAR(startIdx, endIdx, highPtr, lowPtr, opt1, opt2, &vecIdx, &outElements, outReal);
+				taLookback = TA_SAR_Lookback(opt1, opt2);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_SAR(startIdx, endIdx, highPtr, lowPtr, opt1, opt2, &vecIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt( "MATLAB:taInvoke:invokeErr",
 						"Invocation to '%s' failed.. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				vec_OUT = mxCreateDoubleMatrix(vecIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(vec_OUT)) + vecIdx, outReal, outElements * mxGetElementSize(vec_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
+				// NaN data before lookback
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outReal[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -8567,26 +8751,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 						"Each optional input must be a scalar greater than or equal to 0. Aborting (%d).", codeLine);
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				vec_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(vec_OUT);
 
 				// Invoke with error catch
-				retCode = TA_SAREXT(startIdx, endIdx, highPtr, lowPtr, opt1, opt2, opt3, opt4, opt5, opt6, opt7, opt8, &vecIdx, &outElements, outReal);
+				taLookback = TA_SAREXT_Lookback(opt1, opt2, opt3, opt4, opt5, opt6, opt7, opt8);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_SAREXT(startIdx, endIdx, highPtr, lowPtr, opt1, opt2, opt3, opt4, opt5, opt6, opt7, opt8, &vecIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgTxt("Invocation to 'ta_adosc' failed. Aborting (577).");
 				}
 
-				// Populate Output
-				vec_OUT = mxCreateDoubleMatrix(vecIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(vec_OUT)) + vecIdx, outReal, outElements * mxGetElementSize(vec_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(vec_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -8605,7 +8793,7 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				// OUTPUT
 				//		ta_stddev	STDDEV		vector of standard deviation values
 
-				switch (s_mapStringValues[taFuncNameIn])
+				switch (taFunc)
 				{
 					case ta_stddev:
 						taFuncDesc = "Standard Deviation";
@@ -8693,40 +8881,40 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					mexErrMsgIdAndTxt( "MATLAB:taInvoke:InputErr",
 					"Lookback period must be a scalar greater than or equal to 2. Aborting (%d).", codeLine);
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				vec_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(vec_OUT);
 
 				// Invoke with error catch
-				switch (s_mapStringValues[taFuncNameIn])
+				switch (taFunc)
 				{
 					case ta_stddev:
-						retCode = TA_STDDEV(startIdx, endIdx, dataPtr, lookback, numDev, &dataIdx, &outElements, outReal);
+						taLookback = TA_STDDEV_Lookback(lookback, numDev);
+						outBegIdx = outStart(taLookback, rows);
+						if (m_Backend == BACKEND_TALIB)
+							retCode = TA_STDDEV(startIdx, endIdx, dataPtr, lookback, numDev, &dataIdx, &outElements, outReal + outBegIdx);
+						else
+							retCode = nativeRetCode(taNativeStdDev(dataPtr, rows, lookback, numDev, m_Backend, outReal + outBegIdx));
 						break;
 					case ta_var:
-						retCode = TA_VAR(startIdx, endIdx, dataPtr, lookback, numDev, &dataIdx, &outElements, outReal);
+						taLookback = TA_VAR_Lookback(lookback, numDev);
+						outBegIdx = outStart(taLookback, rows);
+						retCode = TA_VAR(startIdx, endIdx, dataPtr, lookback, numDev, &dataIdx, &outElements, outReal + outBegIdx);
 						break;
 				}
 				
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				vec_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(vec_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(vec_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *vecPtr = mxGetPr(vec_OUT);
 
-				for (int iter = 0; iter < lookback; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					vecPtr[iter] = m_Nan;
 				}
@@ -8947,38 +9135,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 						"Period based optional inputs must be a scalar greater than or equal to 1. Aborting (%d).", codeLine);
 				}
 
-				// Preallocate heap
-				outDReal = (double*)mxCalloc(rows, sizeof(double));
-				outKReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				slowD_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outDReal = (double*)mxGetData(slowD_OUT);
+				slowK_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outKReal = (double*)mxGetData(slowK_OUT);
 
 				// Invoke with error catch
-				retCode = TA_STOCH(startIdx, endIdx, highPtr, lowPtr, closePtr, opt1, opt2, (TA_MAType)opt3, opt4, (TA_MAType)opt5, &vecIdx, &outElements, outKReal, outDReal);
+				taLookback = TA_STOCH_Lookback(opt1, opt2, (TA_MAType)opt3, opt4, (TA_MAType)opt5);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_STOCH(startIdx, endIdx, highPtr, lowPtr, closePtr, opt1, opt2, (TA_MAType)opt3, opt4, (TA_MAType)opt5, &vecIdx, &outElements, outKReal + outBegIdx, outDReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outKReal);
-					mxFree(outDReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				slowK_OUT = mxCreateDoubleMatrix(vecIdx + outElements,1, mxREAL);
-				slowD_OUT = mxCreateDoubleMatrix(vecIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(slowK_OUT)) + vecIdx, outKReal, outElements * mxGetElementSize(slowK_OUT));
-				memcpy(((double *) mxGetData(slowD_OUT)) + vecIdx, outDReal, outElements * mxGetElementSize(slowD_OUT));
-
-				// Cleanup
-				mxFree(outKReal);
-				mxFree(outDReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *kPtr = mxGetPr(slowK_OUT);
 				double *dPtr = mxGetPr(slowD_OUT);
 
-				for (int iter = 0; iter < opt1 + max(opt2, opt4); iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					kPtr[iter] = m_Nan;
 					dPtr[iter] = m_Nan;
@@ -9156,38 +9336,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 						"Period based optional inputs must be a scalar greater than or equal to 1. Aborting (%d).", codeLine);
 				}
 
-				// Preallocate heap
-				outDReal = (double*)mxCalloc(rows, sizeof(double));
-				outKReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				slowD_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outDReal = (double*)mxGetData(slowD_OUT);
+				slowK_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outKReal = (double*)mxGetData(slowK_OUT);
 
 				// Invoke with error catch
-				retCode = TA_STOCHF(startIdx, endIdx, highPtr, lowPtr, closePtr, opt1, opt2, (TA_MAType)opt3, &vecIdx, &outElements, outKReal, outDReal);
+				taLookback = TA_STOCHF_Lookback(opt1, opt2, (TA_MAType)opt3);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_STOCHF(startIdx, endIdx, highPtr, lowPtr, closePtr, opt1, opt2, (TA_MAType)opt3, &vecIdx, &outElements, outKReal + outBegIdx, outDReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outKReal);
-					mxFree(outDReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				slowK_OUT = mxCreateDoubleMatrix(vecIdx + outElements,1, mxREAL);
-				slowD_OUT = mxCreateDoubleMatrix(vecIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(slowK_OUT)) + vecIdx, outKReal, outElements * mxGetElementSize(slowK_OUT));
-				memcpy(((double *) mxGetData(slowD_OUT)) + vecIdx, outDReal, outElements * mxGetElementSize(slowD_OUT));
-
-				// Cleanup
-				mxFree(outKReal);
-				mxFree(outDReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *kPtr = mxGetPr(slowK_OUT);
 				double *dPtr = mxGetPr(slowD_OUT);
 
-				for (int iter = 0; iter < opt1 + opt2; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					kPtr[iter] = m_Nan;
 					dPtr[iter] = m_Nan;
@@ -9289,7 +9461,7 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int vecIdx, outElements;
 				double *outDReal, *outKReal;
 
-				if (nrhs > 3)
+				if (nrhs > 2)
 				{
 					#define opt1_IN	prhs[2]
 
@@ -9301,7 +9473,7 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					// Assign
 					opt1 = (int)mxGetScalar(opt1_IN);
 
-					if (nrhs > 4)
+					if (nrhs > 3)
 					{
 						#define opt2_IN	prhs[3]
 
@@ -9313,7 +9485,7 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 						// Assign
 						opt2 = (int)mxGetScalar(opt2_IN);
 
-						if (nrhs > 5)
+						if (nrhs > 4)
 						{
 							#define opt3_IN	prhs[4]
 
@@ -9325,7 +9497,7 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 							// Assign
 							opt3 = (int)mxGetScalar(opt3_IN);
 
-							if (nrhs > 6)
+							if (nrhs > 5)
 							{
 								#define opt4_IN	prhs[5]
 
@@ -9380,38 +9552,30 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 						"Period based optional inputs must be a scalar greater than or equal to 1. Aborting (%d).", codeLine);
 				}
 
-				// Preallocate heap
-				outDReal = (double*)mxCalloc(rows, sizeof(double));
-				outKReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				slowD_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outDReal = (double*)mxGetData(slowD_OUT);
+				slowK_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outKReal = (double*)mxGetData(slowK_OUT);
 
 				// Invoke with error catch
-				retCode = TA_STOCHRSI(startIdx, endIdx, dataPtr, opt1, opt2, opt3, (TA_MAType)opt4, &vecIdx, &outElements, outKReal, outDReal);
+				taLookback = TA_STOCHRSI_Lookback(opt1, opt2, opt3, (TA_MAType)opt4);
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_STOCHRSI(startIdx, endIdx, dataPtr, opt1, opt2, opt3, (TA_MAType)opt4, &vecIdx, &outElements, outKReal + outBegIdx, outDReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outKReal);
-					mxFree(outDReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				slowK_OUT = mxCreateDoubleMatrix(vecIdx + outElements,1, mxREAL);
-				slowD_OUT = mxCreateDoubleMatrix(vecIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(slowK_OUT)) + vecIdx, outKReal, outElements * mxGetElementSize(slowK_OUT));
-				memcpy(((double *) mxGetData(slowD_OUT)) + vecIdx, outDReal, outElements * mxGetElementSize(slowD_OUT));
-
-				// Cleanup
-				mxFree(outKReal);
-				mxFree(outDReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *kPtr = mxGetPr(slowK_OUT);
 				double *dPtr = mxGetPr(slowD_OUT);
 
-				for (int iter = 0; iter < max(opt1, opt2 + opt3); iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					kPtr[iter] = m_Nan;
 					dPtr[iter] = m_Nan;
@@ -9518,38 +9682,33 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 						"The '%s' inVfactor must be an integer between 0 =< x >= 1. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Preallocate heap
-				outReal = (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				vec_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(vec_OUT);
 
 				// Invoke with error catch
-				switch (s_mapStringValues[taFuncNameIn])
+				switch (taFunc)
 				{
 				case ta_t3:
-					retCode = TA_T3(startIdx, endIdx, vecPtr, lookback, inVfactor, &vecIdx, &outElements, outReal);
+					taLookback = TA_T3_Lookback(lookback, inVfactor);
+					outBegIdx = outStart(taLookback, rows);
+					retCode = TA_T3(startIdx, endIdx, vecPtr, lookback, inVfactor, &vecIdx, &outElements, outReal + outBegIdx);
 					break;
 				}
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt( "MATLAB:taInvoke:invokeErr",
 						"Invocation to '%s' failed.. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				vec_OUT = mxCreateDoubleMatrix(vecIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(vec_OUT)) + vecIdx, outReal, outElements * mxGetElementSize(vec_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(vec_OUT);
 
-				for (int iter = 0; iter < (lookback - 1) * 6; iter++)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
 					outPtr[iter] = m_Nan;
 				}
@@ -9573,7 +9732,7 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				//		ta_typprice	TYPPRICE	A single vector of Typical Price values
 
 				// Strings for validation feedback
-				switch (s_mapStringValues[taFuncNameIn])
+				switch (taFunc)
 				{
 					case ta_trange:
 						taFuncDesc = "True Range";
@@ -9627,39 +9786,38 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int dataIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				vec_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(vec_OUT);
 
-				switch (s_mapStringValues[taFuncNameIn])
+				switch (taFunc)
 				{
 					case ta_trange:
-						retCode = TA_TRANGE(startIdx, endIdx, highPtr, lowPtr, closePtr, &dataIdx, &outElements, outReal);
+						taLookback = TA_TRANGE_Lookback();
+						outBegIdx = outStart(taLookback, rows);
+						retCode = TA_TRANGE(startIdx, endIdx, highPtr, lowPtr, closePtr, &dataIdx, &outElements, outReal + outBegIdx);
 						break;
 					case ta_typprice:
-						retCode = TA_TYPPRICE(startIdx, endIdx, highPtr, lowPtr, closePtr, &dataIdx, &outElements, outReal);
+						taLookback = TA_TYPPRICE_Lookback();
+						outBegIdx = outStart(taLookback, rows);
+						retCode = TA_TYPPRICE(startIdx, endIdx, highPtr, lowPtr, closePtr, &dataIdx, &outElements, outReal + outBegIdx);
 						break;
 				}
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				vec_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(vec_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(vec_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(vec_OUT);
 
-				if (taFuncNameIn.compare("ta_trange") == 0)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
-					// NaN first entry
-					double *outPtr = mxGetPr(vec_OUT);
-					outPtr[0] = m_Nan;
+					outPtr[iter] = m_Nan;
 				}
 
 				break;
@@ -9680,7 +9838,7 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				//		ta_ultosc	ULTOSC		A single vector of Ultimate Oscillator values
 				// Strings for validation feedback
 				
-				switch (s_mapStringValues[taFuncNameIn])
+				switch (taFunc)
 				{
 				case ta_ultosc:
 					taFuncDesc = "Ultimate Oscillator ";
@@ -9798,14 +9956,17 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 					mexErrMsgIdAndTxt( "MATLAB:taInvoke:inputErr",
 						"Lookback periods must be of a value greater than or equal to 1. Aborting (%d).", rows, codeLine);
 				}
-				// Preallocate heap
-				outReal	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				data_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(data_OUT);
 
 				// Invoke with error catch
-				switch (s_mapStringValues[taFuncNameIn])
+				switch (taFunc)
 				{
 				case ta_ultosc:
-					retCode = TA_ULTOSC(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback1, lookback2, lookback3, &dataIdx, &outElements, outReal);
+					taLookback = TA_ULTOSC_Lookback(lookback1, lookback2, lookback3);
+					outBegIdx = outStart(taLookback, rows);
+					retCode = TA_ULTOSC(startIdx, endIdx, highPtr, lowPtr, closePtr, lookback1, lookback2, lookback3, &dataIdx, &outElements, outReal + outBegIdx);
 					break;
 				}
 
@@ -9813,32 +9974,20 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt( "MATLAB:taInvoke:invokeErr",
 						"Invocation to '%s' failed.. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				data_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(data_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(data_OUT));
-
-				// Cleanup
-				mxFree(outReal); 
-
 				// NaN data before lookback
 				// assign the variables for manipulating the arrays (by pointer reference)
 				double *outPtr = mxGetPr(data_OUT);
 
-				int lookback = max(lookback1, max(lookback2, lookback3));
-				
-				if (lookback > 1)
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
 				{
-					for (int iter = 0; iter < lookback; iter++)
-					{
-						outPtr[iter] = m_Nan;
-					}
+					outPtr[iter] = m_Nan;
 				}
+
 				break;
 			}
 
@@ -9902,25 +10051,29 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 				int dataIdx, outElements;
 				double *outReal;
 
-				// Preallocate heap
-				outReal	= (double*)mxCalloc(rows, sizeof(double));
+				// Outputs are written in place by TA-Lib
+				data_OUT = mxCreateDoubleMatrix(rows, 1, mxREAL);
+				outReal = (double*)mxGetData(data_OUT);
 
-				retCode = TA_WCLPRICE(startIdx, endIdx, highPtr, lowPtr, closePtr, &dataIdx, &outElements, outReal);
+				taLookback = TA_WCLPRICE_Lookback();
+				outBegIdx = outStart(taLookback, rows);
+				retCode = TA_WCLPRICE(startIdx, endIdx, highPtr, lowPtr, closePtr, &dataIdx, &outElements, outReal + outBegIdx);
 
 				// Error handling
 				if (retCode) 
 				{
-					mxFree(outReal);
 					mexPrintf("%s%i","Return code=",retCode);
 					mexErrMsgIdAndTxt("MATLAB:taInvoke","Invocation to '%s' failed. Aborting (%d).", taFuncNameIn, codeLine);
 				}
 
-				// Populate Output
-				data_OUT = mxCreateDoubleMatrix(dataIdx + outElements,1, mxREAL);
-				memcpy(((double *) mxGetData(data_OUT)) + dataIdx, outReal, outElements * mxGetElementSize(data_OUT));
+				// NaN data before lookback
+				// assign the variables for manipulating the arrays (by pointer reference)
+				double *outPtr = mxGetPr(data_OUT);
 
-				// Cleanup
-				mxFree(outReal); 
+				for (int iter = 0; iter < min(taLookback, rows); iter++)
+				{
+					outPtr[iter] = m_Nan;
+				}
 
 				break;
 			}
@@ -9932,6 +10085,9 @@ void mexFunction(int nlhs, mxArray *plhs[],	/* Output variables */
 			break;
 	}
 
+	// Only reached when the call succeeded
+	cacheInsert(cacheKey, nlhs, plhs);
+
 	return;
 }
 
@@ -10320,169 +10476,1702 @@ void taInvokeInfoOnly()
 	mxFree(typeOut);
 }
 
-void InitSwitchMapping()
+// Function names with their enum values.  Sorted by name (the enum order) and built at compile time,
+// so a name is found by binary search without any per call setup
+typedef struct taFuncEntry
+{
+	const char *name;
+	StringValue value;
+} taFuncEntry;
+
+static const taFuncEntry s_taFuncTable[] = {
+	{"ta_accbands",						ta_accbands},
+	{"ta_acos",							ta_acos},
+	{"ta_ad",							ta_ad},
+	{"ta_add",							ta_add},
+	{"ta_adosc",						ta_adosc},
+	{"ta_adx",							ta_adx},
+	{"ta_adxr",							ta_adxr},
+	{"ta_apo",							ta_apo},
+	{"ta_aroon",						ta_aroon},
+	{"ta_aroonosc",						ta_aroonosc},
+	{"ta_asin",							ta_asin},
+	{"ta_atan",							ta_atan},
+	{"ta_atr",							ta_atr},
+	{"ta_avgdev",						ta_avgdev},
+	{"ta_avgprice",						ta_avgprice},
+	{"ta_bbands",						ta_bbands},
+	{"ta_beta",							ta_beta},
+	{"ta_bop",							ta_bop},
+	{"ta_cci",							ta_cci},
+	{"ta_cdl2crows",					ta_cdl2crows},
+	{"ta_cdl3blackcrows",				ta_cdl3blackcrows},
+	{"ta_cdl3inside",					ta_cdl3inside},
+	{"ta_cdl3linestrike",				ta_cdl3linestrike},
+	{"ta_cdl3outside",					ta_cdl3outside},
+	{"ta_cdl3starsinsouth",				ta_cdl3starsinsouth},
+	{"ta_cdl3whitesoldiers",			ta_cdl3whitesoldiers},
+	{"ta_cdlabandonedbaby",				ta_cdlabandonedbaby},
+	{"ta_cdladvanceblock",				ta_cdladvanceblock},
+	{"ta_cdlbelthold",					ta_cdlbelthold},
+	{"ta_cdlbreakaway",					ta_cdlbreakaway},
+	{"ta_cdlclosingmarubozu",			ta_cdlclosingmarubozu},
+	{"ta_cdlconcealbabyswall",			ta_cdlconcealbabyswall},
+	{"ta_cdlcounterattack",				ta_cdlcounterattack},
+	{"ta_cdldarkcloudcover",			ta_cdldarkcloudcover},
+	{"ta_cdldoji",						ta_cdldoji},
+	{"ta_cdldojistar",					ta_cdldojistar},
+	{"ta_cdldragonflydoji",				ta_cdldragonflydoji},
+	{"ta_cdlengulfing",					ta_cdlengulfing},
+	{"ta_cdleveningdojistar",			ta_cdleveningdojistar},
+	{"ta_cdleveningstar",				ta_cdleveningstar},
+	{"ta_cdlgapsidesidewhite",			ta_cdlgapsidesidewhite},
+	{"ta_cdlgravestonedoji",			ta_cdlgravestonedoji},
+	{"ta_cdlhammer",					ta_cdlhammer},
+	{"ta_cdlhangingman",				ta_cdlhangingman},
+	{"ta_cdlharami",					ta_cdlharami},
+	{"ta_cdlharamicross",				ta_cdlharamicross},
+	{"ta_cdlhighwave",					ta_cdlhighwave},
+	{"ta_cdlhikkake",					ta_cdlhikkake},
+	{"ta_cdlhikkakemod",				ta_cdlhikkakemod},
+	{"ta_cdlhomingpigeon",				ta_cdlhomingpigeon},
+	{"ta_cdlidentical3crows",			ta_cdlidentical3crows},
+	{"ta_cdlinneck",					ta_cdlinneck},
+	{"ta_cdlinvertedhammer",			ta_cdlinvertedhammer},
+	{"ta_cdlkicking",					ta_cdlkicking},
+	{"ta_cdlkickingbylength",			ta_cdlkickingbylength},
+	{"ta_cdlladderbottom",				ta_cdlladderbottom},
+	{"ta_cdllongleggeddoji",			ta_cdllongleggeddoji},
+	{"ta_cdllongline",					ta_cdllongline},
+	{"ta_cdlmarubozu",					ta_cdlmarubozu},
+	{"ta_cdlmatchinglow",				ta_cdlmatchinglow},
+	{"ta_cdlmathold",					ta_cdlmathold},
+	{"ta_cdlmorningdojistar",			ta_cdlmorningdojistar},
+	{"ta_cdlmorningstar",				ta_cdlmorningstar},
+	{"ta_cdlonneck",					ta_cdlonneck},
+	{"ta_cdlpiercing",					ta_cdlpiercing},
+	{"ta_cdlrickshawman",				ta_cdlrickshawman},
+	{"ta_cdlrisefall3methods",			ta_cdlrisefall3methods},
+	{"ta_cdlseparatinglines",			ta_cdlseparatinglines},
+	{"ta_cdlshootingstar",				ta_cdlshootingstar},
+	{"ta_cdlshortline",					ta_cdlshortline},
+	{"ta_cdlspinningtop",				ta_cdlspinningtop},
+	{"ta_cdlstalledpattern",			ta_cdlstalledpattern},
+	{"ta_cdlsticksandwich",				ta_cdlsticksandwich},
+	{"ta_cdltakuri",					ta_cdltakuri},
+	{"ta_cdltasukigap",					ta_cdltasukigap},
+	{"ta_cdlthrusting",					ta_cdlthrusting},
+	{"ta_cdltristar",					ta_cdltristar},
+	{"ta_cdlunique3river",				ta_cdlunique3river},
+	{"ta_cdlupsidegap2crows",			ta_cdlupsidegap2crows},
+	{"ta_cdlxsidegap3methods",			ta_cdlxsidegap3methods},
+	{"ta_ceil",							ta_ceil},
+	{"ta_cmo",							ta_cmo},
+	{"ta_correl",						ta_correl},
+	{"ta_cos",							ta_cos},
+	{"ta_cosh",							ta_cosh},
+	{"ta_dema",							ta_dema},
+	{"ta_div",							ta_div},
+	{"ta_dx",							ta_dx},
+	{"ta_ema",							ta_ema},
+	{"ta_exp",							ta_exp},
+	{"ta_floor",						ta_floor},
+	{"ta_ht_dcperiod",					ta_ht_dcperiod},
+	{"ta_ht_dcphase",					ta_ht_dcphase},
+	{"ta_ht_phasor",					ta_ht_phasor},
+	{"ta_ht_sine",						ta_ht_sine},
+	{"ta_ht_trendline",					ta_ht_trendline},
+	{"ta_ht_trendmode",					ta_ht_trendmode},
+	{"ta_kama",							ta_kama},
+	{"ta_linearreg",					ta_linearreg},
+	{"ta_linearreg_angle",				ta_linearreg_angle},
+	{"ta_linearreg_intercept",			ta_linearreg_intercept},
+	{"ta_linearreg_slope",				ta_linearreg_slope},
+	{"ta_ln",							ta_ln},
+	{"ta_log10",						ta_log10},
+	{"ta_ma",							ta_ma},
+	{"ta_macd",							ta_macd},
+	{"ta_macdext",						ta_macdext},
+	{"ta_macdfix",						ta_macdfix},
+	{"ta_mama",							ta_mama},
+	{"ta_mavp",							ta_mavp},
+	{"ta_max",							ta_max},
+	{"ta_maxindex",						ta_maxindex},
+	{"ta_medprice",						ta_medprice},
+	{"ta_mfi",							ta_mfi},
+	{"ta_midpoint",						ta_midpoint},
+	{"ta_midprice",						ta_midprice},
+	{"ta_min",							ta_min},
+	{"ta_minindex",						ta_minindex},
+	{"ta_minmax",						ta_minmax},
+	{"ta_minmaxindex",					ta_minmaxindex},
+	{"ta_minus_di",						ta_minus_di},
+	{"ta_minus_dm",						ta_minus_dm},
+	{"ta_mom",							ta_mom},
+	{"ta_mult",							ta_mult},
+	{"ta_natr",							ta_natr},
+	{"ta_obv",							ta_obv},
+	{"ta_plus_di",						ta_plus_di},
+	{"ta_plus_dm",						ta_plus_dm},
+	{"ta_ppo",							ta_ppo},
+	{"ta_roc",							ta_roc},
+	{"ta_rocp",							ta_rocp},
+	{"ta_rocr",							ta_rocr},
+	{"ta_rocr100",						ta_rocr100},
+	{"ta_rsi",							ta_rsi},
+	{"ta_sar",							ta_sar},
+	{"ta_sarext",						ta_sarext},
+	{"ta_sin",							ta_sin},
+	{"ta_sinh",							ta_sinh},
+	{"ta_sma",							ta_sma},
+	{"ta_sqrt",							ta_sqrt},
+	{"ta_stddev",						ta_stddev},
+	{"ta_stoch",						ta_stoch},
+	{"ta_stochf",						ta_stochf},
+	{"ta_stochrsi",						ta_stochrsi},
+	{"ta_sub",							ta_sub},
+	{"ta_sum",							ta_sum},
+	{"ta_t3",							ta_t3},
+	{"ta_tan",							ta_tan},
+	{"ta_tanh",							ta_tanh},
+	{"ta_tema",							ta_tema},
+	{"ta_trange",						ta_trange},
+	{"ta_trima",						ta_trima},
+	{"ta_trix",							ta_trix},
+	{"ta_tsf",							ta_tsf},
+	{"ta_typprice",						ta_typprice},
+	{"ta_ultosc",						ta_ultosc},
+	{"ta_var",							ta_var},
+	{"ta_wclprice",						ta_wclprice},
+	{"ta_willr",						ta_willr},
+	{"ta_wma",							ta_wma}
+};
+
+static bool taFuncLess(const taFuncEntry &entry, const char *name)
+{
+	return strcmp(entry.name, name) < 0;
+}
+
+// Find a function by name regardless of case.  The name is lowercased in place.  taNotDefined if there is no match
+StringValue findTaFunc(char *taFuncNameIn)
+{
+	for (char *cc = taFuncNameIn; *cc != 0; cc++)
+	{
+		*cc = (char)tolower(*cc);
+	}
+
+	const taFuncEntry *tableEnd = s_taFuncTable + sizeof(s_taFuncTable) / sizeof(s_taFuncTable[0]);
+	const taFuncEntry *entry = lower_bound(s_taFuncTable, tableEnd, (const char *)taFuncNameIn, taFuncLess);
+
+	if (entry == tableEnd || strcmp(entry->name, taFuncNameIn) != 0)
+	{
+		return taNotDefined;
+	}
+
+	return entry->value;
+}
+
+// Name of a function.  Entries are in enum order after taNotDefined
+const char *taFuncName(StringValue taFunc)
+{
+	return s_taFuncTable[taFunc - 1].name;
+}
+
+// Row at which TA-Lib writes its first value when called over rows 0 .. rows - 1.  Outputs are created
+// full length and TA-Lib is handed a pointer this far in to them so no scratch copy is needed.
+// A series no longer than the lookback produces no values and the caller NaNs all min(lookback, rows) rows
+int outStart(int lookback, int rows)
+{
+	return (lookback < rows) ? lookback : 0;
+}
+
+// Return code of a native routine as TA-Lib's.  Routines only fail on an optional input out of TA-Lib's range
+TA_RetCode nativeRetCode(int status)
+{
+	return (status == 0) ? TA_SUCCESS : TA_BAD_PARAM;
+}
+
+// name = taInvoke('backend') or previous = taInvoke('backend', name) where name is
+//	'talib'		TA-Lib for every function (default)
+//	'native'	taNative.h for ta_sma, ta_ema, ta_wma, ta_stddev, ta_bbands (typeMA 0 - 2), ta_atr, ta_willr, ta_max
+//			and ta_min, with AVX2 when the processor supports it.  Reported as 'avx2' or 'scalar'
+//	'scalar'	As 'native' without AVX2
+//	'avx2'		As 'native'.  An error if the processor does not support AVX2
+// The backend holds until it is changed or taInvoke is cleared.  Pipelines, grids and panels always use TA-Lib
+void taBackend(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	static const char *backendNames[] = {"talib", "scalar", "avx2"};
+	char name[16];
+
+	if (nrhs > 2 || nlhs > 1 || (nrhs == 2 && (!mxIsChar(prhs[1]) || mxGetString(prhs[1], name, sizeof(name)) != 0)))
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:NumInputs",
+		"Usage is name = taInvoke('backend') or previous = taInvoke('backend', name) with name 'talib', 'native', 'scalar' or 'avx2'. Aborting (%d).", codeLine);
+
+	int backend = m_Backend;
+	if (nrhs == 2)
+	{
+		if (strcmp(name, "talib") == 0)
+			backend = BACKEND_TALIB;
+		else if (strcmp(name, "native") == 0)
+			backend = taNativeHasAvx2() ? TA_NATIVE_AVX2 : TA_NATIVE_SCALAR;
+		else if (strcmp(name, "scalar") == 0)
+			backend = TA_NATIVE_SCALAR;
+		else if (strcmp(name, "avx2") == 0 && taNativeHasAvx2())
+			backend = TA_NATIVE_AVX2;
+		else if (strcmp(name, "avx2") == 0)
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:NoAvx2", "This processor does not support AVX2. Use 'native' or 'scalar'. Aborting (%d).", codeLine);
+		else
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:UnknownBackend",
+			"Unknown backend '%s'. Use 'talib', 'native', 'scalar' or 'avx2'. Aborting (%d).", name, codeLine);
+	}
+
+	plhs[0] = mxCreateString(backendNames[m_Backend + 1]);
+	m_Backend = backend;
+}
+
+// Outputs of one memoized call
+typedef struct taCacheEntry
+{
+	vector<unsigned long long> key;		// See cacheKeyOf
+	vector<mxArray*> outputs;		// Persistent, shared with the arrays returned on a hit
+	size_t bytes;				// Output data held
+} taCacheEntry;
+
+// Least recently used cache of function calls.  Entries are in recency order, most recent first, and are evicted
+// from the back once the output data held would exceed the capacity.  MatLab calls a MEX from one thread only
+typedef struct taCache
+{
+	list<taCacheEntry> entries;
+	map<vector<unsigned long long>, list<taCacheEntry>::iterator> index;
+	size_t capacity;			// Bytes.  0 = disabled
+	size_t bytes;
+	double hits;
+	double misses;
+	double evictions;
+} taCache;
+
+static taCache s_cache = {list<taCacheEntry>(), map<vector<unsigned long long>, list<taCacheEntry>::iterator>(), 0, 0, 0, 0, 0};
+
+static unsigned long long hashRotl(unsigned long long value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+// 64 bit hash of an input's data.  Four independent lanes of 8 byte words (as xxHash64) keep it near memory speed,
+// about 0.1 ns per byte, so hashing a series costs a small fraction of any function evaluated over it
+static unsigned long long cacheHash(const void *data, size_t numBytes)
+{
+	const unsigned long long prime1 = 11400714785074694791ULL;
+	const unsigned long long prime2 = 14029467366897019727ULL;
+	const unsigned char *bytes = (const unsigned char*)data;
+	unsigned long long lanes[4] = {prime1 + prime2, prime2, 0, 0 - prime1};
+	size_t ii = 0;
+
+	for (; ii + 32 <= numBytes; ii += 32)
+	{
+		for (int ll = 0; ll < 4; ll++)
+		{
+			unsigned long long word;
+			memcpy(&word, bytes + ii + 8 * ll, 8);
+			lanes[ll] = hashRotl(lanes[ll] + word * prime2, 31) * prime1;
+		}
+	}
+
+	unsigned long long hash = numBytes;
+	for (int ll = 0; ll < 4; ll++)
+		hash = hashRotl(hash ^ (hashRotl(lanes[ll] * prime2, 31) * prime1), 27) * prime1;
+	for (; ii < numBytes; ii++)
+		hash = hashRotl(hash ^ (bytes[ii] * prime1), 11) * prime2;
+
+	hash ^= hash >> 33;
+	hash *= prime2;
+	hash ^= hash >> 29;
+	return hash;
+}
+
+// Key of a function call: the function, backend and number of outputs followed by the class, rows, columns and a hash
+// of the contents of each input.  Inputs are identified by content because MatLab may change an array in place or
+// reuse its memory for another, so neither its address nor its size says the data is unchanged.
+// False when the cache is disabled or an input cannot be hashed (cell, struct, sparse or complex)
+bool cacheKeyOf(StringValue taFunc, int nlhs, int nrhs, const mxArray *prhs[], vector<unsigned long long> &key)
+{
+	if (s_cache.capacity == 0 || taFunc == taNotDefined)
+		return false;
+
+	key.reserve(3 + 4 * (nrhs - 1));
+	key.push_back(taFunc);
+	key.push_back((unsigned long long)(m_Backend + 1));
+	key.push_back(nlhs < 1 ? 1 : nlhs);
+
+	for (int ii = 1; ii < nrhs; ii++)
+	{
+		if (mxIsCell(prhs[ii]) || mxIsStruct(prhs[ii]) || mxIsSparse(prhs[ii]) || mxIsComplex(prhs[ii]))
+		{
+			key.clear();
+			return false;
+		}
+
+		key.push_back(mxGetClassID(prhs[ii]));
+		key.push_back(mxGetM(prhs[ii]));
+		key.push_back(mxGetN(prhs[ii]));
+		key.push_back(cacheHash(mxGetData(prhs[ii]), mxGetNumberOfElements(prhs[ii]) * mxGetElementSize(prhs[ii])));
+	}
+
+	return true;
+}
+
+// Return the outputs of a cached call as shared data copies (MatLab copies them only if the caller writes to them)
+bool cacheFind(const vector<unsigned long long> &key, int nlhs, mxArray *plhs[])
+{
+	map<vector<unsigned long long>, list<taCacheEntry>::iterator>::iterator found = s_cache.index.find(key);
+	if (found == s_cache.index.end())
+	{
+		s_cache.misses++;
+		return false;
+	}
+
+	taCacheEntry &entry = *found->second;
+	s_cache.entries.splice(s_cache.entries.begin(), s_cache.entries, found->second);
+	s_cache.hits++;
+
+	for (size_t kk = 0; kk < entry.outputs.size(); kk++)
+		plhs[kk] = mxCreateSharedDataCopy(entry.outputs[kk]);
+
+	return true;
+}
+
+static void cacheEvict(size_t capacity)
+{
+	while (s_cache.bytes > capacity)
+	{
+		taCacheEntry &entry = s_cache.entries.back();
+		for (size_t kk = 0; kk < entry.outputs.size(); kk++)
+			mxDestroyArray(entry.outputs[kk]);
+
+		s_cache.bytes -= entry.bytes;
+		s_cache.index.erase(entry.key);
+		s_cache.entries.pop_back();
+		s_cache.evictions++;
+	}
+}
+
+// Keep the outputs of a call that missed.  Outputs larger than the whole cache are not kept
+void cacheInsert(const vector<unsigned long long> &key, int nlhs, mxArray *plhs[])
+{
+	if (key.empty())
+		return;
+
+	const int numOutputs = nlhs < 1 ? 1 : nlhs;
+	size_t bytes = 0;
+
+	for (int kk = 0; kk < numOutputs; kk++)
+	{
+		if (plhs[kk] == NULL)
+			return;
+		bytes += mxGetNumberOfElements(plhs[kk]) * mxGetElementSize(plhs[kk]);
+	}
+
+	if (bytes > s_cache.capacity)
+		return;
+
+	cacheEvict(s_cache.capacity - bytes);
+
+	taCacheEntry entry;
+	entry.key = key;
+	entry.bytes = bytes;
+	for (int kk = 0; kk < numOutputs; kk++)
+	{
+		entry.outputs.push_back(mxCreateSharedDataCopy(plhs[kk]));
+		mexMakeArrayPersistent(entry.outputs.back());
+	}
+
+	s_cache.entries.push_front(entry);
+	s_cache.index[key] = s_cache.entries.begin();
+	s_cache.bytes += bytes;
+}
+
+// Release every cached output when taInvoke is cleared
+static void cacheFree()
+{
+	cacheEvict(0);
+	s_cache.capacity = 0;
+}
+
+// stats = taInvoke('cache')			Statistics only
+// stats = taInvoke('cache', megabytes)		Enable the cache holding up to 'megabytes' of output data, or resize it.
+//						Entries beyond the new size are evicted.  0 empties and disables it
+// stats = taInvoke('cache', 'clear')		Empty the cache and zero its statistics, keeping its size
+// Calls by name or handle (including panels) are cached.  Pipelines, grids and commands are not.
+// 'stats' has the fields capacityMB, usedMB, entries, hits, misses and evictions after the command
+void taCacheCommand(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	char option[8];
+
+	if (nrhs > 2 || nlhs > 1)
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:NumInputs",
+		"Usage is stats = taInvoke('cache'), taInvoke('cache', megabytes) or taInvoke('cache', 'clear'). Aborting (%d).", codeLine);
+
+	if (nrhs == 2 && mxIsChar(prhs[1]))
+	{
+		if (mxGetString(prhs[1], option, sizeof(option)) != 0 || strcmp(option, "clear") != 0)
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:inputErr",
+			"The only cache option is 'clear'. Aborting (%d).", codeLine);
+
+		cacheEvict(0);
+		s_cache.hits = 0;
+		s_cache.misses = 0;
+		s_cache.evictions = 0;
+	}
+	else if (nrhs == 2)
+	{
+		if (!isRealScalar(prhs[1]) || !(mxGetScalar(prhs[1]) >= 0) || mxGetScalar(prhs[1]) > 1e9)
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:inputErr",
+			"The cache size must be a scalar number of megabytes, 0 to disable it. Aborting (%d).", codeLine);
+
+		size_t capacity = size_t(mxGetScalar(prhs[1]) * 1048576.0);
+
+		cacheEvict(capacity);
+		s_cache.capacity = capacity;
+	}
+
+	const char *fieldNames[] = {"capacityMB", "usedMB", "entries", "hits", "misses", "evictions"};
+	plhs[0] = mxCreateStructMatrix(1, 1, 6, fieldNames);
+	mxSetField(plhs[0], 0, "capacityMB", mxCreateDoubleScalar(s_cache.capacity / 1048576.0));
+	mxSetField(plhs[0], 0, "usedMB", mxCreateDoubleScalar(s_cache.bytes / 1048576.0));
+	mxSetField(plhs[0], 0, "entries", mxCreateDoubleScalar(double(s_cache.entries.size())));
+	mxSetField(plhs[0], 0, "hits", mxCreateDoubleScalar(s_cache.hits));
+	mxSetField(plhs[0], 0, "misses", mxCreateDoubleScalar(s_cache.misses));
+	mxSetField(plhs[0], 0, "evictions", mxCreateDoubleScalar(s_cache.evictions));
+}
+
+// One function of a pipeline call or one point of a grid call
+typedef struct taPipeStep
+{
+	StringValue taFunc;
+	const TA_FuncHandle *handle;
+	TA_ParamHolder *params;		// Inputs, optional inputs and outputs bound through TA-Lib's abstract interface
+	int lookback;
+	int firstCol;			// Column of the result taking the first output
+	int colStep;			// Columns between one output and the next
+	int numOutputs;
+	int intOutputs;			// Bit k set when output k is an integer
+	vector<int> intOut;		// rows per integer output, converted in to the result after the call
+	TA_RetCode retCode;
+} taPipeStep;
+
+// Free the parameters of every step taken so far
+static void pipeFree(vector<taPipeStep> &steps)
 {
-	s_mapStringValues["ta_accbands"]			= ta_accbands;
-	s_mapStringValues["ta_acos"]				= ta_acos;
-	s_mapStringValues["ta_ad"]					= ta_ad;
-	s_mapStringValues["ta_add"]					= ta_add;
-	s_mapStringValues["ta_adosc"]				= ta_adosc;
-	s_mapStringValues["ta_adx"]					= ta_adx;
-	s_mapStringValues["ta_adxr"]				= ta_adxr;
-	s_mapStringValues["ta_apo"]					= ta_apo;
-	s_mapStringValues["ta_aroon"]				= ta_aroon;
-	s_mapStringValues["ta_aroonosc"]			= ta_aroonosc;
-	s_mapStringValues["ta_asin"]				= ta_asin;
-	s_mapStringValues["ta_atan"]				= ta_atan;
-	s_mapStringValues["ta_atr"]					= ta_atr;
-	s_mapStringValues["ta_avgdev"]				= ta_avgdev;
-	s_mapStringValues["ta_avgprice"]			= ta_avgprice;
-	s_mapStringValues["ta_bbands"]				= ta_bbands;
-	s_mapStringValues["ta_beta"]				= ta_beta;
-	s_mapStringValues["ta_bop"]					= ta_bop;
-	s_mapStringValues["ta_cci"]					= ta_cci;
-	s_mapStringValues["ta_cdl2crows"]			= ta_cdl2crows;
-	s_mapStringValues["ta_cdl3blackcrows"]		= ta_cdl3blackcrows;
-	s_mapStringValues["ta_cdl3inside"]			= ta_cdl3inside;
-	s_mapStringValues["ta_cdl3linestrike"]		= ta_cdl3linestrike;
-	s_mapStringValues["ta_cdl3outside"]			= ta_cdl3outside;
-	s_mapStringValues["ta_cdl3starsinsouth"]	= ta_cdl3starsinsouth;
-	s_mapStringValues["ta_cdl3whitesoldiers"]	= ta_cdl3whitesoldiers;
-	s_mapStringValues["ta_cdlabandonedbaby"]	= ta_cdlabandonedbaby;
-	s_mapStringValues["ta_cdladvanceblock"]		= ta_cdladvanceblock;
-	s_mapStringValues["ta_cdlbelthold"]			= ta_cdlbelthold;
-	s_mapStringValues["ta_cdlbreakaway"]		= ta_cdlbreakaway;
-	s_mapStringValues["ta_cdlclosingmarubozu"]	= ta_cdlclosingmarubozu;
-	s_mapStringValues["ta_cdlconcealbabyswall"]	= ta_cdlconcealbabyswall;
-	s_mapStringValues["ta_cdlcounterattack"]	= ta_cdlcounterattack;
-	s_mapStringValues["ta_cdldarkcloudcover"]	= ta_cdldarkcloudcover;
-	s_mapStringValues["ta_cdldoji"]				= ta_cdldoji;
-	s_mapStringValues["ta_cdldojistar"]			= ta_cdldojistar;
-	s_mapStringValues["ta_cdldragonflydoji"]	= ta_cdldragonflydoji;
-	s_mapStringValues["ta_cdlengulfing"]		= ta_cdlengulfing;
-	s_mapStringValues["ta_cdleveningdojistar"]	= ta_cdleveningdojistar;
-	s_mapStringValues["ta_cdleveningstar"]		= ta_cdleveningstar;
-	s_mapStringValues["ta_cdlgapsidesidewhite"]	= ta_cdlgapsidesidewhite;
-	s_mapStringValues["ta_cdlgravestonedoji"]	= ta_cdlgravestonedoji;
-	s_mapStringValues["ta_cdlhammer"]			= ta_cdlhammer;
-	s_mapStringValues["ta_cdlhangingman"]		= ta_cdlhangingman;
-	s_mapStringValues["ta_cdlharami"]			= ta_cdlharami;
-	s_mapStringValues["ta_cdlharamicross"]		= ta_cdlharamicross;
-	s_mapStringValues["ta_cdlhighwave"]			= ta_cdlhighwave;
-	s_mapStringValues["ta_cdlhikkake"]			= ta_cdlhikkake;
-	s_mapStringValues["ta_cdlhikkakemod"]		= ta_cdlhikkakemod;
-	s_mapStringValues["ta_cdlhomingpigeon"]		= ta_cdlhomingpigeon;
-	s_mapStringValues["ta_cdlidentical3crows"]	= ta_cdlidentical3crows;
-	s_mapStringValues["ta_cdlinneck"]			= ta_cdlinneck;
-	s_mapStringValues["ta_cdlinvertedhammer"]	= ta_cdlinvertedhammer;
-	s_mapStringValues["ta_cdlkicking"]			= ta_cdlkicking;
-	s_mapStringValues["ta_cdlkickingbylength"]	= ta_cdlkickingbylength;
-	s_mapStringValues["ta_cdlladderbottom"]		= ta_cdlladderbottom;
-	s_mapStringValues["ta_cdllongleggeddoji"]	= ta_cdllongleggeddoji;
-	s_mapStringValues["ta_cdllongline"]			= ta_cdllongline;
-	s_mapStringValues["ta_cdlmarubozu"]			= ta_cdlmarubozu;
-	s_mapStringValues["ta_cdlmatchinglow"]		= ta_cdlmatchinglow;
-	s_mapStringValues["ta_cdlmathold"]			= ta_cdlmathold;
-	s_mapStringValues["ta_cdlmorningdojistar"]	= ta_cdlmorningdojistar;
-	s_mapStringValues["ta_cdlmorningstar"]		= ta_cdlmorningstar;
-	s_mapStringValues["ta_cdlonneck"]			= ta_cdlonneck;
-	s_mapStringValues["ta_cdlpiercing"]			= ta_cdlpiercing;
-	s_mapStringValues["ta_cdlrickshawman"]		= ta_cdlrickshawman;
-	s_mapStringValues["ta_cdlrisefall3methods"]	= ta_cdlrisefall3methods;
-	s_mapStringValues["ta_cdlseparatinglines"]	= ta_cdlseparatinglines;
-	s_mapStringValues["ta_cdlshootingstar"]		= ta_cdlshootingstar;
-	s_mapStringValues["ta_cdlshortline"]		= ta_cdlshortline;
-	s_mapStringValues["ta_cdlspinningtop"]		= ta_cdlspinningtop;
-	s_mapStringValues["ta_cdlstalledpattern"]	= ta_cdlstalledpattern;
-	s_mapStringValues["ta_cdlsticksandwich"]	= ta_cdlsticksandwich;
-	s_mapStringValues["ta_cdltakuri"]			= ta_cdltakuri;
-	s_mapStringValues["ta_cdltasukigap"]		= ta_cdltasukigap;
-	s_mapStringValues["ta_cdlthrusting"]		= ta_cdlthrusting;
-	s_mapStringValues["ta_cdltristar"]			= ta_cdltristar;
-	s_mapStringValues["ta_cdlunique3river"]		= ta_cdlunique3river;
-	s_mapStringValues["ta_cdlupsidegap2crows"]	= ta_cdlupsidegap2crows;
-	s_mapStringValues["ta_cdlxsidegap3methods"]	= ta_cdlxsidegap3methods;
-	s_mapStringValues["ta_ceil"]				= ta_ceil;
-	s_mapStringValues["ta_cmo"]					= ta_cmo;
-	s_mapStringValues["ta_correl"]				= ta_correl;
-	s_mapStringValues["ta_cos"]					= ta_cos;
-	s_mapStringValues["ta_cosh"]				= ta_cosh;
-	s_mapStringValues["ta_dema"]				= ta_dema;
-	s_mapStringValues["ta_div"]					= ta_div;
-	s_mapStringValues["ta_dx"]					= ta_dx;
-	s_mapStringValues["ta_ema"]					= ta_ema;
-	s_mapStringValues["ta_exp"]					= ta_exp;
-	s_mapStringValues["ta_floor"]				= ta_floor;
-	s_mapStringValues["ta_ht_dcperiod"]			= ta_ht_dcperiod;
-	s_mapStringValues["ta_ht_dcphase"]			= ta_ht_dcphase;
-	s_mapStringValues["ta_ht_phasor"]			= ta_ht_phasor;
-	s_mapStringValues["ta_ht_sine"]				= ta_ht_sine;
-	s_mapStringValues["ta_ht_trendline"]		= ta_ht_trendline;
-	s_mapStringValues["ta_ht_trendmode"]		= ta_ht_trendmode;
-	s_mapStringValues["ta_kama"]				= ta_kama;
-	s_mapStringValues["ta_linearreg"]			= ta_linearreg;
-	s_mapStringValues["ta_linearreg_angle"]		= ta_linearreg_angle;
-	s_mapStringValues["ta_linearreg_intercept"]	= ta_linearreg_intercept;
-	s_mapStringValues["ta_linearreg_slope"]		= ta_linearreg_slope;
-	s_mapStringValues["ta_ln"]					= ta_ln;
-	s_mapStringValues["ta_log10"]				= ta_log10;
-	s_mapStringValues["ta_ma"]					= ta_ma;
-	s_mapStringValues["ta_macd"]				= ta_macd;
-	s_mapStringValues["ta_macdext"]				= ta_macdext;
-	s_mapStringValues["ta_macdfix"]				= ta_macdfix;
-	s_mapStringValues["ta_mama"]				= ta_mama;
-	s_mapStringValues["ta_mavp"]				= ta_mavp;
-	s_mapStringValues["ta_max"]					= ta_max;
-	s_mapStringValues["ta_maxindex"]			= ta_maxindex;
-	s_mapStringValues["ta_medprice"]			= ta_medprice;
-	s_mapStringValues["ta_mfi"]					= ta_mfi;
-	s_mapStringValues["ta_midpoint"]			= ta_midpoint;
-	s_mapStringValues["ta_midprice"]			= ta_midprice;
-	s_mapStringValues["ta_min"]					= ta_min;
-	s_mapStringValues["ta_minindex"]			= ta_minindex;
-	s_mapStringValues["ta_minmax"]				= ta_minmax;
-	s_mapStringValues["ta_minmaxindex"]			= ta_minmaxindex;
-	s_mapStringValues["ta_minus_di"]			= ta_minus_di;
-	s_mapStringValues["ta_minus_dm"]			= ta_minus_dm;
-	s_mapStringValues["ta_mom"]					= ta_mom;
-	s_mapStringValues["ta_mult"]				= ta_mult;
-	s_mapStringValues["ta_natr"]				= ta_natr;
-	s_mapStringValues["ta_obv"]					= ta_obv;
-	s_mapStringValues["ta_plus_di"]				= ta_plus_di;
-	s_mapStringValues["ta_plus_dm"]				= ta_plus_dm;
-	s_mapStringValues["ta_ppo"]					= ta_ppo;
-	s_mapStringValues["ta_roc"]					= ta_roc;
-	s_mapStringValues["ta_rocp"]				= ta_rocp;
-	s_mapStringValues["ta_rocr"]				= ta_rocr;
-	s_mapStringValues["ta_rocr100"]				= ta_rocr100;
-	s_mapStringValues["ta_rsi"]					= ta_rsi;
-	s_mapStringValues["ta_sar"]					= ta_sar;
-	s_mapStringValues["ta_sarext"]				= ta_sarext;
-	s_mapStringValues["ta_sin"]					= ta_sin;
-	s_mapStringValues["ta_sinh"]				= ta_sinh;
-	s_mapStringValues["ta_sma"]					= ta_sma;
-	s_mapStringValues["ta_sqrt"]				= ta_sqrt;
-	s_mapStringValues["ta_stddev"]				= ta_stddev;
-	s_mapStringValues["ta_stoch"]				= ta_stoch;
-	s_mapStringValues["ta_stochf"]				= ta_stochf;
-	s_mapStringValues["ta_stochrsi"]			= ta_stochrsi;
-	s_mapStringValues["ta_sub"]					= ta_sub;
-	s_mapStringValues["ta_sum"]					= ta_sum;
-	s_mapStringValues["ta_t3"]					= ta_t3;
-	s_mapStringValues["ta_tan"]					= ta_tan;
-	s_mapStringValues["ta_tanh"]				= ta_tanh;
-	s_mapStringValues["ta_tema"]				= ta_tema;
-	s_mapStringValues["ta_trange"]				= ta_trange;
-	s_mapStringValues["ta_trima"]				= ta_trima;
-	s_mapStringValues["ta_trix"]				= ta_trix;
-	s_mapStringValues["ta_tsf"]					= ta_tsf;
-	s_mapStringValues["ta_typprice"]			= ta_typprice;
-	s_mapStringValues["ta_ultosc"]				= ta_ultosc;
-	s_mapStringValues["ta_var"]					= ta_var;
-	s_mapStringValues["ta_wclprice"]			= ta_wclprice;
-	s_mapStringValues["ta_willr"]				= ta_willr;
-	s_mapStringValues["ta_wma"]					= ta_wma;
+	for (size_t ss = 0; ss < steps.size(); ss++)
+	{
+		if (steps[ss].params != NULL)
+			TA_ParamHolderFree(steps[ss].params);
+		steps[ss].params = NULL;
+	}
+}
 
+// Open | High | Low | Close | Volume columns of a pipeline or grid price array (NULL when not given).  Returns rows
+static int pipePrices(const mxArray *ohlcv, const double *pricePtrs[5])
+{
+	int rows = (int)mxGetM(ohlcv);
+	int cols = (int)mxGetN(ohlcv);
+	if (!isReal2DfullDouble(ohlcv) || rows < 1 || (cols != 1 && cols != 4 && cols != 5))
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:InputErr",
+		"Prices should be a rows x 1 (Close), rows x 4 (O | H | L | C) or rows x 5 (O | H | L | C | V) array. Aborting (%d).", codeLine);
+
+	for (int cc = 0; cc < 5; cc++)
+		pricePtrs[cc] = NULL;
+
+	const double *ohlcvPtr = mxGetPr(ohlcv);
+	if (cols == 1)
+		pricePtrs[3] = ohlcvPtr;
+	else
+	{
+		for (int cc = 0; cc < cols; cc++)
+			pricePtrs[cc] = ohlcvPtr + (size_t)cc * rows;
+	}
+
+	return rows;
+}
+
+// Function given as a name or a handle.  taNotDefined when neither
+static StringValue pipeFunc(const mxArray *funcIn)
+{
+	if (mxIsChar(funcIn))
+	{
+		char funcAsChars[TA_FUNC_NAME_CHARS];
+		return (mxGetString(funcIn, funcAsChars, TA_FUNC_NAME_CHARS) == 0) ? findTaFunc(funcAsChars) : taNotDefined;
+	}
+	if (isRealScalar(funcIn) && mxGetScalar(funcIn) >= 1 && mxGetScalar(funcIn) <= ta_wma)
+		return StringValue(int(mxGetScalar(funcIn)));
+
+	return taNotDefined;
+}
+
+// Parameters of a function from TA-Lib's abstract interface, with its outputs noted.  Returns 0, or 1 with 'errMsg' set
+static int pipeAlloc(taPipeStep &step, StringValue taFunc, char *errMsg, size_t errChars)
+{
+	step.taFunc = taFunc;
+	step.params = NULL;
+
+	// TA-Lib's abstract name is ours in upper case without the 'ta_'
+	char abstractName[TA_FUNC_NAME_CHARS];
+	const char *funcName = taFuncName(taFunc);
+	size_t cc = 0;
+	for (; funcName[cc + 3] != '\0'; cc++)
+		abstractName[cc] = (char)toupper((unsigned char)funcName[cc + 3]);
+	abstractName[cc] = '\0';
+
+	const TA_FuncInfo *funcInfo;
+	if (TA_GetFuncHandle(abstractName, &step.handle) != TA_SUCCESS || TA_GetFuncInfo(step.handle, &funcInfo) != TA_SUCCESS
+		|| TA_ParamHolderAlloc(step.handle, &step.params) != TA_SUCCESS)
+	{
+		step.params = NULL;
+		snprintf(errMsg, errChars, "('%s') is not in this build of TA-Lib", funcName);
+		return 1;
+	}
+
+	step.numOutputs = int(funcInfo->nbOutput);
+	step.intOutputs = 0;
+	for (int kk = 0; kk < step.numOutputs; kk++)
+	{
+		const TA_OutputParameterInfo *outInfo;
+		TA_GetOutputParameterInfo(step.handle, kk, &outInfo);
+		if (outInfo->type == TA_Output_Integer)
+			step.intOutputs |= 1 << kk;
+	}
+
+	return 0;
+}
+
+// Bind a function to the prices of a pipeline or grid.  Returns 0, or 1 with 'errMsg' set
+static int pipeBind(taPipeStep &step, StringValue taFunc, const double *pricePtrs[5], char *errMsg, size_t errChars)
+{
+	if (pipeAlloc(step, taFunc, errMsg, errChars) != 0)
+		return 1;
+
+	const TA_FuncInfo *funcInfo;
+	TA_GetFuncInfo(step.handle, &funcInfo);
+	const char *funcName = taFuncName(taFunc);
+
+	// Prices go to price inputs by their flags and Close to a single data series
+	int numReal = 0;
+	for (unsigned int ii = 0; ii < funcInfo->nbInput; ii++)
+	{
+		const TA_InputParameterInfo *inInfo;
+		TA_GetInputParameterInfo(step.handle, ii, &inInfo);
+
+		if (inInfo->type == TA_Input_Price)
+		{
+			if (inInfo->flags & TA_IN_PRICE_OPENINTEREST || (inInfo->flags & TA_IN_PRICE_VOLUME && pricePtrs[4] == NULL)
+				|| (inInfo->flags & (TA_IN_PRICE_OPEN | TA_IN_PRICE_HIGH | TA_IN_PRICE_LOW) && pricePtrs[0] == NULL))
+			{
+				snprintf(errMsg, errChars, "('%s') needs price columns that were not given", funcName);
+				return 1;
+			}
+			TA_SetInputParamPricePtr(step.params, ii, pricePtrs[0], pricePtrs[1], pricePtrs[2], pricePtrs[3],
+				pricePtrs[4], NULL);
+		}
+		else if (inInfo->type == TA_Input_Real && numReal++ == 0)
+			TA_SetInputParamRealPtr(step.params, ii, pricePtrs[3]);
+		else
+		{
+			snprintf(errMsg, errChars, "('%s') takes more than one data series and must be called on its own", funcName);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// Set the first 'numOpts' optional inputs, in the order the function takes them, and take the lookback.
+// Those omitted keep their defaults.  Returns 0, or 1 with 'errMsg' set
+static int pipeSetOpts(taPipeStep &step, const double *opts, int numOpts, char *errMsg, size_t errChars)
+{
+	const TA_FuncInfo *funcInfo;
+	TA_GetFuncInfo(step.handle, &funcInfo);
+
+	if (numOpts > int(funcInfo->nbOptInput))
+	{
+		snprintf(errMsg, errChars, "('%s') takes at most %u optional inputs", taFuncName(step.taFunc), funcInfo->nbOptInput);
+		return 1;
+	}
+
+	for (int oo = 0; oo < numOpts; oo++)
+	{
+		const TA_OptInputParameterInfo *optInfo;
+		TA_GetOptInputParameterInfo(step.handle, oo, &optInfo);
+		if (optInfo->type == TA_OptInput_RealRange || optInfo->type == TA_OptInput_RealList)
+			TA_SetOptInputParamReal(step.params, oo, opts[oo]);
+		else
+			TA_SetOptInputParamInteger(step.params, oo, (TA_Integer)opts[oo]);
+	}
+
+	TA_Integer lookback;
+	if (TA_GetLookback(step.params, &lookback) != TA_SUCCESS || lookback < 0)
+	{
+		snprintf(errMsg, errChars, "('%s') has an optional input out of range", taFuncName(step.taFunc));
+		return 1;
+	}
+	step.lookback = lookback;
+
+	return 0;
+}
+
+// Resolve and bind one spec of a pipeline.  Returns 0, or 1 with 'errMsg' set when the spec cannot be evaluated
+static int pipeStepInit(taPipeStep &step, const mxArray *spec, const double *pricePtrs[5], char *errMsg, size_t errChars)
+{
+	// A spec is a name or handle, alone or leading a cell of its optional inputs
+	const mxArray *funcIn = spec;
+	vector<double> opts;
+	if (mxIsCell(spec))
+	{
+		if (mxGetNumberOfElements(spec) < 1 || mxGetCell(spec, 0) == NULL)
+		{
+			snprintf(errMsg, errChars, "is an empty cell");
+			return 1;
+		}
+		funcIn = mxGetCell(spec, 0);
+
+		for (size_t oo = 1; oo < mxGetNumberOfElements(spec); oo++)
+		{
+			const mxArray *optIn = mxGetCell(spec, oo);
+			if (optIn == NULL || !isRealScalar(optIn))
+			{
+				snprintf(errMsg, errChars, "optional input %d is not a real scalar", int(oo));
+				return 1;
+			}
+			opts.push_back(mxGetScalar(optIn));
+		}
+	}
+
+	StringValue taFunc = pipeFunc(funcIn);
+	if (taFunc == taNotDefined)
+	{
+		snprintf(errMsg, errChars, "is not a function name or handle");
+		return 1;
+	}
+
+	if (pipeBind(step, taFunc, pricePtrs, errMsg, errChars) != 0)
+		return 1;
+
+	return pipeSetOpts(step, opts.empty() ? NULL : &opts[0], int(opts.size()), errMsg, errChars);
+}
+
+// Evaluate bound steps in to 'outPtr' (rows per column).  Outputs are written in place at the lookback of each
+// function and earlier rows are NaN.  The steps only read the shared prices and write their own columns so they
+// run concurrently without touching the MEX API.  Returns the index of the first step that failed, or -1
+static int pipeRun(vector<taPipeStep> &steps, int rows, double *outPtr)
+{
+	int numSteps = (int)steps.size();
+
+	for (int ss = 0; ss < numSteps; ss++)
+	{
+		taPipeStep &step = steps[ss];
+		int outBegIdx = outStart(step.lookback, rows);
+
+		if (step.intOutputs != 0)
+			step.intOut.assign((size_t)rows * step.numOutputs, 0);
+
+		for (int kk = 0; kk < step.numOutputs; kk++)
+		{
+			if (step.intOutputs & (1 << kk))
+				TA_SetOutputParamIntegerPtr(step.params, kk, &step.intOut[(size_t)kk * rows] + outBegIdx);
+			else
+				TA_SetOutputParamRealPtr(step.params, kk,
+					outPtr + (size_t)(step.firstCol + kk * step.colStep) * rows + outBegIdx);
+		}
+	}
+
+	// Functions are independent so they are shared between threads
+#pragma omp parallel for schedule(dynamic)
+	for (int ss = 0; ss < numSteps; ss++)
+	{
+		taPipeStep &step = steps[ss];
+		TA_Integer outBeg, outElements;
+
+		step.retCode = TA_CallFunc(step.params, 0, rows - 1, &outBeg, &outElements);
+
+		// NaN data before lookback.  A series no longer than the lookback has no values
+		int firstValue = (step.lookback < rows) ? step.lookback : rows;
+
+		for (int kk = 0; kk < step.numOutputs; kk++)
+		{
+			double *colOut = outPtr + (size_t)(step.firstCol + kk * step.colStep) * rows;
+
+			for (int ii = 0; ii < firstValue; ii++)
+				colOut[ii] = m_Nan;
+
+			if (step.intOutputs & (1 << kk))
+			{
+				const int *intCol = &step.intOut[(size_t)kk * rows];
+				for (int ii = firstValue; ii < rows; ii++)
+					colOut[ii] = intCol[ii];
+			}
+		}
+	}
+
+	for (int ss = 0; ss < numSteps; ss++)
+	{
+		if (steps[ss].retCode != TA_SUCCESS)
+			return ss;
+	}
+
+	return -1;
+}
+
+// [out, names] = taInvoke('pipeline', ohlcv, specs)
+// Every spec is validated and bound before any function runs
+void taPipeline(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	#define ohlcv_IN	prhs[1]
+	#define specs_IN	prhs[2]
+
+	if (nrhs != 3 || nlhs > 2)
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:NumInputs",
+		"Usage is [out, names] = taInvoke('pipeline', ohlcv, specs). Aborting (%d).", codeLine);
+
+	const double *pricePtrs[5];
+	int rows = pipePrices(ohlcv_IN, pricePtrs);
+
+	if (!mxIsCell(specs_IN) || mxGetNumberOfElements(specs_IN) < 1)
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:InputErr",
+		"Pipeline specs should be a cell array of function names or handles, e.g. {'ta_atr', {'ta_rsi',14}}. Aborting (%d).", codeLine);
+
+	int numSteps = (int)mxGetNumberOfElements(specs_IN);
+	vector<taPipeStep> steps(numSteps);
+	int numCols = 0;
+	char errMsg[160];
+
+	for (int ss = 0; ss < numSteps; ss++)
+	{
+		steps[ss].params = NULL;
+		const mxArray *spec = mxGetCell(specs_IN, ss);
+
+		if (spec == NULL || pipeStepInit(steps[ss], spec, pricePtrs, errMsg, sizeof(errMsg)) != 0)
+		{
+			if (spec == NULL)
+				snprintf(errMsg, sizeof(errMsg), "is empty");
+			pipeFree(steps);
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:BadSpec", "Pipeline spec %d %s. Aborting (%d).", ss + 1, errMsg, codeLine);
+		}
+
+		steps[ss].firstCol = numCols;
+		steps[ss].colStep = 1;
+		numCols += steps[ss].numOutputs;
+	}
+
+	plhs[0] = mxCreateDoubleMatrix(rows, numCols, mxREAL);
+
+	int failed = pipeRun(steps, rows, mxGetPr(plhs[0]));
+	if (failed >= 0)
+	{
+		int retCode = steps[failed].retCode;
+		const char *funcName = taFuncName(steps[failed].taFunc);
+		pipeFree(steps);
+		mexPrintf("%s%i","Return code=",retCode);
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:invokeErr",
+			"Invocation to '%s' (pipeline spec %d) failed. Aborting (%d).", funcName, failed + 1, codeLine);
+	}
+
+	// 'function.output' name of each column
+	if (nlhs > 1)
+	{
+		plhs[1] = mxCreateCellMatrix(1, numCols);
+		for (int ss = 0; ss < numSteps; ss++)
+		{
+			for (int kk = 0; kk < steps[ss].numOutputs; kk++)
+			{
+				const TA_OutputParameterInfo *outInfo;
+				TA_GetOutputParameterInfo(steps[ss].handle, kk, &outInfo);
+
+				string colName = string(taFuncName(steps[ss].taFunc)) + "." + outInfo->paramName;
+				mxSetCell(plhs[1], steps[ss].firstCol + kk, mxCreateString(colName.c_str()));
+			}
+		}
+	}
+
+	pipeFree(steps);
+}
+
+// Bollinger Bands of every point of a grid.  The moving average and standard deviation depend only on the lookback
+// and typeMA so they are taken once for each such pair and shared by all of its multiplier pairs.  The bands are then
+// formed as TA_BBANDS forms them, middle +/- multiplier x standard deviation.  'gridPtr' is numPoints x 4
+// (lookback | upMult | dnMult | typeMA) and 'outPtr' rows x numPoints x 3 (upper | middle | lower).
+// Returns the index of the first point that failed, or -1
+static int gridBbands(const double *closePtr, int rows, const double *gridPtr, int numPoints, double *outPtr,
+	TA_RetCode &retCode)
+{
+	// Points sharing a lookback and typeMA
+	map<pair<int, int>, int> groupOf;
+	vector<vector<int> > groupPoints;
+	for (int pp = 0; pp < numPoints; pp++)
+	{
+		pair<int, int> key(int(gridPtr[pp]), int(gridPtr[3 * numPoints + pp]));
+		map<pair<int, int>, int>::iterator it = groupOf.find(key);
+		if (it == groupOf.end())
+		{
+			it = groupOf.insert(make_pair(key, int(groupPoints.size()))).first;
+			groupPoints.push_back(vector<int>());
+		}
+		groupPoints[it->second].push_back(pp);
+	}
+
+	int numGroups = (int)groupPoints.size();
+	vector<TA_RetCode> retCodes(numGroups, TA_SUCCESS);
+
+#pragma omp parallel for schedule(dynamic)
+	for (int gg = 0; gg < numGroups; gg++)
+	{
+		const vector<int> &points = groupPoints[gg];
+		int lookback = int(gridPtr[points[0]]);
+		int typeMA = int(gridPtr[3 * numPoints + points[0]]);
+
+		// Each written in place at its own lookback
+		vector<double> maOut(rows), sdOut(rows);
+		int maLookback = TA_MA_Lookback(lookback, (TA_MAType)typeMA);
+		int sdLookback = TA_STDDEV_Lookback(lookback, 1.0);
+		TA_Integer outBeg, outElements;
+
+		retCodes[gg] = TA_MA(0, rows - 1, closePtr, lookback, (TA_MAType)typeMA, &outBeg, &outElements,
+			&maOut[0] + outStart(maLookback, rows));
+		if (retCodes[gg] == TA_SUCCESS)
+			retCodes[gg] = TA_STDDEV(0, rows - 1, closePtr, lookback, 1.0, &outBeg, &outElements,
+				&sdOut[0] + outStart(sdLookback, rows));
+		if (retCodes[gg] != TA_SUCCESS)
+			continue;
+
+		// NaN data before lookback.  A series no longer than the lookback has no values
+		int firstValue = max(maLookback, sdLookback);
+		if (firstValue > rows)
+			firstValue = rows;
+
+		for (size_t pt = 0; pt < points.size(); pt++)
+		{
+			int pp = points[pt];
+			double upMult = gridPtr[numPoints + pp];
+			double dnMult = gridPtr[2 * numPoints + pp];
+			double *upperOut = outPtr + (size_t)pp * rows;
+			double *middleOut = outPtr + ((size_t)numPoints + pp) * rows;
+			double *lowerOut = outPtr + ((size_t)2 * numPoints + pp) * rows;
+
+			for (int ii = 0; ii < firstValue; ii++)
+			{
+				upperOut[ii] = m_Nan;
+				middleOut[ii] = m_Nan;
+				lowerOut[ii] = m_Nan;
+			}
+			for (int ii = firstValue; ii < rows; ii++)
+			{
+				upperOut[ii] = maOut[ii] + sdOut[ii] * upMult;
+				middleOut[ii] = maOut[ii];
+				lowerOut[ii] = maOut[ii] - sdOut[ii] * dnMult;
+			}
+		}
+	}
+
+	for (int gg = 0; gg < numGroups; gg++)
+	{
+		if (retCodes[gg] != TA_SUCCESS)
+		{
+			retCode = retCodes[gg];
+			return groupPoints[gg][0];
+		}
+	}
+
+	return -1;
+}
+
+// [out, grid] = taInvoke('grid', ohlcv, spec)
+// Every point of the Cartesian product of the optional input vectors is validated and bound before any is evaluated
+void taGrid(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	#define ohlcv_IN	prhs[1]
+	#define spec_IN		prhs[2]
+
+	if (nrhs != 3 || nlhs > 2)
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:NumInputs",
+		"Usage is [out, grid] = taInvoke('grid', ohlcv, {taFunction, optIn1, optIn2, ...}). Aborting (%d).", codeLine);
+
+	const double *pricePtrs[5];
+	int rows = pipePrices(ohlcv_IN, pricePtrs);
+
+	StringValue taFunc = taNotDefined;
+	if (mxIsCell(spec_IN) && mxGetNumberOfElements(spec_IN) >= 1 && mxGetCell(spec_IN, 0) != NULL)
+		taFunc = pipeFunc(mxGetCell(spec_IN, 0));
+	if (taFunc == taNotDefined)
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:InputErr",
+		"A grid spec should be a cell of a function name or handle and its optional input vectors, e.g. {'ta_bbands', 10:10:50, 1:0.5:3}. Aborting (%d).", codeLine);
+
+	// The function's optional inputs and their defaults
+	char errMsg[160];
+	vector<taPipeStep> steps(1);
+	if (pipeBind(steps[0], taFunc, pricePtrs, errMsg, sizeof(errMsg)) != 0)
+	{
+		pipeFree(steps);
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:BadSpec", "Grid spec %s. Aborting (%d).", errMsg, codeLine);
+	}
+
+	const TA_FuncInfo *funcInfo;
+	TA_GetFuncInfo(steps[0].handle, &funcInfo);
+	int numOpts = int(funcInfo->nbOptInput);
+	int numOutputs = steps[0].numOutputs;
+	int numGiven = int(mxGetNumberOfElements(spec_IN)) - 1;
+
+	if (numGiven > numOpts)
+	{
+		pipeFree(steps);
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:BadSpec", "Grid spec ('%s') takes at most %d optional inputs. Aborting (%d).",
+			taFuncName(taFunc), numOpts, codeLine);
+	}
+
+	// Points are in the order of ndgrid: the first optional input varies fastest
+	double numPointsD = 1;
+	for (int oo = 0; oo < numGiven; oo++)
+	{
+		const mxArray *optIn = mxGetCell(spec_IN, oo + 1);
+		if (optIn == NULL || !isReal2DfullDouble(optIn) || mxGetNumberOfElements(optIn) < 1)
+		{
+			pipeFree(steps);
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:BadSpec", "Grid optional input %d should be a real scalar or vector. Aborting (%d).",
+				oo + 1, codeLine);
+		}
+		numPointsD *= double(mxGetNumberOfElements(optIn));
+	}
+	if (numPointsD * numOutputs * rows > double(numeric_limits<int>::max()))
+	{
+		pipeFree(steps);
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:BadSpec", "A grid of %.0f points is too large to be returned. Aborting (%d).",
+			numPointsD, codeLine);
+	}
+	int numPoints = int(numPointsD);
+
+	mxArray *grid = mxCreateDoubleMatrix(numPoints, numOpts, mxREAL);
+	double *gridPtr = mxGetPr(grid);
+
+	for (int oo = 0; oo < numOpts; oo++)
+	{
+		const TA_OptInputParameterInfo *optInfo;
+		TA_GetOptInputParameterInfo(steps[0].handle, oo, &optInfo);
+
+		const double *values = (oo < numGiven) ? mxGetPr(mxGetCell(spec_IN, oo + 1)) : &optInfo->defaultValue;
+		int numValues = (oo < numGiven) ? (int)mxGetNumberOfElements(mxGetCell(spec_IN, oo + 1)) : 1;
+
+		int stride = 1;
+		for (int prev = 0; prev < oo && prev < numGiven; prev++)
+			stride *= (int)mxGetNumberOfElements(mxGetCell(spec_IN, prev + 1));
+
+		for (int pp = 0; pp < numPoints; pp++)
+			gridPtr[(size_t)oo * numPoints + pp] = values[(pp / stride) % numValues];
+	}
+
+	mwSize dims[3] = {(mwSize)rows, (mwSize)numPoints, (mwSize)numOutputs};
+	plhs[0] = mxCreateNumericArray(3, dims, mxDOUBLE_CLASS, mxREAL);
+	double *outPtr = mxGetPr(plhs[0]);
+
+	int failed;
+	TA_RetCode retCode = TA_SUCCESS;
+	vector<double> pointOpts(numOpts);
+
+	if (taFunc == ta_bbands)
+	{
+		// Each point is still checked as its own call would be
+		for (int pp = 0; pp < numPoints; pp++)
+		{
+			if (TA_BBANDS_Lookback(int(gridPtr[pp]), gridPtr[numPoints + pp], gridPtr[2 * numPoints + pp],
+				(TA_MAType)int(gridPtr[3 * numPoints + pp])) < 0)
+			{
+				pipeFree(steps);
+				mexErrMsgIdAndTxt("MATLAB:taInvoke:BadSpec", "Grid point %d ('%s') has an optional input out of range. Aborting (%d).",
+					pp + 1, taFuncName(taFunc), codeLine);
+			}
+		}
+		pipeFree(steps);
+
+		failed = gridBbands(pricePtrs[3], rows, gridPtr, numPoints, outPtr, retCode);
+	}
+	else
+	{
+		// One bound step per point
+		steps.resize(numPoints);
+		for (int pp = 0; pp < numPoints; pp++)
+		{
+			for (int oo = 0; oo < numOpts; oo++)
+				pointOpts[oo] = gridPtr[(size_t)oo * numPoints + pp];
+
+			if ((pp > 0 && pipeBind(steps[pp], taFunc, pricePtrs, errMsg, sizeof(errMsg)) != 0)
+				|| pipeSetOpts(steps[pp], numOpts > 0 ? &pointOpts[0] : NULL, numOpts, errMsg, sizeof(errMsg)) != 0)
+			{
+				steps.resize(pp + 1);
+				pipeFree(steps);
+				mexErrMsgIdAndTxt("MATLAB:taInvoke:BadSpec", "Grid point %d %s. Aborting (%d).", pp + 1, errMsg, codeLine);
+			}
+
+			steps[pp].firstCol = pp;
+			steps[pp].colStep = numPoints;
+		}
+
+		failed = pipeRun(steps, rows, outPtr);
+		if (failed >= 0)
+			retCode = steps[failed].retCode;
+		pipeFree(steps);
+	}
+
+	if (failed >= 0)
+	{
+		mexPrintf("%s%i","Return code=",retCode);
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:invokeErr",
+			"Invocation to '%s' (grid point %d) failed. Aborting (%d).", taFuncName(taFunc), failed + 1, codeLine);
+	}
+
+	if (nlhs > 1)
+		plhs[1] = grid;
+	else
+		mxDestroyArray(grid);
+}
+
+// Number of data series a function takes in its ordinary call: one per price of a price input (in the order
+// O | H | L | C | V) and one per other input
+static int panelNumSeries(const TA_FuncHandle *handle)
+{
+	const TA_FuncInfo *funcInfo;
+	TA_GetFuncInfo(handle, &funcInfo);
+
+	int numSeries = 0;
+	for (unsigned int ii = 0; ii < funcInfo->nbInput; ii++)
+	{
+		const TA_InputParameterInfo *inInfo;
+		TA_GetInputParameterInfo(handle, ii, &inInfo);
+
+		if (inInfo->type == TA_Input_Price)
+		{
+			for (int price = 0; price < 6; price++)
+				numSeries += (inInfo->flags & (TA_IN_PRICE_OPEN << price)) != 0;
+		}
+		else
+			numSeries++;
+	}
+
+	return numSeries;
+}
+
+// Bind the data series of one panel column, given in the order of the ordinary call
+static void panelBind(taPipeStep &step, const double *const *seriesPtrs)
+{
+	const TA_FuncInfo *funcInfo;
+	TA_GetFuncInfo(step.handle, &funcInfo);
+
+	int next = 0;
+	for (unsigned int ii = 0; ii < funcInfo->nbInput; ii++)
+	{
+		const TA_InputParameterInfo *inInfo;
+		TA_GetInputParameterInfo(step.handle, ii, &inInfo);
+
+		if (inInfo->type == TA_Input_Price)
+		{
+			// Open | High | Low | Close | Volume | Open Interest
+			const double *pricePtrs[6] = {NULL, NULL, NULL, NULL, NULL, NULL};
+			for (int price = 0; price < 6; price++)
+			{
+				if (inInfo->flags & (TA_IN_PRICE_OPEN << price))
+					pricePtrs[price] = seriesPtrs[next++];
+			}
+			TA_SetInputParamPricePtr(step.params, ii, pricePtrs[0], pricePtrs[1], pricePtrs[2], pricePtrs[3],
+				pricePtrs[4], pricePtrs[5]);
+		}
+		else
+			TA_SetInputParamRealPtr(step.params, ii, seriesPtrs[next++]);
+	}
+}
+
+// Optional inputs whose default in the ordinary call is not TA-Lib's, by their position in TA-Lib's order
+typedef struct panelDefault
+{
+	StringValue taFunc;
+	int opt;
+	double value;
+} panelDefault;
+
+static const panelDefault s_panelDefaults[] = {{ta_accbands, 0, 14}, {ta_cdldarkcloudcover, 0, 0.3},
+	{ta_cdlmathold, 0, 0.3}, {ta_ma, 0, 14}, {ta_mom, 0, 14}};
+
+// Optional inputs of a panel call as the ordinary call takes them: counts the ordinary call finds ambiguous are
+// refused, omitted inputs take the ordinary call's defaults and the values are held to its limits.
+// 'opts' holds the 'numGiven' inputs given and is completed to every optional input.  Returns 0, or 1 with 'errMsg' set
+static int panelOpts(StringValue taFunc, const TA_FuncHandle *handle, int numGiven, vector<double> &opts, char *errMsg,
+					 size_t errChars)
+{
+	const char *funcName = taFuncName(taFunc);
+
+	if ((numGiven == 1 && (taFunc == ta_apo || taFunc == ta_ppo || taFunc == ta_macd))
+		|| (numGiven == 2 && taFunc == ta_bbands)
+		|| (taFunc == ta_macdext && ((numGiven >= 1 && numGiven <= 3) || numGiven == 5)))
+	{
+		snprintf(errMsg, errChars, "('%s') cannot interpret %d optional inputs", funcName, numGiven);
+		return 1;
+	}
+
+	const TA_FuncInfo *funcInfo;
+	TA_GetFuncInfo(handle, &funcInfo);
+	int numOpts = int(funcInfo->nbOptInput);
+	opts.resize(numOpts);
+
+	for (int oo = numGiven; oo < numOpts; oo++)
+	{
+		const TA_OptInputParameterInfo *optInfo;
+		TA_GetOptInputParameterInfo(handle, oo, &optInfo);
+		opts[oo] = optInfo->defaultValue;
+
+		for (size_t dd = 0; dd < sizeof(s_panelDefaults) / sizeof(s_panelDefaults[0]); dd++)
+		{
+			if (s_panelDefaults[dd].taFunc == taFunc && s_panelDefaults[dd].opt == oo)
+				opts[oo] = s_panelDefaults[dd].value;
+		}
+	}
+
+	// The limits of each ordinary call
+	const double *opt = opts.empty() ? NULL : &opts[0];
+	const char *limit = NULL;
+	switch (taFunc)
+	{
+		case ta_adosc:
+			if (opt[0] > opt[1])
+				limit = "fastMA must not be greater than slowMA";
+			break;
+		case ta_apo:
+		case ta_ppo:
+			if (opt[0] > opt[1])
+				limit = "fastMA must not be greater than slowMA";
+			else if (opt[2] < 0 || opt[2] > 8)
+				limit = "typeMA must be between 0 - 8";
+			break;
+		case ta_rsi:
+		case ta_sma:
+		case ta_sum:
+		case ta_tema:
+		case ta_trima:
+		case ta_tsf:
+		case ta_wma:
+		case ta_dema:
+		case ta_dx:
+		case ta_ema:
+		case ta_kama:
+		case ta_linearreg:
+		case ta_linearreg_angle:
+		case ta_linearreg_intercept:
+		case ta_linearreg_slope:
+		case ta_max:
+		case ta_maxindex:
+		case ta_mfi:
+		case ta_midpoint:
+		case ta_midprice:
+		case ta_min:
+		case ta_minindex:
+		case ta_minmax:
+		case ta_minmaxindex:
+		case ta_stddev:
+		case ta_var:
+		case ta_willr:
+			if (opt[0] < 2)
+				limit = "lookback must be 2 or greater";
+			break;
+		case ta_avgdev:
+		case ta_roc:
+		case ta_rocp:
+		case ta_rocr:
+		case ta_rocr100:
+		case ta_trix:
+		case ta_minus_di:
+		case ta_minus_dm:
+		case ta_mom:
+		case ta_natr:
+		case ta_plus_di:
+		case ta_plus_dm:
+			if (opt[0] < 1)
+				limit = "lookback must be 1 or greater";
+			break;
+		case ta_ma:
+			if (opt[0] < 1)
+				limit = "lookback must be 1 or greater";
+			else if (opt[1] < 0 || opt[1] > 8)
+				limit = "typeMA must be between 0 - 8";
+			break;
+		case ta_bbands:
+			if (opt[3] < 0 || opt[3] > 8)
+				limit = "typeMA must be between 0 - 8";
+			break;
+		case ta_cdlabandonedbaby:
+		case ta_cdldarkcloudcover:
+		case ta_cdleveningdojistar:
+		case ta_cdleveningstar:
+		case ta_cdlmathold:
+		case ta_cdlmorningdojistar:
+		case ta_cdlmorningstar:
+			if (opt[0] < 0 || opt[0] > 1)
+				limit = "penetration must be between 0 - 1";
+			break;
+		case ta_macd:
+			if (opt[0] > opt[1])
+				limit = "fastMA must not be greater than slowMA";
+			else if (opt[0] < 2 || opt[1] < 2)
+				limit = "fastMA and slowMA must be 2 or greater";
+			else if (opt[2] < 1)
+				limit = "smoothP must be 1 or greater";
+			break;
+		case ta_macdext:
+			if (opt[0] > opt[2])
+				limit = "fastMA must not be greater than slowMA";
+			else if (opt[0] < 2 || opt[2] < 2)
+				limit = "fastMA and slowMA must be 2 or greater";
+			else if (opt[4] < 1)
+				limit = "smoothP must be 1 or greater";
+			else if (opt[1] < 0 || opt[1] > 8 || opt[3] < 0 || opt[3] > 8 || opt[5] < 0 || opt[5] > 8)
+				limit = "average types must be between 0 - 8";
+			break;
+		case ta_macdfix:
+			if (opt[0] < 1)
+				limit = "smoothP must be 1 or greater";
+			break;
+		case ta_mama:
+			if (opt[0] < .01 || opt[0] > .99 || opt[1] < .01 || opt[1] > .99)
+				limit = "fastLmt and slowLmt must be between 0.01 - 0.99";
+			else if (opt[1] > opt[0])
+				limit = "slowLmt must not be greater than fastLmt";
+			break;
+		case ta_mavp:
+			if (opt[0] < 2 || opt[1] < 2)
+				limit = "minPeriod and maxPeriod must be 2 or greater";
+			else if (opt[0] > opt[1])
+				limit = "minPeriod must not be greater than maxPeriod";
+			else if (opt[2] < 0 || opt[2] > 8)
+				limit = "typeMA must be between 0 - 8";
+			break;
+		case ta_sar:
+		case ta_sarext:
+			for (int oo = 0; oo < numOpts; oo++)
+			{
+				if (opt[oo] < 0)
+					limit = "optional inputs must not be negative";
+			}
+			break;
+		case ta_stoch:
+			if (opt[0] < 1 || opt[1] < 1 || opt[3] < 1)
+				limit = "periods must be 1 or greater";
+			else if (opt[2] < 0 || opt[2] > 8 || opt[4] < 0 || opt[4] > 8)
+				limit = "average types must be between 0 - 8";
+			break;
+		case ta_stochf:
+			if (opt[0] < 1 || opt[1] < 1)
+				limit = "periods must be 1 or greater";
+			else if (opt[2] < 0 || opt[2] > 8)
+				limit = "fastDtypeMA must be between 0 - 8";
+			break;
+		case ta_stochrsi:
+			if (opt[0] < 2)
+				limit = "lookback must be 2 or greater";
+			else if (opt[1] < 1 || opt[2] < 1)
+				limit = "fastK and fastD periods must be 1 or greater";
+			else if (opt[3] < 0 || opt[3] > 8)
+				limit = "fastDtypeMA must be between 0 - 8";
+			break;
+		case ta_t3:
+			if (opt[0] < 2)
+				limit = "lookback must be 2 or greater";
+			else if (opt[1] < 0 || opt[1] > 1)
+				limit = "vFactor must be between 0 - 1";
+			break;
+		case ta_ultosc:
+			if (opt[0] > opt[1] || opt[0] > opt[2] || opt[1] > opt[2])
+				limit = "lookbacks must be given shortest first";
+			else if (opt[0] < 1)
+				limit = "lookbacks must be 1 or greater";
+			break;
+		default:
+			break;
+	}
+
+	if (limit != NULL)
+	{
+		snprintf(errMsg, errChars, "('%s') %s", funcName, limit);
+		return 1;
+	}
+
+	return 0;
+}
+
+// [varout] = taInvoke(taFunction, varin) where the data series are N x M panels, one column per series.
+// Every column is evaluated as its own call would be, with its optional inputs, defaults and limits (see panelOpts),
+// and the outputs are N x M in Matlab's column major layout.
+// A series may also be N x 1 and is then shared by every column (e.g. the base of ta_beta).
+// Leading NaNs of a column are history from before the series began: they stay NaN and the column's values start
+// from its first row where every series has a value, as relStrIdx does with a price panel.
+// The columns only read their own series and write their own outputs so they are shared between threads
+void taPanel(StringValue taFunc, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	const char *funcName = taFuncName(taFunc);
+	char errMsg[160];
+
+	vector<taPipeStep> steps(1);
+	if (pipeAlloc(steps[0], taFunc, errMsg, sizeof(errMsg)) != 0)
+	{
+		pipeFree(steps);
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:BadSpec", "Panel call %s. Aborting (%d).", errMsg, codeLine);
+	}
+
+	const TA_FuncInfo *funcInfo;
+	TA_GetFuncInfo(steps[0].handle, &funcInfo);
+	int numSeries = panelNumSeries(steps[0].handle);
+	int numGiven = nrhs - 1 - numSeries;
+	int numOutputs = steps[0].numOutputs;
+	int intOutputs = steps[0].intOutputs;
+
+	if (numGiven < 0 || numGiven > int(funcInfo->nbOptInput) || nlhs > numOutputs)
+	{
+		pipeFree(steps);
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:NumInputs",
+			"Number of arguments to function '%s' is incorrect. A panel call takes %d data series, up to %u optional inputs and returns up to %d outputs. Aborting (%d).",
+			funcName, numSeries, funcInfo->nbOptInput, numOutputs, codeLine);
+	}
+
+	int rows = (int)mxGetM(prhs[1]);
+	int cols = 1;
+	for (int ss = 0; ss < numSeries; ss++)
+		cols = max(cols, (int)mxGetN(prhs[ss + 1]));
+
+	for (int ss = 0; ss < numSeries; ss++)
+	{
+		const mxArray *series = prhs[ss + 1];
+		if (!isReal2DfullDouble(series) || rows < 1 || (int)mxGetM(series) != rows
+			|| ((int)mxGetN(series) != cols && mxGetN(series) != 1))
+		{
+			pipeFree(steps);
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:InputErr",
+				"Data series %d to '%s' should be a real %d x %d panel or %d x 1 vector. Aborting (%d).",
+				ss + 1, funcName, rows, cols, rows, codeLine);
+		}
+	}
+
+	vector<double> opts(numGiven);
+	for (int oo = 0; oo < numGiven; oo++)
+	{
+		if (!isRealScalar(prhs[numSeries + 1 + oo]))
+		{
+			pipeFree(steps);
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:InputErr", "Optional input %d to '%s' should be a real scalar. Aborting (%d).",
+				oo + 1, funcName, codeLine);
+		}
+		opts[oo] = mxGetScalar(prhs[numSeries + 1 + oo]);
+	}
+
+	if (panelOpts(taFunc, steps[0].handle, numGiven, opts, errMsg, sizeof(errMsg)) != 0)
+	{
+		pipeFree(steps);
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:inputErr", "Panel call %s. Aborting (%d).", errMsg, codeLine);
+	}
+	int numOpts = int(opts.size());
+
+	// One bound step per column, starting at the column's first complete row
+	steps.resize(cols);
+	vector<int> starts(cols);
+	vector<const double*> seriesPtrs(numSeries);
+
+	for (int col = 0; col < cols; col++)
+	{
+		int start = 0;
+		for (int ss = 0; ss < numSeries; ss++)
+		{
+			seriesPtrs[ss] = mxGetPr(prhs[ss + 1]) + ((mxGetN(prhs[ss + 1]) == 1) ? 0 : (size_t)col * rows);
+
+			int first = 0;
+			while (first < rows && seriesPtrs[ss][first] != seriesPtrs[ss][first])
+			{
+				first++;
+			}
+			start = max(start, first);
+		}
+		starts[col] = start;
+
+		for (int ss = 0; ss < numSeries; ss++)
+			seriesPtrs[ss] += start;
+
+		if ((col > 0 && pipeAlloc(steps[col], taFunc, errMsg, sizeof(errMsg)) != 0)
+			|| pipeSetOpts(steps[col], numOpts > 0 ? &opts[0] : NULL, numOpts, errMsg, sizeof(errMsg)) != 0)
+		{
+			steps.resize(col + 1);
+			pipeFree(steps);
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:BadSpec", "Panel call %s. Aborting (%d).", errMsg, codeLine);
+		}
+		panelBind(steps[col], &seriesPtrs[0]);
+	}
+
+	// Outputs are written in place at each column's start and lookback
+	vector<mxArray*> outArrays(numOutputs);
+	for (int kk = 0; kk < numOutputs; kk++)
+	{
+		if (intOutputs & (1 << kk))
+			outArrays[kk] = mxCreateNumericMatrix(rows, cols, mxINT32_CLASS, mxREAL);
+		else
+			outArrays[kk] = mxCreateDoubleMatrix(rows, cols, mxREAL);
+	}
+
+	for (int col = 0; col < cols; col++)
+	{
+		size_t outBegIdx = (size_t)col * rows + starts[col] + outStart(steps[col].lookback, rows - starts[col]);
+
+		for (int kk = 0; kk < numOutputs; kk++)
+		{
+			if (intOutputs & (1 << kk))
+				TA_SetOutputParamIntegerPtr(steps[col].params, kk, (int*)mxGetData(outArrays[kk]) + outBegIdx);
+			else
+				TA_SetOutputParamRealPtr(steps[col].params, kk, mxGetPr(outArrays[kk]) + outBegIdx);
+		}
+	}
+
+	bool isIndex = (taFunc == ta_maxindex || taFunc == ta_minindex || taFunc == ta_minmaxindex);
+
+#pragma omp parallel for schedule(dynamic)
+	for (int col = 0; col < cols; col++)
+	{
+		taPipeStep &step = steps[col];
+		int colRows = rows - starts[col];
+		TA_Integer outBeg, outElements;
+
+		step.retCode = (colRows > 0) ? TA_CallFunc(step.params, 0, colRows - 1, &outBeg, &outElements) : TA_SUCCESS;
+
+		// NaN data before the start and lookback.  A series no longer than the lookback has no values
+		int firstValue = starts[col] + min(step.lookback, colRows);
+
+		for (int kk = 0; kk < numOutputs; kk++)
+		{
+			if (intOutputs & (1 << kk))
+			{
+				// Indices are of the bound series.  Shift them to rows of the column
+				if (isIndex && starts[col] > 0)
+				{
+					int *colIdx = (int*)mxGetData(outArrays[kk]) + (size_t)col * rows;
+					for (int ii = firstValue; ii < rows; ii++)
+						colIdx[ii] += starts[col];
+				}
+				continue;
+			}
+
+			double *colOut = mxGetPr(outArrays[kk]) + (size_t)col * rows;
+			for (int ii = 0; ii < firstValue; ii++)
+				colOut[ii] = m_Nan;
+		}
+	}
+
+	for (int col = 0; col < cols; col++)
+	{
+		if (steps[col].retCode != TA_SUCCESS)
+		{
+			int retCode = steps[col].retCode;
+			pipeFree(steps);
+			mexPrintf("%s%i","Return code=",retCode);
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:invokeErr",
+				"Invocation to '%s' (panel column %d) failed. Aborting (%d).", funcName, col + 1, codeLine);
+		}
+	}
+	pipeFree(steps);
+
+	// Outputs in the order of the ordinary call.  ta_aroon returns Up before Down, the reverse of TA-Lib
+	for (int kk = 0; kk < numOutputs; kk++)
+	{
+		int taOut = (taFunc == ta_aroon) ? numOutputs - 1 - kk : kk;
+
+		if (kk < max(nlhs, 1))
+			plhs[kk] = outArrays[taOut];
+		else
+			mxDestroyArray(outArrays[taOut]);
+	}
+}
+
+// Streaming functions in taStreamFunc order, their optional inputs when not given (TA-Lib's defaults) and the
+// unstable period they take from TA-Lib (TA_FUNC_UNST_NONE for none)
+static const StringValue s_streamFuncs[] = {ta_sma, ta_ema, ta_wma, ta_rsi, ta_atr, ta_adx, ta_macd, ta_sar, ta_bbands};
+static const int s_streamNumOpts[] = {1, 1, 1, 1, 1, 1, 3, 2, 4};
+static const double s_streamDefaults[][TA_STREAM_MAX_OPTS] = {{30}, {30}, {30}, {14}, {14}, {14}, {12, 26, 9},
+	{0.02, 0.20}, {5, 2, 2, 0}};
+static const TA_FuncUnstId s_streamUnstable[] = {TA_FUNC_UNST_NONE, TA_FUNC_UNST_EMA, TA_FUNC_UNST_NONE,
+	TA_FUNC_UNST_RSI, TA_FUNC_UNST_ATR, TA_FUNC_UNST_ADX, TA_FUNC_UNST_EMA, TA_FUNC_UNST_NONE, TA_FUNC_UNST_EMA};
+
+// Streaming states by handle
+static map<int, taStreamState*> s_taStreams;
+static int s_taNextStream = 1;
+
+// Release every stream when taInvoke is cleared
+static void clearStreams()
+{
+	for (map<int, taStreamState*>::iterator iter = s_taStreams.begin(); iter != s_taStreams.end(); iter++)
+		delete iter->second;
+	s_taStreams.clear();
+}
+
+// Registered once by mexFunction.  Releases the cached outputs and any streams left open when taInvoke is cleared
+void taInvokeAtExit()
+{
+	cacheFree();
+	clearStreams();
+}
+
+// Look up a stream by handle
+static taStreamState *getStream(const mxArray *handle_IN)
+{
+	if (!isRealScalar(handle_IN))
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:BadHandle",
+		"The stream handle must be a scalar as returned by 'create'. Aborting (%d).", codeLine);
+
+	map<int, taStreamState*>::iterator iter = s_taStreams.find(int(mxGetScalar(handle_IN)));
+	if (iter == s_taStreams.end())
+		mexErrMsgIdAndTxt("MATLAB:taInvoke:BadHandle",
+		"The stream handle is not valid or has been destroyed. Aborting (%d).", codeLine);
+
+	return iter->second;
+}
+
+// Data series of a stream given from prhs[0].  They must be vectors of the same length and may be empty.  Returns rows
+static size_t streamSeries(int func, const mxArray *prhs[], const double *seriesPtrs[3])
+{
+	const int numSeries = taStreamNumSeries(func);
+	const size_t rows = mxGetNumberOfElements(prhs[0]);
+
+	for (int ss = 0; ss < numSeries; ss++)
+	{
+		if (!isReal2DfullDouble(prhs[ss]) || (mxGetM(prhs[ss]) > 1 && mxGetN(prhs[ss]) > 1) || mxGetNumberOfElements(prhs[ss]) != rows)
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:InputErr",
+			"Stream data should be %d vector(s) of equal length. Aborting (%d).", numSeries, codeLine);
+		seriesPtrs[ss] = mxGetPr(prhs[ss]);
+	}
+
+	return rows;
+}
+
+// Push 'rows' bars and return 'numOuts' of the stream's outputs for each bar, rows x 1 each, in outs
+static void streamPush(taStreamState &st, const double *seriesPtrs[3], size_t rows, int numOuts, mxArray *outs[])
+{
+	const int numSeries = taStreamNumSeries(st.func);
+
+	double *outPtrs[TA_STREAM_MAX_OUTPUTS];
+	for (int kk = 0; kk < numOuts; kk++)
+	{
+		outs[kk] = mxCreateDoubleMatrix(rows, 1, mxREAL);
+		outPtrs[kk] = mxGetPr(outs[kk]);
+	}
+
+	double bar[3];
+	for (size_t ii = 0; ii < rows; ii++)
+	{
+		for (int ss = 0; ss < numSeries; ss++)
+			bar[ss] = seriesPtrs[ss][ii];
+
+		taStreamPush(st, bar);
+
+		for (int kk = 0; kk < numOuts; kk++)
+			outPtrs[kk][ii] = st.values[kk];
+	}
+}
+
+// Streaming (bar by bar) functions of taStream.h for ta_sma, ta_ema, ta_wma, ta_rsi, ta_atr, ta_adx, ta_macd, ta_sar
+// and ta_bbands.  Each update is O(1) per bar and the values are those of the function called over every bar taken
+//	[h, varout] = taInvoke('create', taFunction, varin)	varin is the function's data series (history, which may be
+//								empty) and optional inputs as in a call.  varout are the
+//								outputs of the history
+//	[varout] = taInvoke('update', h, data)			Take the new bars and return the outputs of each
+//	[varout] = taInvoke('value', h)				Outputs of the last bar taken (NaN before the lookback)
+//	taInvoke('destroy', h)					Release the stream
+// TA-Lib's unstable period of the function (TA_SetUnstablePeriod) is taken when the stream is created
+void taStreamCommand(const char *cmd, int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+	if (strcmp(cmd, "create") == 0)
+	{
+		StringValue taFunc = (nrhs > 1) ? pipeFunc(prhs[1]) : taNotDefined;
+		int func = 0;
+		while (func <= TA_STREAM_BBANDS && s_streamFuncs[func] != taFunc)
+			func++;
+
+		if (func > TA_STREAM_BBANDS)
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:NoStream",
+			"Streams are available for ta_sma, ta_ema, ta_wma, ta_rsi, ta_atr, ta_adx, ta_macd, ta_sar and ta_bbands. Aborting (%d).", codeLine);
+
+		const int numSeries = taStreamNumSeries(func);
+		const int numOutputs = taStreamNumOutputs(func);
+		const int numOpts = nrhs - 2 - numSeries;
+
+		if (numOpts < 0 || numOpts > s_streamNumOpts[func] || nlhs > 1 + numOutputs)
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:NumInputs",
+			"Usage is [h, varout] = taInvoke('create', '%s', varin) with %d data series and up to %d optional inputs and %d outputs. Aborting (%d).",
+			taFuncName(taFunc), numSeries, s_streamNumOpts[func], numOutputs, codeLine);
+
+		double opts[TA_STREAM_MAX_OPTS];
+		for (int oo = 0; oo < TA_STREAM_MAX_OPTS; oo++)
+		{
+			opts[oo] = s_streamDefaults[func][oo];
+			if (oo < numOpts)
+			{
+				if (!isRealScalar(prhs[2 + numSeries + oo]))
+					mexErrMsgIdAndTxt("MATLAB:taInvoke:inputErr",
+					"Optional input %d of '%s' must be a scalar. Aborting (%d).", oo + 1, taFuncName(taFunc), codeLine);
+				opts[oo] = mxGetScalar(prhs[2 + numSeries + oo]);
+			}
+		}
+
+		const int unstable = (s_streamUnstable[func] == TA_FUNC_UNST_NONE) ? 0 : int(TA_GetUnstablePeriod(s_streamUnstable[func]));
+
+		const double *seriesPtrs[3];
+		const size_t rows = streamSeries(func, prhs + 2, seriesPtrs);
+
+		taStreamState *st = new taStreamState;
+		if (taStreamInit(*st, func, opts, unstable) != 0)
+		{
+			delete st;
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:inputErr",
+			"An optional input of '%s' is outside its range. Aborting (%d).", taFuncName(taFunc), codeLine);
+		}
+
+		// The history is taken as bars before the handle is returned
+		mxArray *outs[TA_STREAM_MAX_OUTPUTS];
+		streamPush(*st, seriesPtrs, rows, max(nlhs - 1, 0), outs);
+
+		int handle = s_taNextStream++;
+		s_taStreams[handle] = st;
+
+		plhs[0] = mxCreateDoubleScalar(handle);
+		for (int kk = 0; kk < nlhs - 1; kk++)
+			plhs[1 + kk] = outs[kk];
+	}
+	else if (strcmp(cmd, "update") == 0)
+	{
+		taStreamState *st = (nrhs > 1) ? getStream(prhs[1]) : NULL;
+
+		if (st == NULL || nrhs != 2 + taStreamNumSeries(st->func) || nlhs > taStreamNumOutputs(st->func))
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:NumInputs",
+			"Usage is [varout] = taInvoke('update', h, data) with one vector of new bars per data series of the function. Aborting (%d).", codeLine);
+
+		const double *seriesPtrs[3];
+		const size_t rows = streamSeries(st->func, prhs + 2, seriesPtrs);
+		streamPush(*st, seriesPtrs, rows, max(nlhs, 1), plhs);
+	}
+	else if (strcmp(cmd, "value") == 0)
+	{
+		taStreamState *st = (nrhs == 2) ? getStream(prhs[1]) : NULL;
+
+		if (st == NULL || nlhs > taStreamNumOutputs(st->func))
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:NumInputs",
+			"Usage is [varout] = taInvoke('value', h). Aborting (%d).", codeLine);
+
+		for (int kk = 0; kk < max(nlhs, 1); kk++)
+			plhs[kk] = mxCreateDoubleScalar(st->values[kk]);
+	}
+	else
+	{
+		if (nrhs != 2 || nlhs > 0)
+			mexErrMsgIdAndTxt("MATLAB:taInvoke:NumInputs",
+			"Usage is taInvoke('destroy', h). Aborting (%d).", codeLine);
+
+		taStreamState *st = getStream(prhs[1]);
+		s_taStreams.erase(int(mxGetScalar(prhs[1])));
+		delete st;
+	}
 }
 
 // Validation Methods
@@ -10605,7 +12294,7 @@ void typeMAcheck(string taFuncNameIn, string taFuncDesc, string taFuncOptName, i
 	}
 }
 
-void taInvokeFuncInfo(string taFuncNameIn)
+void taInvokeFuncInfo(StringValue taFunc, const char *taFuncNameIn)
 {
 	char *para1;
 	char *para2 = NULL;
@@ -10614,7 +12303,7 @@ void taInvokeFuncInfo(string taFuncNameIn)
 	char *form = NULL;
 	char *typeOut;
 
-	switch (s_mapStringValues[taFuncNameIn])
+	switch (taFunc)
 	{
 		case ta_accbands:
 			{